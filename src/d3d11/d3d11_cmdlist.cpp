@@ -13,7 +13,18 @@ namespace dxvk {
   
   
   D3D11CommandList::~D3D11CommandList() {
-    
+    // Return all chunks that are no longer in use to
+    // the pool at once rather than locking it per chunk
+    small_vector<DxvkCsChunk*, 64> chunks;
+
+    for (auto& entry : m_chunks) {
+      DxvkCsChunk* chunk = entry.chunk.release();
+
+      if (chunk)
+        chunks.push_back(chunk);
+    }
+
+    m_parent->GetCsChunkPool()->freeChunks(chunks.size(), chunks.data());
   }
   
   
@@ -121,6 +132,14 @@ namespace dxvk {
   }
 
 
+  void D3D11CommandList::ReserveStorage(
+    const D3D11CommandList*   pCommandList) {
+    m_chunks.reserve(pCommandList->m_chunks.size());
+    m_queries.reserve(pCommandList->m_queries.size());
+    m_resources.reserve(pCommandList->m_resources.size());
+  }
+
+
   void D3D11CommandList::TrackResourceSequenceNumber(
     const D3D11ResourceRef&   Resource,
           uint64_t            Seq) {
@@ -43,6 +43,9 @@ namespace dxvk {
             UINT                Subresource,
             uint64_t            ChunkId);
 
+    void ReserveStorage(
+      const D3D11CommandList*   pCommandList);
+
   private:
 
     struct ChunkEntry {
@@ -18,6 +18,7 @@ namespace dxvk {
     m_device    (Device),
     m_flags     (ContextFlags),
     m_staging   (Device, StagingBufferSize),
+    m_csChunkCache(pParent->GetCsChunkPool()),
     m_csFlags   (CsFlags),
     m_csChunk   (AllocCsChunk()) {
     // Create local allocation cache with the same properties
@@ -55,6 +56,10 @@ namespace dxvk {
 
     if (tessFactorOption > 0 && tessFactorOption < int32_t(m_maxTessFactor))
       m_maxTessFactor = tessFactorOption;
+
+    // API traces only cover the immediate context
+    if constexpr (!IsDeferred)
+      m_trace = pParent->GetTraceWriter();
   }
 
 
@@ -121,6 +126,9 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::ClearState() {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::ClearState);
+
     ResetCommandListState();
     ResetContextState();
   }
@@ -264,6 +272,12 @@ namespace dxvk {
           UINT                              CopyFlags) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::CopySubresourceRegion,
+        pDstResource, DstSubresource, DstX, DstY, DstZ,
+        pSrcResource, SrcSubresource, TraceArray(pSrcBox, 1u), CopyFlags);
+    }
+
     if (!pDstResource || !pSrcResource)
       return;
 
@@ -336,6 +350,9 @@ namespace dxvk {
           ID3D11Resource*                   pSrcResource) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::CopyResource, pDstResource, pSrcResource);
+
     if (!pDstResource || !pSrcResource || (pDstResource == pSrcResource))
       return;
 
@@ -427,6 +444,9 @@ namespace dxvk {
     const FLOAT                             ColorRGBA[4]) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::ClearRenderTargetView, pRenderTargetView, TraceArray(ColorRGBA, 4u));
+
     auto rtv = static_cast<D3D11RenderTargetView*>(pRenderTargetView);
 
     if (!rtv)
@@ -454,6 +474,9 @@ namespace dxvk {
     const UINT                              Values[4]) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::ClearUnorderedAccessViewUint, pUnorderedAccessView, TraceArray(Values, 4u));
+
     if (!pUnorderedAccessView)
       return;
 
@@ -596,6 +619,9 @@ namespace dxvk {
     const FLOAT                             Values[4]) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::ClearUnorderedAccessViewFloat, pUnorderedAccessView, TraceArray(Values, 4u));
+
     auto uav = static_cast<D3D11UnorderedAccessView*>(pUnorderedAccessView);
 
     if (!uav)
@@ -652,6 +678,9 @@ namespace dxvk {
           UINT8                             Stencil) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::ClearDepthStencilView, pDepthStencilView, ClearFlags, Depth, Stencil);
+
     auto dsv = static_cast<D3D11DepthStencilView*>(pDepthStencilView);
 
     if (!dsv)
@@ -777,6 +806,9 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::GenerateMips(ID3D11ShaderResourceView* pShaderResourceView) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::GenerateMips, pShaderResourceView);
+
     auto view = static_cast<D3D11ShaderResourceView*>(pShaderResourceView);
 
     if (!view || view->GetResourceType() == D3D11_RESOURCE_DIMENSION_BUFFER)
@@ -1007,6 +1039,9 @@ namespace dxvk {
           UINT            StartVertexLocation) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::Draw, VertexCount, StartVertexLocation);
+
     if (unlikely(!VertexCount))
       return;
 
@@ -1027,6 +1062,9 @@ namespace dxvk {
           INT             BaseVertexLocation) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::DrawIndexed, IndexCount, StartIndexLocation, BaseVertexLocation);
+
     if (unlikely(!IndexCount))
       return;
 
@@ -1049,6 +1087,11 @@ namespace dxvk {
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::DrawInstanced,
+        VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
+    }
+
     if (unlikely(!VertexCountPerInstance || !InstanceCount))
       return;
 
@@ -1071,6 +1114,11 @@ namespace dxvk {
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::DrawIndexedInstanced,
+        IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+    }
+
     if (unlikely(!IndexCountPerInstance || !InstanceCount))
       return;
 
@@ -1090,6 +1138,10 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::DrawIndexedInstancedIndirect, pBufferForArgs, AlignedByteOffsetForArgs);
+
     SetDrawBuffers(pBufferForArgs, nullptr);
 
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndexedIndirectCommand)))
@@ -1128,6 +1180,10 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::DrawInstancedIndirect, pBufferForArgs, AlignedByteOffsetForArgs);
+
     SetDrawBuffers(pBufferForArgs, nullptr);
 
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndirectCommand)))
@@ -1168,6 +1224,9 @@ namespace dxvk {
           UINT            ThreadGroupCountZ) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::Dispatch, ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+
     if (unlikely(!ThreadGroupCountX || !ThreadGroupCountY || !ThreadGroupCountZ))
       return;
 
@@ -1190,6 +1249,10 @@ namespace dxvk {
           ID3D11Buffer*   pBufferForArgs,
           UINT            AlignedByteOffsetForArgs) {
     D3D10DeviceLock lock = LockContext();
+
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::DispatchIndirect, pBufferForArgs, AlignedByteOffsetForArgs);
+
     SetDrawBuffers(pBufferForArgs, nullptr);
 
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDispatchIndirectCommand)))
@@ -1211,6 +1274,9 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::IASetInputLayout, pInputLayout);
+
     auto inputLayout = static_cast<D3D11InputLayout*>(pInputLayout);
 
     if (m_state.ia.inputLayout != inputLayout) {
@@ -1234,6 +1300,9 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::IASetPrimitiveTopology, Topology);
+
     if (m_state.ia.primitiveTopology != Topology) {
       m_state.ia.primitiveTopology = Topology;
       ApplyPrimitiveTopology();
@@ -1250,6 +1319,13 @@ namespace dxvk {
     const UINT*                             pOffsets) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::IASetVertexBuffers, StartSlot,
+        TraceArray(ppVertexBuffers, NumBuffers),
+        TraceArray(pStrides, NumBuffers),
+        TraceArray(pOffsets, NumBuffers));
+    }
+
     for (uint32_t i = 0; i < NumBuffers; i++) {
       auto newBuffer = static_cast<D3D11Buffer*>(ppVertexBuffers[i]);
 
@@ -1280,6 +1356,9 @@ namespace dxvk {
           UINT                              Offset) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::IASetIndexBuffer, pIndexBuffer, Format, Offset);
+
     auto newBuffer = static_cast<D3D11Buffer*>(pIndexBuffer);
 
     if (m_state.ia.indexBuffer.buffer != newBuffer) {
@@ -1372,6 +1451,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::eVertex), pVertexShader);
+
     auto shader = static_cast<D3D11VertexShader*>(pVertexShader);
     SetClassInstances<D3D11ShaderType::eVertex>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -1508,6 +1590,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::eHull), pHullShader);
+
     auto shader = static_cast<D3D11HullShader*>(pHullShader);
     SetClassInstances<D3D11ShaderType::eHull>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -1644,6 +1729,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::eDomain), pDomainShader);
+
     auto shader = static_cast<D3D11DomainShader*>(pDomainShader);
     SetClassInstances<D3D11ShaderType::eDomain>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -1780,6 +1868,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::eGeometry), pShader);
+
     auto shader = static_cast<D3D11GeometryShader*>(pShader);
     SetClassInstances<D3D11ShaderType::eGeometry>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -1916,6 +2007,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::ePixel), pPixelShader);
+
     auto shader = static_cast<D3D11PixelShader*>(pPixelShader);
     SetClassInstances<D3D11ShaderType::ePixel>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -2052,6 +2146,9 @@ namespace dxvk {
           UINT                              NumClassInstances) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::SetShader, uint32_t(D3D11ShaderType::eCompute), pComputeShader);
+
     auto shader = static_cast<D3D11ComputeShader*>(pComputeShader);
     SetClassInstances<D3D11ShaderType::eCompute>(
       shader ? shader->GetCommonShader() : nullptr, ppClassInstances, NumClassInstances);
@@ -2123,6 +2220,12 @@ namespace dxvk {
     const UINT*                             pUAVInitialCounts) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::CSSetUnorderedAccessViews, StartSlot,
+        TraceArray(ppUnorderedAccessViews, NumUAVs),
+        TraceArray(pUAVInitialCounts, NumUAVs));
+    }
+
     if (TestRtvUavHazards(0, nullptr, NumUAVs, ppUnorderedAccessViews))
       return;
 
@@ -2291,6 +2394,9 @@ namespace dxvk {
           UINT                              SampleMask) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::OMSetBlendState, pBlendState, TraceArray(BlendFactor, 4u), SampleMask);
+
     auto blendState = static_cast<D3D11BlendState*>(pBlendState);
 
     if (m_state.om.cbState    != blendState
@@ -2316,6 +2422,9 @@ namespace dxvk {
           UINT                              StencilRef) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::OMSetDepthStencilState, pDepthStencilState, StencilRef);
+
     auto depthStencilState = static_cast<D3D11DepthStencilState*>(pDepthStencilState);
 
     if (m_state.om.dsState != depthStencilState) {
@@ -2412,6 +2521,9 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::RSSetState(ID3D11RasterizerState* pRasterizerState) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::RSSetState, pRasterizerState);
+
     auto newRasterizerState = static_cast<D3D11RasterizerState*>(pRasterizerState);
 
     if (m_state.rs.state != newRasterizerState) {
@@ -2448,6 +2560,9 @@ namespace dxvk {
     if (unlikely(NumViewports > m_state.rs.viewports.size()))
       return;
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::RSSetViewports, TraceArray(pViewports, NumViewports));
+
     for (uint32_t i = 0; i < NumViewports; i++) {
       const D3D11_VIEWPORT& vp = pViewports[i];
 
@@ -2489,6 +2604,9 @@ namespace dxvk {
     if (unlikely(NumRects > m_state.rs.scissors.size()))
       return;
 
+    if (unlikely(m_trace))
+      m_trace->Record(D3D11TraceOp::RSSetScissorRects, TraceArray(pRects, NumRects));
+
     bool dirty = m_state.rs.numScissors != NumRects;
     m_state.rs.numScissors = NumRects;
 
@@ -3136,7 +3254,12 @@ namespace dxvk {
 
   template<typename ContextType>
   DxvkCsChunkRef D3D11CommonContext<ContextType>::AllocCsChunk() {
-    return m_parent->AllocCsChunk(m_csFlags);
+    // Deferred contexts are only ever used by one thread at a time,
+    // whereas the immediate context can inject chunks from any thread
+    if constexpr (IsDeferred)
+      return m_csChunkCache.allocChunk(m_csFlags);
+    else
+      return m_parent->AllocCsChunk(m_csFlags);
   }
 
 
@@ -5171,6 +5294,13 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumBuffers,
           ID3D11Buffer* const*              ppConstantBuffers) {
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::SetConstantBuffers, uint32_t(ShaderStage), StartSlot,
+        TraceArray(ppConstantBuffers, NumBuffers),
+        TraceArray<UINT>(nullptr, 0u),
+        TraceArray<UINT>(nullptr, 0u));
+    }
+
     auto& bindings = m_state.cbv[ShaderStage];
 
     for (uint32_t i = 0; i < NumBuffers; i++) {
@@ -5206,6 +5336,13 @@ namespace dxvk {
           ID3D11Buffer* const*              ppConstantBuffers,
     const UINT*                             pFirstConstant,
     const UINT*                             pNumConstants) {
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::SetConstantBuffers, uint32_t(ShaderStage), StartSlot,
+        TraceArray(ppConstantBuffers, NumBuffers),
+        TraceArray(pFirstConstant, NumBuffers),
+        TraceArray(pNumConstants, NumBuffers));
+    }
+
     auto& bindings = m_state.cbv[ShaderStage];
 
     for (uint32_t i = 0; i < NumBuffers; i++) {
@@ -5270,6 +5407,11 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumResources,
           ID3D11ShaderResourceView* const*  ppResources) {
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::SetShaderResources, uint32_t(ShaderStage), StartSlot,
+        TraceArray(ppResources, NumResources));
+    }
+
     auto& bindings = m_state.srv[ShaderStage];
 
     for (uint32_t i = 0; i < NumResources; i++) {
@@ -5306,6 +5448,11 @@ namespace dxvk {
           UINT                              StartSlot,
           UINT                              NumSamplers,
           ID3D11SamplerState* const*        ppSamplers) {
+    if (unlikely(m_trace)) {
+      m_trace->Record(D3D11TraceOp::SetSamplers, uint32_t(ShaderStage), StartSlot,
+        TraceArray(ppSamplers, NumSamplers));
+    }
+
     auto& bindings = m_state.samplers[ShaderStage];
 
     for (uint32_t i = 0; i < NumSamplers; i++) {
@@ -5333,6 +5480,16 @@ namespace dxvk {
           UINT                              NumUAVs,
           ID3D11UnorderedAccessView* const* ppUnorderedAccessViews,
     const UINT*                             pUAVInitialCounts) {
+    if (unlikely(m_trace)) {
+      uint32_t rtvCount = NumRTVs != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL ? NumRTVs : 0u;
+      uint32_t uavCount = NumUAVs != D3D11_KEEP_UNORDERED_ACCESS_VIEWS ? NumUAVs : 0u;
+
+      m_trace->Record(D3D11TraceOp::OMSetRenderTargetsAndUnorderedAccessViews,
+        NumRTVs, TraceArray(ppRenderTargetViews, rtvCount), pDepthStencilView,
+        UAVStartSlot, NumUAVs, TraceArray(ppUnorderedAccessViews, uavCount),
+        TraceArray(pUAVInitialCounts, uavCount));
+    }
+
     if (TestRtvUavHazards(NumRTVs, ppRenderTargetViews, NumUAVs, ppUnorderedAccessViews))
       return;
 
@@ -5763,6 +5920,11 @@ namespace dxvk {
     if (!pDstResource)
       return;
 
+    if (unlikely(m_trace)) {
+      m_trace->RecordUpdateSubresource(pDstResource, DstSubresource,
+        pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch, CopyFlags);
+    }
+
     // We need a different code path for buffers
     D3D11_RESOURCE_DIMENSION resourceType;
     pDstResource->GetType(&resourceType);
@@ -20,6 +20,7 @@
 #include "d3d11_context_state.h"
 #include "d3d11_device_child.h"
 #include "d3d11_texture.h"
+#include "d3d11_trace.h"
 
 namespace dxvk {
 
@@ -796,6 +797,7 @@ namespace dxvk {
 
     D3D11CmdType                m_csDataType = D3D11CmdType::None;
 
+    DxvkCsChunkCache            m_csChunkCache;
     DxvkCsChunkFlags            m_csFlags;
     DxvkCsChunkRef              m_csChunk;
     DxvkCsDataBlock*            m_csData = nullptr;
@@ -804,6 +806,8 @@ namespace dxvk {
 
     DxvkLocalAllocationCache    m_allocationCache;
 
+    D3D11TraceWriter*           m_trace = nullptr;
+
     D3D11ShaderStageState<Rc<DxvkBuffer>> m_instanceData;
 
     DxvkCsChunkRef AllocCsChunk();
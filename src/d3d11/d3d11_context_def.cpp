@@ -8,7 +8,7 @@ namespace dxvk {
     const Rc<DxvkDevice>& Device,
           UINT            ContextFlags)
   : D3D11CommonContext<D3D11DeferredContext>(pParent, Device, ContextFlags, 0u),
-    m_commandList(CreateCommandList()),
+    m_commandList(CreateCommandList(nullptr)),
     m_destructionNotifier(this) {
     ResetContextState();
   }
@@ -192,7 +192,7 @@ namespace dxvk {
     // previously set context state. Otherwise, reset the context.
     // Any use of ExecuteCommandList will reset command list state
     // before the command list is actually executed.
-    m_commandList = CreateCommandList();
+    m_commandList = CreateCommandList(m_commandList.ptr());
     m_chunkId = 0;
     
     if (RestoreDeferredContextState)
@@ -390,8 +390,16 @@ namespace dxvk {
   }
 
 
-  Com<D3D11CommandList> D3D11DeferredContext::CreateCommandList() {
-    return new D3D11CommandList(m_parent, m_flags);
+  Com<D3D11CommandList> D3D11DeferredContext::CreateCommandList(
+    const D3D11CommandList*           pPrevious) {
+    Com<D3D11CommandList> commandList = new D3D11CommandList(m_parent, m_flags);
+
+    // Command lists recorded on the same context tend to be similar
+    // in size, so avoid growing the new command list incrementally.
+    if (pPrevious)
+      commandList->ReserveStorage(pPrevious);
+
+    return commandList;
   }
   
   
@@ -114,7 +114,8 @@ namespace dxvk {
 
     void FinalizeQueries();
 
-    Com<D3D11CommandList> CreateCommandList();
+    Com<D3D11CommandList> CreateCommandList(
+      const D3D11CommandList*             pPrevious);
     
     void EmitCsChunk(DxvkCsChunkRef&& chunk);
 
@@ -16,7 +16,7 @@ namespace dxvk {
           D3D11Device*    pParent,
     const Rc<DxvkDevice>& Device)
   : D3D11CommonContext<D3D11ImmediateContext>(pParent, Device, 0, DxvkCsChunkFlag::SingleUse),
-    m_csThread(Device, Device->createContext()),
+    m_csThread(Device, Device->createContext(), pParent->GetOptions()->asyncChunkCleanup),
     m_submissionFence(new sync::CallbackFence()),
     m_flushTracker(GetMaxFlushType(pParent, Device)),
     m_stagingBufferFence(new sync::Fence(0)),
@@ -307,20 +307,32 @@ namespace dxvk {
     D3D11_RESOURCE_DIMENSION resourceDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
     pResource->GetType(&resourceDim);
 
+    HRESULT hr;
+
     if (likely(resourceDim == D3D11_RESOURCE_DIMENSION_BUFFER)) {
-      return MapBuffer(
+      hr = MapBuffer(
         static_cast<D3D11Buffer*>(pResource),
         MapType, MapFlags, pMappedResource);
     } else {
-      return MapImage(GetCommonTexture(pResource),
+      hr = MapImage(GetCommonTexture(pResource),
         Subresource, MapType, MapFlags, pMappedResource);
     }
+
+    if (unlikely(m_trace) && SUCCEEDED(hr)) {
+      m_trace->RecordMap(pResource, Subresource, MapType, MapFlags,
+        pMappedResource ? pMappedResource->pData : nullptr);
+    }
+
+    return hr;
   }
   
   
   void STDMETHODCALLTYPE D3D11ImmediateContext::Unmap(
           ID3D11Resource*             pResource,
           UINT                        Subresource) {
+    if (unlikely(m_trace))
+      m_trace->RecordUnmap(pResource, Subresource);
+
     // Since it is very uncommon for images to be mapped compared
     // to buffers, we count the currently mapped images in order
     // to avoid a virtual method call in the common case.
@@ -880,6 +892,9 @@ namespace dxvk {
           Rc<DxvkLatencyTracker>      LatencyTracker) {
     D3D10DeviceLock lock = LockContext();
 
+    if (unlikely(m_trace))
+      m_trace->EndFrame();
+
     // Don't keep draw buffers alive indefinitely. This cannot be
     // done in ExecuteFlush because command recording itself might
     // flush, so no state changes are allowed to happen there.
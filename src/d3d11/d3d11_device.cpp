@@ -31,6 +31,7 @@
 
 #include "../wsi/wsi_window.h"
 
+#include "../util/util_env.h"
 #include "../util/util_shared_res.h"
 
 namespace dxvk {
@@ -53,6 +54,11 @@ namespace dxvk {
     m_shaderOptions     (GetShaderOptions(m_dxvkDevice, m_d3d11Options)),
     m_maxFeatureLevel   (GetMaxFeatureLevel(m_dxvkDevice->instance(), m_dxvkDevice->adapter())),
     m_deviceFeatures    (m_dxvkDevice->instance(), m_dxvkDevice->adapter(), m_d3d11Options, m_featureLevel) {
+    std::string traceFile = env::getEnvVar("DXVK_D3D11_TRACE");
+
+    if (!traceFile.empty())
+      m_trace = new D3D11TraceWriter(traceFile);
+
     m_initializer = new D3D11Initializer(this);
     m_context     = new D3D11ImmediateContext(this, m_dxvkDevice);
     m_d3d10Device = new D3D10Device(this, m_context.ptr());
@@ -63,6 +69,7 @@ namespace dxvk {
     delete m_d3d10Device;
     m_context = nullptr;
     delete m_initializer;
+    delete m_trace;
   }
   
   
@@ -109,6 +116,9 @@ namespace dxvk {
       if (!(desc.MiscFlags & D3D11_RESOURCE_MISC_TILE_POOL))
         m_initializer->InitBuffer(buffer.ptr(), pInitialData);
 
+      if (unlikely(m_trace))
+        m_trace->RecordCreateBuffer(buffer.ptr(), &desc, pInitialData);
+
       *ppBuffer = buffer.ref();
       return S_OK;
     } catch (const DxvkError& e) {
@@ -155,6 +165,10 @@ namespace dxvk {
     try {
       const Com<D3D11Texture1D> texture = new D3D11Texture1D(this, &desc, nullptr);
       m_initializer->InitTexture(texture->GetCommonTexture(), pInitialData);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateTexture(texture.ptr(), pInitialData);
+
       *ppTexture1D = texture.ref();
       return S_OK;
     } catch (const DxvkError& e) {
@@ -243,6 +257,10 @@ namespace dxvk {
     try {
       Com<D3D11Texture2D> texture = new D3D11Texture2D(this, &desc, nullptr, nullptr);
       m_initializer->InitTexture(texture->GetCommonTexture(), pInitialData);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateTexture(texture.ptr(), pInitialData);
+
       *ppTexture2D = texture.ref();
       return S_OK;
     } catch (const DxvkError& e) {
@@ -330,6 +348,10 @@ namespace dxvk {
     try {
       Com<D3D11Texture3D> texture = new D3D11Texture3D(this, &desc, nullptr);
       m_initializer->InitTexture(texture->GetCommonTexture(), pInitialData);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateTexture(texture.ptr(), pInitialData);
+
       *ppTexture3D = texture.ref();
       return S_OK;
     } catch (const DxvkError& e) {
@@ -419,6 +441,10 @@ namespace dxvk {
     
     try {
       *ppSRView = ref(new D3D11ShaderResourceView(this, pResource, &desc));
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreate(D3D11TraceOp::CreateShaderResourceView, *ppSRView, pResource, desc);
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -509,6 +535,10 @@ namespace dxvk {
       auto uav = new D3D11UnorderedAccessView(this, pResource, &desc);
       m_initializer->InitUavCounter(uav);
       *ppUAView = ref(uav);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreate(D3D11TraceOp::CreateUnorderedAccessView, *ppUAView, pResource, desc);
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -603,6 +633,10 @@ namespace dxvk {
     
     try {
       *ppRTView = ref(new D3D11RenderTargetView(this, pResource, &desc));
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreate(D3D11TraceOp::CreateRenderTargetView, *ppRTView, pResource, desc);
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -651,6 +685,10 @@ namespace dxvk {
     
     try {
       *ppDepthStencilView = ref(new D3D11DepthStencilView(this, pResource, &desc));
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreate(D3D11TraceOp::CreateDepthStencilView, *ppDepthStencilView, pResource, desc);
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -776,6 +814,12 @@ namespace dxvk {
         new D3D11InputLayout(this,
           attrCount, attrList.data(),
           bindCount, bindList.data()));
+
+      if (unlikely(m_trace)) {
+        m_trace->RecordCreateInputLayout(*ppInputLayout, pInputElementDescs, NumElements,
+          pShaderBytecodeWithInputSignature, BytecodeLength);
+      }
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -806,6 +850,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppVertexShader = ref(new D3D11VertexShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppVertexShader, D3D11ShaderType::eVertex, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -832,6 +880,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppGeometryShader = ref(new D3D11GeometryShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppGeometryShader, D3D11ShaderType::eGeometry, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -910,6 +962,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppGeometryShader = ref(new D3D11GeometryShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppGeometryShader, D3D11ShaderType::eGeometry, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -936,6 +992,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppPixelShader = ref(new D3D11PixelShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppPixelShader, D3D11ShaderType::ePixel, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -962,6 +1022,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppHullShader = ref(new D3D11HullShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppHullShader, D3D11ShaderType::eHull, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -988,6 +1052,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppDomainShader = ref(new D3D11DomainShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppDomainShader, D3D11ShaderType::eDomain, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -1014,6 +1082,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppComputeShader = ref(new D3D11ComputeShader(this, module));
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateShader(*ppComputeShader, D3D11ShaderType::eCompute, pShaderBytecode, BytecodeLength);
+
     return S_OK;
   }
   
@@ -1039,6 +1111,10 @@ namespace dxvk {
     
     if (ppBlendState != nullptr) {
       *ppBlendState = m_bsStateObjects.Create(this, desc);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateState(D3D11TraceOp::CreateBlendState, *ppBlendState, desc);
+
       return S_OK;
     } return S_FALSE;
   }
@@ -1059,6 +1135,10 @@ namespace dxvk {
     
     if (ppBlendState != nullptr) {
       *ppBlendState = m_bsStateObjects.Create(this, desc);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateState(D3D11TraceOp::CreateBlendState, *ppBlendState, desc);
+
       return S_OK;
     } return S_FALSE;
   }
@@ -1079,6 +1159,10 @@ namespace dxvk {
     
     if (ppDepthStencilState != nullptr) {
       *ppDepthStencilState = m_dsStateObjects.Create(this, desc);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateState(D3D11TraceOp::CreateDepthStencilState, *ppDepthStencilState, desc);
+
       return S_OK;
     } return S_FALSE;
   }
@@ -1101,6 +1185,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppRasterizerState = m_rsStateObjects.Create(this, desc);
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateState(D3D11TraceOp::CreateRasterizerState, *ppRasterizerState, desc);
+
     return S_OK;
   }
   
@@ -1122,6 +1210,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppRasterizerState = m_rsStateObjects.Create(this, desc);
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateState(D3D11TraceOp::CreateRasterizerState, *ppRasterizerState, desc);
+
     return S_OK;
   }
   
@@ -1147,6 +1239,10 @@ namespace dxvk {
       return S_FALSE;
     
     *ppRasterizerState = m_rsStateObjects.Create(this, desc);
+
+    if (unlikely(m_trace))
+      m_trace->RecordCreateState(D3D11TraceOp::CreateRasterizerState, *ppRasterizerState, desc);
+
     return S_OK;
   }
   
@@ -1174,6 +1270,10 @@ namespace dxvk {
     
     try {
       *ppSamplerState = m_samplerObjects.Create(this, desc);
+
+      if (unlikely(m_trace))
+        m_trace->RecordCreateState(D3D11TraceOp::CreateSamplerState, *ppSamplerState, desc);
+
       return S_OK;
     } catch (const DxvkError& e) {
       Logger::err(e.message());
@@ -2697,7 +2797,7 @@ namespace dxvk {
         util::packImageData(dstData, mapPtr,
           layout.RowPitch, layout.DepthPitch,
           RowPitch, DepthPitch, image->info().type,
-          extent, 1, formatInfo, aspect);
+          extent, 1, formatInfo, aspect, false);
       }
 
       // Advance linear data pointer by the size of the current aspect
@@ -23,6 +23,7 @@
 #include "d3d11_options.h"
 #include "d3d11_shader.h"
 #include "d3d11_state.h"
+#include "d3d11_trace.h"
 #include "d3d11_util.h"
 
 namespace dxvk {
@@ -455,6 +456,10 @@ namespace dxvk {
       return DxvkCsChunkRef(chunk, &m_csChunkPool);
     }
     
+    DxvkCsChunkPool* GetCsChunkPool() {
+      return &m_csChunkPool;
+    }
+    
     const D3D11Options* GetOptions() const {
       return &m_d3d11Options;
     }
@@ -467,6 +472,10 @@ namespace dxvk {
       return m_context.ptr();
     }
 
+    D3D11TraceWriter* GetTraceWriter() const {
+      return m_trace;
+    }
+
     bool Is11on12Device() const;
 
     bool LockImage(
@@ -508,6 +517,7 @@ namespace dxvk {
 
     D3D11Initializer*               m_initializer = nullptr;
     D3D10Device*                    m_d3d10Device = nullptr;
+    D3D11TraceWriter*               m_trace       = nullptr;
 
     D3D11StateObjectSet<D3D11BlendState>        m_bsStateObjects;
     D3D11StateObjectSet<D3D11DepthStencilState> m_dsStateObjects;
@@ -446,4 +446,15 @@ extern "C" {
     }
   }
 
+
+  DLLEXPORT HRESULT __stdcall DXVK_D3D11ReplayTrace(
+          ID3D11Device*         pDevice,
+    const char*                 pFileName) {
+    if (!pDevice || !pFileName)
+      return E_INVALIDARG;
+
+    D3D11TraceReplayer replayer(pDevice);
+    return replayer.Replay(pFileName);
+  }
+
 }
@@ -98,6 +98,11 @@ namespace dxvk {
     /// can negatively affect performance.
     bool reproducibleCommandStream = false;
 
+    /// Destroy executed CS chunks on a separate thread in
+    /// order to reduce the amount of work done on the CS
+    /// thread. Can help CPU-bound games on many-core CPUs.
+    bool asyncChunkCleanup = false;
+
     /// Whether to force a staging buffer for mapped images.
     /// Some games are broken and ignore row pitch.
     bool disableDirectImageMapping = false;
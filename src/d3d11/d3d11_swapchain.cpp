@@ -294,6 +294,9 @@ namespace dxvk {
     if (m_latencyHud)
       m_latencyHud->accumulateStats(latencyStats);
 
+    if (m_pacingHud)
+      m_pacingHud->accumulateStats(m_presenter->getFramePacingStats());
+
     return hr;
   }
 
@@ -601,6 +604,8 @@ namespace dxvk {
 
       if (m_latency)
         m_latencyHud = hud->addItem<hud::HudLatencyItem>("latency", 4);
+
+      m_pacingHud = hud->addItem<hud::HudFramePacingItem>("pacing", 5);
     }
 
     m_blitter = new DxvkSwapchainBlitter(m_device, std::move(hud));
@@ -0,0 +1,1248 @@
+#include <algorithm>
+#include <cstddef>
+
+#include "d3d11_buffer.h"
+#include "d3d11_texture.h"
+#include "d3d11_trace.h"
+
+#include "../util/util_env.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  static const char D3D11TraceMagic[8] = { 'D', 'X', 'V', 'K', 'T', 'R', 'C', '\0' };
+
+
+  static std::atomic<uint32_t> s_traceWriterCount = { 0u };
+
+
+  D3D11TraceWriter::D3D11TraceWriter(
+    const std::string&                BaseName) {
+    // Multiple devices may be created by the same process, most of
+    // which are only used to probe capabilities, so give each device
+    // its own file rather than having them overwrite each other.
+    std::string FileName = str::format(BaseName, ".", env::getProcessId(),
+      ".", s_traceWriterCount.fetch_add(1u), ".trace");
+
+    m_file.open(str::topath(FileName.c_str()).c_str(), std::ios_base::binary | std::ios_base::trunc);
+
+    if (!m_file) {
+      Logger::err(str::format("D3D11: Failed to create trace file ", FileName));
+      m_failed = true;
+      return;
+    }
+
+    Logger::info(str::format("D3D11: Recording API trace to ", FileName));
+
+    D3D11TraceFileHeader header = { };
+    std::memcpy(header.magic, D3D11TraceMagic, sizeof(header.magic));
+    header.version = D3D11TraceVersion;
+
+    WriteValue(header);
+  }
+
+
+  D3D11TraceWriter::~D3D11TraceWriter() {
+    std::lock_guard lock(m_mutex);
+    FlushLocked();
+  }
+
+
+  void D3D11TraceWriter::RecordCreateBuffer(
+          ID3D11Buffer*               pBuffer,
+    const D3D11_BUFFER_DESC*          pDesc,
+    const D3D11_SUBRESOURCE_DATA*     pInitialData) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    bool hasData = pInitialData && pInitialData->pSysMem;
+
+    size_t offset = BeginRecord(D3D11TraceOp::CreateBuffer);
+    WriteValue(AllocObjectId(pBuffer));
+    WriteValue(*pDesc);
+    WriteValue(uint32_t(hasData));
+
+    if (hasData)
+      WriteData(pInitialData->pSysMem, pDesc->ByteWidth);
+
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::RecordCreateTexture(
+          ID3D11Resource*             pTexture,
+    const D3D11_SUBRESOURCE_DATA*     pInitialData) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    auto texture = GetCommonTexture(pTexture);
+    auto desc = texture->Desc();
+
+    // Initial data for multi-plane formats does not use
+    // a regular layout, just ignore it in that case.
+    auto formatInfo = lookupFormatInfo(texture->GetPackedFormat());
+    bool hasData = pInitialData && !(formatInfo->flags.test(DxvkFormatFlag::MultiPlane));
+
+    size_t offset = BeginRecord(D3D11TraceOp::CreateTexture);
+    WriteValue(AllocObjectId(pTexture));
+    WriteValue(uint32_t(texture->GetDimension()));
+    WriteValue(*desc);
+    WriteValue(uint32_t(hasData));
+
+    if (hasData) {
+      for (uint32_t i = 0; i < texture->CountSubresources(); i++) {
+        WriteTextureData(texture, texture->MipLevelExtent(i % desc->MipLevels),
+          pInitialData[i].pSysMem, pInitialData[i].SysMemPitch, pInitialData[i].SysMemSlicePitch);
+      }
+    }
+
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::RecordCreateInputLayout(
+          ID3D11InputLayout*          pInputLayout,
+    const D3D11_INPUT_ELEMENT_DESC*   pInputElementDescs,
+          UINT                        NumElements,
+    const void*                       pBytecode,
+          SIZE_T                      BytecodeLength) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    size_t offset = BeginRecord(D3D11TraceOp::CreateInputLayout);
+    WriteValue(AllocObjectId(pInputLayout));
+    WriteValue(uint32_t(NumElements));
+
+    for (uint32_t i = 0; i < NumElements; i++) {
+      // Semantic names are stored inline and include the null
+      // terminator, so that the replayer can use them directly
+      D3D11_INPUT_ELEMENT_DESC desc = pInputElementDescs[i];
+      uint32_t nameLength = std::strlen(desc.SemanticName) + 1u;
+
+      WriteValue(nameLength);
+      WriteData(desc.SemanticName, nameLength);
+
+      desc.SemanticName = nullptr;
+      WriteValue(desc);
+    }
+
+    WriteValue(uint32_t(BytecodeLength));
+    WriteData(pBytecode, BytecodeLength);
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::RecordCreateShader(
+          ID3D11DeviceChild*          pShader,
+          D3D11ShaderType             Stage,
+    const void*                       pBytecode,
+          SIZE_T                      BytecodeLength) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    size_t offset = BeginRecord(D3D11TraceOp::CreateShader);
+    WriteValue(AllocObjectId(pShader));
+    WriteValue(uint32_t(Stage));
+    WriteValue(uint32_t(BytecodeLength));
+    WriteData(pBytecode, BytecodeLength);
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::RecordUpdateSubresource(
+          ID3D11Resource*             pDstResource,
+          UINT                        DstSubresource,
+    const D3D11_BOX*                  pDstBox,
+    const void*                       pSrcData,
+          UINT                        SrcRowPitch,
+          UINT                        SrcDepthPitch,
+          UINT                        CopyFlags) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    size_t offset = BeginRecord(D3D11TraceOp::UpdateSubresource);
+    WriteArg(pDstResource);
+    WriteValue(DstSubresource);
+    WriteArg(TraceArray(pDstBox, 1u));
+    WriteValue(CopyFlags);
+
+    D3D11_RESOURCE_DIMENSION resourceDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    pDstResource->GetType(&resourceDim);
+
+    if (resourceDim == D3D11_RESOURCE_DIMENSION_BUFFER) {
+      uint32_t size = static_cast<D3D11Buffer*>(pDstResource)->Desc()->ByteWidth;
+
+      if (pDstBox)
+        size = pDstBox->right > pDstBox->left ? pDstBox->right - pDstBox->left : 0u;
+
+      if (!pSrcData)
+        size = 0u;
+
+      // Use the same layout as texture updates so that the
+      // record can be parsed even if the buffer is unknown
+      WriteValue(0u);
+      WriteValue(0u);
+      WriteValue(size);
+      WriteData(pSrcData, size);
+    } else {
+      auto texture = GetCommonTexture(pDstResource);
+
+      if (DstSubresource < texture->CountSubresources()) {
+        VkExtent3D extent = texture->MipLevelExtent(DstSubresource % texture->Desc()->MipLevels);
+
+        if (pDstBox) {
+          extent.width  = pDstBox->right  > pDstBox->left  ? pDstBox->right  - pDstBox->left  : 0u;
+          extent.height = pDstBox->bottom > pDstBox->top   ? pDstBox->bottom - pDstBox->top   : 0u;
+          extent.depth  = pDstBox->back   > pDstBox->front ? pDstBox->back   - pDstBox->front : 0u;
+        }
+
+        WriteTextureData(texture, extent, pSrcData, SrcRowPitch, SrcDepthPitch);
+      } else {
+        WriteTextureData(texture, VkExtent3D { 0u, 0u, 0u }, nullptr, 0u, 0u);
+      }
+    }
+
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::RecordMap(
+          ID3D11Resource*             pResource,
+          UINT                        Subresource,
+          D3D11_MAP                   MapType,
+          UINT                        MapFlags,
+    const void*                       pData) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    m_mappings.push_back({ pResource, Subresource, MapType, MapFlags, pData });
+  }
+
+
+  void D3D11TraceWriter::RecordUnmap(
+          ID3D11Resource*             pResource,
+          UINT                        Subresource) {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    auto entry = std::find_if(m_mappings.begin(), m_mappings.end(),
+      [pResource, Subresource] (const PendingMap& map) {
+        return map.resource == pResource && map.subresource == Subresource;
+      });
+
+    if (entry == m_mappings.end())
+      return;
+
+    PendingMap map = *entry;
+    m_mappings.erase(entry);
+
+    // Only buffer contents written after a discard or a regular write map
+    // are known to be complete, everything else would require tracking
+    // writes to the mapped pointer.
+    D3D11_RESOURCE_DIMENSION resourceDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    pResource->GetType(&resourceDim);
+
+    uint32_t size = 0u;
+
+    if (resourceDim == D3D11_RESOURCE_DIMENSION_BUFFER && map.data
+     && (map.mapType == D3D11_MAP_WRITE_DISCARD || map.mapType == D3D11_MAP_WRITE))
+      size = static_cast<D3D11Buffer*>(pResource)->Desc()->ByteWidth;
+
+    size_t offset = BeginRecord(D3D11TraceOp::Map);
+    WriteArg(pResource);
+    WriteValue(map.subresource);
+    WriteValue(map.mapType);
+    WriteValue(map.mapFlags);
+    WriteValue(size);
+    WriteData(map.data, size);
+    EndRecord(offset);
+  }
+
+
+  void D3D11TraceWriter::EndFrame() {
+    std::lock_guard lock(m_mutex);
+
+    if (unlikely(m_failed))
+      return;
+
+    size_t offset = BeginRecord(D3D11TraceOp::EndFrame);
+    EndRecord(offset);
+
+    FlushLocked();
+  }
+
+
+  uint32_t D3D11TraceWriter::AllocObjectId(
+    const void*                       pObject) {
+    uint32_t id = ++m_objectCount;
+    m_objects.insert_or_assign(pObject, id);
+    return id;
+  }
+
+
+  uint32_t D3D11TraceWriter::LookupObjectId(
+    const void*                       pObject) const {
+    if (!pObject)
+      return 0u;
+
+    auto entry = m_objects.find(pObject);
+
+    return entry != m_objects.end()
+      ? entry->second
+      : 0u;
+  }
+
+
+  size_t D3D11TraceWriter::BeginRecord(
+          D3D11TraceOp                Op) {
+    size_t offset = m_data.size();
+
+    D3D11TraceRecordHeader header = { };
+    header.op = Op;
+
+    WriteValue(header);
+    return offset;
+  }
+
+
+  void D3D11TraceWriter::EndRecord(
+          size_t                      Offset) {
+    uint32_t size = m_data.size() - Offset - sizeof(D3D11TraceRecordHeader);
+
+    std::memcpy(&m_data[Offset + offsetof(D3D11TraceRecordHeader, size)],
+      &size, sizeof(size));
+
+    // Write out data early if the application records large amounts
+    // of data within a frame, or never presents anything at all
+    if (m_data.size() >= MaxBufferSize)
+      FlushLocked();
+  }
+
+
+  void D3D11TraceWriter::WriteData(
+    const void*                       pData,
+          size_t                      Size) {
+    if (!Size)
+      return;
+
+    auto data = reinterpret_cast<const char*>(pData);
+    m_data.insert(m_data.end(), data, data + Size);
+  }
+
+
+  void D3D11TraceWriter::WriteTextureData(
+          D3D11CommonTexture*         pTexture,
+          VkExtent3D                  Extent,
+    const void*                       pData,
+          UINT                        RowPitch,
+          UINT                        DepthPitch) {
+    auto formatInfo = lookupFormatInfo(pTexture->GetPackedFormat());
+
+    if (!pData || formatInfo->flags.test(DxvkFormatFlag::MultiPlane))
+      Extent = VkExtent3D { 0u, 0u, 0u };
+
+    // Data is always stored with tightly packed rows and
+    // slices, the replayer passes the pitches explicitly
+    VkExtent3D blockCount = util::computeBlockCount(Extent, formatInfo->blockSize);
+
+    uint32_t rowSize = blockCount.width * formatInfo->elementSize;
+    uint32_t sliceSize = blockCount.height * rowSize;
+
+    WriteValue(rowSize);
+    WriteValue(sliceSize);
+    WriteValue(uint32_t(blockCount.depth * sliceSize));
+
+    auto data = reinterpret_cast<const char*>(pData);
+
+    for (uint32_t z = 0; z < blockCount.depth; z++) {
+      for (uint32_t y = 0; y < blockCount.height; y++)
+        WriteData(data + y * RowPitch + z * DepthPitch, rowSize);
+    }
+  }
+
+
+  void D3D11TraceWriter::FlushLocked() {
+    if (m_failed || m_data.empty())
+      return;
+
+    m_file.write(m_data.data(), m_data.size());
+    m_file.flush();
+
+    // Stop recording entirely if writing fails, e.g. because
+    // the disk is full, rather than buffering data forever
+    if (!m_file) {
+      Logger::err("D3D11: Failed to write trace file, stopping trace");
+      m_failed = true;
+      m_mappings.clear();
+    }
+
+    m_data.clear();
+  }
+
+
+
+
+  D3D11TraceReplayer::D3D11TraceReplayer(
+          ID3D11Device*               pDevice) {
+    if (SUCCEEDED(pDevice->QueryInterface(__uuidof(ID3D11Device3), reinterpret_cast<void**>(&m_device)))) {
+      m_device->GetImmediateContext1(&m_context);
+
+      D3D11_QUERY_DESC queryDesc = { };
+      queryDesc.Query = D3D11_QUERY_EVENT;
+
+      m_device->CreateQuery(&queryDesc, &m_query);
+    }
+  }
+
+
+  D3D11TraceReplayer::~D3D11TraceReplayer() {
+
+  }
+
+
+  HRESULT D3D11TraceReplayer::Replay(
+    const std::string&                FileName) {
+    if (!m_device || !m_context || !m_query)
+      return E_INVALIDARG;
+
+    std::ifstream file(str::topath(FileName.c_str()).c_str(), std::ios_base::binary);
+
+    if (!file) {
+      Logger::err(str::format("D3D11: Failed to open trace file ", FileName));
+      return E_FAIL;
+    }
+
+    file.seekg(0, std::ios_base::end);
+    m_data.resize(file.tellg());
+    file.seekg(0, std::ios_base::beg);
+
+    if (!file.read(m_data.data(), m_data.size())) {
+      Logger::err(str::format("D3D11: Failed to read trace file ", FileName));
+      return E_FAIL;
+    }
+
+    Logger::info(str::format("D3D11: Replaying API trace ", FileName));
+
+    try {
+      m_offset = 0u;
+      m_recordEnd = m_data.size();
+
+      auto header = Read<D3D11TraceFileHeader>();
+
+      if (std::memcmp(header.magic, D3D11TraceMagic, sizeof(header.magic))
+       || header.version != D3D11TraceVersion)
+        throw DxvkError("D3D11: Unsupported trace file");
+
+      m_frameStart = high_resolution_clock::now();
+
+      while (m_offset < m_data.size()) {
+        m_recordEnd = m_data.size();
+
+        auto record = Read<D3D11TraceRecordHeader>();
+
+        if (record.size > m_data.size() - m_offset)
+          throw DxvkError("D3D11: Truncated trace record");
+
+        m_recordEnd = m_offset + record.size;
+
+        ExecuteRecord(record.op);
+
+        // Skip any data that we may not have consumed
+        m_offset = m_recordEnd;
+      }
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+      return E_FAIL;
+    }
+
+    LogStatistics();
+    return S_OK;
+  }
+
+
+  void D3D11TraceReplayer::ExecuteRecord(
+          D3D11TraceOp                Op) {
+    switch (Op) {
+      case D3D11TraceOp::EndFrame:
+        ExecuteEndFrame();
+        break;
+
+      case D3D11TraceOp::CreateBuffer:
+        ExecuteCreateBuffer();
+        break;
+
+      case D3D11TraceOp::CreateTexture:
+        ExecuteCreateTexture();
+        break;
+
+      case D3D11TraceOp::CreateShaderResourceView: {
+        uint32_t id = Read<uint32_t>();
+        auto resource = ReadObject<ID3D11Resource>();
+        auto desc = Read<D3D11_SHADER_RESOURCE_VIEW_DESC1>();
+
+        Com<ID3D11ShaderResourceView1> view;
+
+        if (resource)
+          m_device->CreateShaderResourceView1(resource, &desc, &view);
+
+        SetObject(id, view.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateUnorderedAccessView: {
+        uint32_t id = Read<uint32_t>();
+        auto resource = ReadObject<ID3D11Resource>();
+        auto desc = Read<D3D11_UNORDERED_ACCESS_VIEW_DESC1>();
+
+        Com<ID3D11UnorderedAccessView1> view;
+
+        if (resource)
+          m_device->CreateUnorderedAccessView1(resource, &desc, &view);
+
+        SetObject(id, view.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateRenderTargetView: {
+        uint32_t id = Read<uint32_t>();
+        auto resource = ReadObject<ID3D11Resource>();
+        auto desc = Read<D3D11_RENDER_TARGET_VIEW_DESC1>();
+
+        Com<ID3D11RenderTargetView1> view;
+
+        if (resource)
+          m_device->CreateRenderTargetView1(resource, &desc, &view);
+
+        SetObject(id, view.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateDepthStencilView: {
+        uint32_t id = Read<uint32_t>();
+        auto resource = ReadObject<ID3D11Resource>();
+        auto desc = Read<D3D11_DEPTH_STENCIL_VIEW_DESC>();
+
+        Com<ID3D11DepthStencilView> view;
+
+        if (resource)
+          m_device->CreateDepthStencilView(resource, &desc, &view);
+
+        SetObject(id, view.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateInputLayout:
+        ExecuteCreateInputLayout();
+        break;
+
+      case D3D11TraceOp::CreateShader:
+        ExecuteCreateShader();
+        break;
+
+      case D3D11TraceOp::CreateBlendState: {
+        uint32_t id = Read<uint32_t>();
+        auto desc = Read<D3D11_BLEND_DESC1>();
+
+        Com<ID3D11BlendState1> state;
+        m_device->CreateBlendState1(&desc, &state);
+        SetObject(id, state.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateDepthStencilState: {
+        uint32_t id = Read<uint32_t>();
+        auto desc = Read<D3D11_DEPTH_STENCIL_DESC>();
+
+        Com<ID3D11DepthStencilState> state;
+        m_device->CreateDepthStencilState(&desc, &state);
+        SetObject(id, state.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateRasterizerState: {
+        uint32_t id = Read<uint32_t>();
+        auto desc = Read<D3D11_RASTERIZER_DESC2>();
+
+        Com<ID3D11RasterizerState2> state;
+        m_device->CreateRasterizerState2(&desc, &state);
+        SetObject(id, state.ptr());
+      } break;
+
+      case D3D11TraceOp::CreateSamplerState: {
+        uint32_t id = Read<uint32_t>();
+        auto desc = Read<D3D11_SAMPLER_DESC>();
+
+        Com<ID3D11SamplerState> state;
+        m_device->CreateSamplerState(&desc, &state);
+        SetObject(id, state.ptr());
+      } break;
+
+      case D3D11TraceOp::ClearState:
+        m_context->ClearState();
+        break;
+
+      case D3D11TraceOp::IASetInputLayout:
+        m_context->IASetInputLayout(ReadObject<ID3D11InputLayout>());
+        break;
+
+      case D3D11TraceOp::IASetPrimitiveTopology:
+        m_context->IASetPrimitiveTopology(Read<D3D11_PRIMITIVE_TOPOLOGY>());
+        break;
+
+      case D3D11TraceOp::IASetVertexBuffers: {
+        std::array<ID3D11Buffer*, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> buffers;
+        std::array<UINT, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> strides;
+        std::array<UINT, D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT> offsets;
+
+        UINT startSlot = Read<UINT>();
+        uint32_t count = ReadObjects(buffers);
+
+        if (ReadValues(strides) != count || ReadValues(offsets) != count)
+          throw DxvkError("D3D11: Invalid vertex buffer record");
+
+        m_context->IASetVertexBuffers(startSlot, count,
+          buffers.data(), strides.data(), offsets.data());
+      } break;
+
+      case D3D11TraceOp::IASetIndexBuffer: {
+        auto buffer = ReadObject<ID3D11Buffer>();
+        auto format = Read<DXGI_FORMAT>();
+        auto offset = Read<UINT>();
+
+        m_context->IASetIndexBuffer(buffer, format, offset);
+      } break;
+
+      case D3D11TraceOp::SetShader: {
+        auto stage = D3D11ShaderType(Read<uint32_t>());
+
+        switch (stage) {
+          case D3D11ShaderType::eVertex:
+            m_context->VSSetShader(ReadObject<ID3D11VertexShader>(), nullptr, 0);
+            break;
+          case D3D11ShaderType::eHull:
+            m_context->HSSetShader(ReadObject<ID3D11HullShader>(), nullptr, 0);
+            break;
+          case D3D11ShaderType::eDomain:
+            m_context->DSSetShader(ReadObject<ID3D11DomainShader>(), nullptr, 0);
+            break;
+          case D3D11ShaderType::eGeometry:
+            m_context->GSSetShader(ReadObject<ID3D11GeometryShader>(), nullptr, 0);
+            break;
+          case D3D11ShaderType::ePixel:
+            m_context->PSSetShader(ReadObject<ID3D11PixelShader>(), nullptr, 0);
+            break;
+          case D3D11ShaderType::eCompute:
+            m_context->CSSetShader(ReadObject<ID3D11ComputeShader>(), nullptr, 0);
+            break;
+          default:
+            throw DxvkError(str::format("D3D11: Invalid shader stage ", uint32_t(stage)));
+        }
+      } break;
+
+      case D3D11TraceOp::SetConstantBuffers: {
+        std::array<ID3D11Buffer*, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> buffers;
+        std::array<UINT, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> firstConstants;
+        std::array<UINT, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT> numConstants;
+
+        auto stage = D3D11ShaderType(Read<uint32_t>());
+        UINT startSlot = Read<UINT>();
+        uint32_t count = ReadObjects(buffers);
+
+        bool hasRanges = ReadValues(firstConstants) == count;
+        hasRanges &= ReadValues(numConstants) == count;
+
+        const UINT* pFirstConstant = hasRanges ? firstConstants.data() : nullptr;
+        const UINT* pNumConstants = hasRanges ? numConstants.data() : nullptr;
+
+        switch (stage) {
+          case D3D11ShaderType::eVertex:
+            m_context->VSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          case D3D11ShaderType::eHull:
+            m_context->HSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          case D3D11ShaderType::eDomain:
+            m_context->DSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          case D3D11ShaderType::eGeometry:
+            m_context->GSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          case D3D11ShaderType::ePixel:
+            m_context->PSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          case D3D11ShaderType::eCompute:
+            m_context->CSSetConstantBuffers1(startSlot, count, buffers.data(), pFirstConstant, pNumConstants);
+            break;
+          default:
+            throw DxvkError(str::format("D3D11: Invalid shader stage ", uint32_t(stage)));
+        }
+      } break;
+
+      case D3D11TraceOp::SetShaderResources: {
+        std::array<ID3D11ShaderResourceView*, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT> views;
+
+        auto stage = D3D11ShaderType(Read<uint32_t>());
+        UINT startSlot = Read<UINT>();
+        uint32_t count = ReadObjects(views);
+
+        switch (stage) {
+          case D3D11ShaderType::eVertex:
+            m_context->VSSetShaderResources(startSlot, count, views.data());
+            break;
+          case D3D11ShaderType::eHull:
+            m_context->HSSetShaderResources(startSlot, count, views.data());
+            break;
+          case D3D11ShaderType::eDomain:
+            m_context->DSSetShaderResources(startSlot, count, views.data());
+            break;
+          case D3D11ShaderType::eGeometry:
+            m_context->GSSetShaderResources(startSlot, count, views.data());
+            break;
+          case D3D11ShaderType::ePixel:
+            m_context->PSSetShaderResources(startSlot, count, views.data());
+            break;
+          case D3D11ShaderType::eCompute:
+            m_context->CSSetShaderResources(startSlot, count, views.data());
+            break;
+          default:
+            throw DxvkError(str::format("D3D11: Invalid shader stage ", uint32_t(stage)));
+        }
+      } break;
+
+      case D3D11TraceOp::SetSamplers: {
+        std::array<ID3D11SamplerState*, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT> samplers;
+
+        auto stage = D3D11ShaderType(Read<uint32_t>());
+        UINT startSlot = Read<UINT>();
+        uint32_t count = ReadObjects(samplers);
+
+        switch (stage) {
+          case D3D11ShaderType::eVertex:
+            m_context->VSSetSamplers(startSlot, count, samplers.data());
+            break;
+          case D3D11ShaderType::eHull:
+            m_context->HSSetSamplers(startSlot, count, samplers.data());
+            break;
+          case D3D11ShaderType::eDomain:
+            m_context->DSSetSamplers(startSlot, count, samplers.data());
+            break;
+          case D3D11ShaderType::eGeometry:
+            m_context->GSSetSamplers(startSlot, count, samplers.data());
+            break;
+          case D3D11ShaderType::ePixel:
+            m_context->PSSetSamplers(startSlot, count, samplers.data());
+            break;
+          case D3D11ShaderType::eCompute:
+            m_context->CSSetSamplers(startSlot, count, samplers.data());
+            break;
+          default:
+            throw DxvkError(str::format("D3D11: Invalid shader stage ", uint32_t(stage)));
+        }
+      } break;
+
+      case D3D11TraceOp::CSSetUnorderedAccessViews: {
+        std::array<ID3D11UnorderedAccessView*, D3D11_1_UAV_SLOT_COUNT> views;
+        std::array<UINT, D3D11_1_UAV_SLOT_COUNT> counters;
+
+        UINT startSlot = Read<UINT>();
+        uint32_t count = ReadObjects(views);
+        bool hasCounters = ReadValues(counters) == count;
+
+        m_context->CSSetUnorderedAccessViews(startSlot, count,
+          views.data(), hasCounters ? counters.data() : nullptr);
+      } break;
+
+      case D3D11TraceOp::OMSetRenderTargetsAndUnorderedAccessViews: {
+        std::array<ID3D11RenderTargetView*, D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT> rtvs;
+        std::array<ID3D11UnorderedAccessView*, D3D11_1_UAV_SLOT_COUNT> uavs;
+        std::array<UINT, D3D11_1_UAV_SLOT_COUNT> counters;
+
+        UINT numRtvs = Read<UINT>();
+        uint32_t rtvCount = ReadObjects(rtvs);
+        auto dsv = ReadObject<ID3D11DepthStencilView>();
+        UINT uavStartSlot = Read<UINT>();
+        UINT numUavs = Read<UINT>();
+        uint32_t uavCount = ReadObjects(uavs);
+        uint32_t counterCount = ReadValues(counters);
+
+        if (numRtvs != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+          numRtvs = rtvCount;
+
+        if (numUavs != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+          numUavs = uavCount;
+
+        m_context->OMSetRenderTargetsAndUnorderedAccessViews(
+          numRtvs, rtvCount ? rtvs.data() : nullptr, dsv,
+          uavStartSlot, numUavs, uavCount ? uavs.data() : nullptr,
+          counterCount == uavCount && counterCount ? counters.data() : nullptr);
+      } break;
+
+      case D3D11TraceOp::OMSetBlendState: {
+        std::array<FLOAT, 4> blendFactor;
+
+        auto state = ReadObject<ID3D11BlendState>();
+        bool hasBlendFactor = ReadValues(blendFactor) == blendFactor.size();
+        auto sampleMask = Read<UINT>();
+
+        m_context->OMSetBlendState(state,
+          hasBlendFactor ? blendFactor.data() : nullptr, sampleMask);
+      } break;
+
+      case D3D11TraceOp::OMSetDepthStencilState: {
+        auto state = ReadObject<ID3D11DepthStencilState>();
+        auto stencilRef = Read<UINT>();
+
+        m_context->OMSetDepthStencilState(state, stencilRef);
+      } break;
+
+      case D3D11TraceOp::RSSetState:
+        m_context->RSSetState(ReadObject<ID3D11RasterizerState>());
+        break;
+
+      case D3D11TraceOp::RSSetViewports: {
+        std::array<D3D11_VIEWPORT, D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE> viewports;
+        uint32_t count = ReadValues(viewports);
+
+        m_context->RSSetViewports(count, viewports.data());
+      } break;
+
+      case D3D11TraceOp::RSSetScissorRects: {
+        std::array<D3D11_RECT, D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE> rects;
+        uint32_t count = ReadValues(rects);
+
+        m_context->RSSetScissorRects(count, rects.data());
+      } break;
+
+      case D3D11TraceOp::Draw: {
+        auto vertexCount = Read<UINT>();
+        auto firstVertex = Read<UINT>();
+
+        m_context->Draw(vertexCount, firstVertex);
+      } break;
+
+      case D3D11TraceOp::DrawIndexed: {
+        auto indexCount = Read<UINT>();
+        auto firstIndex = Read<UINT>();
+        auto vertexOffset = Read<INT>();
+
+        m_context->DrawIndexed(indexCount, firstIndex, vertexOffset);
+      } break;
+
+      case D3D11TraceOp::DrawInstanced: {
+        auto vertexCount = Read<UINT>();
+        auto instanceCount = Read<UINT>();
+        auto firstVertex = Read<UINT>();
+        auto firstInstance = Read<UINT>();
+
+        m_context->DrawInstanced(vertexCount, instanceCount, firstVertex, firstInstance);
+      } break;
+
+      case D3D11TraceOp::DrawIndexedInstanced: {
+        auto indexCount = Read<UINT>();
+        auto instanceCount = Read<UINT>();
+        auto firstIndex = Read<UINT>();
+        auto vertexOffset = Read<INT>();
+        auto firstInstance = Read<UINT>();
+
+        m_context->DrawIndexedInstanced(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+      } break;
+
+      case D3D11TraceOp::DrawInstancedIndirect: {
+        auto buffer = ReadObject<ID3D11Buffer>();
+        auto offset = Read<UINT>();
+
+        m_context->DrawInstancedIndirect(buffer, offset);
+      } break;
+
+      case D3D11TraceOp::DrawIndexedInstancedIndirect: {
+        auto buffer = ReadObject<ID3D11Buffer>();
+        auto offset = Read<UINT>();
+
+        m_context->DrawIndexedInstancedIndirect(buffer, offset);
+      } break;
+
+      case D3D11TraceOp::Dispatch: {
+        auto x = Read<UINT>();
+        auto y = Read<UINT>();
+        auto z = Read<UINT>();
+
+        m_context->Dispatch(x, y, z);
+      } break;
+
+      case D3D11TraceOp::DispatchIndirect: {
+        auto buffer = ReadObject<ID3D11Buffer>();
+        auto offset = Read<UINT>();
+
+        m_context->DispatchIndirect(buffer, offset);
+      } break;
+
+      case D3D11TraceOp::ClearRenderTargetView: {
+        std::array<FLOAT, 4> color;
+
+        auto view = ReadObject<ID3D11RenderTargetView>();
+
+        if (ReadValues(color) == color.size())
+          m_context->ClearRenderTargetView(view, color.data());
+      } break;
+
+      case D3D11TraceOp::ClearDepthStencilView: {
+        auto view = ReadObject<ID3D11DepthStencilView>();
+        auto flags = Read<UINT>();
+        auto depth = Read<FLOAT>();
+        auto stencil = Read<UINT8>();
+
+        m_context->ClearDepthStencilView(view, flags, depth, stencil);
+      } break;
+
+      case D3D11TraceOp::ClearUnorderedAccessViewUint: {
+        std::array<UINT, 4> values;
+
+        auto view = ReadObject<ID3D11UnorderedAccessView>();
+
+        if (ReadValues(values) == values.size())
+          m_context->ClearUnorderedAccessViewUint(view, values.data());
+      } break;
+
+      case D3D11TraceOp::ClearUnorderedAccessViewFloat: {
+        std::array<FLOAT, 4> values;
+
+        auto view = ReadObject<ID3D11UnorderedAccessView>();
+
+        if (ReadValues(values) == values.size())
+          m_context->ClearUnorderedAccessViewFloat(view, values.data());
+      } break;
+
+      case D3D11TraceOp::CopyResource: {
+        auto dst = ReadObject<ID3D11Resource>();
+        auto src = ReadObject<ID3D11Resource>();
+
+        m_context->CopyResource(dst, src);
+      } break;
+
+      case D3D11TraceOp::CopySubresourceRegion: {
+        std::array<D3D11_BOX, 1> box;
+
+        auto dst = ReadObject<ID3D11Resource>();
+        auto dstSubresource = Read<UINT>();
+        auto dstX = Read<UINT>();
+        auto dstY = Read<UINT>();
+        auto dstZ = Read<UINT>();
+        auto src = ReadObject<ID3D11Resource>();
+        auto srcSubresource = Read<UINT>();
+        bool hasBox = ReadValues(box);
+        auto copyFlags = Read<UINT>();
+
+        m_context->CopySubresourceRegion1(dst, dstSubresource, dstX, dstY, dstZ,
+          src, srcSubresource, hasBox ? box.data() : nullptr, copyFlags);
+      } break;
+
+      case D3D11TraceOp::UpdateSubresource:
+        ExecuteUpdateSubresource();
+        break;
+
+      case D3D11TraceOp::GenerateMips:
+        m_context->GenerateMips(ReadObject<ID3D11ShaderResourceView>());
+        break;
+
+      case D3D11TraceOp::Map:
+        ExecuteMap();
+        break;
+
+      default:
+        Logger::warn(str::format("D3D11: Unknown trace record ", uint32_t(Op)));
+    }
+  }
+
+
+  void D3D11TraceReplayer::ExecuteCreateBuffer() {
+    uint32_t id = Read<uint32_t>();
+    auto desc = Read<D3D11_BUFFER_DESC>();
+
+    D3D11_SUBRESOURCE_DATA initialData = { };
+
+    if (Read<uint32_t>())
+      initialData.pSysMem = ReadData(desc.ByteWidth);
+
+    Com<ID3D11Buffer> buffer;
+    m_device->CreateBuffer(&desc, initialData.pSysMem ? &initialData : nullptr, &buffer);
+    SetObject(id, buffer.ptr());
+  }
+
+
+  void D3D11TraceReplayer::ExecuteCreateTexture() {
+    uint32_t id = Read<uint32_t>();
+    auto dim = D3D11_RESOURCE_DIMENSION(Read<uint32_t>());
+    auto desc = Read<D3D11_COMMON_TEXTURE_DESC>();
+
+    // Shared resources cannot be recreated meaningfully
+    desc.MiscFlags &= ~(D3D11_RESOURCE_MISC_SHARED
+                      | D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX
+                      | D3D11_RESOURCE_MISC_SHARED_NTHANDLE
+                      | D3D11_RESOURCE_MISC_GDI_COMPATIBLE);
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initialData;
+
+    if (Read<uint32_t>()) {
+      initialData.resize(desc.MipLevels * desc.ArraySize);
+
+      for (auto& subresource : initialData) {
+        subresource.SysMemPitch = Read<uint32_t>();
+        subresource.SysMemSlicePitch = Read<uint32_t>();
+        subresource.pSysMem = ReadData(Read<uint32_t>());
+      }
+    }
+
+    const D3D11_SUBRESOURCE_DATA* pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    switch (dim) {
+      case D3D11_RESOURCE_DIMENSION_TEXTURE1D: {
+        D3D11_TEXTURE1D_DESC desc1D = { };
+        desc1D.Width          = desc.Width;
+        desc1D.MipLevels      = desc.MipLevels;
+        desc1D.ArraySize      = desc.ArraySize;
+        desc1D.Format         = desc.Format;
+        desc1D.Usage          = desc.Usage;
+        desc1D.BindFlags      = desc.BindFlags;
+        desc1D.CPUAccessFlags = desc.CPUAccessFlags;
+        desc1D.MiscFlags      = desc.MiscFlags;
+
+        Com<ID3D11Texture1D> texture;
+        m_device->CreateTexture1D(&desc1D, pInitialData, &texture);
+        SetObject(id, texture.ptr());
+      } break;
+
+      case D3D11_RESOURCE_DIMENSION_TEXTURE2D: {
+        D3D11_TEXTURE2D_DESC1 desc2D = { };
+        desc2D.Width          = desc.Width;
+        desc2D.Height         = desc.Height;
+        desc2D.MipLevels      = desc.MipLevels;
+        desc2D.ArraySize      = desc.ArraySize;
+        desc2D.Format         = desc.Format;
+        desc2D.SampleDesc     = desc.SampleDesc;
+        desc2D.Usage          = desc.Usage;
+        desc2D.BindFlags      = desc.BindFlags;
+        desc2D.CPUAccessFlags = desc.CPUAccessFlags;
+        desc2D.MiscFlags      = desc.MiscFlags;
+        desc2D.TextureLayout  = desc.TextureLayout;
+
+        Com<ID3D11Texture2D1> texture;
+        m_device->CreateTexture2D1(&desc2D, pInitialData, &texture);
+        SetObject(id, texture.ptr());
+      } break;
+
+      case D3D11_RESOURCE_DIMENSION_TEXTURE3D: {
+        D3D11_TEXTURE3D_DESC1 desc3D = { };
+        desc3D.Width          = desc.Width;
+        desc3D.Height         = desc.Height;
+        desc3D.Depth          = desc.Depth;
+        desc3D.MipLevels      = desc.MipLevels;
+        desc3D.Format         = desc.Format;
+        desc3D.Usage          = desc.Usage;
+        desc3D.BindFlags      = desc.BindFlags;
+        desc3D.CPUAccessFlags = desc.CPUAccessFlags;
+        desc3D.MiscFlags      = desc.MiscFlags;
+        desc3D.TextureLayout  = desc.TextureLayout;
+
+        Com<ID3D11Texture3D1> texture;
+        m_device->CreateTexture3D1(&desc3D, pInitialData, &texture);
+        SetObject(id, texture.ptr());
+      } break;
+
+      default:
+        throw DxvkError(str::format("D3D11: Invalid texture dimension ", uint32_t(dim)));
+    }
+  }
+
+
+  void D3D11TraceReplayer::ExecuteCreateInputLayout() {
+    std::array<D3D11_INPUT_ELEMENT_DESC, D3D11_IA_VERTEX_INPUT_STRUCTURE_ELEMENT_COUNT> elements;
+
+    uint32_t id = Read<uint32_t>();
+    uint32_t count = Read<uint32_t>();
+
+    if (count > elements.size())
+      throw DxvkError("D3D11: Invalid input layout record");
+
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t nameLength = Read<uint32_t>();
+      auto name = reinterpret_cast<const char*>(ReadData(nameLength));
+
+      if (!nameLength || name[nameLength - 1u])
+        throw DxvkError("D3D11: Invalid semantic name");
+
+      elements[i] = Read<D3D11_INPUT_ELEMENT_DESC>();
+      elements[i].SemanticName = name;
+    }
+
+    uint32_t codeSize = Read<uint32_t>();
+    const void* code = ReadData(codeSize);
+
+    Com<ID3D11InputLayout> inputLayout;
+    m_device->CreateInputLayout(elements.data(), count, code, codeSize, &inputLayout);
+    SetObject(id, inputLayout.ptr());
+  }
+
+
+  void D3D11TraceReplayer::ExecuteCreateShader() {
+    uint32_t id = Read<uint32_t>();
+    auto stage = D3D11ShaderType(Read<uint32_t>());
+
+    uint32_t codeSize = Read<uint32_t>();
+    const void* code = ReadData(codeSize);
+
+    switch (stage) {
+      case D3D11ShaderType::eVertex: {
+        Com<ID3D11VertexShader> shader;
+        m_device->CreateVertexShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      case D3D11ShaderType::eHull: {
+        Com<ID3D11HullShader> shader;
+        m_device->CreateHullShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      case D3D11ShaderType::eDomain: {
+        Com<ID3D11DomainShader> shader;
+        m_device->CreateDomainShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      case D3D11ShaderType::eGeometry: {
+        Com<ID3D11GeometryShader> shader;
+        m_device->CreateGeometryShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      case D3D11ShaderType::ePixel: {
+        Com<ID3D11PixelShader> shader;
+        m_device->CreatePixelShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      case D3D11ShaderType::eCompute: {
+        Com<ID3D11ComputeShader> shader;
+        m_device->CreateComputeShader(code, codeSize, nullptr, &shader);
+        SetObject(id, shader.ptr());
+      } break;
+
+      default:
+        throw DxvkError(str::format("D3D11: Invalid shader stage ", uint32_t(stage)));
+    }
+  }
+
+
+  void D3D11TraceReplayer::ExecuteUpdateSubresource() {
+    std::array<D3D11_BOX, 1> box;
+
+    auto resource = ReadObject<ID3D11Resource>();
+    auto subresource = Read<UINT>();
+    bool hasBox = ReadValues(box);
+    auto copyFlags = Read<UINT>();
+
+    auto rowPitch = Read<uint32_t>();
+    auto depthPitch = Read<uint32_t>();
+
+    uint32_t size = Read<uint32_t>();
+    const void* data = ReadData(size);
+
+    if (resource && size) {
+      m_context->UpdateSubresource1(resource, subresource,
+        hasBox ? box.data() : nullptr, data, rowPitch, depthPitch, copyFlags);
+    }
+  }
+
+
+  void D3D11TraceReplayer::ExecuteMap() {
+    auto resource = ReadObject<ID3D11Resource>();
+    auto subresource = Read<UINT>();
+    auto mapType = Read<D3D11_MAP>();
+    auto mapFlags = Read<UINT>();
+
+    uint32_t size = Read<uint32_t>();
+    const void* data = ReadData(size);
+
+    if (!resource)
+      return;
+
+    D3D11_MAPPED_SUBRESOURCE mapped = { };
+
+    if (SUCCEEDED(m_context->Map(resource, subresource, mapType, mapFlags, &mapped))) {
+      if (size)
+        std::memcpy(mapped.pData, data, size);
+
+      m_context->Unmap(resource, subresource);
+    }
+  }
+
+
+  void D3D11TraceReplayer::ExecuteEndFrame() {
+    m_context->Flush();
+    m_context->End(m_query.ptr());
+
+    while (m_context->GetData(m_query.ptr(), nullptr, 0, 0) == S_FALSE)
+      dxvk::this_thread::yield();
+
+    auto now = high_resolution_clock::now();
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - m_frameStart);
+
+    m_frameTimes.push_back(us.count());
+    m_frameStart = now;
+  }
+
+
+  void D3D11TraceReplayer::SetObject(
+          uint32_t                    Id,
+          ID3D11DeviceChild*          pObject) {
+    if (Id >= m_objects.size())
+      m_objects.resize(Id + 1u);
+
+    m_objects[Id] = pObject;
+  }
+
+
+  const void* D3D11TraceReplayer::ReadData(
+          size_t                      Size) {
+    if (Size > m_recordEnd - m_offset)
+      throw DxvkError("D3D11: Unexpected end of trace record");
+
+    const void* data = m_data.data() + m_offset;
+    m_offset += Size;
+    return data;
+  }
+
+
+  void D3D11TraceReplayer::LogStatistics() const {
+    if (m_frameTimes.empty()) {
+      Logger::warn("D3D11: Trace did not contain any frames");
+      return;
+    }
+
+    std::vector<uint64_t> frameTimes = m_frameTimes;
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    uint64_t total = 0u;
+
+    for (auto t : frameTimes)
+      total += t;
+
+    size_t count = frameTimes.size();
+
+    Logger::info(str::format("D3D11: Replayed ", count, " frames:",
+      "\n  Average: ", total / count, " us",
+      "\n  Median:  ", frameTimes[count / 2u], " us",
+      "\n  99th:    ", frameTimes[std::min(count - 1u, (count * 99u) / 100u)], " us",
+      "\n  Minimum: ", frameTimes.front(), " us",
+      "\n  Maximum: ", frameTimes.back(), " us"));
+  }
+
+}
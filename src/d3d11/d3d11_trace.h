@@ -0,0 +1,516 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "d3d11_include.h"
+#include "d3d11_shader.h"
+
+#include "../util/thread.h"
+#include "../util/util_time.h"
+
+namespace dxvk {
+
+  class D3D11CommonTexture;
+
+  /**
+   * \brief Trace record type
+   *
+   * Each record starts with a header containing the record
+   * type and payload size, followed by the call arguments.
+   * Object pointers are replaced by object IDs, where the
+   * ID 0 denotes a null or unknown object.
+   */
+  enum class D3D11TraceOp : uint32_t {
+    EndFrame                                  = 0,
+    CreateBuffer                              = 1,
+    CreateTexture                             = 2,
+    CreateShaderResourceView                  = 3,
+    CreateUnorderedAccessView                 = 4,
+    CreateRenderTargetView                    = 5,
+    CreateDepthStencilView                    = 6,
+    CreateInputLayout                         = 7,
+    CreateShader                              = 8,
+    CreateBlendState                          = 9,
+    CreateDepthStencilState                   = 10,
+    CreateRasterizerState                     = 11,
+    CreateSamplerState                        = 12,
+    ClearState                                = 13,
+    IASetInputLayout                          = 14,
+    IASetPrimitiveTopology                    = 15,
+    IASetVertexBuffers                        = 16,
+    IASetIndexBuffer                          = 17,
+    SetShader                                 = 18,
+    SetConstantBuffers                        = 19,
+    SetShaderResources                        = 20,
+    SetSamplers                               = 21,
+    CSSetUnorderedAccessViews                 = 22,
+    OMSetRenderTargetsAndUnorderedAccessViews = 23,
+    OMSetBlendState                           = 24,
+    OMSetDepthStencilState                    = 25,
+    RSSetState                                = 26,
+    RSSetViewports                            = 27,
+    RSSetScissorRects                         = 28,
+    Draw                                      = 29,
+    DrawIndexed                               = 30,
+    DrawInstanced                             = 31,
+    DrawIndexedInstanced                      = 32,
+    DrawInstancedIndirect                     = 33,
+    DrawIndexedInstancedIndirect              = 34,
+    Dispatch                                  = 35,
+    DispatchIndirect                          = 36,
+    ClearRenderTargetView                     = 37,
+    ClearDepthStencilView                     = 38,
+    ClearUnorderedAccessViewUint              = 39,
+    ClearUnorderedAccessViewFloat             = 40,
+    CopyResource                              = 41,
+    CopySubresourceRegion                     = 42,
+    UpdateSubresource                         = 43,
+    GenerateMips                              = 44,
+    Map                                       = 45,
+  };
+
+
+  /**
+   * \brief Trace file header
+   */
+  struct D3D11TraceFileHeader {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  reserved;
+  };
+
+  /**
+   * \brief Trace record header
+   */
+  struct D3D11TraceRecordHeader {
+    D3D11TraceOp  op;
+    uint32_t      size;
+  };
+
+  constexpr uint32_t D3D11TraceVersion = 1u;
+
+
+  /**
+   * \brief Array argument
+   *
+   * Written as an element count followed by the
+   * elements. Null arrays have an element count
+   * of zero.
+   */
+  template<typename T>
+  struct D3D11TraceArray {
+    const T*  data;
+    uint32_t  count;
+  };
+
+  template<typename T>
+  D3D11TraceArray<T> TraceArray(const T* pData, uint32_t Count) {
+    return D3D11TraceArray<T> { pData, pData ? Count : 0u };
+  }
+
+
+  /**
+   * \brief API trace writer
+   *
+   * Records object creation on the device as well as calls on
+   * the immediate context into a compact binary trace, so that
+   * the frontend's CPU overhead can be measured by replaying the
+   * trace without running the actual application.
+   *
+   * Deferred contexts are not recorded, and neither are command
+   * lists executed on the immediate context, so the trace of an
+   * application that uses deferred contexts is incomplete.
+   *
+   * Records are buffered in memory and written to the file at the
+   * end of each frame, or once the buffer exceeds a certain size.
+   * If the file cannot be created or written, recording stops.
+   */
+  class D3D11TraceWriter {
+    constexpr static size_t MaxBufferSize = 16ull << 20;
+  public:
+
+    /**
+     * \brief Creates trace writer
+     *
+     * The trace is written to a file named after the given base
+     * name, the process ID and a per-process device counter.
+     * \param [in] BaseName Base file name
+     */
+    D3D11TraceWriter(
+      const std::string&                BaseName);
+
+    ~D3D11TraceWriter();
+
+    /**
+     * \brief Records buffer creation
+     *
+     * \param [in] pBuffer The buffer
+     * \param [in] pDesc Buffer description
+     * \param [in] pInitialData Initial data, if any
+     */
+    void RecordCreateBuffer(
+            ID3D11Buffer*               pBuffer,
+      const D3D11_BUFFER_DESC*          pDesc,
+      const D3D11_SUBRESOURCE_DATA*     pInitialData);
+
+    /**
+     * \brief Records texture creation
+     *
+     * \param [in] pTexture The texture
+     * \param [in] pInitialData Initial data, if any
+     */
+    void RecordCreateTexture(
+            ID3D11Resource*             pTexture,
+      const D3D11_SUBRESOURCE_DATA*     pInitialData);
+
+    /**
+     * \brief Records input layout creation
+     *
+     * \param [in] pInputLayout The input layout
+     * \param [in] pInputElementDescs Input elements
+     * \param [in] NumElements Number of input elements
+     * \param [in] pBytecode Vertex shader byte code
+     * \param [in] BytecodeLength Byte code size
+     */
+    void RecordCreateInputLayout(
+            ID3D11InputLayout*          pInputLayout,
+      const D3D11_INPUT_ELEMENT_DESC*   pInputElementDescs,
+            UINT                        NumElements,
+      const void*                       pBytecode,
+            SIZE_T                      BytecodeLength);
+
+    /**
+     * \brief Records shader creation
+     *
+     * \param [in] pShader The shader
+     * \param [in] Stage Shader stage
+     * \param [in] pBytecode Shader byte code
+     * \param [in] BytecodeLength Byte code size
+     */
+    void RecordCreateShader(
+            ID3D11DeviceChild*          pShader,
+            D3D11ShaderType             Stage,
+      const void*                       pBytecode,
+            SIZE_T                      BytecodeLength);
+
+    /**
+     * \brief Records state object creation
+     *
+     * State objects are deduplicated by the device, so
+     * creation is only recorded for new objects.
+     * \param [in] Op Record type
+     * \param [in] pState The state object
+     * \param [in] Desc State object description
+     */
+    template<typename T>
+    void RecordCreateState(
+            D3D11TraceOp                Op,
+            ID3D11DeviceChild*          pState,
+      const T&                          Desc) {
+      std::lock_guard lock(m_mutex);
+
+      if (unlikely(m_failed) || !m_states.insert(pState).second)
+        return;
+
+      size_t offset = BeginRecord(Op);
+      WriteValue(AllocObjectId(pState));
+      WriteValue(Desc);
+      EndRecord(offset);
+    }
+
+    /**
+     * \brief Records creation of another object
+     *
+     * Assigns a new ID to the given object and
+     * writes the remaining arguments as-is.
+     * \param [in] Op Record type
+     * \param [in] pObject The object
+     * \param [in] Arguments Record arguments
+     */
+    template<typename... Args>
+    void RecordCreate(
+            D3D11TraceOp                Op,
+            ID3D11DeviceChild*          pObject,
+      const Args&...                    Arguments) {
+      std::lock_guard lock(m_mutex);
+
+      if (unlikely(m_failed))
+        return;
+
+      size_t offset = BeginRecord(Op);
+      WriteValue(AllocObjectId(pObject));
+      (WriteArg(Arguments), ...);
+      EndRecord(offset);
+    }
+
+    /**
+     * \brief Records a context call
+     *
+     * Pointer arguments are interpreted as objects and
+     * written as object IDs, arrays must be passed via
+     * \ref TraceArray.
+     * \param [in] Op Record type
+     * \param [in] Arguments Record arguments
+     */
+    template<typename... Args>
+    void Record(
+            D3D11TraceOp                Op,
+      const Args&...                    Arguments) {
+      std::lock_guard lock(m_mutex);
+
+      if (unlikely(m_failed))
+        return;
+
+      size_t offset = BeginRecord(Op);
+      (WriteArg(Arguments), ...);
+      EndRecord(offset);
+    }
+
+    /**
+     * \brief Records a subresource update
+     *
+     * Texture data is repacked tightly.
+     */
+    void RecordUpdateSubresource(
+            ID3D11Resource*             pDstResource,
+            UINT                        DstSubresource,
+      const D3D11_BOX*                  pDstBox,
+      const void*                       pSrcData,
+            UINT                        SrcRowPitch,
+            UINT                        SrcDepthPitch,
+            UINT                        CopyFlags);
+
+    /**
+     * \brief Tracks a resource mapping
+     *
+     * The map call itself is recorded when the resource
+     * gets unmapped, together with the written data for
+     * buffers mapped with \c D3D11_MAP_WRITE_DISCARD or
+     * \c D3D11_MAP_WRITE. Data written to buffers mapped
+     * with \c D3D11_MAP_WRITE_NO_OVERWRITE is not known
+     * and therefore not captured.
+     */
+    void RecordMap(
+            ID3D11Resource*             pResource,
+            UINT                        Subresource,
+            D3D11_MAP                   MapType,
+            UINT                        MapFlags,
+      const void*                       pData);
+
+    /**
+     * \brief Records a resource mapping
+     *
+     * \param [in] pResource The resource
+     * \param [in] Subresource Subresource index
+     */
+    void RecordUnmap(
+            ID3D11Resource*             pResource,
+            UINT                        Subresource);
+
+    /**
+     * \brief Records end of frame
+     *
+     * Writes all buffered records to the trace file.
+     */
+    void EndFrame();
+
+  private:
+
+    struct PendingMap {
+      ID3D11Resource* resource;
+      UINT            subresource;
+      D3D11_MAP       mapType;
+      UINT            mapFlags;
+      const void*     data;
+    };
+
+    dxvk::mutex                           m_mutex;
+    std::ofstream                         m_file;
+    bool                                  m_failed = false;
+
+    std::vector<char>                     m_data;
+
+    uint32_t                              m_objectCount = 0u;
+    std::unordered_map<const void*, uint32_t> m_objects;
+    std::unordered_set<const void*>       m_states;
+
+    std::vector<PendingMap>               m_mappings;
+
+    uint32_t AllocObjectId(
+      const void*                       pObject);
+
+    uint32_t LookupObjectId(
+      const void*                       pObject) const;
+
+    size_t BeginRecord(
+            D3D11TraceOp                Op);
+
+    void EndRecord(
+            size_t                      Offset);
+
+    void WriteData(
+      const void*                       pData,
+            size_t                      Size);
+
+    void WriteTextureData(
+            D3D11CommonTexture*         pTexture,
+            VkExtent3D                  Extent,
+      const void*                       pData,
+            UINT                        RowPitch,
+            UINT                        DepthPitch);
+
+    void FlushLocked();
+
+    template<typename T>
+    void WriteValue(const T& Value) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      WriteData(&Value, sizeof(Value));
+    }
+
+    template<typename T>
+    void WriteArg(const T& Value) {
+      if constexpr (std::is_pointer_v<T>)
+        WriteValue(LookupObjectId(Value));
+      else
+        WriteValue(Value);
+    }
+
+    template<typename T>
+    void WriteArg(const D3D11TraceArray<T>& Array) {
+      WriteValue(Array.count);
+
+      for (uint32_t i = 0; i < Array.count; i++)
+        WriteArg(Array.data[i]);
+    }
+
+  };
+
+
+  /**
+   * \brief API trace replayer
+   *
+   * Re-issues all calls from a trace captured with
+   * \ref D3D11TraceWriter on the given device and
+   * measures the CPU time spent on each frame.
+   *
+   * At the end of each frame, the replayer flushes
+   * the immediate context and waits for all work to
+   * complete, so that frame times include the time
+   * spent on the CS thread as well as submission.
+   */
+  class D3D11TraceReplayer {
+
+  public:
+
+    D3D11TraceReplayer(
+            ID3D11Device*               pDevice);
+
+    ~D3D11TraceReplayer();
+
+    /**
+     * \brief Replays trace file
+     *
+     * Logs frame time statistics when done.
+     * \param [in] FileName Trace file
+     * \returns \c S_OK on success
+     */
+    HRESULT Replay(
+      const std::string&                FileName);
+
+  private:
+
+    Com<ID3D11Device3>                    m_device;
+    Com<ID3D11DeviceContext1>             m_context;
+    Com<ID3D11Query>                      m_query;
+
+    std::vector<char>                     m_data;
+    size_t                                m_offset = 0u;
+    size_t                                m_recordEnd = 0u;
+
+    std::vector<Com<ID3D11DeviceChild>>   m_objects;
+    std::vector<uint64_t>                 m_frameTimes;
+
+    high_resolution_clock::time_point     m_frameStart;
+
+    void ExecuteRecord(
+            D3D11TraceOp                Op);
+
+    void ExecuteCreateBuffer();
+
+    void ExecuteCreateTexture();
+
+    void ExecuteCreateInputLayout();
+
+    void ExecuteCreateShader();
+
+    void ExecuteUpdateSubresource();
+
+    void ExecuteMap();
+
+    void ExecuteEndFrame();
+
+    void SetObject(
+            uint32_t                    Id,
+            ID3D11DeviceChild*          pObject);
+
+    const void* ReadData(
+            size_t                      Size);
+
+    template<typename T>
+    T Read() {
+      T value;
+      std::memcpy(&value, ReadData(sizeof(value)), sizeof(value));
+      return value;
+    }
+
+    template<typename T>
+    T* ReadObject() {
+      uint32_t id = Read<uint32_t>();
+
+      return id < m_objects.size()
+        ? static_cast<T*>(m_objects[id].ptr())
+        : nullptr;
+    }
+
+    template<typename T, size_t N>
+    uint32_t ReadObjects(std::array<T*, N>& Objects) {
+      uint32_t count = Read<uint32_t>();
+
+      // Out-of-range elements were ignored by the
+      // original call, so we can drop them as well
+      for (uint32_t i = 0; i < count; i++) {
+        T* object = ReadObject<T>();
+
+        if (i < N)
+          Objects[i] = object;
+      }
+
+      return std::min<uint32_t>(count, N);
+    }
+
+    template<typename T, size_t N>
+    uint32_t ReadValues(std::array<T, N>& Values) {
+      uint32_t count = Read<uint32_t>();
+
+      for (uint32_t i = 0; i < count; i++) {
+        T value = Read<T>();
+
+        if (i < N)
+          Values[i] = value;
+      }
+
+      return std::min<uint32_t>(count, N);
+    }
+
+    void LogStatistics() const;
+
+  };
+
+}
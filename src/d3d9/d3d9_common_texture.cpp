@@ -106,6 +106,7 @@ namespace dxvk {
       m_device->ChangeReportedMemory(m_size);
 
     m_device->RemoveMappedTexture(this);
+    m_device->RemoveManagedUpload(this);
 
     if (m_desc.Pool == D3DPOOL_DEFAULT)
       m_device->DecrementLosableCounter();
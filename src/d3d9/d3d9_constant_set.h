@@ -9,6 +9,7 @@
 
 #include "../util/util_vector.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace dxvk {
@@ -19,6 +20,50 @@ namespace dxvk {
     Bool
   };
 
+  /**
+   * \brief Dirty constant register range
+   *
+   * Covers all registers of one constant type that were written
+   * since the constants were last uploaded, so that uploads can
+   * be skipped if the active shader does not read any of them.
+   */
+  struct D3D9ConstantRange {
+    uint32_t begin = 0u;
+    uint32_t end   = 0u;
+
+    static D3D9ConstantRange all() {
+      return D3D9ConstantRange { 0u, ~0u };
+    }
+
+    bool isEmpty() const {
+      return begin >= end;
+    }
+
+    bool overlaps(uint32_t first, uint32_t last) const {
+      return begin < last && first < end;
+    }
+
+    bool overlaps(const DxsoConstantGatherTable& registers) const {
+      auto entry = std::lower_bound(registers.begin(), registers.end(), begin);
+      return entry != registers.end() && *entry < end;
+    }
+
+    void add(uint32_t first, uint32_t last) {
+      if (isEmpty()) {
+        begin = first;
+        end   = last;
+      } else {
+        begin = std::min(begin, first);
+        end   = std::max(end, last);
+      }
+    }
+
+    void clear() {
+      begin = 0u;
+      end   = 0u;
+    }
+  };
+
   // We make an assumption later based on the packing of this struct for copying.
   struct D3D9ShaderConstantsVSSoftware {
     Vector4i iConsts[caps::MaxOtherConstantsSoftware];
@@ -48,7 +93,9 @@ namespace dxvk {
     D3D9SwvpConstantBuffers   swvp;
     D3D9ConstantBuffer        buffer;
     DxsoShaderMetaInfo        meta  = {};
-    bool                      dirty = true;
+    D3D9ConstantRange         dirtyF = D3D9ConstantRange::all();
+    D3D9ConstantRange         dirtyI = D3D9ConstantRange::all();
+    D3D9ConstantRange         dirtyB = D3D9ConstantRange::all();
     uint32_t                  maxChangedConstF = 0;
     uint32_t                  maxChangedConstI = 0;
     uint32_t                  maxChangedConstB = 0;
@@ -56,7 +56,7 @@ namespace dxvk {
     , m_multithread        ( BehaviorFlags & D3DCREATE_MULTITHREADED )
     , m_isSWVP             ( (BehaviorFlags & D3DCREATE_SOFTWARE_VERTEXPROCESSING) != 0 )
     , m_isD3D8Compatible   ( pParent->IsD3D8Compatible() )
-    , m_csThread           ( dxvkDevice, dxvkDevice->createContext() )
+    , m_csThread           ( dxvkDevice, dxvkDevice->createContext(), false )
     , m_csChunk            ( AllocCsChunk() )
     , m_submissionFence    ( new sync::Fence() )
     , m_flushTracker       ( GetMaxFlushType() )
@@ -73,6 +73,9 @@ namespace dxvk {
     if (canSWVP)
       Logger::info("D3D9DeviceEx: Using extended constant set for software vertex processing.");
 
+    if (env::getEnvVar("DXVK_SHADER_CACHE") != "0" && m_d3d9Options.shaderDumpPath.empty())
+      m_shaderCache = D3D9ShaderCache::getInstance();
+
     if (m_dxvkDevice->debugFlags().test(DxvkDebugFlag::Markers))
       m_annotation = new D3D9UserDefinedAnnotation(this);
 
@@ -201,6 +204,10 @@ namespace dxvk {
 
 
   D3D9DeviceEx::~D3D9DeviceEx() {
+    // Shader translation workers access the device, so
+    // stop them before destroying anything they may use
+    m_shaderModules->StopWorkers();
+
     // Avoids hanging when in this state, see comment
     // in DxvkDevice::~DxvkDevice.
     if (this_thread::isInModuleDetachment())
@@ -3159,7 +3166,8 @@ namespace dxvk {
           UINT             PrimitiveCount,
     const void*            pVertexStreamZeroData,
           UINT             VertexStreamZeroStride) {
-    D3D9DeviceLock lock = LockDevice();
+    // Don't use LockDevice here since that would submit pending UP draws
+    D3D9DeviceLock lock = m_multithread.AcquireLock();
 
     if (unlikely(!VertexStreamZeroStride))
       return D3DERR_INVALIDCALL;
@@ -3170,10 +3178,20 @@ namespace dxvk {
     if (unlikely(!PrimitiveCount))
       return D3D_OK;
 
-    PrepareDraw(PrimitiveType, false, false);
-
     uint32_t vertexCount = GetVertexCount(PrimitiveType, PrimitiveCount);
 
+    if (unlikely(m_d3d9Options.batchUPDraws)) {
+      if (BatchUPDraw(PrimitiveType, PrimitiveCount, vertexCount,
+          pVertexStreamZeroData, VertexStreamZeroStride, nullptr, D3DFMT_UNKNOWN)) {
+        m_state.vertexBuffers[0].vertexBuffer = nullptr;
+        m_state.vertexBuffers[0].offset       = 0;
+        m_state.vertexBuffers[0].stride       = 0;
+        return D3D_OK;
+      }
+    }
+
+    PrepareDraw(PrimitiveType, false, false);
+
     const uint32_t dataSize = GetUPDataSize(vertexCount, VertexStreamZeroStride);
     const uint32_t bufferSize = GetUPBufferSize(vertexCount, VertexStreamZeroStride);
 
@@ -3215,7 +3233,8 @@ namespace dxvk {
           D3DFORMAT        IndexDataFormat,
     const void*            pVertexStreamZeroData,
           UINT             VertexStreamZeroStride) {
-    D3D9DeviceLock lock = LockDevice();
+    // Don't use LockDevice here since that would submit pending UP draws
+    D3D9DeviceLock lock = m_multithread.AcquireLock();
 
     if (unlikely(!VertexStreamZeroStride))
       return D3DERR_INVALIDCALL;
@@ -3226,6 +3245,18 @@ namespace dxvk {
     if (unlikely(!PrimitiveCount || !NumVertices))
       return D3D_OK;
 
+    if (unlikely(m_d3d9Options.batchUPDraws)) {
+      if (BatchUPDraw(PrimitiveType, PrimitiveCount, MinVertexIndex + NumVertices,
+          pVertexStreamZeroData, VertexStreamZeroStride, pIndexData, IndexDataFormat)) {
+        m_state.vertexBuffers[0].vertexBuffer = nullptr;
+        m_state.vertexBuffers[0].offset       = 0;
+        m_state.vertexBuffers[0].stride       = 0;
+
+        m_state.indices = nullptr;
+        return D3D_OK;
+      }
+    }
+
     PrepareDraw(PrimitiveType, false, false);
 
     uint32_t vertexCount = GetVertexCount(PrimitiveType, PrimitiveCount);
@@ -3558,7 +3589,7 @@ namespace dxvk {
     DxsoModuleInfo moduleInfo;
     moduleInfo.options = m_dxsoOptions;
 
-    D3D9CommonShader module;
+    Rc<D3D9ShaderModule> module;
     uint32_t bytecodeLength;
 
     if (FAILED(this->CreateShaderModule(&module,
@@ -3592,18 +3623,7 @@ namespace dxvk {
     auto* oldShader = GetCommonShader(m_state.vertexShader);
     auto* newShader = GetCommonShader(shader);
 
-    bool oldCopies = oldShader && oldShader->GetMeta().needsConstantCopies;
-    bool newCopies = newShader && newShader->GetMeta().needsConstantCopies;
-
-    m_consts[DxsoProgramTypes::VertexShader].dirty |= oldCopies || newCopies || !oldShader;
-    m_consts[DxsoProgramTypes::VertexShader].meta  = newShader ? newShader->GetMeta() : DxsoShaderMetaInfo();
-
-    if (newShader && oldShader) {
-      m_consts[DxsoProgramTypes::VertexShader].dirty
-        |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
-        || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
-        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
-    }
+    UpdateConstantSetShader(m_consts[DxsoProgramTypes::VertexShader], oldShader, newShader);
 
     const bool wasUsingProgrammableVS = UseProgrammableVS();
 
@@ -3917,7 +3937,7 @@ namespace dxvk {
     DxsoModuleInfo moduleInfo;
     moduleInfo.options = m_dxsoOptions;
 
-    D3D9CommonShader module;
+    Rc<D3D9ShaderModule> module;
     uint32_t bytecodeLength;
 
     if (FAILED(this->CreateShaderModule(&module,
@@ -3951,18 +3971,7 @@ namespace dxvk {
     auto* oldShader = GetCommonShader(m_state.pixelShader);
     auto* newShader = GetCommonShader(shader);
 
-    bool oldCopies = oldShader && oldShader->GetMeta().needsConstantCopies;
-    bool newCopies = newShader && newShader->GetMeta().needsConstantCopies;
-
-    m_consts[DxsoProgramTypes::PixelShader].dirty |= oldCopies || newCopies || !oldShader;
-    m_consts[DxsoProgramTypes::PixelShader].meta  = newShader ? newShader->GetMeta() : DxsoShaderMetaInfo();
-
-    if (newShader && oldShader) {
-      m_consts[DxsoProgramTypes::PixelShader].dirty
-        |= newShader->GetMeta().maxConstIndexF > oldShader->GetMeta().maxConstIndexF
-        || newShader->GetMeta().maxConstIndexI > oldShader->GetMeta().maxConstIndexI
-        || newShader->GetMeta().maxConstIndexB > oldShader->GetMeta().maxConstIndexB;
-    }
+    UpdateConstantSetShader(m_consts[DxsoProgramTypes::PixelShader], oldShader, newShader);
 
     const D3D9ShaderMasks oldShaderMasks = PSShaderMasks();
     m_state.pixelShader = shader;
@@ -4867,6 +4876,141 @@ namespace dxvk {
   }
 
 
+  bool D3D9DeviceEx::BatchUPDraw(
+          D3DPRIMITIVETYPE          PrimitiveType,
+          UINT                      PrimitiveCount,
+          UINT                      VertexCount,
+    const void*                     pVertexData,
+          UINT                      Stride,
+    const void*                     pIndexData,
+          D3DFORMAT                 IndexFormat) {
+    constexpr size_t MaxBatchSize = 1 << 18;
+
+    D3D9UPBatch& batch = m_upBatch;
+
+    const bool indexed = pIndexData != nullptr;
+
+    const uint32_t indexCount = indexed ? GetVertexCount(PrimitiveType, PrimitiveCount) : 0u;
+    const uint32_t vertexDataSize = VertexCount * Stride;
+
+    // Only list topologies can be merged by concatenating the geometry. We
+    // also need the vertex data to be tightly packed, i.e. the app must not
+    // declare any elements that read past the stride. Any other streams
+    // would be indexed with the merged vertex indices, so the declaration
+    // must only read stream 0, and draws must not be instanced since that
+    // would change the primitive order.
+    bool batchable = (PrimitiveType == D3DPT_POINTLIST
+                   || PrimitiveType == D3DPT_LINELIST
+                   || PrimitiveType == D3DPT_TRIANGLELIST)
+      && m_state.vertexDecl->GetStreamMask() == 0b1u
+      && m_state.vertexDecl->GetSize(0) <= Stride
+      && !m_vbSlotTracking.instanced
+      && GetInstanceCount() == 1u
+      && vertexDataSize + indexCount * sizeof(uint32_t) <= MaxBatchSize;
+
+    if (batch.drawCount) {
+      bool compatible = batchable
+        && batch.primitiveType == PrimitiveType
+        && batch.stride == Stride
+        && batch.indexed == indexed
+        && batch.vertexData.size() + vertexDataSize
+         + (batch.indexData.size() + indexCount) * sizeof(uint32_t) <= MaxBatchSize;
+
+      if (!compatible)
+        FlushUPBatch();
+    }
+
+    if (!batchable)
+      return false;
+
+    if (!batch.drawCount) {
+      batch.primitiveType = PrimitiveType;
+      batch.stride = Stride;
+      batch.indexed = indexed;
+      batch.vertexCount = 0u;
+    }
+
+    const uint8_t* vertexData = reinterpret_cast<const uint8_t*>(pVertexData);
+    batch.vertexData.insert(batch.vertexData.end(), vertexData, vertexData + vertexDataSize);
+
+    if (indexed) {
+      size_t offset = batch.indexData.size();
+      batch.indexData.resize(offset + indexCount);
+
+      if (IndexFormat == D3DFMT_INDEX16) {
+        auto indices = reinterpret_cast<const uint16_t*>(pIndexData);
+
+        for (uint32_t i = 0; i < indexCount; i++)
+          batch.indexData[offset + i] = batch.vertexCount + indices[i];
+      } else {
+        auto indices = reinterpret_cast<const uint32_t*>(pIndexData);
+
+        for (uint32_t i = 0; i < indexCount; i++)
+          batch.indexData[offset + i] = batch.vertexCount + indices[i];
+      }
+    }
+
+    batch.vertexCount += VertexCount;
+    batch.drawCount += 1u;
+    return true;
+  }
+
+
+  void D3D9DeviceEx::FlushUPBatch() {
+    D3D9UPBatch& batch = m_upBatch;
+
+    // Reset the draw count first since recording
+    // the draw may end up calling LockDevice again.
+    batch.drawCount = 0u;
+
+    PrepareDraw(batch.primitiveType, false, false);
+
+    const uint32_t vertexSize = align(uint32_t(batch.vertexData.size()), uint32_t(sizeof(uint32_t)));
+    const uint32_t indexSize = uint32_t(batch.indexData.size() * sizeof(uint32_t));
+
+    auto upSlice = AllocUPBuffer(vertexSize + indexSize);
+    uint8_t* data = reinterpret_cast<uint8_t*>(upSlice.mapPtr);
+    std::memcpy(data, batch.vertexData.data(), batch.vertexData.size());
+
+    if (indexSize)
+      std::memcpy(data + vertexSize, batch.indexData.data(), indexSize);
+
+    EmitCs([this,
+      cBufferSlice  = std::move(upSlice.slice),
+      cPrimType     = batch.primitiveType,
+      cStride       = batch.stride,
+      cVertexSize   = vertexSize,
+      cVertexCount  = batch.vertexCount,
+      cIndexCount   = uint32_t(batch.indexData.size())
+    ](DxvkContext* ctx) {
+      ApplyPrimitiveType(ctx, cPrimType);
+
+      ctx->bindVertexBuffer(0, cBufferSlice.subSlice(0, cVertexSize), cStride);
+
+      if (cIndexCount) {
+        VkDrawIndexedIndirectCommand draw = { };
+        draw.indexCount    = cIndexCount;
+        draw.instanceCount = 1u;
+
+        ctx->bindIndexBuffer(cBufferSlice.subSlice(cVertexSize, cBufferSlice.length() - cVertexSize), VK_INDEX_TYPE_UINT32);
+        ctx->drawIndexed(1u, &draw);
+        ctx->bindIndexBuffer(DxvkBufferSlice(), VK_INDEX_TYPE_UINT32);
+      } else {
+        VkDrawIndirectCommand draw = { };
+        draw.vertexCount   = cVertexCount;
+        draw.instanceCount = 1u;
+
+        ctx->draw(1u, &draw);
+      }
+
+      ctx->bindVertexBuffer(0, DxvkBufferSlice(), 0);
+    });
+
+    batch.vertexData.clear();
+    batch.indexData.clear();
+  }
+
+
   D3D9BufferSlice D3D9DeviceEx::AllocStagingBuffer(VkDeviceSize size) {
     D3D9BufferSlice result;
     result.slice = m_stagingBuffer.alloc(size);
@@ -5233,6 +5377,12 @@ namespace dxvk {
       // Managed textures are uploaded at draw time.
       pResource->SetNeedsUpload(Subresource, true);
 
+      // Optionally upload textures ahead of time at the end of
+      // the frame, so that large batches of texture updates don't
+      // all have to be uploaded within a single draw.
+      if (m_d3d9Options.managedTextureUploadBudget)
+        m_managedUploadQueue.insert(pResource);
+
       for (uint32_t i : bit::BitMask(m_textureSlotTracking.bound)) {
         // Guaranteed to not be nullptr...
         auto texInfo = GetCommonTexture(m_state.textures[i]);
@@ -5454,28 +5604,55 @@ namespace dxvk {
       VkExtent3D srcBlockCount = util::computeBlockCount(srcTexLevelExtent, srcBlockSize);
       srcBlockCount.height *= std::min(pSrcTexture->GetPlaneCount(), 2u);
 
-      // the converter can not handle the 4 aligned pitch so we always repack into a staging buffer
-      D3D9BufferSlice slice = AllocStagingBuffer(pSrcTexture->GetMipSize(SrcSubresource));
       VkDeviceSize pitch = align(srcBlockCount.width * formatElementSize, 4);
 
       const DxvkFormatInfo* convertedFormatInfo = lookupFormatInfo(convertFormat.FormatColor);
       VkImageSubresourceLayers convertedDstLayers = { convertedFormatInfo->aspectMask, dstSubresource.mipLevel, dstSubresource.arrayLayer, 1 };
 
-      util::packImageData(
-        slice.mapPtr, mapPtr, srcBlockCount, formatElementSize,
-        pitch, std::min(pSrcTexture->GetPlaneCount(), 2u) * pitch * srcBlockCount.height);
-
-      EmitCs([this,
-        cConvertFormat    = convertFormat,
-        cDstImage         = std::move(image),
-        cDstLayers        = convertedDstLayers,
-        cSrcSlice         = std::move(slice.slice)
-      ] (DxvkContext* ctx) {
-        auto contextObjects = ctx->beginExternalRendering();
+      // Small uploads are converted on the CPU, directly into the staging
+      // buffer, which saves a compute dispatch and the associated barriers.
+      VkExtent2D convertExtent = { dstTexLevelExtent.width, dstTexLevelExtent.height };
+      VkDeviceSize convertSize = D3D9FormatHelper::GetCpuConversionSize(convertFormat, convertExtent);
 
-        m_converter->ConvertFormat(contextObjects,
-          cConvertFormat, cDstImage, cDstLayers, cSrcSlice);
-      });
+      if (D3D9FormatHelper::SupportsCpuConversion(convertFormat)
+       && dstTexLevelExtent.depth == 1u && convertSize <= D3D9FormatHelper::MaxCpuConversionSize) {
+        D3D9BufferSlice slice = AllocStagingBuffer(convertSize);
+
+        D3D9FormatHelper::ConvertFormatCpu(convertFormat,
+          slice.mapPtr, mapPtr, pitch, convertExtent);
+
+        EmitCs([
+          cSrcSlice       = std::move(slice.slice),
+          cDstImage       = std::move(image),
+          cDstLayers      = convertedDstLayers,
+          cDstLevelExtent = dstTexLevelExtent
+        ] (DxvkContext* ctx) {
+          ctx->copyBufferToImage(
+            cDstImage,  cDstLayers,
+            VkOffset3D { 0, 0, 0 }, cDstLevelExtent,
+            cSrcSlice.buffer(), cSrcSlice.offset(),
+            0, 0, VK_FORMAT_UNDEFINED);
+        });
+      } else {
+        // the converter can not handle the 4 aligned pitch so we always repack into a staging buffer
+        D3D9BufferSlice slice = AllocStagingBuffer(pSrcTexture->GetMipSize(SrcSubresource));
+
+        util::packImageData(
+          slice.mapPtr, mapPtr, srcBlockCount, formatElementSize,
+          pitch, std::min(pSrcTexture->GetPlaneCount(), 2u) * pitch * srcBlockCount.height);
+
+        EmitCs([this,
+          cConvertFormat    = convertFormat,
+          cDstImage         = std::move(image),
+          cDstLayers        = convertedDstLayers,
+          cSrcSlice         = std::move(slice.slice)
+        ] (DxvkContext* ctx) {
+          auto contextObjects = ctx->beginExternalRendering();
+
+          m_converter->ConvertFormat(contextObjects,
+            cConvertFormat, cDstImage, cDstLayers, cSrcSlice);
+        });
+      }
     }
     UnmapTextures();
     ConsiderFlush(GpuFlushType::ImplicitWeakHint);
@@ -6087,10 +6264,26 @@ namespace dxvk {
 
     D3D9ConstantSets& constSet = m_consts[DxsoProgramType::VertexShader];
 
-    if (!constSet.dirty)
+    if (constSet.dirtyF.isEmpty() && constSet.dirtyI.isEmpty() && constSet.dirtyB.isEmpty())
       return;
 
-    constSet.dirty = false;
+    // Float, int and bool constants live in separate buffers here, so only
+    // re-upload the buffers that contain registers that the shader reads.
+    // Each upload goes to freshly allocated memory, so it has to cover the
+    // entire range that the shader reads, not just the dirty registers.
+    bool uploadF = constSet.meta.maxConstIndexF != 0
+      && constSet.dirtyF.overlaps(0u, constSet.meta.maxConstIndexF);
+    bool uploadI = constSet.meta.maxConstIndexI != 0
+      && constSet.dirtyI.overlaps(0u, constSet.meta.maxConstIndexI);
+    bool uploadB = constSet.meta.maxConstIndexB != 0
+      && constSet.dirtyB.overlaps(0u, constSet.meta.maxConstIndexB);
+
+    if (uploadF && constSet.meta.compactConstantsF)
+      uploadF = constSet.dirtyF.overlaps(GetCommonShader(m_state.vertexShader)->GetConstantGatherTable());
+
+    constSet.dirtyF.clear();
+    constSet.dirtyI.clear();
+    constSet.dirtyB.clear();
 
     uint32_t floatCount = constSet.maxChangedConstF;
     if (constSet.meta.needsConstantCopies) {
@@ -6109,29 +6302,45 @@ namespace dxvk {
 
     // Max copy source size is 8192 * 16 => always aligned to any plausible value
     // => we won't copy out of bounds
-    if (likely(constSet.meta.maxConstIndexF != 0)) {
-      auto mapPtr = CopySoftwareConstants(constSet.buffer, Src.fConsts, floatDataSize);
+    if (uploadF) {
+      if (constSet.meta.compactConstantsF) {
+        // The shader only reads a sparse set of float constants,
+        // which the compiler remapped to consecutive buffer slots.
+        auto& gatherTable = GetCommonShader(m_state.vertexShader)->GetConstantGatherTable();
+
+        const uint32_t alignment = constSet.buffer.GetAlignment();
+        const uint32_t size = align(std::max(uint32_t(gatherTable.size() * sizeof(Vector4)), alignment), alignment);
 
-      if (constSet.meta.needsConstantCopies) {
-        // Copy shader defined constants over so they can be accessed
-        // with relative addressing.
-        Vector4* data = reinterpret_cast<Vector4*>(mapPtr);
+        Vector4* data = reinterpret_cast<Vector4*>(constSet.buffer.Alloc(size));
 
-        auto& shaderConsts = GetCommonShader(m_state.vertexShader)->GetConstants();
+        for (size_t i = 0; i < gatherTable.size(); i++)
+          data[i] = Src.fConsts[gatherTable[i]];
 
-        for (const auto& constant : shaderConsts) {
-          if (constant.uboIdx < constSet.meta.maxConstIndexF)
-            data[constant.uboIdx] = *reinterpret_cast<const Vector4*>(constant.float32);
+        m_constantUploadBytes += size;
+      } else {
+        auto mapPtr = CopySoftwareConstants(constSet.buffer, Src.fConsts, floatDataSize);
+
+        if (constSet.meta.needsConstantCopies) {
+          // Copy shader defined constants over so they can be accessed
+          // with relative addressing.
+          Vector4* data = reinterpret_cast<Vector4*>(mapPtr);
+
+          auto& shaderConsts = GetCommonShader(m_state.vertexShader)->GetConstants();
+
+          for (const auto& constant : shaderConsts) {
+            if (constant.uboIdx < constSet.meta.maxConstIndexF)
+              data[constant.uboIdx] = *reinterpret_cast<const Vector4*>(constant.float32);
+          }
         }
       }
     }
 
     // Max copy source size is 2048 * 16 => always aligned to any plausible value
     // => we won't copy out of bounds
-    if (likely(constSet.meta.maxConstIndexI != 0))
+    if (uploadI)
       CopySoftwareConstants(constSet.swvp.intBuffer, Src.iConsts, intDataSize);
 
-    if (likely(constSet.meta.maxConstIndexB != 0))
+    if (uploadB)
       CopySoftwareConstants(constSet.swvp.boolBuffer, Src.bConsts, boolDataSize);
   }
 
@@ -6143,6 +6352,8 @@ namespace dxvk {
 
     auto mapPtr = dstBuffer.Alloc(size);
     std::memcpy(mapPtr, src, size);
+
+    m_constantUploadBytes += size;
     return mapPtr;
   }
 
@@ -6155,10 +6366,27 @@ namespace dxvk {
     */
     D3D9ConstantSets& constSet = m_consts[ShaderStage];
 
-    if (!constSet.dirty)
+    // Bool constants are passed as spec constants with this layout
+    constSet.dirtyB.clear();
+
+    if (constSet.dirtyF.isEmpty() && constSet.dirtyI.isEmpty())
       return;
 
-    constSet.dirty = false;
+    // Float and int constants share a buffer, so re-upload both if
+    // any register that the current shader reads has changed.
+    bool upload = constSet.dirtyI.overlaps(0u, constSet.meta.maxConstIndexI);
+
+    if (!upload) {
+      upload = constSet.meta.compactConstantsF
+        ? constSet.dirtyF.overlaps(GetCommonShader(Shader)->GetConstantGatherTable())
+        : constSet.dirtyF.overlaps(0u, constSet.meta.maxConstIndexF);
+    }
+
+    constSet.dirtyF.clear();
+    constSet.dirtyI.clear();
+
+    if (!upload)
+      return;
 
     uint32_t floatCount = constSet.maxChangedConstF;
     if (constSet.meta.needsConstantCopies) {
@@ -6170,6 +6398,15 @@ namespace dxvk {
     // If we statically know which is the last float constant accessed by the shader, we don't need to copy the rest.
     floatCount = std::min(constSet.meta.maxConstIndexF, floatCount);
 
+    // If the shader only reads a sparse set of float constants, the compiler
+    // remapped those to consecutive buffer slots and we only copy those.
+    const DxsoConstantGatherTable* gatherTable = nullptr;
+
+    if (constSet.meta.compactConstantsF) {
+      gatherTable = &GetCommonShader(Shader)->GetConstantGatherTable();
+      floatCount = uint32_t(gatherTable->size());
+    }
+
     // There are very few int constants, so we put those into the same buffer at the start.
     // We always allocate memory for all possible int constants to make sure alignment works out.
     const uint32_t intRange = caps::MaxOtherConstants * sizeof(Vector4i);
@@ -6182,11 +6419,17 @@ namespace dxvk {
     void* mapPtr = constSet.buffer.Alloc(bufferSize);
     auto* dst = reinterpret_cast<HardwareLayoutType*>(mapPtr);
 
+    m_constantUploadBytes += bufferSize;
+
     const uint32_t intDataSize = constSet.meta.maxConstIndexI * sizeof(Vector4i);
     if (constSet.meta.maxConstIndexI != 0)
       std::memcpy(dst->iConsts, Src.iConsts, intDataSize);
-    if (constSet.meta.maxConstIndexF != 0)
+    if (gatherTable) {
+      for (size_t i = 0; i < gatherTable->size(); i++)
+        dst->fConsts[i] = Src.fConsts[(*gatherTable)[i]];
+    } else if (constSet.meta.maxConstIndexF != 0) {
       std::memcpy(dst->fConsts, Src.fConsts, floatDataSize);
+    }
 
     if (constSet.meta.needsConstantCopies) {
       // Copy shader defined constants over so they can be accessed
@@ -6203,6 +6446,47 @@ namespace dxvk {
   }
 
 
+  void D3D9DeviceEx::UpdateConstantSetShader(
+          D3D9ConstantSets&           ConstSet,
+    const D3D9CommonShader*           pOldShader,
+    const D3D9CommonShader*           pNewShader) {
+    bool oldCopies = pOldShader && pOldShader->GetMeta().needsConstantCopies;
+    bool newCopies = pNewShader && pNewShader->GetMeta().needsConstantCopies;
+
+    bool oldCompact = pOldShader && pOldShader->GetMeta().compactConstantsF;
+    bool newCompact = pNewShader && pNewShader->GetMeta().compactConstantsF;
+
+    if (!pOldShader) {
+      ConstSet.dirtyF = D3D9ConstantRange::all();
+      ConstSet.dirtyI = D3D9ConstantRange::all();
+      ConstSet.dirtyB = D3D9ConstantRange::all();
+    }
+
+    // Shader-defined constants and compact layouts only ever affect
+    // float constants, but the buffer contents depend on the shader
+    if (oldCopies || newCopies || oldCompact || newCompact)
+      ConstSet.dirtyF = D3D9ConstantRange::all();
+
+    ConstSet.meta = pNewShader ? pNewShader->GetMeta() : DxsoShaderMetaInfo();
+
+    // Registers that the old shader did not read may be stale in the
+    // currently bound buffer, so mark them dirty if the new shader does.
+    if (pNewShader && pOldShader) {
+      const auto& newMeta = pNewShader->GetMeta();
+      const auto& oldMeta = pOldShader->GetMeta();
+
+      if (newMeta.maxConstIndexF > oldMeta.maxConstIndexF)
+        ConstSet.dirtyF.add(oldMeta.maxConstIndexF, newMeta.maxConstIndexF);
+
+      if (newMeta.maxConstIndexI > oldMeta.maxConstIndexI)
+        ConstSet.dirtyI.add(oldMeta.maxConstIndexI, newMeta.maxConstIndexI);
+
+      if (newMeta.maxConstIndexB > oldMeta.maxConstIndexB)
+        ConstSet.dirtyB.add(oldMeta.maxConstIndexB, newMeta.maxConstIndexB);
+    }
+  }
+
+
   template <DxsoProgramType ShaderStage>
   void D3D9DeviceEx::UploadConstants() {
     if constexpr (ShaderStage == DxsoProgramTypes::VertexShader) {
@@ -6387,6 +6671,13 @@ namespace dxvk {
   void D3D9DeviceEx::EndFrame(Rc<DxvkLatencyTracker> LatencyTracker) {
     D3D9DeviceLock lock = LockDevice();
 
+    m_lastFrameConstantUploadBytes.store(
+      std::exchange(m_constantUploadBytes, 0u),
+      std::memory_order_relaxed);
+
+    if (m_d3d9Options.managedTextureUploadBudget)
+      ProcessManagedUploadQueue();
+
     EmitCs<false>([
       cTracker = std::move(LatencyTracker)
     ] (DxvkContext* ctx) {
@@ -6700,6 +6991,68 @@ namespace dxvk {
   }
 
 
+  bool D3D9DeviceEx::StreamManagedTexture(
+          D3D9CommonTexture*  pResource,
+          uint64_t            Budget,
+          uint64_t&           Uploaded) {
+    const D3D9_COMMON_TEXTURE_DESC* desc = pResource->Desc();
+
+    // Upload the smallest mip levels first, so that a large texture
+    // can make progress over multiple frames without having to
+    // allocate staging memory for its entire mip chain at once.
+    for (uint32_t m = desc->MipLevels; m-- > 0u; ) {
+      for (uint32_t a = 0; a < desc->ArraySize; a++) {
+        uint32_t subresource = pResource->CalcSubresource(a, m);
+
+        if (!pResource->NeedsUpload(subresource))
+          continue;
+
+        // Always upload at least one subresource per frame
+        // even if it exceeds the budget on its own
+        uint64_t size = pResource->GetMipSize(subresource);
+
+        if (Uploaded && Uploaded + size > Budget)
+          return false;
+
+        this->FlushImage(pResource, subresource);
+        pResource->SetNeedsUpload(subresource, false);
+
+        Uploaded += size;
+      }
+    }
+
+    pResource->ClearDirtyBoxes();
+    return true;
+  }
+
+
+  void D3D9DeviceEx::ProcessManagedUploadQueue() {
+    const uint64_t budget = m_d3d9Options.managedTextureUploadBudget;
+    uint64_t uploaded = 0u;
+
+    auto iter = m_managedUploadQueue.leastRecentlyUsedIter();
+
+    while (iter != m_managedUploadQueue.leastRecentlyUsedEndIter() && uploaded < budget) {
+      D3D9CommonTexture* texture = *iter;
+
+      // The application is still writing to the texture, it
+      // will get uploaded once it gets unlocked and used.
+      if (unlikely(texture->IsAnySubresourceLocked())) {
+        iter++;
+        continue;
+      }
+
+      if (!StreamManagedTexture(texture, budget, uploaded))
+        break;
+
+      iter = m_managedUploadQueue.remove(iter);
+    }
+
+    m_managedUploadQueueSize.store(m_managedUploadQueue.size(), std::memory_order_relaxed);
+    m_lastFrameManagedUploadBytes.store(uploaded, std::memory_order_relaxed);
+  }
+
+
   void D3D9DeviceEx::UpdateTextureTypeMismatchesForShader(const D3D9CommonShader* shader, uint32_t shaderSamplerMask, uint32_t shaderSamplerOffset) {
     const uint32_t stageCorrectedShaderSamplerMask = shaderSamplerMask << shaderSamplerOffset;
     if (unlikely(shader->GetInfo().majorVersion() < 2 || m_d3d9Options.forceSamplerTypeSpecConstants)) {
@@ -8088,7 +8441,7 @@ namespace dxvk {
     m_state.vsConsts->bConsts[idx] &= ~mask;
     m_state.vsConsts->bConsts[idx] |= bits & mask;
 
-    m_consts[DxsoProgramTypes::VertexShader].dirty = true;
+    m_consts[DxsoProgramTypes::VertexShader].dirtyB.add(idx * 32u, idx * 32u + 32u);
   }
 
 
@@ -8096,12 +8449,12 @@ namespace dxvk {
     m_state.psConsts->bConsts[idx] &= ~mask;
     m_state.psConsts->bConsts[idx] |= bits & mask;
 
-    m_consts[DxsoProgramTypes::PixelShader].dirty = true;
+    m_consts[DxsoProgramTypes::PixelShader].dirtyB.add(idx * 32u, idx * 32u + 32u);
   }
 
 
   HRESULT D3D9DeviceEx::CreateShaderModule(
-        D3D9CommonShader*     pShaderModule,
+        Rc<D3D9ShaderModule>* pShaderModule,
         uint32_t*             pLength,
         VkShaderStageFlagBits ShaderStage,
   const DWORD*                pShaderBytecode,
@@ -8168,17 +8521,13 @@ namespace dxvk {
       constSet.maxChangedConstB = std::max(constSet.maxChangedConstB, StartRegister + Count);
     }
 
-    if constexpr (ConstantType != D3D9ConstantType::Bool) {
-      uint32_t maxCount = ConstantType == D3D9ConstantType::Float
-        ? constSet.meta.maxConstIndexF
-        : constSet.meta.maxConstIndexI;
-
-      constSet.dirty |= StartRegister < maxCount;
-    } else if constexpr (ProgramType == DxsoProgramType::VertexShader) {
-      if (unlikely(CanSWVP())) {
-        constSet.dirty |= StartRegister < constSet.meta.maxConstIndexB;
-      }
-    }
+    // Uploads check the changed registers against the active shader
+    if constexpr (ConstantType == D3D9ConstantType::Float)
+      constSet.dirtyF.add(StartRegister, StartRegister + Count);
+    else if constexpr (ConstantType == D3D9ConstantType::Int)
+      constSet.dirtyI.add(StartRegister, StartRegister + Count);
+    else
+      constSet.dirtyB.add(StartRegister, StartRegister + Count);
 
     UpdateStateConstants<ProgramType, ConstantType, T>(
       &m_state,
@@ -9106,6 +9455,14 @@ namespace dxvk {
 #endif
   }
 
+  void D3D9DeviceEx::RemoveManagedUpload(D3D9CommonTexture* pTexture) {
+    if (!m_d3d9Options.managedTextureUploadBudget || !pTexture->IsManaged())
+      return;
+
+    D3D9DeviceLock lock = LockDevice();
+    m_managedUploadQueue.remove(pTexture);
+  }
+
   void D3D9DeviceEx::UnmapTextures() {
     // Will only be called inside the device lock
 
@@ -23,6 +23,7 @@
 #include "../dxso/dxso_modinfo.h"
 
 #include "d3d9_fixed_function.h"
+#include "d3d9_shader_cache.h"
 #include "d3d9_swvp_emu.h"
 
 #include "d3d9_spec_constants.h"
@@ -47,6 +48,7 @@ namespace dxvk {
   class D3D9CommonTexture;
   class D3D9CommonBuffer;
   class D3D9CommonShader;
+  class D3D9ShaderModule;
   class D3D9ShaderModuleSet;
   class D3D9Initializer;
   class D3D9Query;
@@ -105,6 +107,24 @@ namespace dxvk {
     void*           mapPtr = nullptr;
   };
 
+  /**
+   * \brief Pending batch of UP draws
+   *
+   * Consecutive DrawPrimitiveUP and DrawIndexedPrimitiveUP calls
+   * with the same list topology and stride are merged into one
+   * upload and one draw. Indexed batches use 32-bit indices that
+   * are already rebased to the merged vertex data.
+   */
+  struct D3D9UPBatch {
+    D3DPRIMITIVETYPE      primitiveType = D3DPRIMITIVETYPE(0);
+    uint32_t              stride        = 0u;
+    bool                  indexed       = false;
+    uint32_t              drawCount     = 0u;
+    uint32_t              vertexCount   = 0u;
+    std::vector<uint8_t>  vertexData;
+    std::vector<uint32_t> indexData;
+  };
+
   struct D3D9TextureSlotTracking {
     /* Pixel shaders can access 16 textures/samplers.
      * Then there's 1 dmap texture/sampler.
@@ -982,6 +1002,10 @@ namespace dxvk {
 
     void UploadManagedTextures(uint32_t mask);
 
+    bool StreamManagedTexture(D3D9CommonTexture* pResource, uint64_t Budget, uint64_t& Uploaded);
+
+    void ProcessManagedUploadQueue();
+
     void GenerateTextureMips(uint32_t mask);
 
     void MarkTextureMipsDirty(D3D9CommonTexture* pResource);
@@ -1036,6 +1060,11 @@ namespace dxvk {
     template <DxsoProgramType ShaderStage>
     void UploadConstants();
 
+    void UpdateConstantSetShader(
+            D3D9ConstantSets&           ConstSet,
+      const D3D9CommonShader*           pOldShader,
+      const D3D9CommonShader*           pNewShader);
+
     void UpdateClipPlanes();
 
     /**
@@ -1103,7 +1132,14 @@ namespace dxvk {
     void BindIndices();
 
     D3D9DeviceLock LockDevice() {
-      return m_multithread.AcquireLock();
+      D3D9DeviceLock lock = m_multithread.AcquireLock();
+
+      // Every API call other than a batched UP draw may read or
+      // change state, so submit any pending UP draws first.
+      if (unlikely(m_upBatch.drawCount))
+        FlushUPBatch();
+
+      return lock;
     }
 
     const D3D9Options* GetOptions() const {
@@ -1139,6 +1175,32 @@ namespace dxvk {
             VkImageLayout            OldLayout,
             VkImageLayout            NewLayout);
 
+    D3D9ShaderCache* GetShaderCache() const { return m_shaderCache.ptr(); }
+
+    /**
+     * \brief Queries amount of shader constant data uploaded
+     * \returns Number of bytes uploaded during the last frame
+     */
+    uint64_t GetConstantUploadBytes() const {
+      return m_lastFrameConstantUploadBytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Queries number of queued managed textures
+     * \returns Number of textures waiting to be uploaded
+     */
+    uint32_t GetManagedUploadQueueSize() const {
+      return m_managedUploadQueueSize.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Queries amount of managed texture data uploaded ahead of time
+     * \returns Number of bytes uploaded at the end of the last frame
+     */
+    uint64_t GetManagedUploadBytes() const {
+      return m_lastFrameManagedUploadBytes.load(std::memory_order_relaxed);
+    }
+
     const D3D9ConstantLayout& GetVertexConstantLayout() { return m_consts[DxsoProgramType::VertexShader].layout; }
     const D3D9ConstantLayout& GetPixelConstantLayout()  { return m_consts[DxsoProgramType::PixelShader].layout; }
 
@@ -1171,6 +1233,11 @@ namespace dxvk {
      */
     void RemoveMappedTexture(D3D9CommonTexture* pTexture);
 
+    /**
+     * \brief Removes the texture from the managed texture upload queue
+     */
+    void RemoveManagedUpload(D3D9CommonTexture* pTexture);
+
     /**
      * \brief Returns whether the device is currently recording a StateBlock
      */
@@ -1316,6 +1383,34 @@ namespace dxvk {
      */
     D3D9BufferSlice AllocUPBuffer(VkDeviceSize size);
 
+    /**
+     * \brief Tries to add a UP draw to the pending batch
+     *
+     * Flushes the pending batch if the draw is not compatible
+     * with it, so that the caller can record it normally.
+     * \param [in] PrimitiveType Primitive type
+     * \param [in] PrimitiveCount Primitive count
+     * \param [in] VertexCount Number of vertices to copy
+     * \param [in] pVertexData Vertex data
+     * \param [in] Stride Vertex stride
+     * \param [in] pIndexData Index data, or \c nullptr
+     * \param [in] IndexFormat Index format
+     * \returns \c true if the draw was added to the batch
+     */
+    bool BatchUPDraw(
+            D3DPRIMITIVETYPE          PrimitiveType,
+            UINT                      PrimitiveCount,
+            UINT                      VertexCount,
+      const void*                     pVertexData,
+            UINT                      Stride,
+      const void*                     pIndexData,
+            D3DFORMAT                 IndexFormat);
+
+    /**
+     * \brief Records the merged draw for pending UP draws
+     */
+    void FlushUPBatch();
+
     /**
      * \brief Allocates buffer memory for resource uploads
      */
@@ -1329,7 +1424,7 @@ namespace dxvk {
     DxvkStagingBufferStats GetStagingMemoryStatistics() const;
 
     HRESULT               CreateShaderModule(
-            D3D9CommonShader*     pShaderModule,
+            Rc<D3D9ShaderModule>* pShaderModule,
             uint32_t*             pLength,
             VkShaderStageFlagBits ShaderStage,
       const DWORD*                pShaderBytecode,
@@ -1607,6 +1702,7 @@ namespace dxvk {
     Com<D3D9StateBlock, false>      m_recorder;
 
     Rc<D3D9ShaderModuleSet>         m_shaderModules;
+    Rc<D3D9ShaderCache>             m_shaderCache;
 
     D3D9ConstantBuffer              m_vsClipPlanes;
 
@@ -1620,6 +1716,8 @@ namespace dxvk {
     VkDeviceSize                    m_upBufferOffset  = 0ull;
     void*                           m_upBufferMapPtr  = nullptr;
 
+    D3D9UPBatch                     m_upBatch;
+
     DxvkStagingBuffer               m_stagingBuffer;
     Rc<sync::Fence>                 m_stagingBufferFence;
     VkDeviceSize                    m_stagingMemorySignaled = 0ull;
@@ -1680,6 +1778,8 @@ namespace dxvk {
     uint32_t                        m_robustUBOAlignment      = 1;
 
     D3D9ConstantSets                m_consts[DxsoProgramTypes::Count];
+    uint64_t                        m_constantUploadBytes = 0u;
+    std::atomic<uint64_t>           m_lastFrameConstantUploadBytes = { 0u };
 
     D3D9UserDefinedAnnotation*      m_annotation = nullptr;
 
@@ -1709,6 +1809,10 @@ namespace dxvk {
     lru_list<D3D9CommonTexture*>    m_mappedTextures;
 #endif
 
+    lru_list<D3D9CommonTexture*>    m_managedUploadQueue;
+    std::atomic<uint32_t>           m_managedUploadQueueSize = { 0u };
+    std::atomic<uint64_t>           m_lastFrameManagedUploadBytes = { 0u };
+
     // m_state should be declared last (i.e. freed first), because it
     // references objects that can call back into the device when freed.
     Direct3DState9                  m_state;
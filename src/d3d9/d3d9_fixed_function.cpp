@@ -2,6 +2,7 @@
 
 #include "d3d9_device.h"
 #include "d3d9_util.h"
+#include "d3d9_shader_cache.h"
 #include "d3d9_spec_constants.h"
 
 #include "../dxvk/dxvk_hash.h"
@@ -817,7 +818,7 @@ namespace dxvk {
       const std::string&             Name,
             D3D9FixedFunctionOptions Options);
 
-    Rc<DxvkShader> compile();
+    Rc<DxvkShader> compile(D3D9CachedShader* pCachedShader);
 
     DxsoIsgn isgn() { return m_isgn; }
 
@@ -924,7 +925,7 @@ namespace dxvk {
   , m_options     ( Options ) { }
 
 
-  Rc<DxvkShader> D3D9FFShaderCompiler::compile() {
+  Rc<DxvkShader> D3D9FFShaderCompiler::compile(D3D9CachedShader* pCachedShader) {
     m_floatType  = m_module.defFloatType(32);
     m_uint32Type = m_module.defIntType(32, 0);
     m_vec4Type   = m_module.defVectorType(m_floatType, 4);
@@ -981,7 +982,12 @@ namespace dxvk {
     info.localPushData = m_samplerBlock;
     info.samplerHeap = DxvkShaderBinding(VK_SHADER_STAGE_ALL, GetGlobalSamplerSetIndex(), 0u);
 
-    return new DxvkSpirvShader(info, m_module.compile());
+    SpirvCodeBuffer code = m_module.compile();
+
+    if (pCachedShader)
+      pCachedShader->setBinary(info, code);
+
+    return new DxvkSpirvShader(info, std::move(code));
   }
 
 
@@ -2697,42 +2703,14 @@ namespace dxvk {
   D3D9FFShader::D3D9FFShader(
           D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyVS&    Key) {
-    Sha1Hash hash = Sha1Hash::compute(&Key, sizeof(Key));
-    DxvkShaderKey shaderKey = { VK_SHADER_STAGE_VERTEX_BIT, hash };
-
-    std::string name = str::format("FF_", shaderKey.toString());
-
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
-
-    m_shader = compiler.compile();
-
-    Dump(pDevice, Key, name);
-
-    pDevice->GetDXVKDevice()->registerShader(m_shader);
+    Create(pDevice, Key, VK_SHADER_STAGE_VERTEX_BIT);
   }
 
 
   D3D9FFShader::D3D9FFShader(
           D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyFS&    Key) {
-    Sha1Hash hash = Sha1Hash::compute(&Key, sizeof(Key));
-    DxvkShaderKey shaderKey = { VK_SHADER_STAGE_FRAGMENT_BIT, hash };
-
-    std::string name = str::format("FF_", shaderKey.toString());
-
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
-
-    m_shader = compiler.compile();
-
-    Dump(pDevice, Key, name);
-
-    pDevice->GetDXVKDevice()->registerShader(m_shader);
+    Create(pDevice, Key, VK_SHADER_STAGE_FRAGMENT_BIT);
   }
 
 
@@ -2896,6 +2874,44 @@ namespace dxvk {
   }
 
 
+  template <typename T>
+  void D3D9FFShader::Create(D3D9DeviceEx* pDevice, const T& Key, VkShaderStageFlagBits Stage) {
+    Sha1Hash hash = Sha1Hash::compute(&Key, sizeof(Key));
+    DxvkShaderKey shaderKey = { Stage, hash };
+
+    std::string name = str::format("FF_", shaderKey.toString());
+
+    D3D9FixedFunctionOptions options(pDevice->GetOptions());
+
+    D3D9ShaderCache* shaderCache = pDevice->GetShaderCache();
+
+    D3D9ShaderCacheKey cacheKey;
+    cacheKey.type = D3D9CachedShaderType::FixedFunction;
+    cacheKey.stage = Stage;
+    cacheKey.shaderHash = hash;
+    cacheKey.optionHash = D3D9ShaderCache::hashOptions(options);
+
+    D3D9CachedShader cachedShader;
+
+    if (shaderCache && shaderCache->lookupShader(cacheKey, cachedShader)) {
+      m_shader = cachedShader.createShader();
+    } else {
+      D3D9FFShaderCompiler compiler(
+        pDevice->GetDXVKDevice(),
+        Key, name, options);
+
+      m_shader = compiler.compile(shaderCache ? &cachedShader : nullptr);
+
+      if (shaderCache)
+        shaderCache->addShader(cacheKey, std::move(cachedShader));
+    }
+
+    Dump(pDevice, Key, name);
+
+    pDevice->GetDXVKDevice()->registerShader(m_shader);
+  }
+
+
   D3D9FFShaderModuleSet::D3D9FFShaderModuleSet(D3D9DeviceEx* pDevice)
     : m_vsUbershader(pDevice, DxsoProgramType::VertexShader)
     , m_fsUbershader(pDevice, DxsoProgramType::PixelShader) {}
@@ -147,6 +147,9 @@ namespace dxvk {
     template <typename T>
     void Dump(D3D9DeviceEx* pDevice, const T& Key, const std::string& Name);
 
+    template <typename T>
+    void Create(D3D9DeviceEx* pDevice, const T& Key, VkShaderStageFlagBits Stage);
+
     Rc<DxvkShader> GetShader() const {
       return m_shader;
     }
@@ -1,5 +1,9 @@
 #include "d3d9_format_helpers.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include <d3d9_convert_yuy2_uyvy.h>
 #include <d3d9_convert_l6v5u5.h>
 #include <d3d9_convert_x8l8v8u8.h>
@@ -10,6 +14,221 @@
 
 namespace dxvk {
 
+  /**
+   * \brief Lookup tables for CPU format conversion
+   *
+   * Each entry stores the converted value of a single raw
+   * channel value, computed with the same math as the
+   * conversion compute shaders.
+   */
+  struct D3D9CpuConversionTables {
+    std::array<uint16_t, 4>     unorm2F16  = { };
+    std::array<uint16_t, 32>    snorm5F16  = { };
+    std::array<uint16_t, 64>    unorm6F16  = { };
+    std::array<uint16_t, 256>   snorm8F16  = { };
+    std::array<uint16_t, 256>   unorm8F16  = { };
+    std::array<uint16_t, 1024>  snorm10F16 = { };
+    std::array<int16_t,  1024>  snorm10S16 = { };
+    std::array<int16_t,  2048>  snorm11S16 = { };
+  };
+
+
+  static float UnormalizeChannel(uint32_t value, uint32_t bits) {
+    return float(value) / float((1u << bits) - 1u);
+  }
+
+
+  static float SnormalizeChannel(uint32_t value, uint32_t bits, uint32_t rangeBits) {
+    // Sign-extend the raw value, then normalize it the same way the
+    // shaders do. -2^(n-1) and -2^(n-1)+1 both map to -1.0.
+    int32_t signedValue = int32_t(value << (32u - bits)) >> (32u - bits);
+    float range = float((1u << (rangeBits - 1u)) - 1u);
+    return std::max(float(signedValue) / range, -1.0f);
+  }
+
+
+  static uint16_t ConvertFloatToHalf(float value) {
+    uint32_t bits = bit::cast<uint32_t>(value);
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t  exp  = int32_t((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mant = bits & 0x7fffffu;
+
+    // Converted values are normalized, so infinity, NaN
+    // and overflow cannot occur and need no handling.
+    if (exp <= 0) {
+      if (exp < -10)
+        return sign;
+
+      mant |= 0x800000u;
+
+      uint32_t shift = uint32_t(14 - exp);
+      uint32_t result = mant >> shift;
+      uint32_t rem = mant & ((1u << shift) - 1u);
+      uint32_t mid = 1u << (shift - 1u);
+
+      if (rem > mid || (rem == mid && (result & 1u)))
+        result += 1u;
+
+      return sign | result;
+    }
+
+    uint32_t result = (uint32_t(exp) << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1fffu;
+
+    if (rem > 0x1000u || (rem == 0x1000u && (result & 1u)))
+      result += 1u;
+
+    return sign | result;
+  }
+
+
+  static int16_t ConvertFloatToSnorm16(float value) {
+    return int16_t(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+  }
+
+
+  static const D3D9CpuConversionTables& GetCpuConversionTables() {
+    static const D3D9CpuConversionTables s_tables = [] {
+      D3D9CpuConversionTables tables;
+
+      for (uint32_t i = 0; i < tables.unorm2F16.size(); i++)
+        tables.unorm2F16[i] = ConvertFloatToHalf(UnormalizeChannel(i, 2u));
+
+      for (uint32_t i = 0; i < tables.snorm5F16.size(); i++)
+        tables.snorm5F16[i] = ConvertFloatToHalf(SnormalizeChannel(i, 5u, 5u));
+
+      for (uint32_t i = 0; i < tables.unorm6F16.size(); i++)
+        tables.unorm6F16[i] = ConvertFloatToHalf(UnormalizeChannel(i, 6u));
+
+      for (uint32_t i = 0; i < tables.snorm8F16.size(); i++) {
+        tables.snorm8F16[i] = ConvertFloatToHalf(SnormalizeChannel(i, 8u, 8u));
+        tables.unorm8F16[i] = ConvertFloatToHalf(UnormalizeChannel(i, 8u));
+      }
+
+      for (uint32_t i = 0; i < tables.snorm10F16.size(); i++) {
+        tables.snorm10F16[i] = ConvertFloatToHalf(SnormalizeChannel(i, 10u, 10u));
+        tables.snorm10S16[i] = ConvertFloatToSnorm16(SnormalizeChannel(i, 10u, 10u));
+      }
+
+      // The shader normalizes the 11-bit channels
+      // with the range of a 10-bit value
+      for (uint32_t i = 0; i < tables.snorm11S16.size(); i++)
+        tables.snorm11S16[i] = ConvertFloatToSnorm16(SnormalizeChannel(i, 11u, 10u));
+
+      return tables;
+    } ();
+
+    return s_tables;
+  }
+
+
+  template<bool IsUYVY>
+  static void ConvertYuy2Row(
+          uint8_t*                      pDst,
+    const uint8_t*                      pSrc,
+          uint32_t                      macroPixelCount) {
+    // Mirrors convertYUV in the shader, including the fact that
+    // the matrix coefficients there are integer divisions and
+    // thus evaluate to 1, 0 and 2 respectively.
+    constexpr float Bias = 0.5f / 255.0f;
+
+#ifdef DXVK_ARCH_X86
+    const __m128 scale  = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 offset = _mm_setr_ps(16.0f / 255.0f, 128.0f / 255.0f, 16.0f / 255.0f, 128.0f / 255.0f);
+    const __m128 bias   = _mm_setr_ps(Bias, Bias, Bias, 0.0f);
+    const __m128 chromaScale = _mm_setr_ps(2.0f, 0.0f, 1.0f, 0.0f);
+    const __m128 zero   = _mm_setzero_ps();
+    const __m128 one    = _mm_set1_ps(1.0f);
+    const __m128 unorm  = _mm_set1_ps(255.0f);
+    const __m128i alpha = _mm_set1_epi32(int32_t(0xff000000u));
+
+    for (uint32_t i = 0; i < macroPixelCount; i++) {
+      uint32_t packed;
+      std::memcpy(&packed, pSrc + 4u * i, sizeof(packed));
+
+      __m128i raw = _mm_cvtsi32_si128(int32_t(packed));
+      raw = _mm_unpacklo_epi8(raw, _mm_setzero_si128());
+      raw = _mm_unpacklo_epi16(raw, _mm_setzero_si128());
+
+      if constexpr (IsUYVY)
+        raw = _mm_shuffle_epi32(raw, _MM_SHUFFLE(2, 3, 0, 1));
+
+      // (y0, u, y1, v), with offsets applied
+      __m128 yuv = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(raw), scale), offset);
+
+      // (2u, 0, v, 0) in BGRA order, shared by both pixels
+      __m128 chroma = _mm_mul_ps(_mm_shuffle_ps(yuv, yuv, _MM_SHUFFLE(3, 3, 3, 1)), chromaScale);
+      chroma = _mm_add_ps(chroma, bias);
+
+      __m128 c0 = _mm_add_ps(_mm_shuffle_ps(yuv, yuv, _MM_SHUFFLE(0, 0, 0, 0)), chroma);
+      __m128 c1 = _mm_add_ps(_mm_shuffle_ps(yuv, yuv, _MM_SHUFFLE(2, 2, 2, 2)), chroma);
+
+      c0 = _mm_mul_ps(_mm_min_ps(_mm_max_ps(c0, zero), one), unorm);
+      c1 = _mm_mul_ps(_mm_min_ps(_mm_max_ps(c1, zero), one), unorm);
+
+      __m128i packedColor = _mm_packs_epi32(_mm_cvtps_epi32(c0), _mm_cvtps_epi32(c1));
+      packedColor = _mm_or_si128(_mm_packus_epi16(packedColor, packedColor), alpha);
+
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + 8u * i), packedColor);
+    }
+#else
+    for (uint32_t i = 0; i < macroPixelCount; i++) {
+      const uint8_t* src = pSrc + 4u * i;
+
+      float y0 = float(src[IsUYVY ? 1u : 0u]) * (1.0f / 255.0f) - 16.0f  / 255.0f;
+      float u  = float(src[IsUYVY ? 0u : 1u]) * (1.0f / 255.0f) - 128.0f / 255.0f;
+      float y1 = float(src[IsUYVY ? 3u : 2u]) * (1.0f / 255.0f) - 16.0f  / 255.0f;
+      float v  = float(src[IsUYVY ? 2u : 3u]) * (1.0f / 255.0f) - 128.0f / 255.0f;
+
+      // Same order of operations as the vectorized path
+      std::array<float, 2> y = { y0, y1 };
+      std::array<float, 3> chroma = { 2.0f * u + Bias, Bias, v + Bias };
+
+      for (uint32_t j = 0; j < 2u; j++) {
+        uint8_t* dst = pDst + 8u * i + 4u * j;
+
+        for (uint32_t k = 0; k < 3u; k++)
+          dst[k] = uint8_t(std::lrint(std::clamp(y[j] + chroma[k], 0.0f, 1.0f) * 255.0f));
+
+        dst[3] = 0xffu;
+      }
+    }
+#endif
+  }
+
+
+  template<typename SrcType, typename DstType, typename Fn>
+  static void ConvertPackedImage(
+          void*                         pDstData,
+    const void*                         pSrcData,
+          VkDeviceSize                  srcPitch,
+          VkExtent2D                    extent,
+    const Fn&                           fn) {
+    auto dst = reinterpret_cast<DstType*>(pDstData);
+
+    for (uint32_t y = 0; y < extent.height; y++) {
+      auto src = reinterpret_cast<const uint8_t*>(pSrcData) + y * srcPitch;
+
+      for (uint32_t x = 0; x < extent.width; x++) {
+        SrcType value;
+        std::memcpy(&value, src + x * sizeof(value), sizeof(value));
+        *(dst++) = fn(value);
+      }
+    }
+  }
+
+
+  struct D3D9PackedHalf4 {
+    uint16_t r, g, b, a;
+  };
+
+
+  struct D3D9PackedSnorm4 {
+    int16_t r, g, b, a;
+  };
+
+
   D3D9FormatHelper::D3D9FormatHelper(const Rc<DxvkDevice>& device)
   : m_device          (device)
   , m_layout          (CreatePipelineLayout()) {
@@ -68,6 +287,101 @@ namespace dxvk {
   }
 
 
+  bool D3D9FormatHelper::SupportsCpuConversion(
+          D3D9_CONVERSION_FORMAT_INFO   conversionFormat) {
+    switch (conversionFormat.FormatType) {
+      case D3D9ConversionFormat_YUY2:
+      case D3D9ConversionFormat_UYVY:
+      case D3D9ConversionFormat_L6V5U5:
+      case D3D9ConversionFormat_X8L8V8U8:
+      case D3D9ConversionFormat_A2W10V10U10:
+      case D3D9ConversionFormat_W11V11U10:
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+
+  VkDeviceSize D3D9FormatHelper::GetCpuConversionSize(
+          D3D9_CONVERSION_FORMAT_INFO   conversionFormat,
+          VkExtent2D                    extent) {
+    const DxvkFormatInfo* formatInfo = lookupFormatInfo(conversionFormat.FormatColor);
+    return VkDeviceSize(extent.width) * VkDeviceSize(extent.height) * formatInfo->elementSize;
+  }
+
+
+  void D3D9FormatHelper::ConvertFormatCpu(
+          D3D9_CONVERSION_FORMAT_INFO   conversionFormat,
+          void*                         pDstData,
+    const void*                         pSrcData,
+          VkDeviceSize                  srcPitch,
+          VkExtent2D                    extent) {
+    const auto& tables = GetCpuConversionTables();
+
+    switch (conversionFormat.FormatType) {
+      case D3D9ConversionFormat_YUY2:
+      case D3D9ConversionFormat_UYVY: {
+        bool isUYVY = conversionFormat.FormatType == D3D9ConversionFormat_UYVY;
+
+        for (uint32_t y = 0; y < extent.height; y++) {
+          auto dst = reinterpret_cast<uint8_t*>(pDstData) + y * extent.width * 4u;
+          auto src = reinterpret_cast<const uint8_t*>(pSrcData) + y * srcPitch;
+
+          if (isUYVY)
+            ConvertYuy2Row<true>(dst, src, extent.width / 2u);
+          else
+            ConvertYuy2Row<false>(dst, src, extent.width / 2u);
+        }
+      } break;
+
+      case D3D9ConversionFormat_L6V5U5: {
+        ConvertPackedImage<uint16_t, D3D9PackedHalf4>(pDstData, pSrcData, srcPitch, extent, [&tables] (uint16_t value) {
+          return D3D9PackedHalf4 {
+            tables.snorm5F16[(value >>  0) & 0x1fu],
+            tables.snorm5F16[(value >>  5) & 0x1fu],
+            tables.unorm6F16[(value >> 10) & 0x3fu],
+            0x3c00u };
+        });
+      } break;
+
+      case D3D9ConversionFormat_X8L8V8U8: {
+        ConvertPackedImage<uint32_t, D3D9PackedHalf4>(pDstData, pSrcData, srcPitch, extent, [&tables] (uint32_t value) {
+          return D3D9PackedHalf4 {
+            tables.snorm8F16[(value >>  0) & 0xffu],
+            tables.snorm8F16[(value >>  8) & 0xffu],
+            tables.unorm8F16[(value >> 16) & 0xffu],
+            0x3c00u };
+        });
+      } break;
+
+      case D3D9ConversionFormat_A2W10V10U10: {
+        ConvertPackedImage<uint32_t, D3D9PackedHalf4>(pDstData, pSrcData, srcPitch, extent, [&tables] (uint32_t value) {
+          return D3D9PackedHalf4 {
+            tables.snorm10F16[(value >>  0) & 0x3ffu],
+            tables.snorm10F16[(value >> 10) & 0x3ffu],
+            tables.snorm10F16[(value >> 20) & 0x3ffu],
+            tables.unorm2F16 [(value >> 30) & 0x3u] };
+        });
+      } break;
+
+      case D3D9ConversionFormat_W11V11U10: {
+        ConvertPackedImage<uint32_t, D3D9PackedSnorm4>(pDstData, pSrcData, srcPitch, extent, [&tables] (uint32_t value) {
+          return D3D9PackedSnorm4 {
+            tables.snorm10S16[(value >>  0) & 0x3ffu],
+            tables.snorm11S16[(value >> 10) & 0x7ffu],
+            tables.snorm11S16[(value >> 21) & 0x7ffu],
+            int16_t(0x7fff) };
+        });
+      } break;
+
+      default:
+        Logger::warn("Unimplemented CPU format conversion");
+    }
+  }
+
+
   void D3D9FormatHelper::ConvertGenericFormat(
     const Rc<DxvkCommandList>&          ctx,
           D3D9_CONVERSION_FORMAT_INFO   videoFormat,
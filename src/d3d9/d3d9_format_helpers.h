@@ -11,6 +11,11 @@ namespace dxvk {
 
   public:
 
+    /// Maximum size of converted data, in bytes, for which
+    /// the CPU conversion path is used. Larger uploads are
+    /// converted on the GPU.
+    constexpr static VkDeviceSize MaxCpuConversionSize = 1u << 20;
+
     D3D9FormatHelper(const Rc<DxvkDevice>& device);
 
     ~D3D9FormatHelper();
@@ -24,6 +29,47 @@ namespace dxvk {
             VkImageSubresourceLayers      dstSubresource,
       const DxvkBufferSlice&              srcSlice);
 
+    /**
+     * \brief Checks whether a format can be converted on the CPU
+     *
+     * Only packed formats are supported, planar
+     * video formats always use the GPU path.
+     * \param [in] conversionFormat Conversion format
+     * \returns \c true if \ref ConvertFormatCpu supports the format
+     */
+    static bool SupportsCpuConversion(
+            D3D9_CONVERSION_FORMAT_INFO   conversionFormat);
+
+    /**
+     * \brief Computes size of CPU-converted data
+     *
+     * \param [in] conversionFormat Conversion format
+     * \param [in] extent Image extent, in pixels
+     * \returns Size of the tightly packed converted data
+     */
+    static VkDeviceSize GetCpuConversionSize(
+            D3D9_CONVERSION_FORMAT_INFO   conversionFormat,
+            VkExtent2D                    extent);
+
+    /**
+     * \brief Converts image data on the CPU
+     *
+     * Writes tightly packed data in the converted format, which can
+     * be copied to the image directly, and produces the same results
+     * as the compute shaders used by \ref ConvertFormat.
+     * \param [in] conversionFormat Conversion format
+     * \param [out] pDstData Destination data
+     * \param [in] pSrcData Source data in the D3D9 format
+     * \param [in] srcPitch Source row pitch, in bytes
+     * \param [in] extent Image extent, in pixels
+     */
+    static void ConvertFormatCpu(
+            D3D9_CONVERSION_FORMAT_INFO   conversionFormat,
+            void*                         pDstData,
+      const void*                         pSrcData,
+            VkDeviceSize                  srcPitch,
+            VkExtent2D                    extent);
+
   private:
 
     void ConvertGenericFormat(
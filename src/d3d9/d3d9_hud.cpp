@@ -113,4 +113,80 @@ namespace dxvk::hud {
     return position;
   }
 
+
+  HudConstantUploads::HudConstantUploads(D3D9DeviceEx* device)
+  : m_device        (device)
+  , m_uploadString  ("") { }
+
+
+  void HudConstantUploads::update(dxvk::high_resolution_clock::time_point time) {
+    m_maxBytes = std::max(m_maxBytes, m_device->GetConstantUploadBytes());
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() < UpdateInterval)
+      return;
+
+    m_uploadString = str::format(m_maxBytes >> 10, " kB / frame");
+    m_maxBytes = 0;
+    m_lastUpdate = time;
+  }
+
+
+  HudPos HudConstantUploads::render(
+    const Rc<DxvkCommandList>&ctx,
+    const HudPipelineKey&     key,
+    const HudOptions&         options,
+          HudRenderer&        renderer,
+          HudPos              position) {
+    position.y += 16;
+    renderer.drawText(16, position, 0xffc0ff00u, "Constants:");
+    renderer.drawText(16, { position.x + 155, position.y }, 0xffffffffu, m_uploadString);
+
+    position.y += 8;
+    return position;
+  }
+
+
+  HudManagedUploads::HudManagedUploads(D3D9DeviceEx* device)
+  : m_device        (device)
+  , m_queueString   ("")
+  , m_uploadString  ("") { }
+
+
+  void HudManagedUploads::update(dxvk::high_resolution_clock::time_point time) {
+    m_maxQueued = std::max(m_maxQueued, m_device->GetManagedUploadQueueSize());
+    m_maxBytes = std::max(m_maxBytes, m_device->GetManagedUploadBytes());
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() < UpdateInterval)
+      return;
+
+    m_queueString = str::format(m_maxQueued, " textures");
+    m_uploadString = str::format(m_maxBytes >> 10, " kB / frame");
+    m_maxQueued = 0;
+    m_maxBytes = 0;
+    m_lastUpdate = time;
+  }
+
+
+  HudPos HudManagedUploads::render(
+    const Rc<DxvkCommandList>&ctx,
+    const HudPipelineKey&     key,
+    const HudOptions&         options,
+          HudRenderer&        renderer,
+          HudPos              position) {
+    position.y += 16;
+    renderer.drawText(16, position, 0xffc0ff00u, "Upload queue:");
+    renderer.drawText(16, { position.x + 155, position.y }, 0xffffffffu, m_queueString);
+
+    position.y += 20;
+    renderer.drawText(16, position, 0xffc0ff00u, "Uploaded:");
+    renderer.drawText(16, { position.x + 155, position.y }, 0xffffffffu, m_uploadString);
+
+    position.y += 8;
+    return position;
+  }
+
 }
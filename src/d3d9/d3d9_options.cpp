@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "../util/util_math.h"
 
 #include "d3d9_options.h"
@@ -78,6 +80,9 @@ namespace dxvk {
     this->extraFrontbuffer              = config.getOption<bool>        ("d3d9.extraFrontbuffer",              false);
     this->ffUbershaderVS                = config.getOption<bool>        ("d3d9.ffUbershaderVS",                true);
     this->ffUbershaderFS                = config.getOption<bool>        ("d3d9.ffUbershaderFS",                true);
+    this->batchUPDraws                  = config.getOption<bool>        ("d3d9.batchUPDraws",                  false);
+    this->asyncShaderTranslation        = config.getOption<bool>        ("d3d9.asyncShaderTranslation",        false);
+    this->managedTextureUploadBudget    = uint64_t(std::max(config.getOption<int32_t>("d3d9.managedTextureUploadBudget", 0), 0)) << 20;
 
     // D3D8 options
     this->drefScaling                   = config.getOption<int32_t>     ("d3d8.scaleDref",                     0);
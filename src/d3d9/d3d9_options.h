@@ -173,6 +173,15 @@ namespace dxvk {
 
     /// Use the uber shader for fixed function fragment shaders.
     bool ffUbershaderFS;
+
+    /// Merge consecutive UP draws with identical state
+    bool batchUPDraws;
+
+    /// Translate DXSO shaders on worker threads
+    bool asyncShaderTranslation;
+
+    /// Amount of managed texture data to upload ahead of time per frame, in bytes
+    uint64_t managedTextureUploadBudget;
   };
 
 }
@@ -4,6 +4,8 @@
 #include "d3d9_device.h"
 #include "d3d9_util.h"
 
+#include <algorithm>
+
 namespace dxvk {
 
   D3D9CommonShader::D3D9CommonShader() {}
@@ -15,7 +17,8 @@ namespace dxvk {
       const DxsoModuleInfo*       pDxsoModuleInfo,
       const void*                 pShaderBytecode,
       const DxsoAnalysisInfo&     AnalysisInfo,
-            DxsoModule*           pModule) {
+            DxsoModule*           pModule,
+            D3D9CachedShader*     pCachedShader) {
     const uint32_t bytecodeLength = AnalysisInfo.bytecodeByteLength;
 
     const std::string name = Key.toString();
@@ -54,7 +57,7 @@ namespace dxvk {
     const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
       ? pDevice->GetVertexConstantLayout()
       : pDevice->GetPixelConstantLayout();
-    m_shader       = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
+    m_shader       = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout, pCachedShader);
     m_isgn         = pModule->isgn();
     m_usedSamplers = pModule->usedSamplers();
     m_textureTypes = pModule->textureTypes();
@@ -70,6 +73,7 @@ namespace dxvk {
     m_info                 = pModule->info();
     m_meta                 = pModule->meta();
     m_constants            = pModule->constants();
+    m_constantGatherTable  = pModule->constantGatherTable();
     m_maxDefinedFloatConst = pModule->maxDefinedFloatConstant();
     m_maxDefinedIntConst   = pModule->maxDefinedIntConstant();
     m_maxDefinedBoolConst  = pModule->maxDefinedBoolConstant();
@@ -82,13 +86,170 @@ namespace dxvk {
       m_shader->dump(dumpStream);
     }
 
+    if (pCachedShader) {
+      pCachedShader->isgn                 = m_isgn;
+      pCachedShader->usedSamplers         = m_usedSamplers;
+      pCachedShader->usedRTs              = m_usedRTs;
+      pCachedShader->textureTypes         = m_textureTypes;
+      pCachedShader->info                 = m_info;
+      pCachedShader->meta                 = m_meta;
+      pCachedShader->constants            = m_constants;
+      pCachedShader->constantGatherTable  = m_constantGatherTable;
+      pCachedShader->maxDefinedFloatConst = m_maxDefinedFloatConst;
+      pCachedShader->maxDefinedIntConst   = m_maxDefinedIntConst;
+      pCachedShader->maxDefinedBoolConst  = m_maxDefinedBoolConst;
+    }
+
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
 
 
+  D3D9CommonShader::D3D9CommonShader(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const D3D9CachedShader&     CachedShader)
+  : m_isgn                  ( CachedShader.isgn ),
+    m_usedSamplers          ( CachedShader.usedSamplers ),
+    m_usedRTs               ( CachedShader.usedRTs ),
+    m_textureTypes          ( CachedShader.textureTypes ),
+    m_info                  ( CachedShader.info ),
+    m_meta                  ( CachedShader.meta ),
+    m_constants             ( CachedShader.constants ),
+    m_constantGatherTable   ( CachedShader.constantGatherTable ),
+    m_maxDefinedFloatConst  ( CachedShader.maxDefinedFloatConst ),
+    m_maxDefinedIntConst    ( CachedShader.maxDefinedIntConst ),
+    m_maxDefinedBoolConst   ( CachedShader.maxDefinedBoolConst ),
+    m_shader                ( CachedShader.createShader() ) {
+    pDevice->GetDXVKDevice()->registerShader(m_shader);
+  }
+
+
+  D3D9ShaderModule::D3D9ShaderModule(
+      const D3D9CommonShader&     Shader)
+  : m_status  ( D3D9ShaderModuleStatus::Ready ),
+    m_shader  ( Shader ) {
+
+  }
+
+
+  D3D9ShaderModule::D3D9ShaderModule(
+          D3D9DeviceEx*         pDevice,
+          VkShaderStageFlagBits ShaderStage,
+    const DxvkShaderKey&        Key,
+    const D3D9ShaderCacheKey&   CacheKey,
+    const DxsoModuleInfo&       ModuleInfo,
+    const void*                 pShaderBytecode,
+          DxsoAnalysisInfo&&    AnalysisInfo)
+  : m_status      ( D3D9ShaderModuleStatus::Pending ),
+    m_device      ( pDevice ),
+    m_stage       ( ShaderStage ),
+    m_key         ( Key ),
+    m_cacheKey    ( CacheKey ),
+    m_moduleInfo  ( ModuleInfo ),
+    m_analysis    ( std::move(AnalysisInfo) ) {
+    // The application may free its copy of the
+    // bytecode before the shader gets translated
+    m_bytecode.resize(m_analysis.bytecodeByteLength / sizeof(uint32_t));
+    std::memcpy(m_bytecode.data(), pShaderBytecode, m_analysis.bytecodeByteLength);
+  }
+
+
+  bool D3D9ShaderModule::TryCompile() {
+    D3D9ShaderModuleStatus expected = D3D9ShaderModuleStatus::Pending;
+
+    if (!m_status.compare_exchange_strong(expected,
+        D3D9ShaderModuleStatus::Compiling, std::memory_order_acquire))
+      return false;
+
+    Compile();
+    return true;
+  }
+
+
+  void D3D9ShaderModule::Compile() {
+    DxsoReader reader(
+      reinterpret_cast<const char*>(m_bytecode.data()));
+
+    DxsoModule module(reader);
+
+    D3D9ShaderCache* shaderCache = m_device->GetShaderCache();
+    D3D9CachedShader cachedShader;
+
+    try {
+      m_shader = D3D9CommonShader(
+        m_device, m_stage, m_key,
+        &m_moduleInfo, m_bytecode.data(),
+        m_analysis, &module, shaderCache ? &cachedShader : nullptr);
+
+      if (shaderCache)
+        shaderCache->addShader(m_cacheKey, std::move(cachedShader));
+    } catch (const DxvkError& e) {
+      // Invalid bytecode is already rejected by the analyzer when
+      // the shader is created, so this indicates a compiler bug.
+      Logger::err(str::format("Failed to translate shader ", m_key.toString(), ": ", e.message()));
+    }
+
+    // Inputs are no longer needed at this point
+    m_bytecode = std::vector<uint32_t>();
+    m_analysis = DxsoAnalysisInfo();
+
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_status.store(D3D9ShaderModuleStatus::Ready, std::memory_order_release);
+    }
+
+    m_cond.notify_all();
+  }
+
+
+  void D3D9ShaderModule::WaitForShader() {
+    // Translate the shader on the calling thread if no
+    // worker has started working on it yet, since that
+    // is faster than waiting for the queue to drain.
+    if (TryCompile())
+      return;
+
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this] {
+      return m_status.load(std::memory_order_acquire) == D3D9ShaderModuleStatus::Ready;
+    });
+  }
+
+
+  D3D9ShaderModuleSet::~D3D9ShaderModuleSet() {
+    StopWorkers();
+  }
+
+
+  void D3D9ShaderModuleSet::StopWorkers() {
+    std::vector<dxvk::thread> workers;
+
+    { std::unique_lock<dxvk::mutex> lock(m_workerMutex);
+      m_stopWorkers = true;
+
+      workers = std::move(m_workers);
+      m_workers.clear();
+    }
+
+    m_workerCond.notify_all();
+
+    // Worker threads are already gone if the process is being
+    // terminated, and trying to join them may hang. Shaders that
+    // have not been translated yet will be translated on bind.
+    bool detach = this_thread::isInModuleDetachment();
+
+    for (auto& worker : workers) {
+      if (detach)
+        worker.detach();
+      else
+        worker.join();
+    }
+  }
+
+
   void D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
-            D3D9CommonShader*     pShaderModule,
+            Rc<D3D9ShaderModule>* pShaderModule,
             uint32_t*             pLength,
             VkShaderStageFlagBits ShaderStage,
       const DxsoModuleInfo*       pDxbcModuleInfo,
@@ -134,30 +295,27 @@ namespace dxvk {
     DxsoAnalysisInfo info = module.analyze();
     *pLength = info.bytecodeByteLength;
 
-    DxvkShaderKey lookupKey = DxvkShaderKey(
-      ShaderStage,
-      Sha1Hash::compute(pShaderBytecode, info.bytecodeByteLength));
+    Sha1Hash bytecodeHash = Sha1Hash::compute(pShaderBytecode, info.bytecodeByteLength);
+    DxvkShaderKey lookupKey = DxvkShaderKey(ShaderStage, bytecodeHash);
+
+    Shard& shard = GetShard(lookupKey);
 
     // Use the shader's unique key for the lookup
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+    { std::unique_lock<dxvk::mutex> lock(shard.mutex);
       
-      auto entry = m_modules.find(lookupKey);
-      if (entry != m_modules.end()) {
+      auto entry = shard.modules.find(lookupKey);
+      if (entry != shard.modules.end()) {
         *pShaderModule = entry->second;
         return;
       }
     }
-    
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    *pShaderModule = D3D9CommonShader(
-      pDevice, ShaderStage, lookupKey,
-      pDxbcModuleInfo, pShaderBytecode,
-      info, &module);
 
-    const int32_t maxFloatConstantIndex = pShaderModule->GetMaxDefinedFloatConstant();
-    const int32_t maxIntConstantIndex = pShaderModule->GetMaxDefinedIntConstant();
-    const int32_t maxBoolConstantIndex = pShaderModule->GetMaxDefinedBoolConstant();
+    // Validate defined constants up front using the analysis
+    // results, so that errors can be reported to the app even
+    // if the shader itself gets translated asynchronously.
+    const int32_t maxFloatConstantIndex = info.maxDefinedFloatConst;
+    const int32_t maxIntConstantIndex = info.maxDefinedIntConst;
+    const int32_t maxBoolConstantIndex = info.maxDefinedBoolConst;
 
     // Vertex shader specific validations. These validations are not
     // performed on SWVP devices or on MIXED devices, even if
@@ -197,18 +355,106 @@ namespace dxvk {
                         maxBoolConstantIndex > static_cast<int32_t>(caps::MaxOtherConstants - 1)))
         throw DxvkError(str::format("GetShaderModule: Invalid PS bool constant index ", maxBoolConstantIndex));
     }
+
+    // Check the on-disk cache before translating the shader. The
+    // cache key needs to cover all options that affect compilation.
+    D3D9ShaderCache* shaderCache = pDevice->GetShaderCache();
+
+    D3D9ShaderCacheKey cacheKey;
+    cacheKey.type = D3D9CachedShaderType::Dxso;
+    cacheKey.stage = ShaderStage;
+    cacheKey.shaderHash = bytecodeHash;
+    cacheKey.optionHash = D3D9ShaderCache::hashOptions(*pDxbcModuleInfo,
+      ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
+        ? pDevice->GetVertexConstantLayout()
+        : pDevice->GetPixelConstantLayout());
+
+    D3D9CachedShader cachedShader;
+
+    bool isAsync = false;
+
+    if (shaderCache && shaderCache->lookupShader(cacheKey, cachedShader)) {
+      *pShaderModule = new D3D9ShaderModule(
+        D3D9CommonShader(pDevice, ShaderStage, cachedShader));
+    } else if (options->asyncShaderTranslation) {
+      // Defer translation to the worker threads. The module
+      // keeps its own copy of the bytecode and analysis data.
+      *pShaderModule = new D3D9ShaderModule(
+        pDevice, ShaderStage, lookupKey, cacheKey,
+        *pDxbcModuleInfo, pShaderBytecode, std::move(info));
+      isAsync = true;
+    } else {
+      // This shader has not been compiled yet, so we have to create a
+      // new module. This takes a while, so we won't lock the structure.
+      *pShaderModule = new D3D9ShaderModule(D3D9CommonShader(
+        pDevice, ShaderStage, lookupKey,
+        pDxbcModuleInfo, pShaderBytecode,
+        info, &module, shaderCache ? &cachedShader : nullptr));
+
+      if (shaderCache)
+        shaderCache->addShader(cacheKey, std::move(cachedShader));
+    }
     
     // Insert the new module into the lookup table. If another thread
     // has compiled the same shader in the meantime, we should return
     // that object instead and discard the newly created module.
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+    { std::unique_lock<dxvk::mutex> lock(shard.mutex);
       
-      auto status = m_modules.insert({ lookupKey, *pShaderModule });
+      auto status = shard.modules.insert({ lookupKey, *pShaderModule });
       if (!status.second) {
         *pShaderModule = status.first->second;
         return;
       }
     }
+
+    if (isAsync)
+      EnqueueShader(*pShaderModule);
+  }
+
+
+  void D3D9ShaderModuleSet::EnqueueShader(
+    const Rc<D3D9ShaderModule>& ShaderModule) {
+    std::unique_lock<dxvk::mutex> lock(m_workerMutex);
+
+    // The shader will be translated on bind instead
+    if (unlikely(m_stopWorkers))
+      return;
+
+    if (unlikely(m_workers.empty())) {
+      uint32_t workerCount = std::clamp(dxvk::thread::hardware_concurrency() / 2u, 1u, 4u);
+
+      for (uint32_t i = 0; i < workerCount; i++)
+        m_workers.emplace_back([this] { RunWorker(); });
+    }
+
+    m_workerQueue.push(ShaderModule);
+    m_workerCond.notify_one();
+  }
+
+
+  void D3D9ShaderModuleSet::RunWorker() {
+    env::setThreadName("dxvk-dxso");
+
+    while (true) {
+      Rc<D3D9ShaderModule> shaderModule;
+
+      { std::unique_lock<dxvk::mutex> lock(m_workerMutex);
+
+        m_workerCond.wait(lock, [this] {
+          return m_stopWorkers || !m_workerQueue.empty();
+        });
+
+        if (m_stopWorkers)
+          return;
+
+        shaderModule = std::move(m_workerQueue.front());
+        m_workerQueue.pop();
+      }
+
+      // The shader may have already been translated
+      // by a thread that tried to bind it
+      shaderModule->TryCompile();
+    }
   }
 
 }
@@ -8,8 +8,11 @@
 #include "d3d9_resource.h"
 #include "d3d9_util.h"
 #include "d3d9_mem.h"
+#include "d3d9_shader_cache.h"
 
 #include <array>
+#include <atomic>
+#include <queue>
 
 namespace dxvk {
 
@@ -34,7 +37,13 @@ namespace dxvk {
       const DxsoModuleInfo*       pDxbcModuleInfo,
       const void*                 pShaderBytecode,
       const DxsoAnalysisInfo&     AnalysisInfo,
-            DxsoModule*           pModule);
+            DxsoModule*           pModule,
+            D3D9CachedShader*     pCachedShader);
+
+    D3D9CommonShader(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const D3D9CachedShader&     CachedShader);
 
 
     Rc<DxvkShader> GetShader() const {
@@ -51,6 +60,7 @@ namespace dxvk {
 
     const DxsoShaderMetaInfo& GetMeta() const { return m_meta; }
     const DxsoDefinedConstants& GetConstants() const { return m_constants; }
+    const DxsoConstantGatherTable& GetConstantGatherTable() const { return m_constantGatherTable; }
 
     D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ m_usedSamplers, m_usedRTs }; }
 
@@ -78,6 +88,7 @@ namespace dxvk {
     DxsoProgramInfo       m_info;
     DxsoShaderMetaInfo    m_meta;
     DxsoDefinedConstants  m_constants;
+    DxsoConstantGatherTable m_constantGatherTable;
     int32_t               m_maxDefinedFloatConst = -1;
     int32_t               m_maxDefinedIntConst = -1;
     int32_t               m_maxDefinedBoolConst = -1;
@@ -86,6 +97,86 @@ namespace dxvk {
 
   };
 
+  /**
+   * \brief Shader module status
+   */
+  enum class D3D9ShaderModuleStatus : uint32_t {
+    Pending   = 0u,
+    Compiling = 1u,
+    Ready     = 2u,
+  };
+
+
+  /**
+   * \brief Shader module
+   *
+   * Wraps a common shader object that may still be in the process
+   * of being translated on a worker thread. Stores a copy of the
+   * bytecode and the analysis results so that translation can run
+   * after the application has released its own copy of the shader.
+   * Accessing the shader object will wait for translation to finish,
+   * or perform the translation on the calling thread if no worker
+   * has picked up the shader yet.
+   */
+  class D3D9ShaderModule : public RcObject {
+
+  public:
+
+    D3D9ShaderModule(
+      const D3D9CommonShader&     Shader);
+
+    D3D9ShaderModule(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const DxvkShaderKey&        Key,
+      const D3D9ShaderCacheKey&   CacheKey,
+      const DxsoModuleInfo&       ModuleInfo,
+      const void*                 pShaderBytecode,
+            DxsoAnalysisInfo&&    AnalysisInfo);
+
+    /**
+     * \brief Retrieves common shader object
+     *
+     * Waits for the shader to be translated if necessary.
+     * \returns Common shader object
+     */
+    const D3D9CommonShader& GetShader() {
+      if (unlikely(m_status.load(std::memory_order_acquire) != D3D9ShaderModuleStatus::Ready))
+        WaitForShader();
+
+      return m_shader;
+    }
+
+    /**
+     * \brief Translates shader if no other thread has done so
+     * \returns \c true if the shader was translated by this call
+     */
+    bool TryCompile();
+
+  private:
+
+    std::atomic<D3D9ShaderModuleStatus> m_status;
+
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_cond;
+
+    D3D9CommonShader          m_shader;
+
+    D3D9DeviceEx*             m_device = nullptr;
+    VkShaderStageFlagBits     m_stage  = VkShaderStageFlagBits(0u);
+    DxvkShaderKey             m_key;
+    D3D9ShaderCacheKey        m_cacheKey;
+    DxsoModuleInfo            m_moduleInfo;
+    std::vector<uint32_t>     m_bytecode;
+    DxsoAnalysisInfo          m_analysis;
+
+    void Compile();
+
+    void WaitForShader();
+
+  };
+
+
   /**
    * \brief Common shader interface
    * 
@@ -101,11 +192,11 @@ namespace dxvk {
     D3D9Shader(
             D3D9DeviceEx*        pDevice,
             D3D9MemoryAllocator* pAllocator,
-      const D3D9CommonShader&    CommonShader,
+      const Rc<D3D9ShaderModule>& ShaderModule,
       const void*                pShaderBytecode,
             uint32_t             BytecodeLength)
       : D3D9DeviceChild<Base>( pDevice )
-      , m_shader             ( CommonShader )
+      , m_module             ( ShaderModule )
       , m_bytecode           ( pAllocator->Alloc(BytecodeLength) )
       , m_bytecodeLength     ( BytecodeLength ) {
       m_bytecode.Map();
@@ -151,12 +242,12 @@ namespace dxvk {
     }
 
     const D3D9CommonShader* GetCommonShader() const {
-      return &m_shader;
+      return &m_module->GetShader();
     }
 
   private:
 
-    D3D9CommonShader m_shader;
+    Rc<D3D9ShaderModule> m_module;
 
     D3D9Memory       m_bytecode;
     uint32_t         m_bytecodeLength;
@@ -172,10 +263,10 @@ namespace dxvk {
     D3D9VertexShader(
             D3D9DeviceEx*        pDevice,
             D3D9MemoryAllocator* pAllocator,
-      const D3D9CommonShader&    CommonShader,
+      const Rc<D3D9ShaderModule>& ShaderModule,
       const void*                pShaderBytecode,
             uint32_t             BytecodeLength)
-      : D3D9Shader<IDirect3DVertexShader9>( pDevice, pAllocator, CommonShader, pShaderBytecode, BytecodeLength ) { }
+      : D3D9Shader<IDirect3DVertexShader9>( pDevice, pAllocator, ShaderModule, pShaderBytecode, BytecodeLength ) { }
 
   };
 
@@ -186,10 +277,10 @@ namespace dxvk {
     D3D9PixelShader(
             D3D9DeviceEx*        pDevice,
             D3D9MemoryAllocator* pAllocator,
-      const D3D9CommonShader&    CommonShader,
+      const Rc<D3D9ShaderModule>& ShaderModule,
       const void*                pShaderBytecode,
             uint32_t             BytecodeLength)
-      : D3D9Shader<IDirect3DPixelShader9>( pDevice, pAllocator, CommonShader, pShaderBytecode, BytecodeLength ) { }
+      : D3D9Shader<IDirect3DPixelShader9>( pDevice, pAllocator, ShaderModule, pShaderBytecode, BytecodeLength ) { }
 
   };
 
@@ -200,28 +291,65 @@ namespace dxvk {
    * times, so we should cache the resulting shader modules
    * and reuse them rather than creating new ones. This
    * class is thread-safe.
+   *
+   * The lookup table is split into multiple shards, keyed
+   * on the shader key, so that threads creating different
+   * shaders do not contend on the same lock. Optionally,
+   * shaders are translated on a set of worker threads.
    */
   class D3D9ShaderModuleSet : public RcObject {
-    
+
   public:
-    
+
+    ~D3D9ShaderModuleSet();
+
+    /**
+     * \brief Stops translation worker threads
+     *
+     * Must be called before the device gets destroyed,
+     * since workers access the device while translating
+     * shaders. Pending shaders are translated on bind.
+     */
+    void StopWorkers();
+
     void GetShaderModule(
             D3D9DeviceEx*         pDevice,
-            D3D9CommonShader*     pShaderModule,
+            Rc<D3D9ShaderModule>* pShaderModule,
             uint32_t*             pLength,
             VkShaderStageFlagBits ShaderStage,
       const DxsoModuleInfo*       pDxbcModuleInfo,
       const void*                 pShaderBytecode);
     
   private:
-    
-    dxvk::mutex m_mutex;
-    
-    std::unordered_map<
-      DxvkShaderKey,
-      D3D9CommonShader,
-      DxvkHash, DxvkEq> m_modules;
-    
+
+    constexpr static uint32_t ShardCount = 16u;
+
+    struct Shard {
+      dxvk::mutex mutex;
+
+      std::unordered_map<
+        DxvkShaderKey,
+        Rc<D3D9ShaderModule>,
+        DxvkHash, DxvkEq> modules;
+    };
+
+    std::array<Shard, ShardCount> m_shards;
+
+    dxvk::mutex                       m_workerMutex;
+    dxvk::condition_variable          m_workerCond;
+    std::queue<Rc<D3D9ShaderModule>>  m_workerQueue;
+    std::vector<dxvk::thread>         m_workers;
+    bool                              m_stopWorkers = false;
+
+    Shard& GetShard(const DxvkShaderKey& Key) {
+      return m_shards[Key.hash() % ShardCount];
+    }
+
+    void EnqueueShader(
+      const Rc<D3D9ShaderModule>& ShaderModule);
+
+    void RunWorker();
+
   };
 
   template<typename T>
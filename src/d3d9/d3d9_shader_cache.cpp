@@ -0,0 +1,467 @@
+#include <version.h>
+
+#include "d3d9_constant_layout.h"
+#include "d3d9_fixed_function.h"
+#include "d3d9_shader_cache.h"
+
+#include "../dxso/dxso_modinfo.h"
+
+#include "../dxvk/dxvk_shader_cache.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Cache file version
+   *
+   * Must be bumped whenever the serialized data layout
+   * or the DXSO or fixed-function compilers change in a
+   * way that isn't covered by the DXVK version string.
+   */
+  constexpr static uint32_t D3D9ShaderCacheVersion = 3u;
+
+  D3D9ShaderCache::Instance D3D9ShaderCache::s_instance;
+
+
+  void D3D9CachedShader::setBinary(
+    const DxvkSpirvShaderCreateInfo&  createInfo,
+    const SpirvCodeBuffer&            spirv) {
+    bindings.assign(createInfo.bindings, createInfo.bindings + createInfo.bindingCount);
+    flatShadingInputs = createInfo.flatShadingInputs;
+    sharedPushData = createInfo.sharedPushData;
+    localPushData = createInfo.localPushData;
+    samplerHeap = createInfo.samplerHeap;
+    code = spirv;
+  }
+
+
+  Rc<DxvkShader> D3D9CachedShader::createShader() const {
+    DxvkSpirvShaderCreateInfo info;
+    info.bindingCount = bindings.size();
+    info.bindings = bindings.data();
+    info.flatShadingInputs = flatShadingInputs;
+    info.sharedPushData = sharedPushData;
+    info.localPushData = localPushData;
+    info.samplerHeap = samplerHeap;
+
+    return new DxvkSpirvShader(info, SpirvCodeBuffer(code));
+  }
+
+
+  D3D9ShaderCache::D3D9ShaderCache() {
+    auto paths = DxvkShaderCache::getDefaultFilePaths();
+
+    if (!paths.directory.empty() && !paths.baseName.empty()) {
+      m_directory = paths.directory;
+      m_lutPath = paths.directory + env::PlatformDirSlash + paths.baseName + ".d3d9.lut";
+      m_binPath = paths.directory + env::PlatformDirSlash + paths.baseName + ".d3d9.bin";
+    }
+  }
+
+
+  D3D9ShaderCache::~D3D9ShaderCache() {
+    if (m_writer.joinable()) {
+      { std::unique_lock lock(m_writeMutex);
+        m_stopWriter = true;
+        m_writeCond.notify_one();
+      }
+
+      m_writer.join();
+    }
+  }
+
+
+  bool D3D9ShaderCache::lookupShader(
+    const D3D9ShaderCacheKey&         key,
+          D3D9CachedShader&           shader) {
+    if (initialize() != Status::OpenReadWrite)
+      return false;
+
+    auto entry = m_lut.find(key);
+
+    if (entry == m_lut.end())
+      return false;
+
+    std::unique_lock lock(m_fileMutex);
+
+    if (!loadShaderLocked(entry->second, shader)) {
+      Logger::warn(str::format("Failed to load cached shader ", key.shaderHash.toString()));
+      return false;
+    }
+
+    return true;
+  }
+
+
+  void D3D9ShaderCache::addShader(
+    const D3D9ShaderCacheKey&         key,
+          D3D9CachedShader&&          shader) {
+    if (initialize() != Status::OpenReadWrite)
+      return;
+
+    if (m_lut.find(key) != m_lut.end())
+      return;
+
+    std::unique_lock lock(m_writeMutex);
+
+    auto& entry = m_writeQueue.emplace_back();
+    entry.key = key;
+    entry.shader = std::move(shader);
+
+    m_writeCond.notify_one();
+
+    if (!m_writer.joinable())
+      m_writer = dxvk::thread([this] { runWriter(); });
+  }
+
+
+  D3D9ShaderCache::Status D3D9ShaderCache::initialize() {
+    auto status = m_status.load(std::memory_order_acquire);
+
+    if (likely(status != Status::Uninitialized))
+      return status;
+
+    std::unique_lock lock(m_fileMutex);
+    status = m_status.load(std::memory_order_relaxed);
+
+    if (status != Status::Uninitialized)
+      return status;
+
+    if (m_directory.empty()) {
+      status = Status::CacheDisabled;
+    } else if ((openReadWriteLocked() && parseLut()) || openWriteOnlyLocked()) {
+      status = Status::OpenReadWrite;
+    } else {
+      status = Status::CacheDisabled;
+    }
+
+    m_status.store(status, std::memory_order_release);
+    return status;
+  }
+
+
+  bool D3D9ShaderCache::openReadWriteLocked() {
+    auto flags = util::FileFlags(
+      util::FileFlag::AllowRead,
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Exclusive);
+
+    m_binFile.open(m_binPath, flags);
+    m_lutFile.open(m_lutPath, flags);
+
+    if (!m_binFile || !m_lutFile)
+      return false;
+
+    Logger::info(str::format("Found D3D9 cache file: ", m_binPath));
+    return true;
+  }
+
+
+  bool D3D9ShaderCache::openWriteOnlyLocked() {
+    m_lut.clear();
+
+    auto flags = util::FileFlags(
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Truncate,
+      util::FileFlag::Exclusive);
+
+    m_binFile.open(m_binPath, flags);
+    m_lutFile.open(m_lutPath, flags);
+
+    if (!m_binFile || !m_lutFile) {
+      if (!env::createDirectory(m_directory)) {
+        Logger::warn(str::format("Failed to create directory: ", m_directory));
+        return false;
+      }
+
+      m_binFile.open(m_binPath, flags);
+      m_lutFile.open(m_lutPath, flags);
+    }
+
+    if (!m_binFile || !m_lutFile) {
+      Logger::warn(str::format("Failed to create ", m_lutPath, ", disabling D3D9 shader cache"));
+      return false;
+    }
+
+    Logger::info(str::format("Created D3D9 cache file: ", m_binPath));
+
+    LutHeader header = { };
+    header.magic = { 'D', '3', 'D', '9' };
+    header.version = D3D9ShaderCacheVersion;
+    header.versionString = DXVK_VERSION;
+
+    if (!write(m_lutFile, header.magic)
+     || !write(m_lutFile, header.version)
+     || !write(m_lutFile, uint16_t(header.versionString.size()))
+     || !m_lutFile.append(header.versionString.size(), header.versionString.data())) {
+      Logger::warn(str::format("Failed to write cache header: ", m_lutPath));
+      return false;
+    }
+
+    return true;
+  }
+
+
+  bool D3D9ShaderCache::parseLut() {
+    LutHeader header;
+
+    size_t size = m_lutFile.size();
+    size_t offset = 0u;
+
+    uint16_t versionLength = 0u;
+
+    if (!read(m_lutFile, offset, header.magic)
+     || !read(m_lutFile, offset, header.version)
+     || !read(m_lutFile, offset, versionLength)) {
+      Logger::warn("Failed to parse D3D9 cache file header.");
+      return false;
+    }
+
+    header.versionString.resize(versionLength);
+
+    if (!m_lutFile.read(offset, versionLength, header.versionString.data())) {
+      Logger::warn("Failed to parse D3D9 cache file header.");
+      return false;
+    }
+
+    offset += versionLength;
+
+    if (header.magic != std::array<char, 4u>{ 'D', '3', 'D', '9' }) {
+      Logger::warn("Invalid D3D9 cache file header.");
+      return false;
+    }
+
+    if (header.version != D3D9ShaderCacheVersion || header.versionString != DXVK_VERSION) {
+      Logger::warn(str::format("D3D9 cache was created with DXVK version ", header.versionString,
+        ", but current version is ", DXVK_VERSION, ". Discarding old cache."));
+      return false;
+    }
+
+    while (offset < size) {
+      D3D9ShaderCacheKey k;
+      LutEntry e;
+
+      if (!readLutKey(m_lutFile, offset, k) || !read(m_lutFile, offset, e)) {
+        Logger::warn("Failed to parse D3D9 cache look-up table.");
+        return false;
+      }
+
+      m_lut.insert_or_assign(k, e);
+    }
+
+    return true;
+  }
+
+
+  bool D3D9ShaderCache::loadShaderLocked(const LutEntry& entry, D3D9CachedShader& shader) {
+    std::vector<char> data(entry.size);
+
+    if (!m_binFile.read(entry.offset, data.size(), data.data())) {
+      Logger::warn("Failed to read cached D3D9 shader binary");
+      return false;
+    }
+
+    if (entry.checksum != bit::fnv1a_hash(data.data(), data.size())) {
+      Logger::warn("Checksum mismatch for cached D3D9 shader");
+      return false;
+    }
+
+    return deserializeShader(data, shader);
+  }
+
+
+  bool D3D9ShaderCache::writeShaderLocked(const D3D9ShaderCacheKey& key, const D3D9CachedShader& shader) {
+    std::vector<char> data;
+    serializeShader(data, shader);
+
+    LutEntry entry = { };
+    entry.offset = m_binFile.size();
+    entry.size = data.size();
+    entry.checksum = bit::fnv1a_hash(data.data(), data.size());
+
+    return m_binFile.append(data.size(), data.data())
+        && writeLutKey(m_lutFile, key)
+        && write(m_lutFile, entry);
+  }
+
+
+  void D3D9ShaderCache::runWriter() {
+    std::vector<WriteEntry> localQueue;
+
+    env::setThreadName("dxvk-d3d9-cache");
+
+    bool stop = false;
+
+    while (!stop) {
+      { std::unique_lock lock(m_writeMutex);
+
+        m_writeCond.wait(lock, [this] {
+          return !m_writeQueue.empty() || m_stopWriter;
+        });
+
+        std::swap(localQueue, m_writeQueue);
+        stop = m_stopWriter;
+      }
+
+      std::unique_lock fileLock(m_fileMutex);
+
+      for (const auto& e : localQueue) {
+        if (!writeShaderLocked(e.key, e.shader)) {
+          Logger::err("Failed to write D3D9 cache file.");
+          m_status.store(Status::CacheDisabled, std::memory_order_release);
+          return;
+        }
+      }
+
+      localQueue.clear();
+
+      m_binFile.flush();
+      m_lutFile.flush();
+    }
+  }
+
+
+  void D3D9ShaderCache::serializeShader(std::vector<char>& stream, const D3D9CachedShader& shader) {
+    writeArray(stream, shader.bindings.data(), shader.bindings.size());
+    write(stream, shader.flatShadingInputs);
+    write(stream, shader.sharedPushData);
+    write(stream, shader.localPushData);
+    write(stream, shader.samplerHeap);
+    writeArray(stream, shader.code.data(), shader.code.dwords());
+
+    write(stream, shader.isgn);
+    write(stream, shader.usedSamplers);
+    write(stream, shader.usedRTs);
+    write(stream, shader.textureTypes);
+    write(stream, shader.info);
+    write(stream, shader.meta);
+    writeArray(stream, shader.constants.data(), shader.constants.size());
+    writeArray(stream, shader.constantGatherTable.data(), shader.constantGatherTable.size());
+    write(stream, shader.maxDefinedFloatConst);
+    write(stream, shader.maxDefinedIntConst);
+    write(stream, shader.maxDefinedBoolConst);
+  }
+
+
+  bool D3D9ShaderCache::deserializeShader(const std::vector<char>& stream, D3D9CachedShader& shader) {
+    size_t offset = 0u;
+
+    std::vector<uint32_t> code;
+
+    bool status = readArray(stream, offset, shader.bindings)
+               && read(stream, offset, shader.flatShadingInputs)
+               && read(stream, offset, shader.sharedPushData)
+               && read(stream, offset, shader.localPushData)
+               && read(stream, offset, shader.samplerHeap)
+               && readArray(stream, offset, code)
+               && read(stream, offset, shader.isgn)
+               && read(stream, offset, shader.usedSamplers)
+               && read(stream, offset, shader.usedRTs)
+               && read(stream, offset, shader.textureTypes)
+               && read(stream, offset, shader.info)
+               && read(stream, offset, shader.meta)
+               && readArray(stream, offset, shader.constants)
+               && readArray(stream, offset, shader.constantGatherTable)
+               && read(stream, offset, shader.maxDefinedFloatConst)
+               && read(stream, offset, shader.maxDefinedIntConst)
+               && read(stream, offset, shader.maxDefinedBoolConst);
+
+    if (!status || offset != stream.size())
+      return false;
+
+    shader.code = SpirvCodeBuffer(std::move(code));
+    return true;
+  }
+
+
+  bool D3D9ShaderCache::readLutKey(util::File& stream, size_t& offset, D3D9ShaderCacheKey& key) {
+    return read(stream, offset, key.type)
+        && read(stream, offset, key.stage)
+        && read(stream, offset, key.shaderHash)
+        && read(stream, offset, key.optionHash);
+  }
+
+
+  bool D3D9ShaderCache::writeLutKey(util::File& stream, const D3D9ShaderCacheKey& key) {
+    return write(stream, key.type)
+        && write(stream, key.stage)
+        && write(stream, key.shaderHash)
+        && write(stream, key.optionHash);
+  }
+
+
+  uint64_t D3D9ShaderCache::hashOptions(
+    const DxsoModuleInfo&             moduleInfo,
+    const D3D9ConstantLayout&         layout) {
+    const auto& options = moduleInfo.options;
+
+    uint64_t hash = bit::fnv1a_init();
+    hash = bit::fnv1a_iter(hash, uint32_t(options.strictConstantCopies));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.d3d9FloatEmulation));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.strictPow));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.invariantPosition));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.forceSamplerTypeSpecConstants));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.forceSampleRateShading));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.vertexFloatConstantBufferAsSSBO));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.robustness2Supported));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.sincosEmulation));
+    hash = bit::fnv1a_iter(hash, layout.floatCount);
+    hash = bit::fnv1a_iter(hash, layout.intCount);
+    hash = bit::fnv1a_iter(hash, layout.boolCount);
+    hash = bit::fnv1a_iter(hash, layout.bitmaskCount);
+    return hash;
+  }
+
+
+  uint64_t D3D9ShaderCache::hashOptions(
+    const D3D9FixedFunctionOptions&   options) {
+    uint64_t hash = bit::fnv1a_init();
+    hash = bit::fnv1a_iter(hash, uint32_t(options.invariantPosition));
+    hash = bit::fnv1a_iter(hash, uint32_t(options.forceSampleRateShading));
+    return hash;
+  }
+
+
+  Rc<D3D9ShaderCache> D3D9ShaderCache::getInstance() {
+    std::lock_guard lock(s_instance.mutex);
+
+    if (!s_instance.instance)
+      s_instance.instance = new D3D9ShaderCache();
+
+    return s_instance.instance;
+  }
+
+
+  void D3D9ShaderCache::freeInstance() {
+    std::lock_guard lock(s_instance.mutex);
+
+    // The ref count can only be incremented from 0 to 1 inside a locked
+    // context, so this check is safe. Don't destroy the object if another
+    // thread has essentially revived it.
+    if (!m_useCount.load(std::memory_order_relaxed) && s_instance.instance == this) {
+      s_instance.instance = nullptr;
+      delete this;
+    }
+  }
+
+
+  size_t D3D9ShaderCacheKey::hash() const {
+    DxvkHashState hash;
+    hash.add(uint32_t(type));
+    hash.add(uint32_t(stage));
+
+    for (uint32_t i = 0; i < 5; i++)
+      hash.add(shaderHash.dword(i));
+
+    hash.add(optionHash);
+    return hash;
+  }
+
+
+  bool D3D9ShaderCacheKey::eq(const D3D9ShaderCacheKey& k) const {
+    return type       == k.type
+        && stage      == k.stage
+        && shaderHash == k.shaderHash
+        && optionHash == k.optionHash;
+  }
+
+}
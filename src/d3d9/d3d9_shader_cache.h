@@ -0,0 +1,303 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../dxso/dxso_isgn.h"
+#include "../dxso/dxso_common.h"
+
+#include "../dxvk/dxvk_hash.h"
+#include "../dxvk/dxvk_shader_spirv.h"
+
+#include "../util/thread.h"
+#include "../util/util_file.h"
+
+namespace dxvk {
+
+  struct D3D9ConstantLayout;
+  struct D3D9FixedFunctionOptions;
+  struct DxsoModuleInfo;
+
+  /**
+   * \brief Cached shader type
+   */
+  enum class D3D9CachedShaderType : uint32_t {
+    Dxso          = 0u,
+    FixedFunction = 1u,
+  };
+
+
+  /**
+   * \brief Shader cache key
+   *
+   * For DXSO shaders, the hash is computed from the shader
+   * bytecode, for fixed-function shaders it is computed from
+   * the fixed-function shader key. The option hash covers all
+   * compile options that affect the generated SPIR-V, such as
+   * the \c DxsoModuleInfo and the constant layout.
+   */
+  struct D3D9ShaderCacheKey {
+    D3D9CachedShaderType  type        = D3D9CachedShaderType::Dxso;
+    VkShaderStageFlagBits stage       = VkShaderStageFlagBits(0u);
+    Sha1Hash              shaderHash  = { };
+    uint64_t              optionHash  = 0u;
+
+    size_t hash() const;
+
+    bool eq(const D3D9ShaderCacheKey& k) const;
+  };
+
+
+  /**
+   * \brief Cached shader
+   *
+   * Stores the SPIR-V binary along with the shader create
+   * info, as well as the DXSO reflection data that would
+   * otherwise be gathered while compiling the shader.
+   */
+  struct D3D9CachedShader {
+    std::vector<DxvkBindingInfo> bindings;
+    uint32_t              flatShadingInputs = 0u;
+    DxvkPushDataBlock     sharedPushData;
+    DxvkPushDataBlock     localPushData;
+    DxvkShaderBinding     samplerHeap;
+    SpirvCodeBuffer       code;
+
+    DxsoIsgn              isgn;
+    uint32_t              usedSamplers = 0u;
+    uint32_t              usedRTs = 0u;
+    uint32_t              textureTypes = 0u;
+    DxsoProgramInfo       info;
+    DxsoShaderMetaInfo    meta;
+    DxsoDefinedConstants  constants;
+    DxsoConstantGatherTable constantGatherTable;
+    int32_t               maxDefinedFloatConst = -1;
+    int32_t               maxDefinedIntConst = -1;
+    int32_t               maxDefinedBoolConst = -1;
+
+    /**
+     * \brief Initializes binary data from create info
+     *
+     * \param [in] createInfo Shader create info
+     * \param [in] spirv SPIR-V code
+     */
+    void setBinary(
+      const DxvkSpirvShaderCreateInfo&  createInfo,
+      const SpirvCodeBuffer&            spirv);
+
+    /**
+     * \brief Creates shader object from cached data
+     * \returns Shader object
+     */
+    Rc<DxvkShader> createShader() const;
+  };
+
+
+  /**
+   * \brief D3D9 shader cache
+   *
+   * On-disk cache for DXSO and fixed-function shaders. Uses the same
+   * layout as \c DxvkShaderCache, i.e. an append-only binary blob that
+   * stores the SPIR-V and reflection data, and a look-up table with the
+   * shader keys and checksums, which is parsed on initialization.
+   */
+  class D3D9ShaderCache {
+
+  public:
+
+    ~D3D9ShaderCache();
+
+    void incRef() {
+      m_useCount.fetch_add(1u, std::memory_order_acquire);
+    }
+
+    void decRef() {
+      if (m_useCount.fetch_sub(1u, std::memory_order_release) == 1u)
+        freeInstance();
+    }
+
+    /**
+     * \brief Looks up shader with matching key
+     *
+     * \param [in] key Shader key
+     * \param [out] shader Cached shader data
+     * \returns \c true if the shader was found and loaded
+     */
+    bool lookupShader(
+      const D3D9ShaderCacheKey&         key,
+            D3D9CachedShader&           shader);
+
+    /**
+     * \brief Writes shader to cache file
+     *
+     * The shader binary will be written asynchronously.
+     * \param [in] key Shader key
+     * \param [in] shader Shader data
+     */
+    void addShader(
+      const D3D9ShaderCacheKey&         key,
+            D3D9CachedShader&&          shader);
+
+    /**
+     * \brief Computes option hash for DXSO shaders
+     *
+     * \param [in] moduleInfo DXSO module info
+     * \param [in] layout Constant buffer layout
+     * \returns Option hash for the cache key
+     */
+    static uint64_t hashOptions(
+      const DxsoModuleInfo&             moduleInfo,
+      const D3D9ConstantLayout&         layout);
+
+    /**
+     * \brief Computes option hash for fixed-function shaders
+     *
+     * \param [in] options Fixed-function options
+     * \returns Option hash for the cache key
+     */
+    static uint64_t hashOptions(
+      const D3D9FixedFunctionOptions&   options);
+
+    /**
+     * \brief Initializes shader cache
+     * \returns Shader cache instance
+     */
+    static Rc<D3D9ShaderCache> getInstance();
+
+  private:
+
+    struct Instance {
+      dxvk::mutex       mutex;
+      D3D9ShaderCache*  instance = nullptr;
+    };
+
+    static Instance s_instance;
+
+    struct LutHeader {
+      std::array<char, 4u>  magic = { };
+      uint32_t              version = 0u;
+      std::string           versionString = { };
+    };
+
+    struct LutEntry {
+      uint64_t offset = 0u;
+      uint32_t size = 0u;
+      uint32_t reserved = 0u;
+      uint64_t checksum = 0u;
+    };
+
+    struct WriteEntry {
+      D3D9ShaderCacheKey  key;
+      D3D9CachedShader    shader;
+    };
+
+    enum class Status : uint32_t {
+      Uninitialized   = 0u,
+      CacheDisabled   = 1u,
+      OpenReadWrite   = 2u,
+    };
+
+    std::atomic<uint32_t>         m_useCount = { 0u };
+
+    std::string                   m_directory;
+    std::string                   m_lutPath;
+    std::string                   m_binPath;
+
+    dxvk::mutex                   m_fileMutex;
+
+    util::File                    m_lutFile;
+    util::File                    m_binFile;
+
+    std::atomic<Status>           m_status = { Status::Uninitialized };
+
+    std::unordered_map<D3D9ShaderCacheKey, LutEntry, DxvkHash, DxvkEq> m_lut;
+
+    dxvk::mutex                   m_writeMutex;
+    dxvk::condition_variable      m_writeCond;
+    std::vector<WriteEntry>       m_writeQueue;
+    bool                          m_stopWriter = false;
+
+    dxvk::thread                  m_writer;
+
+    D3D9ShaderCache();
+
+    Status initialize();
+
+    bool openReadWriteLocked();
+
+    bool openWriteOnlyLocked();
+
+    bool parseLut();
+
+    bool loadShaderLocked(const LutEntry& entry, D3D9CachedShader& shader);
+
+    bool writeShaderLocked(const D3D9ShaderCacheKey& key, const D3D9CachedShader& shader);
+
+    void runWriter();
+
+    void freeInstance();
+
+    static void serializeShader(std::vector<char>& stream, const D3D9CachedShader& shader);
+
+    static bool deserializeShader(const std::vector<char>& stream, D3D9CachedShader& shader);
+
+    static bool readLutKey(util::File& stream, size_t& offset, D3D9ShaderCacheKey& key);
+
+    static bool writeLutKey(util::File& stream, const D3D9ShaderCacheKey& key);
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static void write(std::vector<char>& stream, const T& data) {
+      auto bytes = reinterpret_cast<const char*>(&data);
+      stream.insert(stream.end(), bytes, bytes + sizeof(data));
+    }
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static void writeArray(std::vector<char>& stream, const T* data, size_t count) {
+      write(stream, uint32_t(count));
+
+      auto bytes = reinterpret_cast<const char*>(data);
+      stream.insert(stream.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool read(const std::vector<char>& stream, size_t& offset, T& data) {
+      if (offset + sizeof(data) > stream.size())
+        return false;
+
+      std::memcpy(&data, &stream[offset], sizeof(data));
+      offset += sizeof(data);
+      return true;
+    }
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool readArray(const std::vector<char>& stream, size_t& offset, std::vector<T>& data) {
+      uint32_t count = 0u;
+
+      if (!read(stream, offset, count) || offset + sizeof(T) * count > stream.size())
+        return false;
+
+      data.resize(count);
+      std::memcpy(data.data(), &stream[offset], sizeof(T) * count);
+      offset += sizeof(T) * count;
+      return true;
+    }
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool write(util::File& stream, const T& data) {
+      return stream.append(sizeof(data), &data);
+    }
+
+    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool read(util::File& stream, size_t& offset, T& data) {
+      bool result = stream.read(offset, sizeof(data), &data);
+      offset += sizeof(data);
+      return result;
+    }
+
+  };
+
+}
@@ -183,6 +183,7 @@ namespace dxvk {
 
     Rc<hud::HudClientApiItem> m_apiHud;
     Rc<hud::HudLatencyItem>   m_latencyHud;
+    Rc<hud::HudFramePacingItem> m_pacingHud;
 
     std::optional<VkHdrMetadataEXT> m_hdrMetadata;
 
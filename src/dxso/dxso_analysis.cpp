@@ -1,5 +1,7 @@
 #include "dxso_analysis.h"
 
+#include <algorithm>
+
 namespace dxvk {
 
   DxsoAnalyzer::DxsoAnalyzer(
@@ -21,6 +23,97 @@ namespace dxvk {
     if (opcode == DxsoOpcode::TexKill)
       m_analysis->usesKill = true;
 
+    // Validate control flow up front, so that shaders which
+    // the compiler would reject can be rejected at creation
+    // time even if translation happens asynchronously.
+    switch (opcode) {
+      case DxsoOpcode::Rep:
+      case DxsoOpcode::Loop:
+        m_controlFlowBlocks.push_back({ true, false });
+        break;
+
+      case DxsoOpcode::If:
+      case DxsoOpcode::Ifc:
+        m_controlFlowBlocks.push_back({ false, false });
+        break;
+
+      case DxsoOpcode::Else:
+        if (m_controlFlowBlocks.empty()
+         || m_controlFlowBlocks.back().isLoop
+         || m_controlFlowBlocks.back().hasElse)
+          throw DxvkError("DxsoAnalyzer: 'Else' without 'If' found");
+
+        m_controlFlowBlocks.back().hasElse = true;
+        break;
+
+      case DxsoOpcode::EndIf:
+        if (m_controlFlowBlocks.empty()
+         || m_controlFlowBlocks.back().isLoop)
+          throw DxvkError("DxsoAnalyzer: 'EndIf' without 'If' found");
+
+        m_controlFlowBlocks.pop_back();
+        break;
+
+      case DxsoOpcode::EndRep:
+      case DxsoOpcode::EndLoop:
+        if (m_controlFlowBlocks.empty()
+         || !m_controlFlowBlocks.back().isLoop)
+          throw DxvkError("DxsoAnalyzer: 'EndRep' without 'Rep' or 'Loop' found");
+
+        m_controlFlowBlocks.pop_back();
+        break;
+
+      case DxsoOpcode::Break:
+      case DxsoOpcode::BreakC:
+        if (std::none_of(m_controlFlowBlocks.begin(), m_controlFlowBlocks.end(),
+            [] (const ControlFlowBlock& block) { return block.isLoop; }))
+          throw DxvkError("DxsoAnalyzer: 'Break' outside 'Rep' or 'Loop' found");
+        break;
+
+      default:
+        break;
+    }
+
+    // Track which float constants are read from the constant
+    // buffer. Mirrors the compiler, which only emits a buffer
+    // load if the register has not been defined at this point.
+    if (opcode == DxsoOpcode::Def) {
+      if (ctx.dst.id.num < MaxFloatConstants)
+        m_definedConstF.set(ctx.dst.id.num, true);
+
+      m_analysis->maxDefinedFloatConst = std::max(
+        m_analysis->maxDefinedFloatConst, int32_t(ctx.dst.id.num));
+    } else if (opcode == DxsoOpcode::DefI) {
+      m_analysis->maxDefinedIntConst = std::max(
+        m_analysis->maxDefinedIntConst, int32_t(ctx.dst.id.num));
+    } else if (opcode == DxsoOpcode::DefB) {
+      m_analysis->maxDefinedBoolConst = std::max(
+        m_analysis->maxDefinedBoolConst, int32_t(ctx.dst.id.num));
+    }
+
+    for (uint32_t i = 0; i < ctx.srcCount; i++) {
+      const DxsoRegister& src = ctx.src[i];
+
+      if (src.id.type != DxsoRegisterType::Const)
+        continue;
+
+      if (src.hasRelative) {
+        m_analysis->usesRelativeConstF = true;
+        continue;
+      }
+
+      // Matrix macros read one consecutive register
+      // per output component from the second operand
+      uint32_t regCount = i == 1 ? getMatrixRowCount(opcode) : 1u;
+
+      for (uint32_t j = 0; j < regCount; j++) {
+        uint32_t reg = src.id.num + j;
+
+        if (reg < MaxFloatConstants && !m_definedConstF.get(reg))
+          m_usedConstF.set(reg, true);
+      }
+    }
+
     if (opcode == DxsoOpcode::DsX
      || opcode == DxsoOpcode::DsY
 
@@ -50,8 +143,26 @@ namespace dxvk {
     m_parentOpcode = ctx.instruction.opcode;
   }
 
+  uint32_t DxsoAnalyzer::getMatrixRowCount(DxsoOpcode opcode) {
+    switch (opcode) {
+      case DxsoOpcode::M3x2: return 2u;
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M4x3: return 3u;
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M4x4: return 4u;
+      default: return 1u;
+    }
+  }
+
   void DxsoAnalyzer::finalize(size_t tokenCount) {
     m_analysis->bytecodeByteLength = tokenCount * sizeof(uint32_t);
+
+    if (!m_analysis->usesRelativeConstF) {
+      for (uint32_t i = 0; i < MaxFloatConstants; i++) {
+        if (m_usedConstF.get(i))
+          m_analysis->usedConstantsF.push_back(i);
+      }
+    }
   }
 
 }
\ No newline at end of file
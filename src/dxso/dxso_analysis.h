@@ -3,6 +3,8 @@
 #include "dxso_modinfo.h"
 #include "dxso_decoder.h"
 
+#include "../util/util_bit.h"
+
 namespace dxvk {
 
   struct DxsoAnalysisInfo {
@@ -11,11 +13,27 @@ namespace dxvk {
     bool usesDerivatives = false;
     bool usesKill        = false;
 
+    bool usesRelativeConstF = false;
+
+    /// Highest constant registers defined via \c def,
+    /// \c defi and \c defb, or -1 if none are defined.
+    /// Used to validate shaders before compiling them.
+    int32_t maxDefinedFloatConst = -1;
+    int32_t maxDefinedIntConst   = -1;
+    int32_t maxDefinedBoolConst  = -1;
+
     std::vector<DxsoInstructionContext> coissues;
+
+    /// Float constant registers that are read by the shader
+    /// and not defined via \c def at the time of the read,
+    /// in ascending order. Only valid if the shader does
+    /// not use relative addressing on float constants.
+    std::vector<uint32_t> usedConstantsF;
   };
 
   class DxsoAnalyzer {
-
+    /// Number of float constant registers with software vertex processing
+    constexpr static uint32_t MaxFloatConstants = 8192u;
   public:
 
     DxsoAnalyzer(
@@ -23,6 +41,10 @@ namespace dxvk {
 
     /**
      * \brief Processes a single instruction
+     *
+     * Throws if the instruction is not valid in the
+     * current control flow scope, mirroring the checks
+     * that the compiler performs.
      * \param [in] ins The instruction
      */
     void processInstruction(
@@ -32,10 +54,22 @@ namespace dxvk {
 
   private:
 
+    struct ControlFlowBlock {
+      bool isLoop;
+      bool hasElse;
+    };
+
     DxsoAnalysisInfo* m_analysis = nullptr;
 
     DxsoOpcode m_parentOpcode    = DxsoOpcode::Nop;
 
+    bit::bitset<MaxFloatConstants> m_definedConstF;
+    bit::bitset<MaxFloatConstants> m_usedConstF;
+
+    std::vector<ControlFlowBlock> m_controlFlowBlocks;
+
+    static uint32_t getMatrixRowCount(DxsoOpcode opcode);
+
   };
 
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "../dxvk/dxvk_shader_spirv.h"
 
+#include <algorithm>
 #include <cfloat>
 
 namespace dxvk {
@@ -24,7 +25,10 @@ namespace dxvk {
     , m_programInfo( programInfo )
     , m_analysis   ( &analysis )
     , m_layout     ( &layout )
-    , m_module     ( spvVersion(1, 3) ) {
+    , m_module     ( spvVersion(1, 3), analysis.bytecodeByteLength * 2u ) {
+    // The module size hint above assumes roughly eight dwords
+    // of SPIR-V function code per dword of DXSO bytecode.
+
     // Declare an entry point ID. We'll need it during the
     // initialization phase where the execution mode is set.
     m_entryPointId = m_module.allocateId();
@@ -223,7 +227,7 @@ namespace dxvk {
   }
 
 
-  Rc<DxvkShader> DxsoCompiler::compile() {
+  Rc<DxvkShader> DxsoCompiler::compile(D3D9CachedShader* pCachedShader) {
     DxvkSpirvShaderCreateInfo info;
     info.bindingCount = m_bindings.size();
     info.bindings = m_bindings.data();
@@ -234,7 +238,12 @@ namespace dxvk {
     if (m_programInfo.type() == DxsoProgramTypes::PixelShader)
       info.flatShadingInputs = m_ps.flatShadingMask;
 
-    return new DxvkSpirvShader(info, m_module.compile());
+    SpirvCodeBuffer code = m_module.compile();
+
+    if (pCachedShader)
+      pCachedShader->setBinary(info, code);
+
+    return new DxvkSpirvShader(info, std::move(code));
   }
 
   void DxsoCompiler::emitInit() {
@@ -242,6 +251,8 @@ namespace dxvk {
     m_module.enableCapability(spv::CapabilityShader);
     m_module.enableCapability(spv::CapabilityImageQuery);
 
+    this->setupConstantGatherTable();
+
     if (isSwvp()) {
       m_cFloatBuffer = this->emitDclSwvpConstantBuffer<DxsoConstantBufferType::Float>();
       m_cIntBuffer = this->emitDclSwvpConstantBuffer<DxsoConstantBufferType::Int>();
@@ -261,6 +272,29 @@ namespace dxvk {
     }
   }
 
+  void DxsoCompiler::setupConstantGatherTable() {
+    // Relative addressing can access any register, so
+    // we need to keep the application's layout as-is.
+    if (m_analysis->usesRelativeConstF)
+      return;
+
+    for (uint32_t reg : m_analysis->usedConstantsF) {
+      if (reg < m_layout->floatCount)
+        m_constantGatherTable.push_back(reg);
+    }
+
+    // Only use the compact layout if it saves a meaningful
+    // amount of data over copying the entire register range
+    // up to the highest constant that the shader reads.
+    if (m_constantGatherTable.empty()
+     || m_constantGatherTable.size() * 2u > m_constantGatherTable.back() + 1u) {
+      m_constantGatherTable.clear();
+      return;
+    }
+
+    m_meta.compactConstantsF = true;
+  }
+
   void DxsoCompiler::emitDclConstantBuffer() {
     std::array<uint32_t, 2> members = {
       // int i[16 or 2048]
@@ -941,7 +975,22 @@ namespace dxvk {
       default: break;
     }
 
-    uint32_t relativeIdx = this->emitArrayIndex(reg.id.num, relative);
+    uint32_t constIdx = reg.id.num;
+
+    if (reg.id.type == DxsoRegisterType::Const && m_meta.compactConstantsF) {
+      // Compact layouts are never used with relative addressing. Registers
+      // outside the layout are not in the table and would read 0 anyway.
+      auto entry = std::lower_bound(m_constantGatherTable.begin(), m_constantGatherTable.end(), reg.id.num);
+
+      if (entry == m_constantGatherTable.end() || *entry != reg.id.num) {
+        result.id = m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f);
+        return result;
+      }
+
+      constIdx = uint32_t(entry - m_constantGatherTable.begin());
+    }
+
+    uint32_t relativeIdx = this->emitArrayIndex(constIdx, relative);
 
     if (reg.id.type != DxsoRegisterType::ConstBool) {
       uint32_t structIdx;
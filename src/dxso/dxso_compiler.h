@@ -7,6 +7,7 @@
 #include "dxso_util.h"
 
 #include "../d3d9/d3d9_constant_layout.h"
+#include "../d3d9/d3d9_shader_cache.h"
 #include "../d3d9/d3d9_spec_constants.h"
 #include "../spirv/spirv_module.h"
 
@@ -237,15 +238,19 @@ namespace dxvk {
 
     /**
      * \brief Compiles the shader
+     *
+     * \param [out] pCachedShader If not \c nullptr, receives
+     *    the SPIR-V binary and create info for the shader cache
      * \returns The final shader objects
      */
-    Rc<DxvkShader> compile();
+    Rc<DxvkShader> compile(D3D9CachedShader* pCachedShader);
 
     const DxsoIsgn& isgn() { return m_isgn; }
     const DxsoIsgn& osgn() { return m_osgn; }
 
     const DxsoShaderMetaInfo& meta() { return m_meta; }
     const DxsoDefinedConstants& constants() { return m_constants; }
+    const DxsoConstantGatherTable& constantGatherTable() { return m_constantGatherTable; }
     uint32_t usedSamplers() const { return m_usedSamplers; }
     uint32_t usedRTs() const { return m_usedRTs; }
     int32_t  maxDefinedFloatConstant() const { return m_maxDefinedFloatConstant; }
@@ -262,6 +267,7 @@ namespace dxvk {
 
     DxsoShaderMetaInfo         m_meta;
     DxsoDefinedConstants       m_constants;
+    DxsoConstantGatherTable    m_constantGatherTable;
     int32_t                    m_maxDefinedFloatConstant = -1;
     int32_t                    m_maxDefinedIntConstant = -1;
     int32_t                    m_maxDefinedBoolConstant = -1;
@@ -388,6 +394,8 @@ namespace dxvk {
 
     void emitDclConstantBuffer();
 
+    void setupConstantGatherTable();
+
     void emitDclInputArray();
     void emitDclOutputArray();
 
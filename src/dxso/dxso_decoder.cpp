@@ -143,6 +143,7 @@ namespace dxvk {
     uint32_t token = iter.read();
 
     this->decodeGenericRegister(m_ctx.src[i], token);
+    m_ctx.srcCount = i + 1;
 
     m_ctx.src[i].swizzle = DxsoRegSwizzle(
       uint8_t((token & 0x00ff0000) >> 16));
@@ -179,6 +180,7 @@ namespace dxvk {
     uint32_t token = iter.read();
 
     m_ctx.instructionIdx++;
+    m_ctx.srcCount = 0;
 
     m_ctx.instruction.opcode = static_cast<DxsoOpcode>(
       token & 0x0000ffff);
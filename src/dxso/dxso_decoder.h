@@ -203,6 +203,7 @@ namespace dxvk {
     std::array<
       DxsoRegister,
       DxsoMaxOperandCount>      src;
+    uint32_t                    srcCount;
 
     DxsoDefinition              def;
 
@@ -216,6 +217,7 @@ namespace dxvk {
     DxsoDecodeContext(const DxsoProgramInfo& programInfo)
       : m_programInfo( programInfo ) {
       m_ctx.instructionIdx = 0;
+      m_ctx.srcCount       = 0;
     }
 
     /**
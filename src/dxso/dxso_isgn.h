@@ -29,8 +29,17 @@ namespace dxvk {
 
   using DxsoDefinedConstants = std::vector<DxsoDefinedConstant>;
 
+  /**
+   * \brief Float constant gather table
+   *
+   * Maps compact constant buffer slots to the
+   * application-visible float constant registers.
+   */
+  using DxsoConstantGatherTable = std::vector<uint32_t>;
+
   struct DxsoShaderMetaInfo {
     bool needsConstantCopies = false;
+    bool compactConstantsF = false;
     uint32_t maxConstIndexF = 0;
     uint32_t maxConstIndexI = 0;
     uint32_t maxConstIndexB = 0;
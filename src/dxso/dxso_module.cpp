@@ -25,7 +25,8 @@ namespace dxvk {
     const DxsoModuleInfo&     moduleInfo,
     const std::string&        fileName,
     const DxsoAnalysisInfo&   analysis,
-    const D3D9ConstantLayout& layout) {
+    const D3D9ConstantLayout& layout,
+          D3D9CachedShader*   pCachedShader) {
     auto compiler = std::make_unique<DxsoCompiler>(
       fileName, moduleInfo,
       m_header.info(), analysis,
@@ -36,6 +37,7 @@ namespace dxvk {
 
     m_meta                 = compiler->meta();
     m_constants            = compiler->constants();
+    m_constantGatherTable  = compiler->constantGatherTable();
     m_maxDefinedFloatConst = compiler->maxDefinedFloatConstant();
     m_maxDefinedIntConst   = compiler->maxDefinedIntConstant();
     m_maxDefinedBoolConst  = compiler->maxDefinedBoolConstant();
@@ -49,7 +51,7 @@ namespace dxvk {
     // after that.
     m_usedRTs = compiler->usedRTs();
 
-    return compiler->compile();
+    return compiler->compile(pCachedShader);
   }
 
   void DxsoModule::runAnalyzer(
@@ -17,6 +17,7 @@ namespace dxvk {
   class DxsoCompiler;
   class DxsoCode;
   struct DxsoModuleInfo;
+  struct D3D9CachedShader;
 
   /**
    * \brief DXSO shader module, a d3d9 shader object.
@@ -39,13 +40,15 @@ namespace dxvk {
      * \param [in] moduleInfo DXSO module info
      * \param [in] fileName File name, will be added to
      *        the compiled SPIR-V for debugging purposes.
+     * \param [out] pCachedShader Optional shader cache data
      * \returns The compiled shader object
      */
     Rc<DxvkShader> compile(
       const DxsoModuleInfo&     moduleInfo,
       const std::string&        fileName,
       const DxsoAnalysisInfo&   analysis,
-      const D3D9ConstantLayout& layout);
+      const D3D9ConstantLayout& layout,
+            D3D9CachedShader*   pCachedShader);
 
     const DxsoIsgn& isgn() {
       return m_isgn;
@@ -55,6 +58,8 @@ namespace dxvk {
 
     const DxsoDefinedConstants& constants() { return m_constants; }
 
+    const DxsoConstantGatherTable& constantGatherTable() { return m_constantGatherTable; }
+
     uint32_t usedSamplers() { return m_usedSamplers; }
 
     uint32_t usedRTs() { return m_usedRTs; }
@@ -91,6 +96,8 @@ namespace dxvk {
     int32_t              m_maxDefinedBoolConst = -1;
     DxsoDefinedConstants m_constants;
 
+    DxsoConstantGatherTable m_constantGatherTable;
+
   };
 
 }
\ No newline at end of file
@@ -9,7 +9,7 @@
 namespace dxvk {
 
   DxvkPageAllocator::DxvkPageAllocator() {
-
+    m_freeLists.fill(-1);
   }
 
 
@@ -18,6 +18,28 @@ namespace dxvk {
   }
 
 
+  template<typename Fn>
+  void DxvkPageAllocator::forEachFreeRange(uint32_t chunkIndex, const Fn& fn) const {
+    // Free ranges are marked in the look-up table by their first page
+    // pointing to itself. Allocated pages are skipped one at a time,
+    // which is fine since this is only used on rare occasions.
+    uint32_t pageIndex = chunkIndex << ChunkPageBits;
+    uint32_t pageEnd = pageIndex + m_chunks[chunkIndex].pageCount;
+
+    while (pageIndex < pageEnd) {
+      const auto& page = m_pages[pageIndex];
+
+      if (page.head == int32_t(pageIndex)) {
+        uint32_t count = page.count;
+        fn(pageIndex, count);
+        pageIndex += count;
+      } else {
+        pageIndex += 1u;
+      }
+    }
+  }
+
+
   int64_t DxvkPageAllocator::alloc(uint64_t size, uint64_t alignment) {
     uint32_t pageCount = (size + PageSize - 1u) / PageSize;
     uint32_t pageAlign = (alignment + PageSize - 1u) / PageSize;
@@ -27,60 +49,36 @@ namespace dxvk {
 
 
   int32_t DxvkPageAllocator::allocPages(uint32_t count, uint32_t alignment) {
-    int32_t index = searchFreeList(count);
-
-    while (index--) {
-      PageRange entry = m_freeList[index];
-
-      // The chunk index is the same regardless of alignment.
-      // Skip chunk if it does not accept new allocations.
-      uint32_t chunkIndex = entry.index >> ChunkPageBits;
+    alignment = std::max(alignment, 1u);
 
-      if (unlikely(m_chunks[chunkIndex].disabled))
-        continue;
+    // Any free range that can hold the padding required for alignment
+    // in addition to the actual allocation will do. If there is none,
+    // fall back to checking free ranges that may fit individually.
+    int32_t index = findFreeRange(count + alignment - 1u);
 
-      if (likely(!(entry.index & (alignment - 1u)))) {
-        // If the current free range is sufficiently aligned, we can use
-        // it as-is and simply modify the remaining free list entry.
-        uint32_t pageIndex = entry.index;
+    if (unlikely(index < 0)) {
+      index = searchFreeRange(count, alignment);
 
-        entry.index += count;
-        entry.count -= count;
-
-        insertFreeRange(entry, index);
-
-        m_chunks[chunkIndex].pagesUsed += count;
-        return pageIndex;
-      } else {
-        // Apply alignment and skip if the free range is too small.
-        uint32_t pageIndex = align(entry.index, alignment);
-
-        if (pageIndex + count > entry.index + entry.count)
-          continue;
-
-        // Insert free range before the first allocated page,
-        // guaranteed to be non-empty at this point.
-        PageRange prevRange = { };
-        prevRange.index = entry.index;
-        prevRange.count = pageIndex - entry.index;
-
-        insertFreeRange(prevRange, index);
+      if (index < 0)
+        return -1;
+    }
 
-        // Insert free range after the last allocated page.
-        PageRange nextRange = { };
-        nextRange.index = pageIndex + count;
-        nextRange.count = entry.index + entry.count - nextRange.index;
+    uint32_t rangeIndex = uint32_t(index);
+    uint32_t rangeEnd = rangeIndex + m_pages[rangeIndex].count;
+    uint32_t pageIndex = align(rangeIndex, alignment);
 
-        if (nextRange.count)
-          insertFreeRange(nextRange, -1);
+    removeFreeRange(rangeIndex);
 
-        m_chunks[chunkIndex].pagesUsed += count;
+    // Return any pages before and after the allocated
+    // region to the free list as separate ranges.
+    if (pageIndex > rangeIndex)
+      insertFreeRange(rangeIndex, pageIndex - rangeIndex);
 
-        return pageIndex;
-      }
-    }
+    if (pageIndex + count < rangeEnd)
+      insertFreeRange(pageIndex + count, rangeEnd - pageIndex - count);
 
-    return -1;    
+    m_chunks[rangeIndex >> ChunkPageBits].pagesUsed += count;
+    return int32_t(pageIndex);
   }
 
 
@@ -93,60 +91,32 @@ namespace dxvk {
 
 
   bool DxvkPageAllocator::freePages(uint32_t index, uint32_t count) {
-    // Use the lookup table to quickly determine which
-    // free ranges we can actually merge with
-    int32_t prevRange = -1;
-    int32_t nextRange = -1;
-
-    if (index & ChunkPageMask)
-      prevRange = m_freeListLutByPage[index - 1];
-
-    if ((index + count) & ChunkPageMask)
-      nextRange = m_freeListLutByPage[index + count];
-
-    if (prevRange < 0) {
-      if (nextRange < 0) {
-        // No adjacent range, need to insert a new one
-        PageRange range = { };
-        range.index = index;
-        range.count = count;
+    // Use the per-page look-up table to quickly determine which free
+    // ranges we can merge with. Any free page adjacent to an allocated
+    // page is guaranteed to be the first or last page of its range.
+    uint32_t rangeIndex = index;
+    uint32_t rangeEnd = index + count;
+
+    if (index & ChunkPageMask) {
+      int32_t prevRange = m_pages[index - 1u].head;
+
+      if (prevRange >= 0) {
+        rangeIndex = uint32_t(prevRange);
+        removeFreeRange(rangeIndex);
+      }
+    }
 
-        insertFreeRange(range, -1);
-      } else {
-        // One adjacent range after the current one
-        PageRange range = m_freeList[nextRange];
-        range.index = index;
-        range.count += count;
+    if (rangeEnd & ChunkPageMask) {
+      int32_t nextRange = m_pages[rangeEnd].head;
 
-        insertFreeRange(range, nextRange);
+      if (nextRange >= 0) {
+        rangeEnd += m_pages[nextRange].count;
+        removeFreeRange(uint32_t(nextRange));
       }
-    } else if (nextRange < 0) {
-        // One adjacent range before the current one
-      PageRange range = m_freeList[prevRange];
-      range.count += count;
-
-      insertFreeRange(range, prevRange);
-    } else {
-      // Two adjacent ranges, need to merge with both
-      // and replace one while removing the other.
-      PageRange prev = m_freeList[prevRange];
-      PageRange next = m_freeList[nextRange];
-
-      PageRange mergedRange = { };
-      mergedRange.index = prev.index;
-      mergedRange.count = next.index + next.count - prev.index;
-
-      PageRange emptyRange = { };
-
-      // Remove the range at the higher index, then replace the one at the
-      // lower index with the merged range. The order is important here since
-      // having overlapping entries in the free list would cause issues for
-      // the look-up table, and using the correct indices is important since
-      // the index for the second operation could otherwise be invalidated.
-      insertFreeRange(emptyRange, std::max(prevRange, nextRange));
-      insertFreeRange(mergedRange, std::min(prevRange, nextRange));
     }
 
+    insertFreeRange(rangeIndex, rangeEnd - rangeIndex);
+
     uint32_t chunkIndex = index >> ChunkPageBits;
     return !(m_chunks[chunkIndex].pagesUsed -= count);
   }
@@ -158,7 +128,7 @@ namespace dxvk {
     if (chunkIndex < 0) {
       chunkIndex = m_chunks.size();
 
-      m_freeListLutByPage.resize((chunkIndex + 1u) << ChunkPageBits, -1);
+      m_pages.resize((chunkIndex + 1u) << ChunkPageBits);
       m_chunks.emplace_back();
     }
 
@@ -170,11 +140,8 @@ namespace dxvk {
     chunk.nextChunk = -1;
     chunk.disabled = false;
 
-    PageRange pageRange = { };
-    pageRange.index = uint32_t(chunkIndex) << ChunkPageBits;
-    pageRange.count = chunk.pageCount;
-
-    insertFreeRange(pageRange, -1);
+    if (chunk.pageCount)
+      insertFreeRange(uint32_t(chunkIndex) << ChunkPageBits, chunk.pageCount);
 
     return uint32_t(chunkIndex);
   }
@@ -182,28 +149,46 @@ namespace dxvk {
 
   void DxvkPageAllocator::removeChunk(uint32_t chunkIndex) {
     auto& chunk = m_chunks[chunkIndex];
+
+    // The entire chunk is unused, so it consists of one single free
+    // range. This must be removed before the chunk gets disabled.
+    if (chunk.pageCount)
+      removeFreeRange(chunkIndex << ChunkPageBits);
+
     chunk.pageCount = 0u;
     chunk.pagesUsed = 0u;
     chunk.nextChunk = std::exchange(m_freeChunk, int32_t(chunkIndex));
     chunk.disabled = true;
+  }
 
-    uint32_t pageIndex = chunkIndex << ChunkPageBits;
 
-    PageRange pageRange = { };
-    pageRange.index = pageIndex;
-    pageRange.count = 0;
+  void DxvkPageAllocator::killChunk(uint32_t chunkIndex) {
+    auto& chunk = m_chunks[chunkIndex];
 
-    insertFreeRange(pageRange, m_freeListLutByPage[pageIndex]);
-  }
+    if (chunk.disabled)
+      return;
 
+    // Take all free ranges of the chunk out of the size class lists
+    // so that allocations never have to skip over disabled chunks.
+    forEachFreeRange(chunkIndex, [this] (uint32_t index, uint32_t) {
+      unlinkFreeRange(index);
+    });
 
-  void DxvkPageAllocator::killChunk(uint32_t chunkIndex) {
-    m_chunks[chunkIndex].disabled = true;
+    chunk.disabled = true;
   }
 
 
   void DxvkPageAllocator::reviveChunk(uint32_t chunkIndex) {
-    m_chunks[chunkIndex].disabled = false;
+    auto& chunk = m_chunks[chunkIndex];
+
+    if (!chunk.disabled)
+      return;
+
+    chunk.disabled = false;
+
+    forEachFreeRange(chunkIndex, [this] (uint32_t index, uint32_t) {
+      linkFreeRange(index);
+    });
   }
 
 
@@ -212,7 +197,7 @@ namespace dxvk {
 
     for (uint32_t i = 0; i < m_chunks.size(); i++) {
       if (m_chunks[i].pageCount && m_chunks[i].disabled) {
-        m_chunks[i].disabled = false;
+        reviveChunk(i);
         count += 1u;
       }
     }
@@ -234,124 +219,189 @@ namespace dxvk {
     if (lastCount)
       pageMask[fullCount] = (1u << lastCount) - 1u;
 
-    // Iterate over free list and set all pages included
-    // in the current chunk to 0.
-    for (PageRange range : m_freeList) {
-      if ((range.index >> ChunkPageBits) != chunkIndex)
-        continue;
+    // Iterate over free ranges in the current chunk
+    // and set all pages included in them to 0.
+    forEachFreeRange(chunkIndex, [pageMask] (uint32_t rangeIndex, uint32_t rangeCount) {
+      rangeIndex &= ChunkPageMask;
 
-      range.index &= ChunkPageMask;
+      uint32_t index = rangeIndex / 32u;
+      uint32_t shift = rangeIndex % 32u;
 
-      uint32_t index = range.index / 32u;
-      uint32_t shift = range.index % 32u;
-
-      if (shift + range.count < 32u) {
+      if (shift + rangeCount < 32u) {
         // Entire free range fits in one single mask
-        pageMask[index] ^= ((1u << range.count) - 1u) << shift;
+        pageMask[index] ^= ((1u << rangeCount) - 1u) << shift;
       } else {
         if (shift) {
           pageMask[index++] ^= ~0u << shift;
-          range.count -= 32u - shift;
+          rangeCount -= 32u - shift;
         }
 
-        while (range.count >= 32u) {
+        while (rangeCount >= 32u) {
           pageMask[index++] = 0u;
-          range.count -= 32u;
+          rangeCount -= 32u;
         }
 
-        if (range.count)
-          pageMask[index++] &= ~0u << range.count;
+        if (rangeCount)
+          pageMask[index++] &= ~0u << rangeCount;
       }
-    }
+    });
   }
 
 
-  int32_t DxvkPageAllocator::searchFreeList(uint32_t count) {
-    // Find the insertion index of a free list entry with the given page count.
-    // All entries with an index lower than but not equal to the return value
-    // will have a page count greater than or equal to count.
-    if (unlikely(m_freeList.empty()))
-      return 0u;
+  int32_t DxvkPageAllocator::findFreeRange(uint32_t count) const {
+    // Round the page count up to the next size class boundary, so
+    // that every free range in the resulting class is large enough.
+    if (count >= SecondLevelCount)
+      count += (1u << (31u - bit::lzcnt(count) - SecondLevelBits)) - 1u;
+
+    SizeClass sizeClass = getSizeClass(count);
 
-    // Do a binary search, but optimize for the common
-    // case where we request a small page count
-    uint32_t lo = 0u;
-    uint32_t hi = m_freeList.size();
+    if (unlikely(sizeClass.firstLevel >= FirstLevelCount))
+      return -1;
+
+    uint32_t firstLevel = sizeClass.firstLevel;
+    uint32_t secondLevelMask = m_secondLevelMasks[firstLevel] & (~0u << sizeClass.secondLevel);
 
-    if (count <= m_freeList.back().count)
-      return int32_t(hi);
+    if (!secondLevelMask) {
+      uint32_t firstLevelMask = m_firstLevelMask & (~1u << firstLevel);
 
-    while (lo < hi) {
-      uint32_t mid = (lo + hi) / 2u;
+      if (!firstLevelMask)
+        return -1;
 
-      if (count <= m_freeList[mid].count)
-        lo = mid + 1;
-      else
-        hi = mid;
+      firstLevel = bit::tzcnt(firstLevelMask);
+      secondLevelMask = m_secondLevelMasks[firstLevel];
     }
 
-    return int32_t(lo);
+    uint32_t secondLevel = bit::tzcnt(secondLevelMask);
+    return m_freeLists[firstLevel * SecondLevelCount + secondLevel];
   }
 
 
-  void DxvkPageAllocator::addLutEntry(const PageRange& range, int32_t index) {
-    m_freeListLutByPage[range.index] = index;
-    m_freeListLutByPage[range.index + range.count - 1u] = index;
+  int32_t DxvkPageAllocator::searchFreeRange(uint32_t count, uint32_t alignment) const {
+    // Free ranges in the size class of the requested page count as well
+    // as aligned allocations may not fit, so check each range that can
+    // potentially hold the allocation. This is slow, but rarely needed.
+    SizeClass sizeClass = getSizeClass(count);
+
+    if (unlikely(sizeClass.firstLevel >= FirstLevelCount))
+      return -1;
+
+    uint32_t firstLevel = sizeClass.firstLevel;
+    uint32_t firstLevelMask = m_firstLevelMask & (~1u << firstLevel);
+    uint32_t secondLevelMask = m_secondLevelMasks[firstLevel] & (~0u << sizeClass.secondLevel);
+
+    while (true) {
+      while (secondLevelMask) {
+        uint32_t secondLevel = bit::tzcnt(secondLevelMask);
+        int32_t index = m_freeLists[firstLevel * SecondLevelCount + secondLevel];
+
+        while (index >= 0) {
+          uint32_t rangeEnd = uint32_t(index) + m_pages[index].count;
+
+          if (align(uint32_t(index), alignment) + count <= rangeEnd)
+            return index;
+
+          index = m_pages[index].next;
+        }
+
+        secondLevelMask &= secondLevelMask - 1u;
+      }
+
+      if (!firstLevelMask)
+        return -1;
+
+      firstLevel = bit::tzcnt(firstLevelMask);
+      firstLevelMask &= firstLevelMask - 1u;
+
+      secondLevelMask = m_secondLevelMasks[firstLevel];
+    }
   }
 
 
-  void DxvkPageAllocator::removeLutEntry(const PageRange& range) {
-    m_freeListLutByPage[range.index] = -1;
-    m_freeListLutByPage[range.index + range.count - 1u] = -1;
+  void DxvkPageAllocator::insertFreeRange(uint32_t index, uint32_t count) {
+    m_pages[index].count = count;
+    m_pages[index].head = int32_t(index);
+    m_pages[index + count - 1u].head = int32_t(index);
+
+    // Free ranges in disabled chunks are kept out of the size class
+    // lists, but can still be merged with adjacent ranges as usual.
+    if (likely(!m_chunks[index >> ChunkPageBits].disabled))
+      linkFreeRange(index);
   }
 
 
-  void DxvkPageAllocator::insertFreeRange(PageRange newRange, int32_t currentIndex) {
-    size_t count = m_freeList.size();
-    size_t index = size_t(currentIndex);
+  void DxvkPageAllocator::removeFreeRange(uint32_t index) {
+    uint32_t count = m_pages[index].count;
 
-    if (unlikely(currentIndex < 0)) {
-      m_freeList.emplace_back();
-      index = count++;
-    }
+    if (likely(!m_chunks[index >> ChunkPageBits].disabled))
+      unlinkFreeRange(index);
 
-    // Remove old range from the LUT since it gets replaced
-    PageRange oldRange = m_freeList[index];
+    m_pages[index].count = 0u;
+    m_pages[index].head = -1;
+    m_pages[index + count - 1u].head = -1;
+  }
 
-    if (likely(oldRange.count))
-      removeLutEntry(oldRange);
 
-    // Move range within the free list until the proper ordering
-    // is restored again and update LUT entries for all ranges we
-    // move in the process.
-    if (newRange.count < oldRange.count) {
-      while (index + 1u < count) {
-        PageRange next = m_freeList[index + 1u];
+  void DxvkPageAllocator::linkFreeRange(uint32_t index) {
+    auto& page = m_pages[index];
 
-        if (newRange.count >= next.count)
-          break;
+    SizeClass sizeClass = getSizeClass(page.count);
+    int32_t& list = m_freeLists[sizeClass.firstLevel * SecondLevelCount + sizeClass.secondLevel];
 
-        addLutEntry(next, index);
-        m_freeList[index++] = next;
-      }
-    } else if (newRange.count > oldRange.count) {
-      while (index) {
-        PageRange prev = m_freeList[index - 1u];
+    page.prev = -1;
+    page.next = list;
+
+    if (page.next >= 0)
+      m_pages[page.next].prev = int32_t(index);
+
+    list = int32_t(index);
+
+    m_firstLevelMask |= 1u << sizeClass.firstLevel;
+    m_secondLevelMasks[sizeClass.firstLevel] |= 1u << sizeClass.secondLevel;
+  }
+
+
+  void DxvkPageAllocator::unlinkFreeRange(uint32_t index) {
+    auto& page = m_pages[index];
+
+    if (page.next >= 0)
+      m_pages[page.next].prev = page.prev;
+
+    if (page.prev >= 0) {
+      m_pages[page.prev].next = page.next;
+    } else {
+      SizeClass sizeClass = getSizeClass(page.count);
+      m_freeLists[sizeClass.firstLevel * SecondLevelCount + sizeClass.secondLevel] = page.next;
 
-        if (newRange.count <= prev.count)
-          break;
+      // Update bit masks if the size class is now empty
+      if (page.next < 0) {
+        uint32_t& secondLevelMask = m_secondLevelMasks[sizeClass.firstLevel];
+        secondLevelMask &= ~(1u << sizeClass.secondLevel);
 
-        addLutEntry(prev, index);
-        m_freeList[index--] = prev;
+        if (!secondLevelMask)
+          m_firstLevelMask &= ~(1u << sizeClass.firstLevel);
       }
     }
 
-    if (newRange.count) {
-      m_freeList[index] = newRange;
-      addLutEntry(newRange, index);
+    page.prev = -1;
+    page.next = -1;
+  }
+
+
+  DxvkPageAllocator::SizeClass DxvkPageAllocator::getSizeClass(uint32_t count) {
+    SizeClass result = { };
+
+    if (count < SecondLevelCount) {
+      // Small ranges use one size class per page count
+      result.secondLevel = count;
     } else {
-      m_freeList.pop_back();
+      uint32_t msb = 31u - bit::lzcnt(count);
+
+      result.firstLevel = msb - SecondLevelBits + 1u;
+      result.secondLevel = (count >> (msb - SecondLevelBits)) - SecondLevelCount;
     }
+
+    return result;
   }
 
 
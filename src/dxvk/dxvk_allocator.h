@@ -13,11 +13,14 @@ namespace dxvk {
   /**
    * \brief Page allocator
    *
-   * Implements a best-fit allocation strategy for coarse allocations
-   * using an ordered free list. While allocating and freeing memory
-   * are both linear in the worst case, minimum-size allocations can
-   * generally be performed in constant time, with larger allocations
-   * getting gradually slower.
+   * Implements a two-level segregated fit allocation strategy for
+   * coarse allocations. Free ranges are sorted into size classes,
+   * with one bit mask per level indicating which of those classes
+   * are non-empty, so that a suitable free range can be found with
+   * two bit scans. Allocating and freeing memory are both performed
+   * in constant time, unless no size class is guaranteed to satisfy
+   * the allocation, in which case allocation falls back to checking
+   * individual free ranges that may be large enough.
    */
   class DxvkPageAllocator {
 
@@ -187,24 +190,56 @@ namespace dxvk {
       bool      disabled  = false;
     };
 
-    struct PageRange {
-      uint32_t  index = 0u;
+    /// Number of second-level size classes per first-level class. Free
+    /// ranges smaller than this are sorted into exact size classes.
+    constexpr static uint32_t SecondLevelBits = 4u;
+    constexpr static uint32_t SecondLevelCount = 1u << SecondLevelBits;
+
+    /// Number of first-level size classes. Must be large enough to
+    /// accommodate free ranges covering an entire chunk.
+    constexpr static uint32_t FirstLevelCount = ChunkPageBits - SecondLevelBits + 2u;
+
+    struct PageInfo {
+      /// Page count of the free range, only valid for its first page
       uint32_t  count = 0u;
+      /// Previous and next free range in the same size class
+      int32_t   prev  = -1;
+      int32_t   next  = -1;
+      /// First page of the free range that starts or ends
+      /// at this page, or -1 if this is not the case.
+      int32_t   head  = -1;
+    };
+
+    struct SizeClass {
+      uint32_t  firstLevel  = 0u;
+      uint32_t  secondLevel = 0u;
     };
 
-    std::vector<PageRange>  m_freeList;
-    std::vector<int32_t>    m_freeListLutByPage;
+    std::vector<PageInfo>   m_pages;
+
+    uint32_t                m_firstLevelMask = 0u;
+    std::array<uint32_t, FirstLevelCount> m_secondLevelMasks = { };
+    std::array<int32_t, FirstLevelCount * SecondLevelCount> m_freeLists;
 
     std::vector<ChunkInfo>  m_chunks;
     int32_t                 m_freeChunk = -1;
 
-    int32_t searchFreeList(uint32_t count);
+    int32_t findFreeRange(uint32_t count) const;
+
+    int32_t searchFreeRange(uint32_t count, uint32_t alignment) const;
+
+    void insertFreeRange(uint32_t index, uint32_t count);
+
+    void removeFreeRange(uint32_t index);
+
+    void linkFreeRange(uint32_t index);
 
-    void addLutEntry(const PageRange& range, int32_t index);
+    void unlinkFreeRange(uint32_t index);
 
-    void removeLutEntry(const PageRange& range);
+    template<typename Fn>
+    void forEachFreeRange(uint32_t chunkIndex, const Fn& fn) const;
 
-    void insertFreeRange(PageRange newRange, int32_t currentIndex);
+    static SizeClass getSizeClass(uint32_t count);
 
   };
 
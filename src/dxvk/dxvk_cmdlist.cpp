@@ -387,6 +387,9 @@ namespace dxvk {
   
   
   void DxvkCommandList::finalize() {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     // Record commands to upload descriptors if necessary, and
     // reset the descriptor range to not keep it alive for too
     // long. Descriptor ranges are tracked when bound.
@@ -419,6 +422,9 @@ namespace dxvk {
 
 
   void DxvkCommandList::next() {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     bool push = m_cmd.sparseBind || m_cmd.execCommands;
 
     for (uint32_t i = 0; i < m_cmd.cmdBuffers.size(); i++) {
@@ -857,6 +863,9 @@ namespace dxvk {
 
   void DxvkCommandList::beginSecondaryCommandBuffer(
           VkCommandBufferInheritanceInfo inheritanceInfo) {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     VkCommandBufferInheritanceDescriptorHeapInfoEXT heapInheritance = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_DESCRIPTOR_HEAP_INFO_EXT };
 
     VkBindHeapInfoEXT samplerHeap = { };
@@ -926,6 +935,9 @@ namespace dxvk {
 
 
   void DxvkCommandList::rebindSamplerHeap() {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     // Secondary command buffer must not be active when this gets called
     for (uint32_t i = uint32_t(DxvkCmdBuffer::ExecBuffer); i <= uint32_t(DxvkCmdBuffer::InitBarriers); i++)
       bindSamplerHeap(m_cmd.cmdBuffers[i]);
@@ -933,6 +945,9 @@ namespace dxvk {
 
 
   void DxvkCommandList::rebindResourceHeap() {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     // Secondary command buffer must not be active when this gets called
     for (uint32_t i = uint32_t(DxvkCmdBuffer::ExecBuffer); i <= uint32_t(DxvkCmdBuffer::InitBarriers); i++)
       bindResourceHeap(m_cmd.cmdBuffers[i]);
@@ -940,6 +955,9 @@ namespace dxvk {
 
 
   void DxvkCommandList::rebindDescriptorBuffers() {
+    if (m_queuedDraws.drawCount)
+      flushDraws();
+
     // Secondary command buffer must not be active when this gets called
     for (uint32_t i = uint32_t(DxvkCmdBuffer::ExecBuffer); i <= uint32_t(DxvkCmdBuffer::InitBuffer); i++)
       bindDescriptorBuffers(m_cmd.cmdBuffers[i]);
@@ -993,6 +1011,38 @@ namespace dxvk {
   }
 
 
+  void DxvkCommandList::flushDraws() {
+    VkCommandBuffer cmdBuffer = m_cmd.cmdBuffers[uint32_t(DxvkCmdBuffer::ExecBuffer)];
+
+    uint32_t drawCount = std::exchange(m_queuedDraws.drawCount, 0u);
+
+    if (m_queuedDraws.indexed) {
+      if (drawCount == 1u) {
+        const auto& draw = m_queuedDraws.indexedDraws[0u];
+
+        m_vkd->vkCmdDrawIndexed(cmdBuffer, draw.indexCount, m_queuedDraws.instanceCount,
+          draw.firstIndex, draw.vertexOffset, m_queuedDraws.firstInstance);
+      } else {
+        m_vkd->vkCmdDrawMultiIndexedEXT(cmdBuffer, drawCount, m_queuedDraws.indexedDraws.data(),
+          m_queuedDraws.instanceCount, m_queuedDraws.firstInstance, sizeof(VkMultiDrawIndexedInfoEXT), nullptr);
+      }
+    } else {
+      if (drawCount == 1u) {
+        const auto& draw = m_queuedDraws.draws[0u];
+
+        m_vkd->vkCmdDraw(cmdBuffer, draw.vertexCount, m_queuedDraws.instanceCount,
+          draw.firstVertex, m_queuedDraws.firstInstance);
+      } else {
+        m_vkd->vkCmdDrawMultiEXT(cmdBuffer, drawCount, m_queuedDraws.draws.data(),
+          m_queuedDraws.instanceCount, m_queuedDraws.firstInstance, sizeof(VkMultiDrawInfoEXT));
+      }
+    }
+
+    m_statCounters.addCtr(DxvkStatCounter::CmdDrawCalls, 1u);
+    m_statCounters.addCtr(DxvkStatCounter::CmdDrawsMerged, drawCount - 1u);
+  }
+
+
   void DxvkCommandList::endCommandBuffer(VkCommandBuffer cmdBuffer) {
     auto vk = m_device->vkd();
 
@@ -243,6 +243,8 @@ namespace dxvk {
   class DxvkCommandList : public RcObject {
     
   public:
+
+    constexpr static uint32_t MaxQueuedDraws = 256u;
     
     DxvkCommandList(DxvkDevice* device);
     ~DxvkCommandList();
@@ -873,6 +875,63 @@ namespace dxvk {
     }
 
 
+    /**
+     * \brief Queues a non-indexed draw
+     *
+     * Consecutive queued draws with the same instance parameters
+     * are merged into one multi-draw if no other command gets
+     * recorded into the execution buffer in between. Any such
+     * command will flush pending draws first. Requires support
+     * for \c VK_EXT_multi_draw with at least \c MaxQueuedDraws.
+     * \param [in] draw Draw parameters
+     */
+    void queueDraw(
+      const VkDrawIndirectCommand&  draw) {
+      if (m_queuedDraws.drawCount && (m_queuedDraws.indexed
+       || m_queuedDraws.drawCount == MaxQueuedDraws
+       || m_queuedDraws.instanceCount != draw.instanceCount
+       || m_queuedDraws.firstInstance != draw.firstInstance))
+        flushDraws();
+
+      if (!m_queuedDraws.drawCount) {
+        m_queuedDraws.indexed = false;
+        m_queuedDraws.instanceCount = draw.instanceCount;
+        m_queuedDraws.firstInstance = draw.firstInstance;
+      }
+
+      auto& entry = m_queuedDraws.draws[m_queuedDraws.drawCount++];
+      entry.firstVertex = draw.firstVertex;
+      entry.vertexCount = draw.vertexCount;
+    }
+
+
+    /**
+     * \brief Queues an indexed draw
+     *
+     * See \c queueDraw.
+     * \param [in] draw Draw parameters
+     */
+    void queueDrawIndexed(
+      const VkDrawIndexedIndirectCommand& draw) {
+      if (m_queuedDraws.drawCount && (!m_queuedDraws.indexed
+       || m_queuedDraws.drawCount == MaxQueuedDraws
+       || m_queuedDraws.instanceCount != draw.instanceCount
+       || m_queuedDraws.firstInstance != draw.firstInstance))
+        flushDraws();
+
+      if (!m_queuedDraws.drawCount) {
+        m_queuedDraws.indexed = true;
+        m_queuedDraws.instanceCount = draw.instanceCount;
+        m_queuedDraws.firstInstance = draw.firstInstance;
+      }
+
+      auto& entry = m_queuedDraws.indexedDraws[m_queuedDraws.drawCount++];
+      entry.firstIndex = draw.firstIndex;
+      entry.indexCount = draw.indexCount;
+      entry.vertexOffset = draw.vertexOffset;
+    }
+
+
     void cmdDrawIndexedIndirect(
             VkBuffer                buffer,
             VkDeviceSize            offset,
@@ -1321,15 +1380,35 @@ namespace dxvk {
 
     bool m_descriptorHeapInvalidated = false;
 
-    force_inline VkCommandBuffer getCmdBuffer() const {
+    struct {
+      bool                      indexed       = false;
+      uint32_t                  instanceCount = 0u;
+      uint32_t                  firstInstance = 0u;
+      uint32_t                  drawCount     = 0u;
+
+      // Intentionally not initialized, see drawGeneric
+      std::array<VkMultiDrawInfoEXT,        MaxQueuedDraws> draws;
+      std::array<VkMultiDrawIndexedInfoEXT, MaxQueuedDraws> indexedDraws;
+    } m_queuedDraws;
+
+    void flushDraws();
+
+    force_inline VkCommandBuffer getCmdBuffer() {
+      // Queued draws must be recorded before any other command
+      if (unlikely(m_queuedDraws.drawCount))
+        flushDraws();
+
       // Allocation logic will always provide an execution buffer
       return m_cmd.cmdBuffers[uint32_t(DxvkCmdBuffer::ExecBuffer)];
     }
 
     force_inline VkCommandBuffer getCmdBuffer(DxvkCmdBuffer cmdBuffer) {
+      if (cmdBuffer == DxvkCmdBuffer::ExecBuffer)
+        return getCmdBuffer();
+
       VkCommandBuffer buffer = m_cmd.cmdBuffers[uint32_t(cmdBuffer)];
 
-      if (likely(cmdBuffer == DxvkCmdBuffer::ExecBuffer || buffer))
+      if (likely(buffer))
         return buffer;
 
       // Allocate a new command buffer if necessary
@@ -1555,16 +1555,25 @@ namespace dxvk {
     const T*                        draws) {
     if (this->commitGraphicsState<Indexed, false>()) {
       if (count == 1u) {
-        // Most common case, just emit a single draw
-        if constexpr (Indexed) {
-          m_cmd->cmdDrawIndexed(draws->indexCount, draws->instanceCount,
-            draws->firstIndex, draws->vertexOffset, draws->firstInstance);
+        // Most common case, just emit a single draw. If the draw does not
+        // change any state, the command list will merge it with the last
+        // draw into a single multi-draw and count the draw calls saved.
+        if (m_features.test(DxvkContextFeature::DirectMultiDraw)) {
+          if constexpr (Indexed)
+            m_cmd->queueDrawIndexed(*draws);
+          else
+            m_cmd->queueDraw(*draws);
         } else {
-          m_cmd->cmdDraw(draws->vertexCount, draws->instanceCount,
-            draws->firstVertex, draws->firstInstance);
-        }
+          if constexpr (Indexed) {
+            m_cmd->cmdDrawIndexed(draws->indexCount, draws->instanceCount,
+              draws->firstIndex, draws->vertexOffset, draws->firstInstance);
+          } else {
+            m_cmd->cmdDraw(draws->vertexCount, draws->instanceCount,
+              draws->firstVertex, draws->firstInstance);
+          }
 
-        m_cmd->addStatCtr(DxvkStatCounter::CmdDrawCalls, 1u);
+          m_cmd->addStatCtr(DxvkStatCounter::CmdDrawCalls, 1u);
+        }
       } else if (unlikely(needsDrawBarriers())) {
         // If the current pipeline has storage resource hazards,
         // unroll draws and insert a barrier after each one.
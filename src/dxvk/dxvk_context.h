@@ -25,7 +25,7 @@ namespace dxvk {
     constexpr static VkDeviceSize MaxDiscardSizeInRp = 256u << 10u;
     constexpr static VkDeviceSize MaxDiscardSize     =  16u << 10u;
 
-    constexpr static uint32_t DirectMultiDrawBatchSize = 256u;
+    constexpr static uint32_t DirectMultiDrawBatchSize = DxvkCommandList::MaxQueuedDraws;
 
     constexpr static uint32_t MaxUnsynchronizedDraws = 64u;
   public:
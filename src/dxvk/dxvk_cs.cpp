@@ -1,3 +1,7 @@
+#include <algorithm>
+
+#include "../util/sync/sync_spinlock.h"
+
 #include "dxvk_cs.h"
 
 namespace dxvk {
@@ -87,6 +91,22 @@ namespace dxvk {
   }
   
   
+  void DxvkCsChunkPool::allocChunks(size_t count, DxvkCsChunk** chunks) {
+    size_t index = 0;
+
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+      while (index < count && !m_chunks.empty()) {
+        chunks[index++] = m_chunks.back();
+        m_chunks.pop_back();
+      }
+    }
+
+    while (index < count)
+      chunks[index++] = new DxvkCsChunk();
+  }
+
+
   void DxvkCsChunkPool::freeChunk(DxvkCsChunk* chunk) {
     chunk->reset();
     
@@ -95,91 +115,186 @@ namespace dxvk {
   }
   
   
-  DxvkCsThread::DxvkCsThread(
-    const Rc<DxvkDevice>&   device,
-    const Rc<DxvkContext>&  context)
-  : m_device(device), m_context(context),
-    m_thread([this] { threadFunc(); }) {
-    
+  void DxvkCsChunkPool::freeChunks(size_t count, DxvkCsChunk* const* chunks) {
+    if (!count)
+      return;
+
+    for (size_t i = 0; i < count; i++)
+      chunks[i]->reset();
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    m_chunks.insert(m_chunks.end(), chunks, chunks + count);
   }
-  
-  
-  DxvkCsThread::~DxvkCsThread() {
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      m_stopped.store(true);
+
+
+  DxvkCsChunkCache::DxvkCsChunkCache(
+          DxvkCsChunkPool*  pool)
+  : m_pool(pool) {
+
+  }
+
+
+  DxvkCsChunkCache::~DxvkCsChunkCache() {
+    // Chunks in the cache are not initialized, which
+    // is fine since freeing them resets them anyway
+    m_pool->freeChunks(m_count, m_chunks.data());
+  }
+
+
+  DxvkCsChunkRef DxvkCsChunkCache::allocChunk(DxvkCsChunkFlags flags) {
+    if (!m_count) {
+      m_pool->allocChunks(BatchSize, m_chunks.data());
+      m_count = BatchSize;
     }
-    
-    m_condOnAdd.notify_one();
-    m_thread.join();
+
+    DxvkCsChunk* chunk = m_chunks[--m_count];
+    chunk->init(flags);
+
+    return DxvkCsChunkRef(chunk, m_pool);
   }
   
   
-  uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
-    uint64_t seq;
+  DxvkCsChunkQueue::DxvkCsChunkQueue() {
 
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      seq = ++m_queueOrdered.seqDispatch;
+  }
 
-      auto& entry = m_queueOrdered.queue.emplace_back();
-      entry.chunk = std::move(chunk);
-      entry.seq = seq;
 
-      m_condOnAdd.notify_one();
+  DxvkCsChunkQueue::~DxvkCsChunkQueue() {
+
+  }
+
+
+  uint64_t DxvkCsChunkQueue::push(
+          DxvkCsChunkRef&&      chunk,
+          bool                  counted) {
+    std::lock_guard lock(m_lock);
+
+    uint64_t seq = 0u;
+
+    if (counted) {
+      seq = m_seqDispatch.load(std::memory_order_relaxed) + 1u;
+      m_seqDispatch.store(seq, std::memory_order_release);
     }
-    
+
+    auto& entry = m_queue.emplace_back();
+    entry.chunk = std::move(chunk);
+    entry.seq = seq;
+
+    m_pending.store(true, std::memory_order_release);
     return seq;
   }
 
 
-  void DxvkCsThread::injectChunk(DxvkCsQueue queue, DxvkCsChunkRef&& chunk, bool synchronize) {
-    uint64_t timeline = 0u;
+  bool DxvkCsChunkQueue::pop(
+          DxvkCsQueuedChunk&    entry) {
+    if (m_localIndex >= m_local.size()) {
+      if (!m_pending.load(std::memory_order_acquire))
+        return false;
 
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      auto& q = getQueue(queue);
+      // All chunks in the local list have been moved
+      // from already, so we can just recycle the list
+      m_local.clear();
+      m_localIndex = 0u;
 
-      if (synchronize)
-        timeline = ++q.seqDispatch;
+      std::lock_guard lock(m_lock);
+      std::swap(m_local, m_queue);
 
-      auto& entry = q.queue.emplace_back();
-      entry.chunk = std::move(chunk);
-      entry.seq = timeline;
+      m_pending.store(false, std::memory_order_relaxed);
+    }
 
-      m_condOnAdd.notify_one();
+    entry = std::move(m_local[m_localIndex++]);
+    return true;
+  }
 
-      if (queue == DxvkCsQueue::HighPriority) {
-        // Worker will check this flag after executing any
-        // chunk without causing additional lock contention
-        m_hasHighPrio.store(true, std::memory_order_release);
+
+  /**
+   * \brief Adaptive spin-wait
+   *
+   * Spins for a limited number of iterations until the given condition
+   * is met. The spin count grows if spinning succeeded and shrinks if
+   * it did not, so that threads that would have to wait for a long time
+   * anyway go to sleep quickly.
+   * \param [in,out] spinCount Current spin count
+   * \param [in] fn Condition to test
+   * \returns \c true if the condition was met
+   */
+  template<typename Fn>
+  static bool spinWait(std::atomic<uint32_t>& spinCount, const Fn& fn) {
+    constexpr uint32_t MinSpinCount = 16u;
+    constexpr uint32_t MaxSpinCount = 4096u;
+
+    uint32_t count = spinCount.load(std::memory_order_relaxed);
+
+    for (uint32_t i = 0u; i < count; i++) {
+      if (fn()) {
+        spinCount.store(std::min(count * 2u, MaxSpinCount), std::memory_order_relaxed);
+        return true;
       }
+
+      sync::pause();
     }
 
-    if (synchronize) {
-      std::unique_lock<dxvk::mutex> lock(m_counterMutex);
+    spinCount.store(std::max(count / 2u, MinSpinCount), std::memory_order_relaxed);
+    return fn();
+  }
 
-      m_condOnSync.wait(lock, [this, queue, timeline] {
-        return getCounter(queue).load(std::memory_order_acquire) >= timeline;
-      });
+
+  DxvkCsThread::DxvkCsThread(
+    const Rc<DxvkDevice>&   device,
+    const Rc<DxvkContext>&  context,
+          bool              asyncCleanup)
+  : m_device(device), m_context(context) {
+    if (asyncCleanup)
+      m_cleanupThread = dxvk::thread([this] { runCleanup(); });
+
+    m_thread = dxvk::thread([this] { threadFunc(); });
+  }
+  
+  
+  DxvkCsThread::~DxvkCsThread() {
+    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_stopped.store(true);
+    }
+    
+    m_condOnAdd.notify_one();
+    m_thread.join();
+
+    if (m_cleanupThread.joinable()) {
+      { std::unique_lock<dxvk::mutex> lock(m_cleanupMutex);
+        m_cleanupStopped = true;
+      }
+
+      m_cleanupCond.notify_one();
+      m_cleanupThread.join();
     }
   }
+  
+  
+  uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
+    return pushChunk(DxvkCsQueue::Ordered, std::move(chunk), true);
+  }
+
+
+  void DxvkCsThread::injectChunk(DxvkCsQueue queue, DxvkCsChunkRef&& chunk, bool synchronize) {
+    uint64_t timeline = pushChunk(queue, std::move(chunk), synchronize);
+
+    if (synchronize)
+      waitForSequenceNumber(queue, timeline);
+  }
 
 
   void DxvkCsThread::synchronize(uint64_t seq) {
     // Avoid locking if we know the sync is a no-op, may
     // reduce overhead if this is being called frequently
     if (seq > m_seqOrdered.load(std::memory_order_acquire)) {
-      // We don't need to lock the queue here, if synchronization
-      // happens while another thread is submitting then there is
-      // an inherent race anyway
+      // If synchronization happens while another thread is
+      // submitting then there is an inherent race anyway
       if (seq == SynchronizeAll)
-        seq = m_queueOrdered.seqDispatch;
+        seq = m_queueOrdered.lastSequenceNumber();
 
       auto t0 = dxvk::high_resolution_clock::now();
 
-      { std::unique_lock<dxvk::mutex> lock(m_counterMutex);
-        m_condOnSync.wait(lock, [this, seq] {
-          return m_seqOrdered.load(std::memory_order_acquire) >= seq;
-        });
-      }
+      waitForSequenceNumber(DxvkCsQueue::Ordered, seq);
 
       auto t1 = dxvk::high_resolution_clock::now();
       auto ticks = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
@@ -188,86 +303,202 @@ namespace dxvk {
       m_device->addStatCtr(DxvkStatCounter::CsSyncTicks, ticks.count());
     }
   }
-  
-  
-  void DxvkCsThread::threadFunc() {
-    env::setThreadName("dxvk-cs");
 
-    // Local chunk queues, we use two queues and swap between
-    // them in order to potentially reduce lock contention.
-    std::vector<DxvkCsQueuedChunk> ordered;
-    std::vector<DxvkCsQueuedChunk> highPrio;
 
-    try {
-      while (!m_stopped.load()) {
-        { std::unique_lock<dxvk::mutex> lock(m_mutex);
+  uint64_t DxvkCsThread::pushChunk(
+          DxvkCsQueue       queue,
+          DxvkCsChunkRef&&  chunk,
+          bool              counted) {
+    uint64_t seq = getQueue(queue).push(std::move(chunk), counted);
 
-          auto pred = [this] { return
-              !m_queueOrdered.queue.empty()
-              || !m_queueHighPrio.queue.empty()
-              || m_stopped.load();
-          };
+    // Pairs with the fence in waitForChunks, ensures that either
+    // we see the worker going idle, or the worker sees the chunk.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-          if (unlikely(!pred())) {
-            auto t0 = dxvk::high_resolution_clock::now();
+    if (m_idle.load(std::memory_order_relaxed)) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_condOnAdd.notify_one();
+    }
 
-            m_condOnAdd.wait(lock, [&] {
-              return pred();
-            });
+    return seq;
+  }
 
-            auto t1 = dxvk::high_resolution_clock::now();
-            m_device->addStatCtr(DxvkStatCounter::CsIdleTicks, std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
-          }
 
-          std::swap(ordered, m_queueOrdered.queue);
-          std::swap(highPrio, m_queueHighPrio.queue);
+  void DxvkCsThread::waitForChunks() {
+    auto pred = [this] { return
+        !m_queueOrdered.empty()
+        || !m_queueHighPrio.empty()
+        || m_stopped.load();
+    };
 
-          m_hasHighPrio.store(false, std::memory_order_release);
-        }
+    if (likely(pred()))
+      return;
+
+    auto t0 = dxvk::high_resolution_clock::now();
+
+    if (!spinWait(m_idleSpinCount, pred)) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      m_idle.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
 
-        size_t orderedIndex = 0u;
-        size_t highPrioIndex = 0u;
+      m_condOnAdd.wait(lock, [&] {
+        return pred();
+      });
 
-        while (highPrioIndex < highPrio.size() || orderedIndex < ordered.size()) {
-          // Re-fill local high-priority queue if the app has queued anything up
-          // in the meantime, we want to reduce possible synchronization delays.
-          if (highPrioIndex >= highPrio.size() && m_hasHighPrio.load(std::memory_order_acquire)) {
-            highPrio.clear();
-            highPrioIndex = 0u;
+      m_idle.store(false, std::memory_order_relaxed);
+    }
 
-            std::unique_lock<dxvk::mutex> lock(m_mutex);
-            std::swap(highPrio, m_queueHighPrio.queue);
+    auto t1 = dxvk::high_resolution_clock::now();
+    m_device->addStatCtr(DxvkStatCounter::CsIdleTicks, std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+  }
 
-            m_hasHighPrio.store(false, std::memory_order_release);
-          }
 
-          // Drain high-priority queue first
-          bool isHighPrio = highPrioIndex < highPrio.size();
-          auto& entry = isHighPrio ? highPrio[highPrioIndex++] : ordered[orderedIndex++];
+  void DxvkCsThread::waitForSequenceNumber(
+          DxvkCsQueue       queue,
+          uint64_t          seq) {
+    auto& counter = getCounter(queue);
 
-          m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+    auto pred = [&counter, seq] {
+      return counter.load(std::memory_order_acquire) >= seq;
+    };
 
-          entry.chunk->executeAll(m_context.ptr());
+    if (spinWait(m_syncSpinCount, pred))
+      return;
 
-          if (entry.seq) {
-            // Use a separate mutex for the chunk counter, this will only
-            // ever be contested if synchronization is actually necessary.
-            std::lock_guard lock(m_counterMutex);
+    std::unique_lock<dxvk::mutex> lock(m_counterMutex);
 
-            auto& counter = isHighPrio ? m_seqHighPrio : m_seqOrdered;
-            counter.store(entry.seq, std::memory_order_release);
+    m_syncWaiters += 1u;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-            m_condOnSync.notify_one();
-          }
+    m_condOnSync.wait(lock, pred);
+
+    m_syncWaiters -= 1u;
+  }
 
-          // Immediately free the chunk to release
-          // references to any resources held by it
-          entry.chunk = DxvkCsChunkRef();
+
+  void DxvkCsThread::signalSequenceNumber(
+          DxvkCsQueue       queue,
+          uint64_t          seq) {
+    getCounter(queue).store(seq, std::memory_order_release);
+
+    // Only take the lock if any thread is actually waiting, the
+    // fence pairs with the one in waitForSequenceNumber.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_syncWaiters.load(std::memory_order_relaxed)) {
+      std::lock_guard lock(m_counterMutex);
+      m_condOnSync.notify_all();
+    }
+  }
+
+
+  void DxvkCsThread::queueCleanup(
+          std::vector<DxvkCsQueuedChunk>& chunks) {
+    { std::unique_lock<dxvk::mutex> lock(m_cleanupMutex);
+
+      if (m_cleanupQueue.empty()) {
+        std::swap(m_cleanupQueue, chunks);
+      } else {
+        for (auto& chunk : chunks)
+          m_cleanupQueue.push_back(std::move(chunk));
+      }
+    }
+
+    m_cleanupCond.notify_one();
+    chunks.clear();
+  }
+
+
+  void DxvkCsThread::runCleanup() {
+    env::setThreadName("dxvk-cs-cleanup");
+
+    std::vector<DxvkCsQueuedChunk> chunks;
+    bool stopped = false;
+
+    while (!stopped) {
+      { std::unique_lock<dxvk::mutex> lock(m_cleanupMutex);
+
+        m_cleanupCond.wait(lock, [this] {
+          return !m_cleanupQueue.empty() || m_cleanupStopped;
+        });
+
+        // Process remaining chunks before exiting
+        std::swap(chunks, m_cleanupQueue);
+        stopped = m_cleanupStopped;
+      }
+
+      // Only signal the sequence number once the chunks are destroyed,
+      // so that callers synchronizing with the CS thread can still rely
+      // on all resource references being released.
+      uint64_t seq = 0u;
+
+      for (auto& entry : chunks) {
+        entry.chunk = DxvkCsChunkRef();
+        seq = std::max(seq, entry.seq);
+      }
+
+      if (seq)
+        signalSequenceNumber(DxvkCsQueue::Ordered, seq);
+
+      chunks.clear();
+    }
+  }
+
+
+  void DxvkCsThread::threadFunc() {
+    env::setThreadName("dxvk-cs");
+
+    // Number of executed chunks to pass to the
+    // cleanup thread at once, if it is enabled
+    constexpr size_t CleanupBatchSize = 16u;
+
+    std::vector<DxvkCsQueuedChunk> cleanup;
+
+    try {
+      while (!m_stopped.load()) {
+        // Hand off pending chunks before going idle so that
+        // resources do not stay alive for an extended time
+        if (!cleanup.empty() && m_queueOrdered.empty() && m_queueHighPrio.empty())
+          queueCleanup(cleanup);
+
+        waitForChunks();
+
+        // Drain the high-priority queue first, and check it again after
+        // every chunk in order to reduce possible synchronization delays.
+        DxvkCsQueuedChunk entry;
+
+        bool isHighPrio = m_queueHighPrio.pop(entry);
+
+        if (!isHighPrio && !m_queueOrdered.pop(entry))
+          continue;
+
+        m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+
+        entry.chunk->executeAll(m_context.ptr());
+
+        // Ordered chunks are destroyed by the cleanup thread if enabled,
+        // which also signals their sequence numbers. Hand off the batch
+        // early if another thread is waiting for any of them.
+        if (!isHighPrio && m_cleanupThread.joinable()) {
+          cleanup.push_back(std::move(entry));
+
+          if (cleanup.size() >= CleanupBatchSize || m_syncWaiters.load(std::memory_order_relaxed))
+            queueCleanup(cleanup);
+
+          continue;
         }
 
-        ordered.clear();
-        highPrio.clear();
+        if (entry.seq)
+          signalSequenceNumber(isHighPrio ? DxvkCsQueue::HighPriority : DxvkCsQueue::Ordered, entry.seq);
+
+        // Immediately free the chunk to release
+        // references to any resources held by it
+        entry.chunk = DxvkCsChunkRef();
       }
+
+      if (!cleanup.empty())
+        queueCleanup(cleanup);
     } catch (const DxvkError& e) {
       Logger::err("Exception on CS thread!");
       Logger::err(e.message());
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 #include "../util/thread.h"
 
@@ -378,6 +379,18 @@ namespace dxvk {
      */
     DxvkCsChunk* allocChunk(DxvkCsChunkFlags flags);
     
+    /**
+     * \brief Allocates multiple chunks
+     *
+     * Takes as many chunks from the pool as possible
+     * while only locking it once, and creates new ones
+     * as necessary. Chunks must be initialized before
+     * they can be used.
+     * \param [in] count Number of chunks to allocate
+     * \param [out] chunks Allocated chunk objects
+     */
+    void allocChunks(size_t count, DxvkCsChunk** chunks);
+
     /**
      * \brief Releases a chunk
      * 
@@ -386,6 +399,16 @@ namespace dxvk {
      */
     void freeChunk(DxvkCsChunk* chunk);
     
+    /**
+     * \brief Releases multiple chunks
+     *
+     * Resets all chunks and adds them to the
+     * pool while only locking it once.
+     * \param [in] count Number of chunks to release
+     * \param [in] chunks Chunks to release
+     */
+    void freeChunks(size_t count, DxvkCsChunk* const* chunks);
+    
   private:
     
     dxvk::mutex               m_mutex;
@@ -456,6 +479,21 @@ namespace dxvk {
       return m_chunk != nullptr;
     }
     
+    /**
+     * \brief Drops reference without freeing the chunk
+     *
+     * Can be used to return multiple chunks to the pool at once.
+     * \returns The chunk if this was the last reference to it,
+     *    in which case it must be returned to the pool by the
+     *    caller, or \c nullptr otherwise.
+     */
+    DxvkCsChunk* release() {
+      DxvkCsChunk* chunk = std::exchange(m_chunk, nullptr);
+      m_pool = nullptr;
+
+      return chunk && !chunk->decRef() ? chunk : nullptr;
+    }
+    
   private:
     
     DxvkCsChunk*      m_chunk = nullptr;
@@ -474,6 +512,46 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Chunk cache
+   *
+   * Keeps a small number of chunks around that are taken from
+   * the pool in batches, so that contexts that record a lot of
+   * chunks do not need to lock the pool for every allocation.
+   * Not thread-safe, each recording thread needs its own cache.
+   */
+  class DxvkCsChunkCache {
+    constexpr static size_t BatchSize = 16u;
+  public:
+
+    DxvkCsChunkCache(
+            DxvkCsChunkPool*  pool);
+
+    ~DxvkCsChunkCache();
+
+    DxvkCsChunkCache             (const DxvkCsChunkCache&) = delete;
+    DxvkCsChunkCache& operator = (const DxvkCsChunkCache&) = delete;
+
+    /**
+     * \brief Allocates a chunk
+     *
+     * Takes a chunk from the local cache, and refills
+     * the cache from the pool if it is empty.
+     * \param [in] flags Chunk flags
+     * \returns Allocated chunk
+     */
+    DxvkCsChunkRef allocChunk(DxvkCsChunkFlags flags);
+
+  private:
+
+    DxvkCsChunkPool*  m_pool;
+
+    size_t            m_count = 0u;
+    std::array<DxvkCsChunk*, BatchSize> m_chunks = { };
+
+  };
+
+
   /**
    * \brief Queue type
    */
@@ -495,12 +573,83 @@ namespace dxvk {
   /**
    * \brief Chunk queue
    *
-   * Stores queued chunks as well as the sequence
-   * counters for synchronization.
+   * Unbounded queue that supports multiple producers and a single
+   * consumer. Producers append chunks to a shared list protected
+   * by a spin lock, which is only ever held for a short duration.
+   * The consumer takes the entire list at once whenever its local
+   * list runs empty, so that it does not need to lock the queue
+   * for every chunk.
+   *
+   * Only chunks that need synchronization are assigned a sequence
+   * number, other chunks do not contribute to the timeline.
    */
-  struct DxvkCsChunkQueue {
-    std::vector<DxvkCsQueuedChunk> queue;
-    uint64_t                       seqDispatch = 0u;
+  class DxvkCsChunkQueue {
+
+  public:
+
+    DxvkCsChunkQueue();
+
+    ~DxvkCsChunkQueue();
+
+    DxvkCsChunkQueue             (const DxvkCsChunkQueue&) = delete;
+    DxvkCsChunkQueue& operator = (const DxvkCsChunkQueue&) = delete;
+
+    /**
+     * \brief Adds a chunk to the queue
+     *
+     * Safe to call from multiple threads concurrently.
+     * \param [in] chunk The chunk to add
+     * \param [in] counted Whether to assign a sequence number
+     * \returns Sequence number of the chunk, or 0 if
+     *    \c counted is \c false.
+     */
+    uint64_t push(
+            DxvkCsChunkRef&&      chunk,
+            bool                  counted);
+
+    /**
+     * \brief Removes the oldest chunk from the queue
+     *
+     * Must only be called from the consumer thread.
+     * \param [out] entry The chunk and its sequence number
+     * \returns \c false if the queue is empty
+     */
+    bool pop(
+            DxvkCsQueuedChunk&    entry);
+
+    /**
+     * \brief Checks whether the queue is empty
+     *
+     * Must only be called from the consumer thread.
+     * \returns \c true if no chunk can be read
+     */
+    bool empty() const {
+      return m_localIndex >= m_local.size()
+          && !m_pending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Queries sequence number of the last chunk
+     *
+     * Only considers chunks that were assigned a sequence number.
+     * \returns Sequence number of last added chunk
+     */
+    uint64_t lastSequenceNumber() const {
+      return m_seqDispatch.load(std::memory_order_acquire);
+    }
+
+  private:
+
+    alignas(CACHE_LINE_SIZE)
+    sync::Spinlock                  m_lock;
+    std::vector<DxvkCsQueuedChunk>  m_queue;
+    std::atomic<uint64_t>           m_seqDispatch = { 0u };
+    std::atomic<bool>               m_pending     = { false };
+
+    alignas(CACHE_LINE_SIZE)
+    std::vector<DxvkCsQueuedChunk>  m_local;
+    size_t                          m_localIndex  = 0u;
+
   };
 
 
@@ -509,6 +658,14 @@ namespace dxvk {
    * 
    * Spawns a thread that will execute
    * commands on a DXVK context. 
+   *
+   * Optionally, destroying executed commands and returning chunks
+   * to the pool can be done on a separate thread. This takes work
+   * off the CS thread, which is often the bottleneck in CPU-bound
+   * games. In that case, sequence numbers of the ordered queue are
+   * only signalled once the respective chunks have been destroyed,
+   * so that synchronizing with the thread still guarantees that
+   * all resource references held by those chunks are released.
    */
   class DxvkCsThread {
 
@@ -518,7 +675,8 @@ namespace dxvk {
 
     DxvkCsThread(
       const Rc<DxvkDevice>&   device,
-      const Rc<DxvkContext>&  context);
+      const Rc<DxvkContext>&  context,
+            bool              asyncCleanup);
     ~DxvkCsThread();
     
     /**
@@ -538,7 +696,8 @@ namespace dxvk {
      * from a thread other than the main thread recording rendering
      * commands. The context can still be safely accessed, but chunks
      * will not be executed in any particular oder. These chunks also
-     * do not contribute to the main timeline.
+     * do not contribute to the main timeline unless synchronization
+     * is requested.
      * \param [in] queue Which queue to add the chunk to
      * \param [in] chunk The chunk to dispatch
      * \param [in] synchronize Whether to wait for execution to complete
@@ -576,21 +735,32 @@ namespace dxvk {
 
     alignas(CACHE_LINE_SIZE)
     dxvk::mutex                 m_counterMutex;
+    dxvk::condition_variable    m_condOnSync;
 
     std::atomic<uint64_t>       m_seqHighPrio = { 0u };
     std::atomic<uint64_t>       m_seqOrdered  = { 0u };
 
-    std::atomic<bool>           m_stopped     = { false };
-    std::atomic<bool>           m_hasHighPrio = { false };
+    std::atomic<uint32_t>       m_syncWaiters = { 0u };
+    std::atomic<uint32_t>       m_syncSpinCount = { 256u };
 
     alignas(CACHE_LINE_SIZE)
     dxvk::mutex                 m_mutex;
     dxvk::condition_variable    m_condOnAdd;
-    dxvk::condition_variable    m_condOnSync;
+
+    std::atomic<bool>           m_stopped     = { false };
+    std::atomic<bool>           m_idle        = { false };
+    std::atomic<uint32_t>       m_idleSpinCount = { 256u };
 
     DxvkCsChunkQueue            m_queueOrdered;
     DxvkCsChunkQueue            m_queueHighPrio;
 
+    alignas(CACHE_LINE_SIZE)
+    dxvk::mutex                 m_cleanupMutex;
+    dxvk::condition_variable    m_cleanupCond;
+    std::vector<DxvkCsQueuedChunk> m_cleanupQueue;
+    bool                        m_cleanupStopped = false;
+
+    dxvk::thread                m_cleanupThread;
     dxvk::thread                m_thread;
 
     auto& getQueue(DxvkCsQueue which) {
@@ -603,6 +773,26 @@ namespace dxvk {
         ? m_seqOrdered : m_seqHighPrio;
     }
 
+    uint64_t pushChunk(
+            DxvkCsQueue       queue,
+            DxvkCsChunkRef&&  chunk,
+            bool              counted);
+
+    void waitForChunks();
+
+    void waitForSequenceNumber(
+            DxvkCsQueue       queue,
+            uint64_t          seq);
+
+    void signalSequenceNumber(
+            DxvkCsQueue       queue,
+            uint64_t          seq);
+
+    void queueCleanup(
+            std::vector<DxvkCsQueuedChunk>& chunks);
+
+    void runCleanup();
+
     void threadFunc();
     
   };
@@ -37,8 +37,10 @@ namespace dxvk {
 
     determineShaderOptions();
 
-    if (env::getEnvVar("DXVK_SHADER_CACHE") != "0" && DxvkShader::getShaderDumpPath().empty())
+    if (env::getEnvVar("DXVK_SHADER_CACHE") != "0" && DxvkShader::getShaderDumpPath().empty()) {
       m_shaderCache = DxvkShaderCache::getInstance();
+      m_pipelineCache = std::make_unique<DxvkPipelineCache>(this);
+    }
 
     logBindingModel();
   }
@@ -328,7 +330,7 @@ namespace dxvk {
     VkPipeline pipeline = VK_NULL_HANDLE;
 
     VkResult vr = m_vkd->vkCreateComputePipelines(m_vkd->device(),
-      VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+      getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
 
     if (vr)
       throw DxvkError(str::format("Failed to create built-in compute pipeline: ", vr));
@@ -493,7 +495,7 @@ namespace dxvk {
     VkPipeline pipeline = VK_NULL_HANDLE;
 
     VkResult vr = m_vkd->vkCreateGraphicsPipelines(m_vkd->device(),
-      VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+      getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline);
 
     if (vr)
       throw DxvkError(str::format("Failed to create built-in graphics pipeline: ", vr));
@@ -514,6 +516,16 @@ namespace dxvk {
     result.setCtr(DxvkStatCounter::PipeTasksTotal,    workers.tasksTotal);
     result.setCtr(DxvkStatCounter::GpuIdleTicks,      m_submissionQueue.gpuIdleTicks());
 
+    DxvkIrShaderCodeCacheStats code = DxvkIrShader::getCodeCacheStats();
+    result.setCtr(DxvkStatCounter::ShaderCodeCacheHits,   code.hits);
+    result.setCtr(DxvkStatCounter::ShaderCodeCacheMisses, code.misses);
+
+    if (m_shaderCache) {
+      DxvkShaderCacheStats cache = m_shaderCache->getStats();
+      result.setCtr(DxvkStatCounter::ShaderCacheQueueDepth,   cache.queueDepth);
+      result.setCtr(DxvkStatCounter::ShaderCacheBytesWritten, cache.bytesWritten);
+    }
+
     std::lock_guard<sync::Spinlock> lock(m_statLock);
     result.merge(m_statCounters);
     return result;
@@ -14,6 +14,7 @@
 #include "dxvk_meta_clear.h"
 #include "dxvk_objects.h"
 #include "dxvk_options.h"
+#include "dxvk_pipeline_cache.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_presenter.h"
 #include "dxvk_queue.h"
@@ -348,6 +349,16 @@ namespace dxvk {
       return m_perfHints;
     }
     
+    /**
+     * \brief Queries Vulkan pipeline cache
+     *
+     * Must be passed to all pipeline creation functions.
+     * \returns Pipeline cache, may be \c VK_NULL_HANDLE
+     */
+    VkPipelineCache getPipelineCache() const {
+      return m_pipelineCache ? m_pipelineCache->handle() : VK_NULL_HANDLE;
+    }
+
     /**
      * \brief Creates a command list
      * \returns The command list
@@ -761,6 +772,7 @@ namespace dxvk {
     DxvkSubmissionQueue         m_submissionQueue;
 
     Rc<DxvkShaderCache>         m_shaderCache;
+    std::unique_ptr<DxvkPipelineCache> m_pipelineCache;
 
     DxvkDevicePerfHints getPerfHints();
 
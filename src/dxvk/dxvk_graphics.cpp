@@ -252,7 +252,7 @@ namespace dxvk {
     info.basePipelineIndex    = -1;
 
     VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(),
-      VK_NULL_HANDLE, 1, &info, nullptr, &m_pipeline);
+      m_device->getPipelineCache(), 1, &info, nullptr, &m_pipeline);
 
     if (vr)
       throw DxvkError("Failed to create vertex input pipeline library");
@@ -536,7 +536,7 @@ namespace dxvk {
     info.basePipelineIndex    = -1;
 
     VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(),
-      VK_NULL_HANDLE, 1, &info, nullptr, &m_pipeline);
+      m_device->getPipelineCache(), 1, &info, nullptr, &m_pipeline);
 
     if (vr)
       throw DxvkError("Failed to create vertex input pipeline library");
@@ -1378,7 +1378,7 @@ namespace dxvk {
       flags.pNext = std::exchange(info.pNext, &flags);
 
     VkPipeline pipeline = VK_NULL_HANDLE;
-    VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline);
+    VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(), m_device->getPipelineCache(), 1, &info, nullptr, &pipeline);
 
     if (vr && vr != VK_PIPELINE_COMPILE_REQUIRED_EXT)
       Logger::err(str::format("DxvkGraphicsPipeline: Failed to create base pipeline: ", vr));
@@ -1463,7 +1463,7 @@ namespace dxvk {
       flags.pNext = std::exchange(info.pNext, &flags);
     
     VkPipeline pipeline = VK_NULL_HANDLE;
-    VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(), VK_NULL_HANDLE, 1, &info, nullptr, &pipeline);
+    VkResult vr = vk->vkCreateGraphicsPipelines(vk->device(), m_device->getPipelineCache(), 1, &info, nullptr, &pipeline);
 
     if (vr != VK_SUCCESS) {
       Logger::err(str::format("DxvkGraphicsPipeline: Failed to compile pipeline: ", vr));
@@ -482,11 +482,6 @@ namespace dxvk {
   DxvkSharedAllocationCache::DxvkSharedAllocationCache(
           DxvkMemoryAllocator*        allocator)
   : m_allocator(allocator) {
-    for (uint32_t i = 0; i < m_pools.size(); i++) {
-      VkDeviceSize size = DxvkLocalAllocationCache::computeAllocationSize(i);
-      m_freeLists[i].capacity = DxvkLocalAllocationCache::computePreferredAllocationCount(size);
-    }
-
     // Initialize unallocated list of lists
     for (uint32_t i = 0u; i < m_lists.size() - 1u; i++)
       m_lists[i].next = i + 1;
@@ -496,9 +491,6 @@ namespace dxvk {
 
 
   DxvkSharedAllocationCache::~DxvkSharedAllocationCache() {
-    for (const auto& freeList : m_freeLists)
-      m_allocator->freeCachedAllocations(freeList.head);
-
     for (const auto& list : m_lists)
       m_allocator->freeCachedAllocations(list.head);
   }
@@ -537,76 +529,60 @@ namespace dxvk {
   }
 
 
-  DxvkResourceAllocation* DxvkSharedAllocationCache::freeAllocation(
+  DxvkResourceAllocation* DxvkSharedAllocationCache::freeAllocationList(
           DxvkResourceAllocation*     allocation) {
     uint32_t poolIndex = DxvkLocalAllocationCache::computePoolIndex(allocation->m_size);
 
-    { std::unique_lock freeLock(m_freeMutex);
-      auto& list = m_freeLists[poolIndex];
-
-      allocation->m_nextCached = list.head;
-      list.head = allocation;
-
-      if (++list.size < list.capacity)
-        return nullptr;
-
-      // Free list is full, try to add it to the list array
-      // so that subsequent allocations can use it.
-      list.head = nullptr;
-      list.size = 0u;
-    }
-
-    // Add free list to the pool if possible.
-    { std::unique_lock poolLock(m_poolMutex);
-      auto& pool = m_pools[poolIndex];
+    // Add list to the pool if possible.
+    std::unique_lock poolLock(m_poolMutex);
+    auto& pool = m_pools[poolIndex];
 
-      if (unlikely(m_nextList < 0)) {
-        // Cache is currently full, see if we can steal a list from
-        // the largest pool. This automatically balances pool sizes
-        // under cache pressure.
-        uint32_t largestPoolIndex = 0;
+    if (unlikely(m_nextList < 0)) {
+      // Cache is currently full, see if we can steal a list from
+      // the largest pool. This automatically balances pool sizes
+      // under cache pressure.
+      uint32_t largestPoolIndex = 0;
 
-        for (uint32_t i = 1; i < PoolCount; i++) {
-          if (m_pools[i].listCount > m_pools[largestPoolIndex].listCount)
-            largestPoolIndex = i;
-        }
+      for (uint32_t i = 1; i < PoolCount; i++) {
+        if (m_pools[i].listCount > m_pools[largestPoolIndex].listCount)
+          largestPoolIndex = i;
+      }
 
-        // If the current pool is already (one of) the largest, give up
-        // and free the entire list to avoid pools playing ping-pong.
-        if (m_pools[largestPoolIndex].listCount == pool.listCount)
-          return allocation;
+      // If the current pool is already (one of) the largest, give up
+      // and free the entire list to avoid pools playing ping-pong.
+      if (m_pools[largestPoolIndex].listCount == pool.listCount)
+        return allocation;
 
-        // Move first list of largest pool to current pool and free any
-        // allocations associated with it.
-        auto& largestPool = m_pools[largestPoolIndex];
-        int32_t listIndex = largestPool.listIndex;
+      // Move first list of largest pool to current pool and free any
+      // allocations associated with it.
+      auto& largestPool = m_pools[largestPoolIndex];
+      int32_t listIndex = largestPool.listIndex;
 
-        DxvkResourceAllocation* result = m_lists[listIndex].head;
-        largestPool.listIndex = m_lists[listIndex].next;
-        largestPool.listCount -= 1u;
+      DxvkResourceAllocation* result = m_lists[listIndex].head;
+      largestPool.listIndex = m_lists[listIndex].next;
+      largestPool.listCount -= 1u;
 
-        m_lists[listIndex].head = allocation;
-        m_lists[listIndex].next = pool.listIndex;
+      m_lists[listIndex].head = allocation;
+      m_lists[listIndex].next = pool.listIndex;
 
-        pool.listIndex = listIndex;
-        pool.listCount += 1u;
-        return result;
-      } else {
-        // Otherwise, allocate a fresh list and assign it to the pool
-        int32_t listIndex = m_nextList;
-        m_nextList = m_lists[listIndex].next;
+      pool.listIndex = listIndex;
+      pool.listCount += 1u;
+      return result;
+    } else {
+      // Otherwise, allocate a fresh list and assign it to the pool
+      int32_t listIndex = m_nextList;
+      m_nextList = m_lists[listIndex].next;
 
-        m_lists[listIndex].head = allocation;
-        m_lists[listIndex].next = pool.listIndex;
+      m_lists[listIndex].head = allocation;
+      m_lists[listIndex].next = pool.listIndex;
 
-        pool.listIndex = listIndex;
-        pool.listCount += 1u;
+      pool.listIndex = listIndex;
+      pool.listCount += 1u;
 
-        if ((m_cacheSize += PoolCapacityInBytes) > m_maxCacheSize)
-          m_maxCacheSize = m_cacheSize;
+      if ((m_cacheSize += PoolCapacityInBytes) > m_maxCacheSize)
+        m_maxCacheSize = m_cacheSize;
 
-        return nullptr;
-      }
+      return nullptr;
     }
   }
 
@@ -770,6 +746,11 @@ namespace dxvk {
     determineBufferUsageFlagsPerMemoryType();
 
     updateMemoryHeapBudgets();
+
+    std::string traceFile = env::getEnvVar("DXVK_MEMORY_TRACE");
+
+    if (!traceFile.empty())
+      m_trace = std::make_unique<DxvkAllocationTrace>(traceFile, memInfo);
   }
   
   
@@ -780,6 +761,13 @@ namespace dxvk {
     // before destroying any allocator structures
     m_relocations.clear();
 
+    // Return allocations held by thread caches to the allocator
+    { std::unique_lock lock(m_mutex);
+
+      for (auto& cache : m_threadCaches)
+        freeThreadCacheLocked(cache);
+    }
+
     // Destroy shared caches so that any allocations
     // that are still alive get returned to the device
     for (uint32_t i = 0; i < m_memTypeCount; i++) {
@@ -804,7 +792,7 @@ namespace dxvk {
   Rc<DxvkResourceAllocation> DxvkMemoryAllocator::allocateMemory(
     const VkMemoryRequirements&             requirements,
     const DxvkAllocationInfo&               allocationInfo) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    std::lock_guard lock(m_mutex);
 
     // If we're allocating device-local memory, only consider memory types from
     // the first reported heap. This way, we avoid falling back to HVV on systems
@@ -832,7 +820,7 @@ namespace dxvk {
       int64_t address = selectedPool.alloc(size, requirements.alignment);
 
       if (likely(address >= 0))
-        return createAllocation(type, selectedPool, address, size, allocationInfo);
+        return createAllocation(type, selectedPool, address, size, requirements.alignment, allocationInfo);
 
       // If we're not allowed to allocate additional device memory, move on.
       // Also do not try to revive any chunks marked for defragmentation since
@@ -846,7 +834,7 @@ namespace dxvk {
         address = selectedPool.alloc(size, requirements.alignment);
 
         if (address >= 0)
-          return createAllocation(type, selectedPool, address, size, allocationInfo);
+          return createAllocation(type, selectedPool, address, size, requirements.alignment, allocationInfo);
       }
 
       // If the allocation is very large, use a dedicated allocation instead
@@ -883,7 +871,7 @@ namespace dxvk {
           continue;
 
         mapDeviceMemory(memory, allocationInfo.properties);
-        return createAllocation(type, memory, allocationInfo);
+        return createAllocation(type, memory, requirements.alignment, allocationInfo);
       }
 
       // Try to allocate a new chunk that is large enough to hold
@@ -895,7 +883,7 @@ namespace dxvk {
 
       if (allocateChunkInPool(type, selectedPool, allocationInfo.properties, size, desiredSize)) {
         address = selectedPool.alloc(size, requirements.alignment);
-        return createAllocation(type, selectedPool, address, size, allocationInfo);
+        return createAllocation(type, selectedPool, address, size, requirements.alignment, allocationInfo);
       }
     }
 
@@ -907,7 +895,7 @@ namespace dxvk {
     const VkMemoryRequirements&             requirements,
     const DxvkAllocationInfo&               allocationInfo,
     const void*                             next) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    std::lock_guard lock(m_mutex);
 
     DxvkDeviceMemory memory = { };
 
@@ -917,7 +905,7 @@ namespace dxvk {
 
       if (likely(memory.memory != VK_NULL_HANDLE)) {
         mapDeviceMemory(memory, allocationInfo.properties);
-        return createAllocation(type, memory, allocationInfo);
+        return createAllocation(type, memory, requirements.alignment, allocationInfo);
       }
     }
 
@@ -963,6 +951,15 @@ namespace dxvk {
           // for any relevant memory pools as necessary.
           if (refillAllocationCache(allocationCache, memoryRequirements, allocationInfo.properties))
             return allocationCache->allocateFromCache(createInfo.size);
+        } else if (createInfo.size <= DxvkLocalAllocationCache::MaxSize
+                && (allocationInfo.properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+          // Otherwise, service small mappable allocations from the calling
+          // thread's cache, so that resources created and destroyed outside
+          // of a context do not need to lock the allocator either.
+          allocation = allocateFromThreadCache(memoryRequirements, allocationInfo.properties);
+
+          if (likely(allocation))
+            return allocation;
         }
 
         // If there is at least one memory type that supports the required
@@ -1528,6 +1525,7 @@ namespace dxvk {
           DxvkMemoryPool&       pool,
           VkDeviceSize          address,
           VkDeviceSize          size,
+          VkDeviceSize          alignment,
     const DxvkAllocationInfo&   allocationInfo) {
     type.stats.memoryUsed += size;
 
@@ -1568,6 +1566,9 @@ namespace dxvk {
     if (&pool == &type.devicePool)
       chunk.addAllocation(allocation);
 
+    if (unlikely(m_trace))
+      traceAllocation(DxvkAllocationTraceEvent::Allocate, allocation, alignment, 0u);
+
     return allocation;
   }
 
@@ -1586,6 +1587,7 @@ namespace dxvk {
   DxvkResourceAllocation* DxvkMemoryAllocator::createAllocation(
           DxvkMemoryType&       type,
     const DxvkDeviceMemory&     memory,
+          VkDeviceSize          alignment,
     const DxvkAllocationInfo&   allocationInfo) {
     type.stats.memoryUsed += memory.size;
 
@@ -1606,6 +1608,10 @@ namespace dxvk {
 
     allocation->m_buffer = memory.buffer;
     allocation->m_bufferAddress = memory.gpuVa;
+
+    if (unlikely(m_trace))
+      traceAllocation(DxvkAllocationTraceEvent::Allocate, allocation, alignment, 0u);
+
     return allocation;
   }
 
@@ -1629,11 +1635,11 @@ namespace dxvk {
     }
 
     if (allocation->m_flags.test(DxvkAllocationFlag::CanCache)) {
-      // Return cacheable allocations to the shared cache
+      // Return cacheable allocations to the thread cache
       allocation->destroyBufferViews();
 
       if (allocation->m_type->sharedCache)
-        allocation = allocation->m_type->sharedCache->freeAllocation(allocation);
+        allocation = freeToThreadCache(allocation);
 
       // If we get a list of allocations back from the
       // shared cache, free all of them in one go
@@ -1642,6 +1648,9 @@ namespace dxvk {
       std::unique_lock lock(m_mutex);
 
       if (likely(allocation->m_type)) {
+        if (unlikely(m_trace))
+          traceAllocation(DxvkAllocationTraceEvent::Free, allocation, 0u, 0u);
+
         allocation->m_type->stats.memoryUsed -= allocation->m_size;
 
         if (unlikely(allocation->m_flags.test(DxvkAllocationFlag::OwnsMemory))) {
@@ -1701,6 +1710,9 @@ namespace dxvk {
       // still own the memory, so make sure to release it here.
       allocation->m_type->stats.memoryUsed -= allocation->m_size;
 
+      if (unlikely(m_trace))
+        traceAllocation(DxvkAllocationTraceEvent::Free, allocation, 0u, 0u);
+
       if (unlikely(pool.free(allocation->m_address, allocation->m_size))) {
         if (freeEmptyChunksInPool(*allocation->m_type, pool, 0, high_resolution_clock::now()))
           updateMemoryHeapStats(allocation->m_type->properties.heapIndex);
@@ -1855,76 +1867,197 @@ namespace dxvk {
           DxvkLocalAllocationCache*   cache,
     const VkMemoryRequirements&       requirements,
           VkMemoryPropertyFlags       properties) {
-    // Ensure that all cached allocations report a power-of-two size.
-    // The shared cache implementation currently relies on this.
-    VkDeviceSize allocationSize = (VkDeviceSize(-1) >> bit::lzcnt(requirements.size - 1u)) + 1u;
-    allocationSize = std::max(allocationSize, DxvkLocalAllocationCache::MinSize);
+    VkDeviceSize allocationSize = computeCachedAllocationSize(requirements.size);
+
+    for (auto typeIndex : bit::BitMask(cache->m_memoryTypes)) {
+      uint32_t allocationCount = 0u;
+
+      DxvkResourceAllocation* allocation = allocateCachedAllocationList(
+        m_memTypes[typeIndex], allocationSize, requirements.alignment, allocationCount);
+
+      if (allocation) {
+        freeCachedAllocations(cache->assignCache(allocationSize, allocation));
+        return true;
+      }
+    }
 
+    return false;
+  }
+
+
+  DxvkResourceAllocation* DxvkMemoryAllocator::allocateCachedAllocationList(
+          DxvkMemoryType&             memoryType,
+          VkDeviceSize                allocationSize,
+          VkDeviceSize                alignment,
+          uint32_t&                   allocationCount) {
     // Maximum number of allocations when we miss in the shared cache
-    uint32_t allocationCount = DxvkLocalAllocationCache::computePreferredAllocationCount(allocationSize);
+    uint32_t maxCount = DxvkLocalAllocationCache::computePreferredAllocationCount(allocationSize);
 
-    for (auto typeIndex : bit::BitMask(cache->m_memoryTypes)) {
-      auto& memoryType = m_memTypes[typeIndex];
+    // Initialize shared cache on demand only
+    if (unlikely(!memoryType.sharedCache)) {
+      std::unique_lock lock(m_mutex);
+
+      if (!memoryType.sharedCache)
+        memoryType.sharedCache = new DxvkSharedAllocationCache(this);
+    }
 
-      // Initialize shared cache on demand only
-      if (unlikely(!memoryType.sharedCache)) {
-        std::unique_lock lock(m_mutex);
+    // Try to grab a list of allocations from the shared cache first. If
+    // this succeeds, allocating several pages of memory is near instant.
+    DxvkResourceAllocation* head = memoryType.sharedCache->getAllocationList(allocationSize);
 
-        if (!memoryType.sharedCache)
-          memoryType.sharedCache = new DxvkSharedAllocationCache(this);
+    if (likely(head)) {
+      allocationCount = maxCount;
+      return head;
+    }
+
+    // Fill cache with the preferred allocation count of this size category so
+    // that subsequent allocations can be handled without locking the allocator.
+    DxvkResourceAllocation* tail = nullptr;
+
+    std::unique_lock lock(m_mutex);
+    auto& memoryPool = memoryType.mappedPool;
+
+    allocationCount = 0u;
+
+    while (allocationCount < maxCount) {
+      // Try to suballocate from existing chunks, but do not create
+      // any new chunks. Let the regular code path handle that case
+      // as necessary.
+      int64_t address = memoryPool.alloc(allocationSize, alignment);
+
+      if (address < 0)
+        break;
+
+      // Add allocation to the list and mark it as cacheable,
+      // so it will get recycled as-is after use.
+      DxvkResourceAllocation* allocation = createAllocation(memoryType, memoryPool,
+        address, allocationSize, alignment, DxvkAllocationInfo());
+      allocation->m_flags.set(DxvkAllocationFlag::CanCache);
+
+      if (tail) {
+        tail->m_nextCached = allocation;
+        tail = allocation;
+      } else {
+        head = allocation;
+        tail = allocation;
       }
 
-      // Try to grab a list of allocations from the shared cache first. If
-      // this succeeds, allocating several pages of memory is near instant.
-      DxvkResourceAllocation* allocation = memoryType.sharedCache->getAllocationList(allocationSize);
+      allocationCount++;
+    }
 
-      if (likely(allocation)) {
-        allocation = cache->assignCache(allocationSize, allocation);
-        freeCachedAllocations(allocation);
-        return true;
+    return head;
+  }
+
+
+  DxvkResourceAllocation* DxvkMemoryAllocator::allocateFromThreadCache(
+    const VkMemoryRequirements&       requirements,
+          VkMemoryPropertyFlags       properties) {
+    uint32_t memoryTypeMask = requirements.memoryTypeBits & getMemoryTypeMask(properties);
+
+    if (!memoryTypeMask)
+      return nullptr;
+
+    auto& memoryType = m_memTypes[bit::tzcnt(memoryTypeMask)];
+
+    VkDeviceSize allocationSize = computeCachedAllocationSize(requirements.size);
+    uint32_t poolIndex = DxvkLocalAllocationCache::computePoolIndex(allocationSize);
+
+    auto& cache = getThreadCache();
+    std::unique_lock lock(cache.mutex);
+    cache.useCount += 1u;
+
+    auto& pool = cache.pools[memoryType.index][poolIndex];
+
+    if (unlikely(!pool.loaded.head)) {
+      // Use the full magazine if there is one, otherwise get a new
+      // one from the shared cache or allocate a batch of memory.
+      if (pool.previous.head) {
+        std::swap(pool.loaded, pool.previous);
+      } else {
+        pool.loaded.head = allocateCachedAllocationList(memoryType,
+          allocationSize, requirements.alignment, pool.loaded.size);
+
+        if (!pool.loaded.head)
+          return nullptr;
       }
+    }
 
-      // Fill cache with the preferred allocation count of this size category so
-      // that subsequent allocations can be handled without locking the allocator.
-      DxvkResourceAllocation* head = nullptr;
-      DxvkResourceAllocation* tail = nullptr;
+    DxvkResourceAllocation* allocation = pool.loaded.head;
+    pool.loaded.head = allocation->m_nextCached;
+    pool.loaded.size -= 1u;
 
-      std::unique_lock lock(m_mutex);
-      auto& memoryPool = memoryType.mappedPool;
-
-      while (allocationCount) {
-        // Try to suballocate from existing chunks, but do not create
-        // any new chunks. Let the regular code path handle that case
-        // as necessary.
-        int64_t address = memoryPool.alloc(allocationSize, requirements.alignment);
-
-        if (address < 0)
-          break;
-
-        // Add allocation to the list and mark it as cacheable,
-        // so it will get recycled as-is after use.
-        allocation = createAllocation(memoryType, memoryPool,
-          address, allocationSize, DxvkAllocationInfo());
-        allocation->m_flags.set(DxvkAllocationFlag::CanCache);
-
-        if (tail) {
-          tail->m_nextCached = allocation;
-          tail = allocation;
-        } else {
-          head = allocation;
-          tail = allocation;
-        }
+    allocation->m_nextCached = nullptr;
+    return allocation;
+  }
+
+
+  DxvkResourceAllocation* DxvkMemoryAllocator::freeToThreadCache(
+          DxvkResourceAllocation*     allocation) {
+    DxvkMemoryType* memoryType = allocation->m_type;
+
+    uint32_t poolIndex = DxvkLocalAllocationCache::computePoolIndex(allocation->m_size);
+    uint32_t capacity = DxvkLocalAllocationCache::computePreferredAllocationCount(allocation->m_size);
+
+    DxvkResourceAllocation* fullList = nullptr;
+
+    { auto& cache = getThreadCache();
+      std::unique_lock lock(cache.mutex);
+      cache.useCount += 1u;
+
+      auto& pool = cache.pools[memoryType->index][poolIndex];
 
-        allocationCount--;
+      // If the loaded magazine is full, keep it around for subsequent
+      // allocations and return the previous full one to the shared
+      // cache if necessary, so that we only ever pass full lists.
+      if (pool.loaded.size >= capacity) {
+        if (pool.previous.head)
+          fullList = pool.previous.head;
+
+        pool.previous = pool.loaded;
+        pool.loaded = DxvkThreadAllocationCache::Magazine();
       }
 
-      if (tail) {
-        tail->m_nextCached = cache->assignCache(allocationSize, head);
-        return true;
+      allocation->m_nextCached = pool.loaded.head;
+      pool.loaded.head = allocation;
+      pool.loaded.size += 1u;
+    }
+
+    if (!fullList)
+      return nullptr;
+
+    return memoryType->sharedCache->freeAllocationList(fullList);
+  }
+
+
+  void DxvkMemoryAllocator::freeThreadCacheLocked(
+          DxvkThreadAllocationCache&  cache) {
+    for (uint32_t i = 0; i < m_memTypeCount; i++) {
+      for (auto& pool : cache.pools[i]) {
+        freeCachedAllocationsLocked(pool.loaded.head);
+        freeCachedAllocationsLocked(pool.previous.head);
+
+        pool = DxvkThreadAllocationCache::Pool();
       }
     }
+  }
 
-    return false;
+
+  DxvkThreadAllocationCache& DxvkMemoryAllocator::getThreadCache() {
+    // Thread IDs are not necessarily sequential, so hash them in
+    // order to distribute threads more evenly among the caches
+    uint32_t threadId = dxvk::this_thread::get_id();
+    uint32_t index = (threadId * 0x9e3779b9u) >> (32u - ThreadCacheBits);
+
+    return m_threadCaches[index];
+  }
+
+
+  VkDeviceSize DxvkMemoryAllocator::computeCachedAllocationSize(
+          VkDeviceSize                size) {
+    // Ensure that all cached allocations report a power-of-two size.
+    // The shared cache implementation currently relies on this.
+    VkDeviceSize allocationSize = (VkDeviceSize(-1) >> bit::lzcnt(size - 1u)) + 1u;
+    return std::max(allocationSize, DxvkLocalAllocationCache::MinSize);
   }
 
 
@@ -2199,10 +2332,11 @@ namespace dxvk {
 
 
   void DxvkMemoryAllocator::getAllocationStats(DxvkMemoryAllocationStats& stats) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    std::lock_guard lock(m_mutex);
 
     stats.chunks.clear();
     stats.pageMasks.clear();
+    stats.lockStats = m_mutex.getStats();
 
     for (uint32_t i = 0; i < m_memTypeCount; i++) {
       const auto& typeInfo = m_memTypes[i];
@@ -2429,6 +2563,42 @@ namespace dxvk {
   }
 
 
+  void DxvkMemoryAllocator::queueRelocation(
+          Rc<DxvkPagedResource>&& resource,
+    const DxvkResourceAllocation* allocation,
+          DxvkAllocationModes   mode) {
+    if (unlikely(m_trace))
+      traceAllocation(DxvkAllocationTraceEvent::Relocate, allocation, 0u, mode);
+
+    m_relocations.addResource(std::move(resource), allocation, mode);
+  }
+
+
+  void DxvkMemoryAllocator::traceAllocation(
+          DxvkAllocationTraceEvent event,
+    const DxvkResourceAllocation* allocation,
+          VkDeviceSize          alignment,
+          DxvkAllocationModes   mode) {
+    DxvkAllocationTraceRecord record = { };
+    record.allocation = reinterpret_cast<uintptr_t>(allocation);
+    record.address = allocation->m_address;
+    record.size = allocation->m_size;
+    record.alignment = alignment;
+    record.event = event;
+    record.memoryType = allocation->m_type->index;
+    record.mode = mode.raw();
+
+    if (allocation->m_flags.test(DxvkAllocationFlag::OwnsMemory))
+      record.pool = DxvkAllocationTracePool::Dedicated;
+    else if (allocation->m_mapPtr)
+      record.pool = DxvkAllocationTracePool::Mapped;
+    else
+      record.pool = DxvkAllocationTracePool::Device;
+
+    m_trace->record(record);
+  }
+
+
   void DxvkMemoryAllocator::moveDefragChunk(
           DxvkMemoryType&       type) {
     auto& pool = type.devicePool;
@@ -2474,7 +2644,7 @@ namespace dxvk {
         continue;
 
       // Acquired the resource, add it to the relocation list.
-      m_relocations.addResource(std::move(resource), a, mode);
+      queueRelocation(std::move(resource), a, mode);
     }
   }
 
@@ -2654,13 +2824,13 @@ namespace dxvk {
         bool evicted = resource->requestEviction();
 
         if (evicted && (heapUsage + minUnusedMemory > heapBudget + memoryEvicted)) {
-          m_relocations.addResource(std::move(resource), a, DxvkAllocationMode::NoDeviceMemory);
+          queueRelocation(std::move(resource), a, DxvkAllocationMode::NoDeviceMemory);
           memoryEvicted += a->getMemoryInfo().size;
         }
 
         if (!evicted && memoryEvicted) {
           // Relocate other resources within the chunk to reduce fragmentation
-          m_relocations.addResource(std::move(resource), a, DxvkAllocationModes(
+          queueRelocation(std::move(resource), a, DxvkAllocationModes(
             DxvkAllocationMode::NoFallback, DxvkAllocationMode::NoAllocation));
         }
       }
@@ -2717,6 +2887,16 @@ namespace dxvk {
         m_memTypes[i].sharedCache->cleanupUnusedFromLockedAllocator(currentTime);
     }
 
+    // Drain thread caches that have not been used since the last
+    // iteration. Skip any cache that is currently in use, since
+    // its owning thread may be waiting for the allocator lock.
+    for (auto& cache : m_threadCaches) {
+      std::unique_lock lock(cache.mutex, std::try_to_lock);
+
+      if (lock && cache.useCount == std::exchange(cache.lastUseCount, cache.useCount))
+        freeThreadCacheLocked(cache);
+    }
+
     if (enableDefrag()) {
       // Periodically defragment device-local memory types. We cannot
       // do anything about mapped allocations since we rely on pointer
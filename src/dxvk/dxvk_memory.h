@@ -8,6 +8,7 @@
 #include "dxvk_allocator.h"
 #include "dxvk_descriptor.h"
 #include "dxvk_hash.h"
+#include "dxvk_memory_trace.h"
 
 #include "../util/util_time.h"
 
@@ -215,6 +216,23 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Allocator lock statistics
+   *
+   * Accumulated since statistics were last queried.
+   */
+  struct DxvkMemoryLockStats {
+    /// Number of times the lock was acquired
+    uint64_t lockCount = 0u;
+    /// Number of times the lock was held by another thread
+    uint64_t contentionCount = 0u;
+    /// Total time spent waiting for the lock, in microseconds
+    uint64_t waitTime = 0u;
+    /// Total time the lock was held, in microseconds
+    uint64_t holdTime = 0u;
+  };
+
+
   /**
    * \brief Detailed memory allocation statistics
    */
@@ -222,6 +240,7 @@ namespace dxvk {
     std::array<DxvkMemoryTypeStats, VK_MAX_MEMORY_TYPES> memoryTypes = { };
     std::vector<DxvkMemoryChunkStats> chunks;
     std::vector<uint32_t> pageMasks;
+    DxvkMemoryLockStats lockStats;
   };
 
 
@@ -900,13 +919,16 @@ namespace dxvk {
             VkDeviceSize                allocationSize);
 
     /**
-     * \brief Frees cacheable allocation
+     * \brief Frees list of cacheable allocations
      *
-     * \param [in] allocation Allocation to free
+     * Allocations are returned to the cache in batches by
+     * the thread allocation caches of the allocator.
+     * \param [in] allocation Allocation list. Must contain the
+     *    preferred number of allocations for the given size.
      * \returns List to destroy if the cache is full. Usually,
-     *    \c nullptr if the allocation was successfully added.
+     *    \c nullptr if the list was successfully added.
      */
-    DxvkResourceAllocation* freeAllocation(
+    DxvkResourceAllocation* freeAllocationList(
             DxvkResourceAllocation*     allocation);
 
     /**
@@ -927,13 +949,6 @@ namespace dxvk {
 
   private:
 
-    struct FreeList {
-      uint16_t size = 0u;
-      uint16_t capacity = 0u;
-
-      DxvkResourceAllocation* head = nullptr;
-    };
-
     struct List {
       DxvkResourceAllocation* head = nullptr;
       int32_t                 next = -1;
@@ -948,9 +963,6 @@ namespace dxvk {
     alignas(CACHE_LINE_SIZE)
     DxvkMemoryAllocator*        m_allocator = nullptr;
 
-    dxvk::mutex                 m_freeMutex;
-    std::array<FreeList, PoolCount> m_freeLists = { };
-
     alignas(CACHE_LINE_SIZE)
     dxvk::mutex                 m_poolMutex;
     std::array<Pool, PoolCount> m_pools = { };
@@ -966,6 +978,116 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Thread allocation cache
+   *
+   * Magazine-style cache of small mappable allocations for each
+   * memory type. Threads are assigned one of these caches based
+   * on their thread ID, so that allocating and freeing small
+   * buffers does not need to take the allocator lock, or any
+   * lock shared with other threads in most cases. Allocations
+   * are exchanged with the shared cache only as full lists.
+   */
+  struct alignas(CACHE_LINE_SIZE) DxvkThreadAllocationCache {
+    constexpr static uint32_t PoolCount = DxvkLocalAllocationCache::PoolCount;
+
+    struct Magazine {
+      DxvkResourceAllocation* head = nullptr;
+      uint32_t                size = 0u;
+    };
+
+    struct Pool {
+      /// Magazine that allocations are taken from and freed to
+      Magazine loaded;
+      /// Full magazine to use when the loaded one runs empty
+      /// or to return to the shared cache when it runs full
+      Magazine previous;
+    };
+
+    dxvk::mutex mutex;
+
+    /// Number of operations performed on this cache. Used
+    /// to detect idle caches that should be drained.
+    uint32_t useCount = 0u;
+    uint32_t lastUseCount = 0u;
+
+    std::array<std::array<Pool, PoolCount>, VK_MAX_MEMORY_TYPES> pools = { };
+  };
+
+
+  /**
+   * \brief Allocator mutex
+   *
+   * Regular mutex that additionally keeps track of how often the
+   * lock is contended and of the time spent waiting for and while
+   * holding the lock. Counters are only modified while the lock
+   * is held, so no atomics are needed.
+   */
+  class DxvkMemoryAllocatorMutex {
+
+  public:
+
+    void lock() {
+      if (likely(m_mutex.try_lock())) {
+        m_lockTime = high_resolution_clock::now();
+      } else {
+        auto waitTime = high_resolution_clock::now();
+        m_mutex.lock();
+
+        m_lockTime = high_resolution_clock::now();
+        m_waitTime += m_lockTime - waitTime;
+        m_contentionCount += 1u;
+      }
+
+      m_lockCount += 1u;
+    }
+
+    void unlock() {
+      m_holdTime += high_resolution_clock::now() - m_lockTime;
+      m_mutex.unlock();
+    }
+
+    bool try_lock() {
+      if (!m_mutex.try_lock())
+        return false;
+
+      m_lockTime = high_resolution_clock::now();
+      m_lockCount += 1u;
+      return true;
+    }
+
+    /**
+     * \brief Retrieves and resets statistics
+     *
+     * Must only be called while the lock is held. The
+     * current lock operation is not accounted for.
+     * \returns Lock statistics
+     */
+    DxvkMemoryLockStats getStats() {
+      DxvkMemoryLockStats result = { };
+      result.lockCount = std::exchange(m_lockCount, 0u);
+      result.contentionCount = std::exchange(m_contentionCount, 0u);
+      result.waitTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::exchange(m_waitTime, high_resolution_clock::duration())).count();
+      result.holdTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::exchange(m_holdTime, high_resolution_clock::duration())).count();
+      return result;
+    }
+
+  private:
+
+    dxvk::mutex                       m_mutex;
+
+    high_resolution_clock::time_point m_lockTime = { };
+    high_resolution_clock::duration   m_waitTime = { };
+    high_resolution_clock::duration   m_holdTime = { };
+
+    uint64_t                          m_lockCount = 0u;
+    uint64_t                          m_contentionCount = 0u;
+
+  };
+
+
   /**
    * \brief Buffer import info
    *
@@ -1120,6 +1242,12 @@ namespace dxvk {
 
     constexpr static uint64_t DedicatedChunkAddress = 1ull << 63u;
 
+    // Number of thread allocation caches. Threads are assigned a
+    // cache based on a hash of their ID, so this need not match
+    // the actual number of threads using the allocator.
+    constexpr static uint32_t ThreadCacheBits = 3u;
+    constexpr static uint32_t ThreadCacheCount = 1u << ThreadCacheBits;
+
     constexpr static VkDeviceSize MinChunkSize =   4ull << 20;
     constexpr static VkDeviceSize MaxChunkSize = 256ull << 20;
 
@@ -1365,7 +1493,7 @@ namespace dxvk {
 
     DxvkSharingModeInfo       m_sharingModeInfo;
 
-    dxvk::mutex               m_mutex;
+    DxvkMemoryAllocatorMutex  m_mutex;
 
     uint32_t m_memTypeCount = 0u;
     uint32_t m_memHeapCount = 0u;
@@ -1395,6 +1523,10 @@ namespace dxvk {
     alignas(CACHE_LINE_SIZE)
     DxvkRelocationList        m_relocations;
 
+    std::unique_ptr<DxvkAllocationTrace> m_trace;
+
+    std::array<DxvkThreadAllocationCache, ThreadCacheCount> m_threadCaches;
+
     DxvkDeviceMemory allocateDeviceMemory(
             DxvkMemoryType&       type,
             VkDeviceSize          size,
@@ -1455,11 +1587,13 @@ namespace dxvk {
             DxvkMemoryPool&       pool,
             VkDeviceSize          address,
             VkDeviceSize          size,
+            VkDeviceSize          alignment,
       const DxvkAllocationInfo&   allocationInfo);
 
     DxvkResourceAllocation* createAllocation(
             DxvkMemoryType&       type,
       const DxvkDeviceMemory&     memory,
+            VkDeviceSize          alignment,
       const DxvkAllocationInfo&   allocationInfo);
 
     DxvkResourceAllocation* createAllocation(
@@ -1471,6 +1605,27 @@ namespace dxvk {
       const VkMemoryRequirements& requirements,
             VkMemoryPropertyFlags properties);
 
+    DxvkResourceAllocation* allocateCachedAllocationList(
+            DxvkMemoryType&       memoryType,
+            VkDeviceSize          allocationSize,
+            VkDeviceSize          alignment,
+            uint32_t&             allocationCount);
+
+    DxvkResourceAllocation* allocateFromThreadCache(
+      const VkMemoryRequirements& requirements,
+            VkMemoryPropertyFlags properties);
+
+    DxvkResourceAllocation* freeToThreadCache(
+            DxvkResourceAllocation* allocation);
+
+    void freeThreadCacheLocked(
+            DxvkThreadAllocationCache& cache);
+
+    DxvkThreadAllocationCache& getThreadCache();
+
+    static VkDeviceSize computeCachedAllocationSize(
+            VkDeviceSize          size);
+
     void getAllocationStatsForPool(
       const DxvkMemoryType&       type,
       const DxvkMemoryPool&       pool,
@@ -1506,6 +1661,17 @@ namespace dxvk {
     void updateMemoryHeapStats(
             uint32_t              heapIndex);
 
+    void queueRelocation(
+            Rc<DxvkPagedResource>&& resource,
+      const DxvkResourceAllocation* allocation,
+            DxvkAllocationModes   mode);
+
+    void traceAllocation(
+            DxvkAllocationTraceEvent event,
+      const DxvkResourceAllocation* allocation,
+            VkDeviceSize          alignment,
+            DxvkAllocationModes   mode);
+
     void moveDefragChunk(
             DxvkMemoryType&       type);
 
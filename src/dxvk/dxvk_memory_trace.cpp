@@ -0,0 +1,74 @@
+#include <atomic>
+#include <cstring>
+
+#include "dxvk_memory_trace.h"
+
+#include "../util/log/log.h"
+
+#include "../util/util_env.h"
+#include "../util/util_likely.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  static std::atomic<uint32_t> s_allocationTraceCount = { 0u };
+
+
+  DxvkAllocationTrace::DxvkAllocationTrace(
+    const std::string&                      baseName,
+    const VkPhysicalDeviceMemoryProperties& memoryProperties)
+  : m_startTime(high_resolution_clock::now()) {
+    std::string fileName = str::format(baseName, ".", env::getProcessId(),
+      ".", s_allocationTraceCount.fetch_add(1u), ".trace");
+
+    m_file.open(str::topath(fileName.c_str()).c_str(), std::ios::binary | std::ios::trunc);
+
+    if (!m_file) {
+      Logger::err(str::format("Memory: Failed to create allocation trace ", fileName));
+      return;
+    }
+
+    Logger::info(str::format("Memory: Recording allocation trace to ", fileName));
+
+    DxvkAllocationTraceHeader header = { };
+    std::memcpy(header.magic, DxvkAllocationTraceMagic, sizeof(header.magic));
+    header.version = Version;
+    header.recordSize = sizeof(DxvkAllocationTraceRecord);
+    header.memoryProperties = memoryProperties;
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_records.reserve(MaxPendingRecords);
+  }
+
+
+  DxvkAllocationTrace::~DxvkAllocationTrace() {
+    flush();
+  }
+
+
+  void DxvkAllocationTrace::record(DxvkAllocationTraceRecord record) {
+    if (unlikely(!m_file))
+      return;
+
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      high_resolution_clock::now() - m_startTime).count();
+
+    m_records.push_back(record);
+
+    if (m_records.size() >= MaxPendingRecords)
+      flush();
+  }
+
+
+  void DxvkAllocationTrace::flush() {
+    if (m_records.empty())
+      return;
+
+    m_file.write(reinterpret_cast<const char*>(m_records.data()),
+      m_records.size() * sizeof(DxvkAllocationTraceRecord));
+    m_file.flush();
+
+    m_records.clear();
+  }
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "../util/util_time.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Allocation trace event type
+   */
+  enum class DxvkAllocationTraceEvent : uint32_t {
+    Allocate  = 0,  ///< Memory got allocated
+    Free      = 1,  ///< Memory got returned to the allocator
+    Relocate  = 2,  ///< Allocation got queued for relocation
+  };
+
+
+  /**
+   * \brief Allocation trace pool type
+   */
+  enum class DxvkAllocationTracePool : uint8_t {
+    Device    = 0,  ///< Device memory pool of the memory type
+    Mapped    = 1,  ///< Mapped memory pool of the memory type
+    Dedicated = 2,  ///< Dedicated device memory allocation
+  };
+
+
+  /**
+   * \brief Allocation trace file header
+   *
+   * Stores memory properties of the device, so that memory
+   * types referenced by records can be mapped to heaps.
+   */
+  struct DxvkAllocationTraceHeader {
+    char      magic[8];
+    uint32_t  version;
+    uint32_t  recordSize;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+  };
+
+
+  /**
+   * \brief Allocation trace record
+   *
+   * Fixed-size record that is written for each event.
+   */
+  struct DxvkAllocationTraceRecord {
+    /// Time since the trace was started, in nanoseconds
+    uint64_t                  timestamp;
+    /// Unique ID of the allocation object. May be reused
+    /// for a different allocation after it is freed.
+    uint64_t                  allocation;
+    /// Address within the page allocator of the memory pool,
+    /// with the chunk index stored in the upper bits. Not
+    /// meaningful for dedicated allocations.
+    uint64_t                  address;
+    /// Allocation size, in bytes
+    uint64_t                  size;
+    /// Required alignment, in bytes. Only set for allocations.
+    uint64_t                  alignment;
+    /// Event type
+    DxvkAllocationTraceEvent  event;
+    /// Memory type index
+    uint8_t                   memoryType;
+    /// Memory pool type
+    DxvkAllocationTracePool   pool;
+    /// Raw allocation mode flags. Only set for relocations.
+    uint16_t                  mode;
+  };
+
+  static_assert(sizeof(DxvkAllocationTraceRecord) == 48u);
+
+  /// Magic number at the start of allocation trace files
+  constexpr char DxvkAllocationTraceMagic[8] = { 'D', 'X', 'V', 'K', 'M', 'E', 'M', '\0' };
+
+
+  /**
+   * \brief Allocation trace
+   *
+   * Writes memory allocator events to a binary file, so that
+   * allocation patterns of real applications can be analyzed
+   * or replayed against different allocation strategies offline
+   * using the \c dxvk-memory-replay tool. Not thread-safe, the
+   * allocator lock must be held when recording events.
+   */
+  class DxvkAllocationTrace {
+    constexpr static size_t   MaxPendingRecords = 4096u;
+  public:
+
+    constexpr static uint32_t Version = 1u;
+
+    /**
+     * \brief Creates allocation trace
+     *
+     * The trace is written to a file named after the given base
+     * name, the process ID and a per-process allocator counter,
+     * so that multiple devices do not write to the same file.
+     * \param [in] baseName Base file name
+     * \param [in] memoryProperties Device memory properties
+     */
+    DxvkAllocationTrace(
+      const std::string&                      baseName,
+      const VkPhysicalDeviceMemoryProperties& memoryProperties);
+
+    ~DxvkAllocationTrace();
+
+    DxvkAllocationTrace             (const DxvkAllocationTrace&) = delete;
+    DxvkAllocationTrace& operator = (const DxvkAllocationTrace&) = delete;
+
+    /**
+     * \brief Records an event
+     *
+     * Sets the time stamp and appends the record
+     * to the file. Records are written in batches.
+     * \param [in] record Event record
+     */
+    void record(DxvkAllocationTraceRecord record);
+
+  private:
+
+    std::ofstream                           m_file;
+    high_resolution_clock::time_point       m_startTime;
+
+    std::vector<DxvkAllocationTraceRecord>  m_records;
+
+    void flush();
+
+  };
+
+}
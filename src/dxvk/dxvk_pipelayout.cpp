@@ -411,6 +411,61 @@ namespace dxvk {
   }
 
 
+  bool DxvkShaderBindingMap::eq(const DxvkShaderBindingMap& other) const {
+    if (m_bindings.size() != other.m_bindings.size()
+     || m_pushData.size() != other.m_pushData.size())
+      return false;
+
+    for (const auto& binding : m_bindings) {
+      auto entry = other.mapBinding(binding.first);
+
+      if (!entry || !entry->eq(binding.second))
+        return false;
+    }
+
+    for (size_t i = 0u; i < m_pushData.size(); i++) {
+      const auto& a = m_pushData[i];
+      const auto& b = other.m_pushData[i];
+
+      if (a.second != b.second
+       || a.first.getStageMask() != b.first.getStageMask()
+       || a.first.getOffset() != b.first.getOffset()
+       || a.first.getSize() != b.first.getSize()
+       || a.first.getResourceDwordMask() != b.first.getResourceDwordMask())
+        return false;
+    }
+
+    return true;
+  }
+
+
+  size_t DxvkShaderBindingMap::hash() const {
+    // Binding iteration order is undefined, so accumulate
+    // individual binding hashes in a commutative way
+    size_t bindingHash = 0u;
+
+    for (const auto& binding : m_bindings) {
+      DxvkHashState entry;
+      entry.add(binding.first.hash());
+      entry.add(binding.second.hash());
+
+      bindingHash += entry;
+    }
+
+    DxvkHashState hash;
+    hash.add(bindingHash);
+
+    for (const auto& block : m_pushData) {
+      hash.add(block.first.getStageMask());
+      hash.add(block.first.getOffset());
+      hash.add(block.first.getSize());
+      hash.add(block.second);
+    }
+
+    return hash;
+  }
+
+
   DxvkPipelineBindings::DxvkPipelineBindings(
           DxvkDevice*                 device,
           DxvkPipelineManager*        manager,
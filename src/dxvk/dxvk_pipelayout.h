@@ -1475,6 +1475,22 @@ namespace dxvk {
      */
     uint32_t mapPushData(VkShaderStageFlags stage, uint32_t offset) const;
 
+    /**
+     * \brief Checks for equality
+     *
+     * \param [in] other Other binding map
+     * \returns \c true if all mappings are identical
+     */
+    bool eq(const DxvkShaderBindingMap& other) const;
+
+    /**
+     * \brief Computes hash
+     *
+     * Independent of the order in which bindings were added.
+     * \returns Hash
+     */
+    size_t hash() const;
+
   private:
 
     std::unordered_map<DxvkShaderBinding, DxvkShaderBinding, DxvkHash, DxvkEq> m_bindings;
@@ -0,0 +1,249 @@
+#include <version.h>
+
+#include "dxvk_device.h"
+#include "dxvk_pipeline_cache.h"
+#include "dxvk_shader_cache.h"
+
+namespace dxvk {
+
+  constexpr static uint32_t PipelineCacheFileVersion = 1u;
+
+  DxvkPipelineCache::DxvkPipelineCache(DxvkDevice* device)
+  : m_device(device), m_vkd(device->vkd()) {
+    auto paths = DxvkShaderCache::getDefaultFilePaths();
+
+    if (!paths.directory.empty() && !paths.vkFile.empty())
+      m_filePath = paths.directory + env::PlatformDirSlash + paths.vkFile;
+
+    std::vector<char> data;
+
+    if (!m_filePath.empty())
+      data = readCacheFile();
+
+    VkPipelineCacheCreateInfo info = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+    info.initialDataSize = data.size();
+    info.pInitialData = data.empty() ? nullptr : data.data();
+
+    VkResult vr = m_vkd->vkCreatePipelineCache(m_vkd->device(), &info, nullptr, &m_cache);
+
+    if (vr && info.initialDataSize) {
+      Logger::warn(str::format("Failed to create pipeline cache with initial data: ", vr));
+
+      info.initialDataSize = 0u;
+      info.pInitialData = nullptr;
+
+      vr = m_vkd->vkCreatePipelineCache(m_vkd->device(), &info, nullptr, &m_cache);
+    }
+
+    if (vr) {
+      Logger::warn(str::format("Failed to create pipeline cache: ", vr));
+      m_cache = VK_NULL_HANDLE;
+      return;
+    }
+
+    // Only write back to disk if the cache has actually grown
+    m_writtenSize = info.initialDataSize;
+
+    if (!m_filePath.empty())
+      m_writer = dxvk::thread([this] { runWriter(); });
+  }
+
+
+  DxvkPipelineCache::~DxvkPipelineCache() {
+    if (m_writer.joinable()) {
+      { std::unique_lock lock(m_mutex);
+        m_stopped = true;
+        m_cond.notify_one();
+      }
+
+      m_writer.join();
+    }
+
+    m_vkd->vkDestroyPipelineCache(m_vkd->device(), m_cache, nullptr);
+  }
+
+
+  std::vector<char> DxvkPipelineCache::readCacheFile() {
+    util::File file(m_filePath, util::FileFlags(util::FileFlag::AllowRead));
+
+    if (!file)
+      return std::vector<char>();
+
+    Header expected = getExpectedHeader();
+    Header header = { };
+
+    size_t offset = 0u;
+
+    auto read = [&file, &offset] (auto& data) {
+      bool status = file.read(offset, sizeof(data), &data);
+      offset += sizeof(data);
+      return status;
+    };
+
+    bool status = read(header.magic)
+               && read(header.version)
+               && read(header.dxvkVersion)
+               && read(header.vendorId)
+               && read(header.deviceId)
+               && read(header.driverVersion)
+               && read(header.uuid)
+               && read(header.dataSize)
+               && read(header.checksum);
+
+    if (!status || header.magic != expected.magic) {
+      Logger::warn(str::format("Failed to parse pipeline cache header: ", m_filePath));
+      return std::vector<char>();
+    }
+
+    if (header.version != expected.version
+     || header.dxvkVersion != expected.dxvkVersion
+     || header.vendorId != expected.vendorId
+     || header.deviceId != expected.deviceId
+     || header.driverVersion != expected.driverVersion
+     || header.uuid != expected.uuid) {
+      Logger::info("Pipeline cache created with different DXVK version or device, discarding.");
+      return std::vector<char>();
+    }
+
+    if (header.dataSize != file.size() - offset) {
+      Logger::warn(str::format("Pipeline cache size mismatch: ", m_filePath));
+      return std::vector<char>();
+    }
+
+    std::vector<char> data(header.dataSize);
+
+    if (!file.read(offset, data.size(), data.data())
+     || header.checksum != bit::fnv1a_hash(data.data(), data.size())) {
+      Logger::warn(str::format("Pipeline cache checksum mismatch: ", m_filePath));
+      return std::vector<char>();
+    }
+
+    Logger::info(str::format("Found pipeline cache file: ", m_filePath, " (", data.size(), " bytes)"));
+    return data;
+  }
+
+
+  bool DxvkPipelineCache::writeCacheFile(size_t size) {
+    std::vector<char> data(size);
+
+    VkResult vr = m_vkd->vkGetPipelineCacheData(m_vkd->device(), m_cache, &size, data.data());
+
+    // The cache may have grown in the meantime, in which case we get
+    // an incomplete but still valid blob, which is fine to write.
+    if (vr < 0) {
+      Logger::warn(str::format("Failed to query pipeline cache data: ", vr));
+      return false;
+    }
+
+    data.resize(size);
+
+    Header header = getExpectedHeader();
+    header.dataSize = data.size();
+    header.checksum = bit::fnv1a_hash(data.data(), data.size());
+
+    // Write to a temporary file and move it into place, so that the
+    // existing cache is not lost if the process dies while writing.
+    std::string tmpPath = m_filePath + ".tmp";
+
+    auto flags = util::FileFlags(
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Truncate,
+      util::FileFlag::Exclusive);
+
+    bool status = false;
+
+    { util::File file(tmpPath, flags);
+
+      if (!file) {
+        auto directory = DxvkShaderCache::getDefaultFilePaths().directory;
+
+        if (!env::createDirectory(directory)) {
+          Logger::warn(str::format("Failed to create directory: ", directory));
+          return false;
+        }
+
+        file = util::File(tmpPath, flags);
+      }
+
+      if (!file) {
+        Logger::warn(str::format("Failed to create pipeline cache file: ", tmpPath));
+        return false;
+      }
+
+      auto write = [&file] (const auto& data) {
+        return file.append(sizeof(data), &data);
+      };
+
+      status = write(header.magic)
+            && write(header.version)
+            && write(header.dxvkVersion)
+            && write(header.vendorId)
+            && write(header.deviceId)
+            && write(header.driverVersion)
+            && write(header.uuid)
+            && write(header.dataSize)
+            && write(header.checksum)
+            && file.append(data.size(), data.data())
+            && file.flush();
+    }
+
+    if (!status || !env::replaceFile(tmpPath, m_filePath)) {
+      Logger::warn(str::format("Failed to write pipeline cache file: ", m_filePath));
+      env::removeFile(tmpPath);
+      return false;
+    }
+
+    m_writtenSize = data.size();
+    return true;
+  }
+
+
+  DxvkPipelineCache::Header DxvkPipelineCache::getExpectedHeader() const {
+    const auto& properties = m_device->properties().core.properties;
+
+    std::string version = DXVK_VERSION;
+
+    Header header = { };
+    header.magic = { 'D', 'X', 'P', 'C' };
+    header.version = PipelineCacheFileVersion;
+    header.dxvkVersion = bit::fnv1a_hash(version.data(), version.size());
+    header.vendorId = properties.vendorID;
+    header.deviceId = properties.deviceID;
+    header.driverVersion = properties.driverVersion;
+
+    for (size_t i = 0u; i < header.uuid.size(); i++)
+      header.uuid[i] = properties.pipelineCacheUUID[i];
+
+    return header;
+  }
+
+
+  void DxvkPipelineCache::runWriter() {
+    env::setThreadName("dxvk-pipecache");
+
+    bool stopped = false;
+
+    while (!stopped) {
+      { std::unique_lock lock(m_mutex);
+
+        m_cond.wait_for(lock, std::chrono::seconds(10), [this] {
+          return m_stopped;
+        });
+
+        stopped = m_stopped;
+      }
+
+      // The driver merges all pipelines compiled so far into the cache,
+      // including the initial data, so we only need to check whether the
+      // blob has changed since the last time it was written to disk.
+      size_t size = 0u;
+
+      if (m_vkd->vkGetPipelineCacheData(m_vkd->device(), m_cache, &size, nullptr))
+        return;
+
+      if (size != m_writtenSize && !writeCacheFile(size))
+        return;
+    }
+  }
+
+}
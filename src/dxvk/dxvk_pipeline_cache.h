@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../util/thread.h"
+#include "../util/util_file.h"
+
+#include "../vulkan/vulkan_loader.h"
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Persistent Vulkan pipeline cache
+   *
+   * Wraps a \c VkPipelineCache object that is used for all pipeline
+   * and pipeline library compiles on the device. The cache blob is
+   * stored next to the shader cache files, loaded when the device
+   * is created, and written back by a background thread whenever
+   * the driver reports that the cache has grown.
+   */
+  class DxvkPipelineCache {
+
+  public:
+
+    DxvkPipelineCache(DxvkDevice* device);
+
+    ~DxvkPipelineCache();
+
+    /**
+     * \brief Queries pipeline cache handle
+     *
+     * May be \c VK_NULL_HANDLE if cache creation failed,
+     * which is valid to pass to pipeline creation functions.
+     * \returns Pipeline cache handle
+     */
+    VkPipelineCache handle() const {
+      return m_cache;
+    }
+
+  private:
+
+    struct Header {
+      std::array<char, 4u>  magic = { };
+      uint32_t              version = 0u;
+      uint64_t              dxvkVersion = 0u;
+      uint32_t              vendorId = 0u;
+      uint32_t              deviceId = 0u;
+      uint32_t              driverVersion = 0u;
+      std::array<uint8_t, VK_UUID_SIZE> uuid = { };
+      uint64_t              dataSize = 0u;
+      uint64_t              checksum = 0u;
+    };
+
+    DxvkDevice*               m_device;
+    Rc<vk::DeviceFn>          m_vkd;
+
+    std::string               m_filePath;
+
+    VkPipelineCache           m_cache = VK_NULL_HANDLE;
+
+    size_t                    m_writtenSize = 0u;
+
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_cond;
+    bool                      m_stopped = false;
+
+    dxvk::thread              m_writer;
+
+    std::vector<char> readCacheFile();
+
+    bool writeCacheFile(size_t size);
+
+    Header getExpectedHeader() const;
+
+    void runWriter();
+
+  };
+
+}
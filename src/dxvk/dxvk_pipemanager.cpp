@@ -20,13 +20,11 @@ namespace dxvk {
   void DxvkPipelineWorkers::compilePipelineLibrary(
           DxvkShaderPipelineLibrary*      library,
           DxvkPipelinePriority            priority) {
-    std::unique_lock lock(m_lock);
     this->startWorkers();
 
     m_tasksTotal += 1;
 
-    m_buckets[uint32_t(priority)].queue.emplace(library);
-    notifyWorkers(priority);
+    enqueue(priority, library);
   }
 
 
@@ -34,24 +32,23 @@ namespace dxvk {
           DxvkGraphicsPipeline*           pipeline,
     const DxvkGraphicsPipelineStateInfo&  state,
           DxvkPipelinePriority            priority) {
-    std::unique_lock lock(m_lock);
     this->startWorkers();
 
     pipeline->acquirePipeline();
     m_tasksTotal += 1;
 
-    m_buckets[uint32_t(priority)].queue.emplace(pipeline, state);
-    notifyWorkers(priority);
+    enqueue(priority, pipeline, state);
   }
 
 
   void DxvkPipelineWorkers::stopWorkers() {
-    { std::unique_lock lock(m_lock);
+    std::unique_lock lock(m_lock);
 
-      if (!m_workersRunning)
-        return;
+    if (!m_workersRunning.load())
+      return;
 
-      m_workersRunning = false;
+    { std::unique_lock idleLock(m_idleLock);
+      m_workersRunning.store(false);
 
       for (uint32_t i = 0; i < m_buckets.size(); i++)
         m_buckets[i].cond.notify_all();
@@ -61,6 +58,78 @@ namespace dxvk {
       worker.join();
 
     m_workers.clear();
+
+    // Discard any work that is still queued up
+    m_queues.clear();
+
+    for (auto& pending : m_pending)
+      pending.store(0u);
+  }
+
+
+  template<typename... Args>
+  void DxvkPipelineWorkers::enqueue(
+          DxvkPipelinePriority            priority,
+          Args&&...                       args) {
+    uint32_t index = uint32_t(priority);
+
+    // Distribute work among all workers that can process the given
+    // priority. Since idle workers will steal work from others, this
+    // does not need to be perfectly balanced.
+    uint32_t queueIndex = m_nextQueue.fetch_add(1u, std::memory_order_relaxed);
+    auto& queue = *m_queues[queueIndex % m_queueCounts[index]];
+
+    { std::unique_lock lock(queue.lock);
+      queue.queues[index].emplace_back(std::forward<Args>(args)...);
+
+      // Must be incremented before checking for idle
+      // workers, or we might miss a worker going idle
+      m_pending[index] += 1u;
+    }
+
+    notifyWorkers(priority);
+  }
+
+
+  bool DxvkPipelineWorkers::dequeue(
+          uint32_t                        workerIndex,
+          uint32_t                        maxPriorityIndex,
+          PipelineEntry&                  entry) {
+    uint32_t queueCount = m_queues.size();
+
+    // Fetch a work item from the highest-priority queue that is not empty.
+    // Check the worker's own queue first, and steal from other workers'
+    // queues if that is empty.
+    for (uint32_t i = 0; i <= maxPriorityIndex; i++) {
+      if (!m_pending[i].load())
+        continue;
+
+      for (uint32_t j = 0; j < queueCount; j++) {
+        auto& queue = *m_queues[(workerIndex + j) % queueCount];
+        std::unique_lock lock(queue.lock);
+
+        if (!queue.queues[i].empty()) {
+          entry = std::move(queue.queues[i].front());
+          queue.queues[i].pop_front();
+
+          m_pending[i] -= 1u;
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+
+  bool DxvkPipelineWorkers::hasPendingWork(
+          uint32_t                        maxPriorityIndex) const {
+    for (uint32_t i = 0; i <= maxPriorityIndex; i++) {
+      if (m_pending[i].load())
+        return true;
+    }
+
+    return false;
   }
 
 
@@ -71,7 +140,8 @@ namespace dxvk {
     // condition variable. If all workers are busy anyway, we know that the
     // job is going to be picked up at some point anyway.
     for (uint32_t i = index; i < m_buckets.size(); i++) {
-      if (m_buckets[i].idleWorkers) {
+      if (m_buckets[i].idleWorkers.load()) {
+        std::unique_lock lock(m_idleLock);
         m_buckets[i].cond.notify_one();
         break;
       }
@@ -80,80 +150,95 @@ namespace dxvk {
 
 
   void DxvkPipelineWorkers::startWorkers() {
-    if (!std::exchange(m_workersRunning, true)) {
-      // Use all available cores by default
-      uint32_t workerCount = dxvk::thread::hardware_concurrency();
+    if (m_workersRunning.load(std::memory_order_acquire))
+      return;
 
-      if (workerCount <  1) workerCount =  1;
-      if (workerCount > 64) workerCount = 64;
+    std::unique_lock lock(m_lock);
 
-      // Reduce worker count on 32-bit to save adderss space
-      if (env::is32BitHostPlatform())
-        workerCount = std::min(workerCount, 16u);
+    if (m_workersRunning.load())
+      return;
 
-      if (m_device->config().numCompilerThreads > 0)
-        workerCount = m_device->config().numCompilerThreads;
+    // Use all available cores by default
+    uint32_t workerCount = dxvk::thread::hardware_concurrency();
 
-      // Number of workers that can process pipeline pipelines with normal
-      // priority. Any other workers can only build high-priority pipelines.
-      uint32_t npWorkerCount = std::max(((workerCount - 1) * 5) / 7, 1u);
-      uint32_t lpWorkerCount = std::max(((workerCount - 1) * 2) / 7, 1u);
+    if (workerCount <  1) workerCount =  1;
+    if (workerCount > 64) workerCount = 64;
 
-      m_workers.reserve(workerCount);
+    // Reduce worker count on 32-bit to save adderss space
+    if (env::is32BitHostPlatform())
+      workerCount = std::min(workerCount, 16u);
 
-      for (size_t i = 0; i < workerCount; i++) {
-        DxvkPipelinePriority priority = DxvkPipelinePriority::Normal;
+    if (m_device->config().numCompilerThreads > 0)
+      workerCount = m_device->config().numCompilerThreads;
 
-        if (i >= npWorkerCount)
-          priority = DxvkPipelinePriority::High;
-        else if (i < lpWorkerCount)
-          priority = DxvkPipelinePriority::Low;
+    // Number of workers that can process pipeline pipelines with normal
+    // priority. Any other workers can only build high-priority pipelines.
+    uint32_t npWorkerCount = std::max(((workerCount - 1) * 5) / 7, 1u);
+    uint32_t lpWorkerCount = std::max(((workerCount - 1) * 2) / 7, 1u);
 
-        auto& worker = m_workers.emplace_back([this, priority] {
-          runWorker(priority);
-        });
-        
-        worker.set_priority(ThreadPriority::Lowest);
-      }
+    // Workers that can process a given priority are always at the start
+    // of the worker list, so work can be distributed among the first n
+    // queues when submitting it.
+    m_queueCounts[uint32_t(DxvkPipelinePriority::High)]   = workerCount;
+    m_queueCounts[uint32_t(DxvkPipelinePriority::Normal)] = npWorkerCount;
+    m_queueCounts[uint32_t(DxvkPipelinePriority::Low)]    = lpWorkerCount;
+
+    m_queues.reserve(workerCount);
+
+    for (size_t i = 0; i < workerCount; i++)
+      m_queues.push_back(std::make_unique<PipelineQueue>());
+
+    m_workersRunning.store(true, std::memory_order_release);
+    m_workers.reserve(workerCount);
+
+    for (uint32_t i = 0; i < workerCount; i++) {
+      DxvkPipelinePriority priority = DxvkPipelinePriority::Normal;
+
+      if (i >= npWorkerCount)
+        priority = DxvkPipelinePriority::High;
+      else if (i < lpWorkerCount)
+        priority = DxvkPipelinePriority::Low;
 
-      Logger::info(str::format("DXVK: Using ", workerCount, " compiler threads"));
+      auto& worker = m_workers.emplace_back([this, i, priority] {
+        runWorker(i, priority);
+      });
+
+      worker.set_priority(ThreadPriority::Lowest);
     }
+
+    Logger::info(str::format("DXVK: Using ", workerCount, " compiler threads"));
   }
 
 
-  void DxvkPipelineWorkers::runWorker(DxvkPipelinePriority maxPriority) {
+  void DxvkPipelineWorkers::runWorker(
+          uint32_t                        workerIndex,
+          DxvkPipelinePriority            maxPriority) {
     static const std::array<char, 3> suffixes = { 'h', 'n', 'l' };
 
     const uint32_t maxPriorityIndex = uint32_t(maxPriority);
     env::setThreadName(str::format("dxvk-shader-", suffixes.at(maxPriorityIndex)));
 
     while (true) {
+      // Skip pending work, exiting early is
+      // more important in this case.
+      if (!m_workersRunning.load())
+        break;
+
       PipelineEntry entry;
 
-      { std::unique_lock lock(m_lock);
+      if (!dequeue(workerIndex, maxPriorityIndex, entry)) {
+        std::unique_lock lock(m_idleLock);
         auto& bucket = m_buckets[maxPriorityIndex];
 
+        // Pending work counts are checked after marking the worker
+        // as idle, which pairs with the submission path checking
+        // for idle workers after adding work.
         bucket.idleWorkers += 1;
-        bucket.cond.wait(lock, [this, maxPriorityIndex, &entry] {
-          // Attempt to fetch a work item from the
-          // highest-priority queue that is not empty
-          for (uint32_t i = 0; i <= maxPriorityIndex; i++) {
-            if (!m_buckets[i].queue.empty()) {
-              entry = m_buckets[i].queue.front();
-              m_buckets[i].queue.pop();
-              return true;
-            }
-          }
-
-          return !m_workersRunning;
+        bucket.cond.wait(lock, [this, maxPriorityIndex] {
+          return hasPendingWork(maxPriorityIndex) || !m_workersRunning.load();
         });
-
         bucket.idleWorkers -= 1;
-
-        // Skip pending work, exiting early is
-        // more important in this case.
-        if (!m_workersRunning)
-          break;
+        continue;
       }
 
       if (entry.pipelineLibrary) {
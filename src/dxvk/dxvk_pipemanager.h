@@ -1,8 +1,9 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <unordered_map>
 
 #include "dxvk_compute.h"
@@ -52,6 +53,13 @@ namespace dxvk {
    *
    * Spawns worker threads to compile shader pipeline
    * libraries and optimized pipelines asynchronously.
+   *
+   * Each worker owns one queue per priority, protected by a
+   * per-worker lock. New work is distributed round-robin among the
+   * workers that can process the given priority, and idle workers
+   * steal work from other workers' queues, so that submitting and
+   * fetching work does not serialize on one global lock. A shared
+   * lock is only taken in order to put idle workers to sleep.
    */
   class DxvkPipelineWorkers {
 
@@ -124,10 +132,14 @@ namespace dxvk {
       DxvkGraphicsPipelineStateInfo graphicsState;
     };
 
+    struct PipelineQueue {
+      dxvk::mutex                             lock;
+      std::array<std::deque<PipelineEntry>, 3> queues;
+    };
+
     struct PipelineBucket {
       dxvk::condition_variable  cond;
-      std::queue<PipelineEntry> queue;
-      uint32_t                  idleWorkers = 0;
+      std::atomic<uint32_t>     idleWorkers = { 0u };
     };
 
     DxvkDevice*                       m_device;
@@ -136,16 +148,38 @@ namespace dxvk {
     std::atomic<uint64_t>             m_tasksCompleted = { 0ull };
 
     dxvk::mutex                       m_lock;
+    std::atomic<bool>                 m_workersRunning = { false };
+    std::vector<dxvk::thread>         m_workers;
+
+    std::vector<std::unique_ptr<PipelineQueue>> m_queues;
+    std::array<uint32_t, 3>           m_queueCounts = { };
+    std::atomic<uint32_t>             m_nextQueue = { 0u };
+
+    std::array<std::atomic<uint64_t>, 3> m_pending = { };
+
+    dxvk::mutex                       m_idleLock;
     std::array<PipelineBucket, 3>     m_buckets;
 
-    bool                              m_workersRunning = false;
-    std::vector<dxvk::thread>         m_workers;
+    template<typename... Args>
+    void enqueue(
+            DxvkPipelinePriority            priority,
+            Args&&...                       args);
+
+    bool dequeue(
+            uint32_t                        workerIndex,
+            uint32_t                        maxPriorityIndex,
+            PipelineEntry&                  entry);
+
+    bool hasPendingWork(
+            uint32_t                        maxPriorityIndex) const;
 
     void notifyWorkers(DxvkPipelinePriority priority);
 
     void startWorkers();
 
-    void runWorker(DxvkPipelinePriority maxPriority);
+    void runWorker(
+            uint32_t                        workerIndex,
+            DxvkPipelinePriority            maxPriority);
 
   };
 
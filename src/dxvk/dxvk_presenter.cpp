@@ -48,6 +48,8 @@ namespace dxvk {
     // the present fence if presentation is queued but fails.
     // TODO Remove this hack when this gets fixed in stable SteamOS.
     m_hasGamescopeFenceSignalBug = env::getEnvVar("ENABLE_GAMESCOPE_WSI") == "1";
+
+    m_fpsLimiter.setPrecisePacing(m_device->config().preciseFramePacing);
   }
 
   
@@ -161,6 +161,16 @@ namespace dxvk {
      */
     void setFrameRateLimit(double frameRate, uint32_t maxLatency);
 
+    /**
+     * \brief Retrieves frame pacing statistics
+     *
+     * Resets the statistics after querying them.
+     * \returns Frame rate limiter pacing statistics
+     */
+    FpsLimiterStats getFramePacingStats() {
+      return m_fpsLimiter.getStatistics();
+    }
+
     /**
      * \brief Sets preferred color space and format
      *
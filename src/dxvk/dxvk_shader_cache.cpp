@@ -1,21 +1,47 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iomanip>
 #include <version.h>
 
 #include "dxvk_shader_cache.h"
 
+#include "../util/util_compress.h"
 #include "../util/util_time.h"
 
 namespace dxvk {
 
+  constexpr static uint32_t LutFileVersion = 2u;
+
+  constexpr static uint32_t IndexFileVersion = 5u;
+
+  // Number of unindexed look-up table entries that causes
+  // the index to be rebuilt when initializing the cache
+  constexpr static size_t IndexRebuildThreshold = 256u;
+
+  // Minimum amount of reclaimable data in the binary
+  // file before the cache gets compacted on startup
+  constexpr static size_t CompactionMinDeadSize = 1ull << 20;
+
+  // Maximum amount of serialized shader data to
+  // accumulate before writing it to the cache files
+  constexpr static size_t WriteBatchMaxSize = 4ull << 20;
+
   DxvkShaderCache::Instance DxvkShaderCache::s_instance;
 
   DxvkShaderCache::DxvkShaderCache()
-  : m_filePaths(getDefaultFilePaths()) {
-
+  : m_filePaths(getDefaultFilePaths()),
+    m_compress(env::getEnvVar("DXVK_SHADER_CACHE_COMPRESS") == "1") {
+    // Parsing and compacting the cache files may take a while,
+    // do it in the background while the application starts up.
+    m_initializer = dxvk::thread([this] { runInitializer(); });
   }
 
 
   DxvkShaderCache::~DxvkShaderCache() {
+    if (m_initializer.joinable())
+      m_initializer.join();
+
     if (m_writer.joinable()) {
       { std::unique_lock lock(m_writeMutex);
         m_writeQueue.push(nullptr);
@@ -24,6 +50,11 @@ namespace dxvk {
 
       m_writer.join();
     }
+
+    if (m_status.load() == Status::OpenReadWrite) {
+      std::unique_lock lock(m_fileMutex);
+      updateUsageStampsLocked();
+    }
   }
 
 
@@ -37,9 +68,11 @@ namespace dxvk {
     k.name = name;
     k.createInfo = options;
 
-    auto entry = m_lut.find(k);
+    // The look-up table, index and mappings are not modified after
+    // initialization, so lookups do not need to wait for the writer.
+    IndexBucket entry = { };
 
-    if (entry == m_lut.end()) {
+    if (!findEntry(k, entry)) {
       if (Logger::logLevel() <= LogLevel::Debug)
         Logger::debug(str::format("Shader cache miss: ", name));
 
@@ -48,21 +81,19 @@ namespace dxvk {
 
     if (Logger::logLevel() <= LogLevel::Debug) {
       Logger::debug(str::format("Shader cache hit: ", name,
-        " (offset: ", entry->second.offset,
-        ", size: ", entry->second.binarySize,
-        ", metadata: ", entry->second.metadataSize, ")"));
+        " (offset: ", entry.entry.offset,
+        ", size: ", entry.entry.binarySize,
+        ", metadata: ", entry.entry.metadataSize, ")"));
     }
 
-    std::unique_lock lock(m_fileMutex);
-    auto shader = loadCachedShaderLocked(entry->first, entry->second);
+    auto shader = loadCachedShader(k, entry.entry);
 
-    if (!shader) {
+    if (shader) {
+      std::lock_guard lock(m_usageMutex);
+      m_usedKeys.insert(entry.keyOffset);
+    } else {
       Logger::warn(str::format("Failed to load cached shader ", name));
-
-      if (!openWriteOnlyLocked())
-        Logger::warn(str::format("Failed to re-initialize shader cache ", name));
-
-      m_status.store(Status::OpenWriteOnly, std::memory_order_release);
+      invalidate();
     }
 
     return shader;
@@ -77,11 +108,15 @@ namespace dxvk {
     k.name = shader->debugName();
     k.createInfo = shader->getShaderCreateInfo();
 
-    if (m_lut.find(k) == m_lut.end()) {
+    IndexBucket entry = { };
+
+    if (!findEntry(k, entry)) {
       std::unique_lock lock(m_writeMutex);
       m_writeQueue.push(std::move(shader));
       m_writeCond.notify_one();
 
+      m_statQueueDepth.fetch_add(1u, std::memory_order_relaxed);
+
       if (!m_writer.joinable())
         m_writer = dxvk::thread([this] { runWriter(); });
     }
@@ -91,39 +126,59 @@ namespace dxvk {
   bool DxvkShaderCache::ensureStatus(Status status) {
     auto currentStatus = m_status.load(std::memory_order_acquire);
 
-    if (currentStatus == Status::Uninitialized)
-      currentStatus = initialize();
+    if (unlikely(currentStatus == Status::Uninitialized)) {
+      std::unique_lock lock(m_fileMutex);
+
+      m_statusCond.wait(lock, [this, &currentStatus] {
+        currentStatus = m_status.load(std::memory_order_acquire);
+        return currentStatus != Status::Uninitialized;
+      });
+    }
 
     return currentStatus >= status;
   }
 
 
-  DxvkShaderCache::Status DxvkShaderCache::initialize() {
-    std::unique_lock lock(m_fileMutex);
-    auto status = m_status.load(std::memory_order_relaxed);
-
-    if (status != Status::Uninitialized)
-      return status;
+  void DxvkShaderCache::runInitializer() {
+    env::setThreadName("dxvk-cache-init");
 
-    status = tryInitializeLocked();
+    std::unique_lock lock(m_fileMutex);
+    auto status = tryInitializeLocked();
 
     m_status.store(status, std::memory_order_release);
-    return status;
+    m_statusCond.notify_all();
   }
 
 
   DxvkShaderCache::Status DxvkShaderCache::tryInitializeLocked() {
-    if (m_filePaths.directory.empty() || m_filePaths.binFile.empty() || m_filePaths.lutFile.empty()) {
+    if (m_filePaths.directory.empty() || m_filePaths.binFile.empty() || m_filePaths.lutFile.empty() || m_filePaths.idxFile.empty()) {
       Logger::warn("No path found for shader cache, consider setting DXVK_SHADER_CACHE_PATH.");
       return Status::CacheDisabled;
     }
 
     if (openReadWriteLocked()) {
-      if (parseLut())
+      bool valid = parseLut();
+
+      // Compaction replaces all files, so it must happen before the binary
+      // file gets mapped, since Windows does not allow replacing files with
+      // an active mapping. Re-open and parse the files if that happened.
+      if (valid && needsCompactionLocked() && compactLocked())
+        valid = openReadWriteLocked() && parseLut();
+
+      if (valid) {
+        if (m_lut.size() >= IndexRebuildThreshold && !buildIndexLocked())
+          Logger::warn("Failed to build shader cache index.");
+
+        // Serialized IR of cache hits is used directly from the mapped
+        // file, so the binary must not be truncated after this point.
+        m_binMapping = m_binFile.map(m_binFile.size());
         return Status::OpenReadWrite;
+      }
+
+      closeFilesLocked();
     }
 
-    if (openWriteOnlyLocked())
+    if (createFilesLocked())
       return Status::OpenReadWrite;
 
     return Status::CacheDisabled;
@@ -151,48 +206,66 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::openWriteOnlyLocked() {
-    // Didn't have a lot of success so far, nuke the files and retry.
+  bool DxvkShaderCache::createFilesLocked() {
+    // Didn't have a lot of success so far, start over with new files.
+    // The old files may still be mapped by another process, so they must
+    // never be truncated. Instead, write the new files to a temporary
+    // location and move them into place, which preserves existing mappings.
     auto path = m_filePaths.directory + env::PlatformDirSlash;
 
     auto flags = util::FileFlags(
+      util::FileFlag::AllowRead,
       util::FileFlag::AllowWrite,
       util::FileFlag::Truncate,
       util::FileFlag::Exclusive);
 
-    m_binFile.open(path + m_filePaths.binFile, flags);
-    m_lutFile.open(path + m_filePaths.lutFile, flags);
+    if (!env::createDirectory(m_filePaths.directory)) {
+      Logger::warn(str::format("Failed to create directory: ", m_filePaths.directory));
+      return false;
+    }
 
-    if (!m_binFile || !m_lutFile) {
-      if (!env::createDirectory(m_filePaths.directory)) {
-        Logger::warn(str::format("Failed to create directory: ", m_filePaths.directory));
-        return false;
-      }
+    m_generation = createGeneration();
 
-      m_binFile.open(path + m_filePaths.binFile, flags);
-      m_lutFile.open(path + m_filePaths.lutFile, flags);
-    }
+    LutHeader header = { };
+    header.magic = { 'D', 'X', 'V', 'K' };
+    header.version = LutFileVersion;
+    header.versionString = DXVK_VERSION;
+    header.generation = m_generation;
 
-    if (!m_binFile)
-      Logger::warn(str::format("Failed to create ", path + m_filePaths.binFile, ", disabling cache"));
+    bool status = false;
 
-    if (!m_lutFile)
-      Logger::warn(str::format("Failed to create ", path + m_filePaths.lutFile, ", disabling cache"));
+    { util::File binFile(path + m_filePaths.binFile + ".tmp", flags);
+      util::File lutFile(path + m_filePaths.lutFile + ".tmp", flags);
 
-    if (!m_binFile || !m_lutFile)
+      status = binFile && lutFile
+        && writeBinHeader(binFile, m_generation) && binFile.flush()
+        && writeHeader(lutFile, header) && lutFile.flush();
+    }
+
+    // Any existing index is invalidated by the new generation.
+    status = status
+      && env::replaceFile(path + m_filePaths.binFile + ".tmp", path + m_filePaths.binFile)
+      && env::replaceFile(path + m_filePaths.lutFile + ".tmp", path + m_filePaths.lutFile);
+
+    if (!status) {
+      Logger::warn(str::format("Failed to create ", path + m_filePaths.binFile, ", disabling cache"));
+      removeTempFiles();
       return false;
+    }
 
-    Logger::info(str::format("Created cache file: ", path + m_filePaths.binFile));
+    flags.clr(util::FileFlag::Truncate);
 
-    LutHeader header = { };
-    header.magic = { 'D', 'X', 'V', 'K' };
-    header.versionString = DXVK_VERSION;
+    m_binFile.open(path + m_filePaths.binFile, flags);
+    m_lutFile.open(path + m_filePaths.lutFile, flags);
 
-    if (!writeHeader(m_lutFile, header)) {
-      Logger::warn(str::format("Failed to write cache header: ", path + m_filePaths.lutFile));
+    if (!m_binFile || !m_lutFile) {
+      Logger::warn(str::format("Failed to open ", path + m_filePaths.binFile, ", disabling cache"));
       return false;
     }
 
+    Logger::info(str::format("Created cache file: ", path + m_filePaths.binFile));
+
+    m_lutDataOffset = m_lutFile.size();
     return true;
   }
 
@@ -204,26 +277,59 @@ namespace dxvk {
     size_t offset = 0u;
 
     if (!readBytes(m_lutFile, header.magic.data(), offset, header.magic.size())
-     || !readString(m_lutFile, offset, header.versionString)) {
+     || !read(m_lutFile, offset, header.version)
+     || !readString(m_lutFile, offset, header.versionString)
+     || !read(m_lutFile, offset, header.generation)
+     || header.magic != std::array<char, 4u>({ 'D', 'X', 'V', 'K' })) {
       Logger::warn("Failed to parse cache file header.");
       return false;
     }
 
-    if (header.versionString != DXVK_VERSION) {
+    if (header.version != LutFileVersion || header.versionString != DXVK_VERSION) {
       Logger::warn(str::format("Cache was created with DXVK version ", header.versionString,
         ", but current version is ", DXVK_VERSION, ". Discarding old cache."));
       return false;
     }
 
+    // The generation changes whenever the files get rewritten, so a
+    // mismatch means that replacing the files did not complete.
+    BinHeader binHeader = { };
+    size_t binOffset = 0u;
+
+    if (!read(m_binFile, binOffset, binHeader)
+     || binHeader.magic != std::array<char, 4u>({ 'D', 'X', 'V', 'B' })
+     || binHeader.version != LutFileVersion
+     || binHeader.generation != header.generation
+     || !header.generation) {
+      Logger::warn("Shader cache files do not match. Discarding old cache.");
+      return false;
+    }
+
+    m_generation = header.generation;
+    m_lutDataOffset = offset;
+    m_lutMapping = m_lutFile.map(size);
+
+    // Only parse entries that are not covered by the index
+    if (mapIndexLocked(offset, size))
+      offset = m_idxHeader.lutSize;
+
     while (offset < size) {
       LutKey k;
-      LutEntry e;
+      IndexBucket e;
+
+      e.keyOffset = offset;
+      e.lastUse = getUsageStamp();
 
-      if (!readShaderLutEntry(k, e, offset)) {
+      if (!readShaderLutEntry(k, e.entry, offset)) {
         Logger::warn("Failed to parse cache look-up table.");
         return false;
       }
 
+      e.keySize = offset - e.keyOffset - sizeof(e.entry);
+
+      auto key = serializeLutKey(k.name, k.createInfo);
+      e.keyHash = bit::fnv1a_hash(key.data.data(), key.data.size());
+
       m_lut.insert_or_assign(k, e);
     }
 
@@ -231,7 +337,637 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::writeShaderXfbInfo(util::File& stream, const dxbc_spv::ir::IoXfbInfo& xfb) {
+  void DxvkShaderCache::invalidate() {
+    auto status = Status::OpenReadWrite;
+
+    if (!m_status.compare_exchange_strong(status, Status::OpenWriteOnly, std::memory_order_release))
+      return;
+
+    // Shaders may still use the mapped files, so only clear the generation
+    // in the look-up table header, the cache will be recreated on the next
+    // run. This is the last field of the header.
+    std::lock_guard lock(m_fileMutex);
+
+    uint64_t generation = 0u;
+
+    if (!m_lutFile.write(m_lutDataOffset - sizeof(generation), sizeof(generation), &generation) || !m_lutFile.flush())
+      Logger::warn("Failed to invalidate shader cache");
+  }
+
+
+  void DxvkShaderCache::closeFilesLocked() {
+    m_lutFile = util::File();
+    m_binFile = util::File();
+
+    m_lut.clear();
+
+    m_lutMapping = nullptr;
+    m_binMapping = nullptr;
+    m_idxMapping = nullptr;
+
+    m_idxHeader = IndexHeader();
+  }
+
+
+  bool DxvkShaderCache::mapIndexLocked(size_t lutOffset, size_t lutSize) {
+    auto path = m_filePaths.directory + env::PlatformDirSlash + m_filePaths.idxFile;
+
+    util::File file(path, util::FileFlags(util::FileFlag::AllowRead));
+
+    size_t fileSize = file.size();
+
+    if (fileSize < sizeof(IndexHeader))
+      return false;
+
+    IndexHeader header = { };
+    size_t offset = 0u;
+
+    if (!read(file, offset, header)
+     || header.magic != std::array<char, 4u>({ 'D', 'X', 'V', 'I' })) {
+      Logger::warn(str::format("Failed to parse cache index header: ", path));
+      return false;
+    }
+
+    if (header.version != IndexFileVersion
+     || header.dxvkVersion != getIndexVersionHash()
+     || header.generation != m_generation
+     || header.lutSize < lutOffset || header.lutSize > lutSize
+     || header.binSize > m_binFile.size()
+     || !header.bucketCount || (header.bucketCount & (header.bucketCount - 1u))
+     || header.entryCount >= header.bucketCount
+     || fileSize != sizeof(header) + header.bucketCount * sizeof(IndexBucket)) {
+      Logger::warn(str::format("Shader cache index out of date, ignoring: ", path));
+      return false;
+    }
+
+    // An index that is not backed by a mapped look-up table is useless
+    if (!m_lutMapping || m_lutMapping->size() < header.lutSize)
+      return false;
+
+    m_idxMapping = file.map(fileSize);
+
+    if (!m_idxMapping)
+      return false;
+
+    m_idxHeader = header;
+    return true;
+  }
+
+
+  bool DxvkShaderCache::buildIndexLocked() {
+    if (!m_lutMapping)
+      return false;
+
+    uint32_t entryCount = m_lut.size();
+
+    if (m_idxMapping)
+      entryCount += m_idxHeader.entryCount;
+
+    uint32_t bucketCount = computeBucketCount(entryCount);
+
+    std::vector<IndexBucket> buckets(bucketCount);
+    entryCount = 0u;
+
+    auto insert = [&] (const IndexBucket& e) {
+      auto data = reinterpret_cast<const char*>(m_lutMapping->data()) + e.keyOffset;
+
+      for (uint32_t i = e.keyHash & (bucketCount - 1u); ; i = (i + 1u) & (bucketCount - 1u)) {
+        if (!buckets[i].keySize)
+          entryCount += 1u;
+        else if (buckets[i].keyHash != e.keyHash || !compareKeyData(buckets[i], data, e.keySize))
+          continue;
+
+        buckets[i] = e;
+        return;
+      }
+    };
+
+    // Entries from the look-up table tail take precedence over
+    // entries in the old index in case a key was written twice.
+    if (m_idxMapping) {
+      auto oldBuckets = reinterpret_cast<const IndexBucket*>(
+        reinterpret_cast<const char*>(m_idxMapping->data()) + sizeof(IndexHeader));
+
+      for (uint32_t i = 0u; i < m_idxHeader.bucketCount; i++) {
+        if (oldBuckets[i].keySize)
+          insert(oldBuckets[i]);
+      }
+    }
+
+    for (const auto& e : m_lut)
+      insert(e.second);
+
+    // Count the binary data that is still referenced, so that the amount of
+    // reclaimable data is known on startup without parsing the whole cache.
+    // Deduplicated entries share their payload.
+    std::unordered_set<uint64_t> payloads;
+    uint64_t liveSize = 0u;
+
+    for (const auto& b : buckets) {
+      if (b.keySize && payloads.insert(b.entry.offset).second)
+        liveSize += b.entry.binarySize + b.entry.metadataSize;
+    }
+
+    uint64_t binSize = m_binFile.size();
+    uint64_t dataSize = binSize - std::min<uint64_t>(binSize, sizeof(BinHeader));
+
+    IndexHeader header = { };
+    header.magic = { 'D', 'X', 'V', 'I' };
+    header.version = IndexFileVersion;
+    header.dxvkVersion = getIndexVersionHash();
+    header.generation = m_generation;
+    header.lutSize = m_lutMapping->size();
+    header.binSize = binSize;
+    header.liveSize = liveSize;
+    header.deadSize = dataSize - std::min(dataSize, liveSize);
+    header.bucketCount = bucketCount;
+    header.entryCount = entryCount;
+
+    m_idxMapping = nullptr;
+
+    // Write to a temporary file first so that another process
+    // that has the old index mapped is not affected.
+    auto path = m_filePaths.directory + env::PlatformDirSlash + m_filePaths.idxFile;
+
+    if (!writeIndexFile(path + ".tmp", header, buckets)
+     || !env::replaceFile(path + ".tmp", path)) {
+      env::removeFile(path + ".tmp");
+      return false;
+    }
+
+    util::File file(path, util::FileFlags(util::FileFlag::AllowRead));
+    m_idxMapping = file.map(file.size());
+
+    if (!m_idxMapping)
+      return false;
+
+    Logger::info(str::format("Built shader cache index: ", path, " (", entryCount, " entries)"));
+
+    m_idxHeader = header;
+    m_lut.clear();
+    return true;
+  }
+
+
+  bool DxvkShaderCache::writeIndexFile(
+    const std::string&                path,
+    const IndexHeader&                header,
+    const std::vector<IndexBucket>&   buckets) {
+    util::File file(path, util::FileFlags(
+      util::FileFlag::AllowRead,
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Truncate,
+      util::FileFlag::Exclusive));
+
+    return file && write(file, header)
+        && writeBytes(file, reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(IndexBucket))
+        && file.flush();
+  }
+
+
+  uint32_t DxvkShaderCache::computeBucketCount(uint32_t entryCount) {
+    // Keep the load factor at or below 50%
+    uint32_t bucketCount = 64u;
+
+    while (bucketCount < 2u * entryCount)
+      bucketCount *= 2u;
+
+    return bucketCount;
+  }
+
+
+  bool DxvkShaderCache::findEntry(const LutKey& key, IndexBucket& entry) const {
+    auto e = m_lut.find(key);
+
+    if (e != m_lut.end()) {
+      entry = e->second;
+      return true;
+    }
+
+    if (!m_idxMapping)
+      return false;
+
+    auto data = serializeLutKey(key.name, key.createInfo);
+    auto hash = bit::fnv1a_hash(data.data.data(), data.data.size());
+
+    auto buckets = reinterpret_cast<const IndexBucket*>(
+      reinterpret_cast<const char*>(m_idxMapping->data()) + sizeof(IndexHeader));
+
+    uint32_t mask = m_idxHeader.bucketCount - 1u;
+
+    for (uint32_t i = 0u; i < m_idxHeader.bucketCount; i++) {
+      const auto& bucket = buckets[(hash + i) & mask];
+
+      if (!bucket.keySize)
+        return false;
+
+      if (bucket.keyHash == hash && compareKeyData(bucket, data.data.data(), data.data.size())) {
+        entry = bucket;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  bool DxvkShaderCache::compareKeyData(const IndexBucket& a, const char* data, size_t size) const {
+    if (a.keySize != size || a.keyOffset > m_lutMapping->size() || size > m_lutMapping->size() - a.keyOffset)
+      return false;
+
+    auto keyData = reinterpret_cast<const char*>(m_lutMapping->data()) + a.keyOffset;
+    return !std::memcmp(keyData, data, size);
+  }
+
+
+  bool DxvkShaderCache::gatherEntriesLocked(std::unordered_map<std::string, CompactEntry>& entries) {
+    uint32_t now = getUsageStamp();
+
+    // Gather indexed entries first, and keep their usage stamps
+    // unless the entry has been used during the current session.
+    if (m_idxMapping) {
+      auto buckets = reinterpret_cast<const IndexBucket*>(
+        reinterpret_cast<const char*>(m_idxMapping->data()) + sizeof(IndexHeader));
+      auto lutData = reinterpret_cast<const char*>(m_lutMapping->data());
+
+      for (uint32_t i = 0u; i < m_idxHeader.bucketCount; i++) {
+        const auto& bucket = buckets[i];
+
+        if (!bucket.keySize || bucket.keyOffset + bucket.keySize > m_lutMapping->size())
+          continue;
+
+        CompactEntry e = { };
+        e.entry = bucket.entry;
+        e.lastUse = m_usedKeys.count(bucket.keyOffset) ? now : bucket.lastUse;
+
+        entries.insert_or_assign(std::string(lutData + bucket.keyOffset, bucket.keySize), e);
+      }
+    }
+
+    // Entries in the look-up table tail override indexed entries
+    size_t size = m_lutFile.size();
+    size_t offset = m_idxMapping ? size_t(m_idxHeader.lutSize) : m_lutDataOffset;
+
+    while (offset < size) {
+      size_t keyOffset = offset;
+
+      LutKey k;
+      CompactEntry e = { };
+      e.lastUse = now;
+
+      if (!readShaderLutEntry(k, e.entry, offset))
+        return false;
+
+      std::string key(offset - keyOffset - sizeof(e.entry), '\0');
+
+      if (!m_lutFile.read(keyOffset, key.size(), key.data()))
+        return false;
+
+      entries.insert_or_assign(std::move(key), e);
+    }
+
+    return true;
+  }
+
+
+  bool DxvkShaderCache::needsCompactionLocked() {
+    size_t binSize = m_binFile.size();
+    size_t lutSize = m_lutFile.size();
+
+    // Reclaimable data is only tracked when building the index, and
+    // entries appended since then are assumed to be live. This keeps
+    // the check cheap, the cache only gets parsed in full if it is
+    // actually going to be compacted.
+    size_t entryCount = m_lut.size();
+    size_t deadSize = 0u;
+
+    if (m_idxMapping) {
+      entryCount += m_idxHeader.entryCount;
+      deadSize = m_idxHeader.deadSize;
+    }
+
+    Logger::info(str::format("Shader cache: ", entryCount, " entries, ",
+      (binSize + lutSize) >> 10, " kB, ", deadSize >> 10, " kB reclaimable"));
+
+    uint64_t maxSize = getMaxCacheSize();
+
+    if (maxSize && binSize + lutSize > maxSize)
+      return true;
+
+    return deadSize >= CompactionMinDeadSize && deadSize >= binSize / 4u;
+  }
+
+
+  bool DxvkShaderCache::compactLocked() {
+    std::unordered_map<std::string, CompactEntry> entries;
+
+    if (!gatherEntriesLocked(entries)) {
+      Logger::warn("Failed to parse shader cache, skipping compaction.");
+      return false;
+    }
+
+    CompactStats stats = { };
+    stats.oldSize = m_binFile.size() + m_lutFile.size();
+
+    if (!writeCompactedFilesLocked(entries, createGeneration(), stats)) {
+      removeTempFiles();
+      return false;
+    }
+
+    // Release all file handles and mappings so that the files can be
+    // replaced. The binary file is replaced first since it is the most
+    // likely to fail, e.g. if a previous cache instance in this process
+    // still has it mapped. Since the files are not replaced atomically,
+    // any mismatch will be detected via the generation number when the
+    // files are parsed again, and the entire cache gets discarded.
+    closeFilesLocked();
+
+    auto path = m_filePaths.directory + env::PlatformDirSlash;
+
+    if (!env::replaceFile(path + m_filePaths.binFile + ".tmp", path + m_filePaths.binFile)
+     || !env::replaceFile(path + m_filePaths.lutFile + ".tmp", path + m_filePaths.lutFile)
+     || !env::replaceFile(path + m_filePaths.idxFile + ".tmp", path + m_filePaths.idxFile)) {
+      Logger::warn("Failed to replace shader cache files.");
+      removeTempFiles();
+      return true;
+    }
+
+    Logger::info(str::format("Compacted shader cache: ", stats.entryCount, " entries, ",
+      stats.oldSize >> 10, " kB -> ", stats.newSize >> 10, " kB (",
+      stats.dedupCount, " deduplicated, ",
+      stats.evictCount, " evicted, ",
+      stats.corruptCount, " corrupted)"));
+    return true;
+  }
+
+
+  void DxvkShaderCache::updateUsageStampsLocked() {
+    if (!m_idxMapping || m_usedKeys.empty())
+      return;
+
+    uint32_t now = getUsageStamp();
+
+    auto buckets = reinterpret_cast<const IndexBucket*>(
+      reinterpret_cast<const char*>(m_idxMapping->data()) + sizeof(IndexHeader));
+
+    std::vector<size_t> offsets;
+
+    for (uint32_t i = 0u; i < m_idxHeader.bucketCount; i++) {
+      if (buckets[i].keySize && buckets[i].lastUse != now && m_usedKeys.count(buckets[i].keyOffset))
+        offsets.push_back(sizeof(IndexHeader) + i * sizeof(IndexBucket) + offsetof(IndexBucket, lastUse));
+    }
+
+    m_idxMapping = nullptr;
+
+    if (offsets.empty())
+      return;
+
+    auto path = m_filePaths.directory + env::PlatformDirSlash + m_filePaths.idxFile;
+
+    util::File file(path, util::FileFlags(
+      util::FileFlag::AllowRead,
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Exclusive));
+
+    // Make sure that we are not writing to an index that was
+    // replaced by another process in the meantime.
+    IndexHeader header = { };
+    size_t headerOffset = 0u;
+
+    if (!read(file, headerOffset, header)
+     || header.generation != m_idxHeader.generation
+     || header.lutSize != m_idxHeader.lutSize
+     || header.bucketCount != m_idxHeader.bucketCount)
+      return;
+
+    for (auto offset : offsets) {
+      if (!file.write(offset, sizeof(now), &now))
+        break;
+    }
+  }
+
+
+  bool DxvkShaderCache::writeCompactedFilesLocked(
+    const std::unordered_map<std::string, CompactEntry>& entries,
+          uint64_t                    generation,
+          CompactStats&               stats) {
+    auto path = m_filePaths.directory + env::PlatformDirSlash;
+
+    auto flags = util::FileFlags(
+      util::FileFlag::AllowRead,
+      util::FileFlag::AllowWrite,
+      util::FileFlag::Truncate,
+      util::FileFlag::Exclusive);
+
+    util::File lutFile(path + m_filePaths.lutFile + ".tmp", flags);
+    util::File binFile(path + m_filePaths.binFile + ".tmp", flags);
+
+    LutHeader header = { };
+    header.magic = { 'D', 'X', 'V', 'K' };
+    header.version = LutFileVersion;
+    header.versionString = DXVK_VERSION;
+    header.generation = generation;
+
+    if (!lutFile || !binFile || !writeHeader(lutFile, header) || !writeBinHeader(binFile, generation)) {
+      Logger::warn("Failed to create temporary shader cache files.");
+      return false;
+    }
+
+    // Process most recently used entries first, so that
+    // we can simply stop once the size limit is reached.
+    std::vector<std::pair<const std::string*, const CompactEntry*>> sorted;
+    sorted.reserve(entries.size());
+
+    for (const auto& e : entries)
+      sorted.emplace_back(&e.first, &e.second);
+
+    std::sort(sorted.begin(), sorted.end(), [] (const auto& a, const auto& b) {
+      return a.second->lastUse > b.second->lastUse;
+    });
+
+    uint64_t maxSize = getMaxCacheSize();
+
+    std::unordered_multimap<uint64_t, LutEntry> payloads;
+    std::vector<IndexBucket> newEntries;
+
+    std::vector<char> payload;
+    std::vector<char> existing;
+
+    for (size_t i = 0u; i < sorted.size(); i++) {
+      const auto& key = *sorted[i].first;
+      const auto& entry = *sorted[i].second;
+
+      payload.resize(entry.entry.binarySize + entry.entry.metadataSize);
+
+      if (!m_binFile.read(entry.entry.offset, payload.size(), payload.data())
+       || entry.entry.checksum != bit::fnv1a_hash(payload.data(), entry.entry.binarySize)) {
+        stats.corruptCount += 1u;
+        continue;
+      }
+
+      IndexBucket bucket = { };
+      bucket.keyHash = bit::fnv1a_hash(key.data(), key.size());
+      bucket.keyOffset = lutFile.size();
+      bucket.keySize = key.size();
+      bucket.lastUse = entry.lastUse;
+      bucket.entry = entry.entry;
+
+      // Check whether an identical payload has already been written
+      uint64_t payloadHash = bit::fnv1a_hash(payload.data(), payload.size());
+      auto range = payloads.equal_range(payloadHash);
+
+      bool found = false;
+
+      for (auto p = range.first; p != range.second && !found; p++) {
+        if (p->second.binarySize != entry.entry.binarySize
+         || p->second.metadataSize != entry.entry.metadataSize)
+          continue;
+
+        existing.resize(payload.size());
+
+        if (binFile.read(p->second.offset, existing.size(), existing.data())
+         && !std::memcmp(existing.data(), payload.data(), payload.size())) {
+          bucket.entry.offset = p->second.offset;
+          found = true;
+        }
+      }
+
+      size_t requiredSize = key.size() + sizeof(LutEntry) + (found ? 0u : payload.size());
+
+      if (maxSize && binFile.size() + lutFile.size() + requiredSize > maxSize) {
+        stats.evictCount = sorted.size() - i;
+        break;
+      }
+
+      if (!found) {
+        bucket.entry.offset = binFile.size();
+
+        if (!writeBytes(binFile, payload.data(), payload.size())) {
+          Logger::warn("Failed to write temporary shader cache files.");
+          return false;
+        }
+
+        payloads.emplace(payloadHash, bucket.entry);
+      } else {
+        stats.dedupCount += 1u;
+      }
+
+      if (!writeBytes(lutFile, key.data(), key.size())
+       || !write(lutFile, bucket.entry)) {
+        Logger::warn("Failed to write temporary shader cache files.");
+        return false;
+      }
+
+      newEntries.push_back(bucket);
+    }
+
+    // Build index for the new look-up table. All keys are unique.
+    uint32_t bucketCount = computeBucketCount(newEntries.size());
+    std::vector<IndexBucket> buckets(bucketCount);
+
+    for (const auto& e : newEntries) {
+      uint32_t index = e.keyHash & (bucketCount - 1u);
+
+      while (buckets[index].keySize)
+        index = (index + 1u) & (bucketCount - 1u);
+
+      buckets[index] = e;
+    }
+
+    IndexHeader idxHeader = { };
+    idxHeader.magic = { 'D', 'X', 'V', 'I' };
+    idxHeader.version = IndexFileVersion;
+    idxHeader.dxvkVersion = getIndexVersionHash();
+    idxHeader.generation = generation;
+    idxHeader.lutSize = lutFile.size();
+    idxHeader.binSize = binFile.size();
+    idxHeader.liveSize = binFile.size() - sizeof(BinHeader);
+    idxHeader.deadSize = 0u;
+    idxHeader.bucketCount = bucketCount;
+    idxHeader.entryCount = newEntries.size();
+
+    if (!binFile.flush() || !lutFile.flush()
+     || !writeIndexFile(path + m_filePaths.idxFile + ".tmp", idxHeader, buckets)) {
+      Logger::warn("Failed to write temporary shader cache files.");
+      return false;
+    }
+
+    stats.entryCount = newEntries.size();
+    stats.newSize = binFile.size() + lutFile.size();
+    return true;
+  }
+
+
+  void DxvkShaderCache::removeTempFiles() {
+    auto path = m_filePaths.directory + env::PlatformDirSlash;
+
+    env::removeFile(path + m_filePaths.binFile + ".tmp");
+    env::removeFile(path + m_filePaths.lutFile + ".tmp");
+    env::removeFile(path + m_filePaths.idxFile + ".tmp");
+  }
+
+
+  std::vector<uint8_t> DxvkShaderCache::decompressIr(const uint8_t* data, const LutEntry& entry) {
+    std::vector<uint8_t> result(entry.rawSize);
+
+    if (!util::decompressBlock(data, entry.binarySize, result.data(), result.size()))
+      result.clear();
+
+    return result;
+  }
+
+
+  DxvkShaderCacheStats DxvkShaderCache::getStats() const {
+    DxvkShaderCacheStats stats = { };
+    stats.queueDepth = m_statQueueDepth.load(std::memory_order_relaxed);
+    stats.bytesWritten = m_statBytesWritten.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+
+  uint32_t DxvkShaderCache::getUsageStamp() {
+    // Hours are plenty of resolution for usage tracking
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return uint32_t(std::chrono::duration_cast<std::chrono::hours>(now).count());
+  }
+
+
+  uint64_t DxvkShaderCache::getMaxCacheSize() {
+    std::string maxSize = env::getEnvVar("DXVK_SHADER_CACHE_MAX_SIZE");
+
+    if (maxSize.empty())
+      return 0u;
+
+    return uint64_t(std::strtoull(maxSize.c_str(), nullptr, 10)) << 20;
+  }
+
+
+  uint64_t DxvkShaderCache::createGeneration() {
+    // Only needs to differ between subsequent rewrites of the files,
+    // zero is reserved to mark files as invalid.
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::max<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), 1u);
+  }
+
+
+  uint64_t DxvkShaderCache::getIndexVersionHash() {
+    std::string version = DXVK_VERSION;
+    return bit::fnv1a_hash(version.data(), version.size());
+  }
+
+
+  DxvkShaderCache::MemoryStream DxvkShaderCache::serializeLutKey(
+    const std::string&                name,
+    const DxvkIrShaderCreateInfo&     createInfo) {
+    MemoryStream stream;
+    writeString(stream, name);
+    writeShaderCreateInfo(stream, createInfo);
+    return stream;
+  }
+
+
+  template<typename Stream>
+  bool DxvkShaderCache::writeShaderXfbInfo(Stream& stream, const dxbc_spv::ir::IoXfbInfo& xfb) {
     return writeString(stream, xfb.semanticName)
         && write(stream, xfb.semanticIndex)
         && write(stream, xfb.componentMask)
@@ -242,7 +978,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::writeShaderCreateInfo(util::File& stream, const DxvkIrShaderCreateInfo& createInfo) {
+  template<typename Stream>
+  bool DxvkShaderCache::writeShaderCreateInfo(Stream& stream, const DxvkIrShaderCreateInfo& createInfo) {
     bool status = write(stream, createInfo.options)
                && write(stream, createInfo.flatShadingInputs)
                && write(stream, createInfo.rasterizedStream);
@@ -256,7 +993,56 @@ namespace dxvk {
   }
 
 
-  Rc<DxvkIrShader> DxvkShaderCache::loadCachedShaderLocked(const LutKey& key, const LutEntry& entry) {
+  Rc<DxvkIrShader> DxvkShaderCache::loadCachedShader(const LutKey& key, const LutEntry& entry) {
+    size_t endOffset = entry.offset + entry.binarySize + entry.metadataSize;
+
+    if (!m_binMapping || endOffset > m_binMapping->size()) {
+      // The writer appends to the same file object
+      std::lock_guard lock(m_fileMutex);
+      return loadCachedShaderFromFileLocked(key, entry);
+    }
+
+    // Use serialized IR directly from the mapped file
+    auto ir = reinterpret_cast<const uint8_t*>(m_binMapping->data()) + entry.offset;
+
+    if (entry.checksum != bit::fnv1a_hash(ir, entry.binarySize)) {
+      Logger::warn("Checksum mismatch for cached shader");
+      return nullptr;
+    }
+
+    size_t offset = entry.offset + entry.binarySize;
+
+    DxvkShaderMetadata metadata;
+
+    if (!readShaderMetadata(*m_binMapping, offset, metadata)) {
+      Logger::warn("Failed to read cached shader metadata");
+      return nullptr;
+    }
+
+    DxvkPipelineLayoutBuilder layout;
+
+    if (!readShaderLayout(*m_binMapping, offset, layout)) {
+      Logger::warn("Failed to read cached shader binding layout");
+      return nullptr;
+    }
+
+    if (entry.rawSize) {
+      auto data = decompressIr(ir, entry);
+
+      if (data.empty()) {
+        Logger::warn("Failed to decompress cached shader binary");
+        return nullptr;
+      }
+
+      return new DxvkIrShader(key.name, key.createInfo, std::move(metadata), std::move(layout), std::move(data));
+    }
+
+    return new DxvkIrShader(key.name, key.createInfo, std::move(metadata),
+      std::move(layout), m_binMapping, ir, entry.binarySize);
+  }
+
+
+  Rc<DxvkIrShader> DxvkShaderCache::loadCachedShaderFromFileLocked(const LutKey& key, const LutEntry& entry) {
     std::vector<uint8_t> ir(entry.binarySize);
 
     size_t offset = entry.offset;
@@ -285,28 +1071,21 @@ namespace dxvk {
       return nullptr;
     }
 
-    return new DxvkIrShader(key.name, key.createInfo, std::move(metadata), std::move(layout), std::move(ir));
-  }
-
-
-  bool DxvkShaderCache::writeShaderLutEntry(DxvkIrShader& shader, const LutEntry& entry) {
-    return writeString(m_lutFile, shader.debugName())
-        && writeShaderCreateInfo(m_lutFile, shader.getShaderCreateInfo())
-        && write(m_lutFile, entry);
-  }
+    if (entry.rawSize) {
+      ir = decompressIr(ir.data(), entry);
 
+      if (ir.empty()) {
+        Logger::warn("Failed to decompress cached shader binary");
+        return nullptr;
+      }
+    }
 
-  bool DxvkShaderCache::writeShaderToCache(DxvkIrShader& shader) {
-    auto entry = writeShaderBinary(m_binFile, shader);
-
-    if (!entry)
-      return false;
-
-    return writeShaderLutEntry(shader, *entry);
+    return new DxvkIrShader(key.name, key.createInfo, std::move(metadata), std::move(layout), std::move(ir));
   }
 
 
-  bool DxvkShaderCache::readShaderIo(util::File& stream, size_t& offset, DxvkShaderIo& io) {
+  template<typename Stream>
+  bool DxvkShaderCache::readShaderIo(Stream& stream, size_t& offset, DxvkShaderIo& io) {
     uint8_t varCount = 0u;
 
     if (!read(stream, offset, varCount))
@@ -331,7 +1110,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::readShaderMetadata(util::File& stream, size_t& offset, DxvkShaderMetadata& metadata) {
+  template<typename Stream>
+  bool DxvkShaderCache::readShaderMetadata(Stream& stream, size_t& offset, DxvkShaderMetadata& metadata) {
     bool status = read(stream, offset, metadata.stage)
                && read(stream, offset, metadata.flags)
                && read(stream, offset, metadata.specConstantMask)
@@ -350,7 +1130,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::readShaderLayout(util::File& stream, size_t& offset, DxvkPipelineLayoutBuilder& layout) {
+  template<typename Stream>
+  bool DxvkShaderCache::readShaderLayout(Stream& stream, size_t& offset, DxvkPipelineLayoutBuilder& layout) {
     VkShaderStageFlags stageMask = { };
 
     if (!read(stream, offset, stageMask))
@@ -407,7 +1188,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::readShaderXfbInfo(util::File& stream, size_t& offset, dxbc_spv::ir::IoXfbInfo& xfb) {
+  template<typename Stream>
+  bool DxvkShaderCache::readShaderXfbInfo(Stream& stream, size_t& offset, dxbc_spv::ir::IoXfbInfo& xfb) {
     return readString(stream, offset, xfb.semanticName)
         && read(stream, offset, xfb.semanticIndex)
         && read(stream, offset, xfb.componentMask)
@@ -442,7 +1224,7 @@ namespace dxvk {
 
 
   void DxvkShaderCache::runWriter() {
-    small_vector<Rc<DxvkIrShader>, 128u> localQueue;
+    WriteBatch batch;
 
     env::setThreadName("dxvk-cache");
 
@@ -451,44 +1233,57 @@ namespace dxvk {
     while (!stop) {
       std::unique_lock lock(m_writeMutex);
 
-      m_writeCond.wait(lock, [this] {
+      auto cond = [this] {
         return !m_writeQueue.empty();
-      });
+      };
 
-      auto entry = std::move(m_writeQueue.front());
-      m_writeQueue.pop();
+      // Write out pending data if no new shaders arrive for a while
+      bool hasEntry = true;
 
-      lock.unlock();
+      if (batch.entryOffsets.empty())
+        m_writeCond.wait(lock, cond);
+      else
+        hasEntry = m_writeCond.wait_for(lock, std::chrono::seconds(1), cond);
+
+      Rc<DxvkIrShader> shader;
 
-      stop = !entry;
-      bool drain = stop;
+      if (hasEntry) {
+        shader = std::move(m_writeQueue.front());
+        m_writeQueue.pop();
 
-      if (entry) {
-        localQueue.push_back(std::move(entry));
-        drain = localQueue.size() == localQueue.capacity();
+        stop = shader == nullptr;
       }
 
-      if (drain) {
-        std::unique_lock fileLock(m_fileMutex);
+      lock.unlock();
 
-        for (const auto& shader : localQueue) {
-          if (!writeShaderToCache(*shader)) {
-            Logger::err("Failed to write cache file.");
-            m_status = Status::CacheDisabled;
-            return;
-          }
-        }
+      // Serialize shaders immediately so that we don't hold on to
+      // shader objects for longer than necessary.
+      if (shader) {
+        bool status = serializeShader(batch, *shader);
+
+        shader = nullptr;
+        m_statQueueDepth.fetch_sub(1u, std::memory_order_relaxed);
 
-        localQueue.clear();
+        if (!status) {
+          Logger::err("Failed to serialize shader for cache.");
+          m_status = Status::CacheDisabled;
+          return;
+        }
+      }
 
-        m_binFile.flush();
-        m_lutFile.flush();
+      if (!hasEntry || stop || batch.bin.data.size() >= WriteBatchMaxSize) {
+        if (!writeBatch(batch)) {
+          Logger::err("Failed to write cache file.");
+          m_status = Status::CacheDisabled;
+          return;
+        }
       }
     }
   }
 
 
-  bool DxvkShaderCache::writeShaderLayout(util::File& stream, const DxvkPipelineLayoutBuilder& layout) {
+  template<typename Stream>
+  bool DxvkShaderCache::writeShaderLayout(Stream& stream, const DxvkPipelineLayoutBuilder& layout) {
     bool status = write(stream, layout.getStageMask())
                && write(stream, layout.getPushDataMask());
 
@@ -510,7 +1305,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::writeShaderIo(util::File& stream, const DxvkShaderIo& io) {
+  template<typename Stream>
+  bool DxvkShaderCache::writeShaderIo(Stream& stream, const DxvkShaderIo& io) {
     bool status = write(stream, uint8_t(io.getVarCount()));
 
     for (uint32_t i = 0u; i < io.getVarCount(); i++) {
@@ -529,7 +1325,8 @@ namespace dxvk {
   }
 
 
-  bool DxvkShaderCache::writeShaderMetadata(util::File& stream, const DxvkShaderMetadata& metadata) {
+  template<typename Stream>
+  bool DxvkShaderCache::writeShaderMetadata(Stream& stream, const DxvkShaderMetadata& metadata) {
     bool status = write(stream, metadata.stage)
                && write(stream, metadata.flags)
                && write(stream, metadata.specConstantMask)
@@ -548,28 +1345,95 @@ namespace dxvk {
   }
 
 
-  std::optional<DxvkShaderCache::LutEntry> DxvkShaderCache::writeShaderBinary(util::File& stream, DxvkIrShader& shader) {
-    auto [data, size] = shader.getSerializedIr();
+  bool DxvkShaderCache::serializeShader(WriteBatch& batch, DxvkIrShader& shader) {
+    auto [irData, irSize] = shader.getSerializedIr();
+
+    const uint8_t* data = irData;
+    size_t size = irSize;
 
     LutEntry entry = { };
-    entry.offset = stream.size();
-    entry.binarySize = size;
+    entry.offset = batch.bin.data.size();
+
+    // Only store compressed IR if it actually saves a meaningful
+    // amount of space, since it prevents zero-copy loading.
+    std::vector<uint8_t> compressed;
 
-    if (!writeBytes(stream, data, size)
-     || !writeShaderMetadata(stream, shader.getShaderMetadata())
-     || !writeShaderLayout(stream, shader.getLayout()))
-      return std::nullopt;
+    if (m_compress) {
+      compressed = util::compressBlock(irData, irSize);
 
+      if (compressed.size() < irSize - irSize / 8u) {
+        entry.rawSize = irSize;
+
+        data = compressed.data();
+        size = compressed.size();
+      }
+    }
 
-    entry.metadataSize = uint32_t(uint64_t(stream.size()) - (entry.offset + entry.binarySize));
+    entry.binarySize = size;
     entry.checksum = bit::fnv1a_hash(data, size);
-    return std::make_optional(entry);
+
+    if (!writeBytes(batch.bin, data, size)
+     || !writeShaderMetadata(batch.bin, shader.getShaderMetadata())
+     || !writeShaderLayout(batch.bin, shader.getLayout()))
+      return false;
+
+    entry.metadataSize = uint32_t(batch.bin.data.size() - (entry.offset + entry.binarySize));
+
+    if (!writeString(batch.lut, shader.debugName())
+     || !writeShaderCreateInfo(batch.lut, shader.getShaderCreateInfo()))
+      return false;
+
+    batch.entryOffsets.push_back(batch.lut.data.size());
+    return write(batch.lut, entry);
+  }
+
+
+  bool DxvkShaderCache::writeBatch(WriteBatch& batch) {
+    if (batch.entryOffsets.empty())
+      return true;
+
+    std::unique_lock lock(m_fileMutex);
+
+    // Binary offsets are relative to the start of the batch so far,
+    // patch them now that we know where the data will be written.
+    uint64_t binOffset = m_binFile.size();
+
+    for (auto offset : batch.entryOffsets) {
+      LutEntry entry = { };
+      std::memcpy(&entry, &batch.lut.data[offset], sizeof(entry));
+      entry.offset += binOffset;
+      std::memcpy(&batch.lut.data[offset], &entry, sizeof(entry));
+    }
+
+    if (!writeBytes(m_binFile, batch.bin.data.data(), batch.bin.data.size())
+     || !writeBytes(m_lutFile, batch.lut.data.data(), batch.lut.data.size())
+     || !m_binFile.flush() || !m_lutFile.flush())
+      return false;
+
+    m_statBytesWritten.fetch_add(batch.bin.data.size() + batch.lut.data.size(), std::memory_order_relaxed);
+
+    batch.bin.data.clear();
+    batch.lut.data.clear();
+    batch.entryOffsets.clear();
+    return true;
   }
 
 
   bool DxvkShaderCache::writeHeader(util::File& stream, const LutHeader& header) {
     return writeBytes(stream, header.magic.data(), header.magic.size())
-        && writeString(stream, header.versionString);
+        && write(stream, header.version)
+        && writeString(stream, header.versionString)
+        && write(stream, header.generation);
+  }
+
+
+  bool DxvkShaderCache::writeBinHeader(util::File& stream, uint64_t generation) {
+    BinHeader header = { };
+    header.magic = { 'D', 'X', 'V', 'B' };
+    header.version = LutFileVersion;
+    header.generation = generation;
+
+    return write(stream, header);
   }
 
 
@@ -626,8 +1490,11 @@ namespace dxvk {
 
     FilePaths paths;
     paths.directory = cachePath;
+    paths.baseName = baseName;
     paths.lutFile = baseName + ".dxvk.lut";
     paths.binFile = baseName + ".dxvk.bin";
+    paths.idxFile = baseName + ".dxvk.idx";
+    paths.vkFile = baseName + ".dxvk.vkpc";
     return paths;
   }
 
@@ -648,10 +1515,8 @@ namespace dxvk {
     // The ref count can only be incremented from 0 to 1 inside a locked
     // context, so this check is safe. Don't destroy the object if another
     // thread has essentially revived it.
-    if (m_useCount.load(std::memory_order_relaxed) || s_instance.instance != this) {
-      if (s_instance.instance == this)
-        s_instance.instance = nullptr;
-
+    if (!m_useCount.load(std::memory_order_relaxed) && s_instance.instance == this) {
+      s_instance.instance = nullptr;
       delete this;
     }
   }
@@ -6,6 +6,7 @@
 #include <queue>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../util/thread.h"
@@ -16,6 +17,15 @@
 
 namespace dxvk {
 
+  /**
+   * \brief Shader cache statistics
+   */
+  struct DxvkShaderCacheStats {
+    uint64_t queueDepth   = 0u;
+    uint64_t bytesWritten = 0u;
+  };
+
+
   /**
    * \brief Shader cache
    *
@@ -24,6 +34,23 @@ namespace dxvk {
    * The implementation creates two files that can trivially grow by appending
    * data to them: A binary blob that contains the actual serialized IR as well
    * as shader metadata, and a look-up table
+   *
+   * Since parsing the look-up table gets slow for large caches, a
+   * separate index file stores an open-addressing hash table that
+   * covers a prefix of the look-up table. The index, look-up table
+   * and binary files are memory-mapped, so that only entries that
+   * were appended after the index was built need to be parsed, and
+   * serialized IR can be used directly from the mapped binary file.
+   *
+   * The index header tracks how much data in the binary file is no longer
+   * referenced. If that amount is significant, or if the cache exceeds its
+   * size limit, all files get rewritten on startup to remove stale, corrupted
+   * and duplicate data and to evict the least recently used entries. This
+   * happens on a background thread before the binary file gets mapped, so
+   * that the files can be replaced on all platforms. All files store a common
+   * generation number, so that files which do not belong together, e.g.
+   * because the process was terminated while replacing them, are detected
+   * and discarded.
    */
   class DxvkShaderCache {
 
@@ -31,8 +58,11 @@ namespace dxvk {
 
     struct FilePaths {
       std::string directory;
+      std::string baseName;
       std::string lutFile;
       std::string binFile;
+      std::string idxFile;
+      std::string vkFile;
     };
 
     ~DxvkShaderCache();
@@ -78,6 +108,12 @@ namespace dxvk {
      */
     static Rc<DxvkShaderCache> getInstance();
 
+    /**
+     * \brief Queries writer statistics
+     * \returns Shader cache statistics
+     */
+    DxvkShaderCacheStats getStats() const;
+
   private:
 
     struct Instance {
@@ -89,7 +125,15 @@ namespace dxvk {
 
     struct LutHeader {
       std::array<char, 4u>  magic = { };
+      uint32_t              version = 0u;
       std::string           versionString = { };
+      uint64_t              generation = 0u;
+    };
+
+    struct BinHeader {
+      std::array<char, 4u>  magic = { };
+      uint32_t              version = 0u;
+      uint64_t              generation = 0u;
     };
 
     struct LutKey {
@@ -101,11 +145,80 @@ namespace dxvk {
       bool eq(const LutKey& k) const;
     };
 
+    /**
+     * \brief Look-up table entry
+     *
+     * If the raw size is non-zero, the IR is stored in compressed
+     * form and the binary size refers to the compressed size. The
+     * checksum is always computed from the data stored in the file.
+     */
     struct LutEntry {
       uint64_t offset = 0u;
       uint32_t binarySize = 0u;
       uint32_t metadataSize = 0u;
       uint64_t checksum = 0u;
+      uint32_t rawSize = 0u;
+      uint32_t reserved = 0u;
+    };
+
+    struct IndexHeader {
+      std::array<char, 4u>  magic = { };
+      uint32_t              version = 0u;
+      uint64_t              dxvkVersion = 0u;
+      uint64_t              generation = 0u;
+      uint64_t              lutSize = 0u;
+      uint64_t              binSize = 0u;
+      uint64_t              liveSize = 0u;
+      uint64_t              deadSize = 0u;
+      uint32_t              bucketCount = 0u;
+      uint32_t              entryCount = 0u;
+    };
+
+    /**
+     * \brief Index hash table bucket
+     *
+     * Refers to the serialized key inside the look-up
+     * table file, so that keys can be compared without
+     * deserializing them. Empty buckets have a key size
+     * of zero. The usage stamp is used to evict the least
+     * recently used entries when compacting the cache.
+     */
+    struct IndexBucket {
+      uint64_t keyHash = 0u;
+      uint64_t keyOffset = 0u;
+      uint32_t keySize = 0u;
+      uint32_t lastUse = 0u;
+      LutEntry entry = { };
+    };
+
+    struct CompactEntry {
+      LutEntry entry = { };
+      uint32_t lastUse = 0u;
+    };
+
+    struct CompactStats {
+      size_t entryCount = 0u;
+      size_t corruptCount = 0u;
+      size_t dedupCount = 0u;
+      size_t evictCount = 0u;
+      size_t oldSize = 0u;
+      size_t newSize = 0u;
+    };
+
+    struct MemoryStream {
+      std::vector<char> data;
+
+      bool append(size_t size, const void* src) {
+        auto bytes = reinterpret_cast<const char*>(src);
+        data.insert(data.end(), bytes, bytes + size);
+        return true;
+      }
+    };
+
+    struct WriteBatch {
+      MemoryStream        bin;
+      MemoryStream        lut;
+      std::vector<size_t> entryOffsets;
     };
 
     enum class Status : uint32_t {
@@ -123,35 +236,82 @@ namespace dxvk {
     util::File                    m_lutFile;
     util::File                    m_binFile;
 
+    Rc<util::FileMapping>         m_lutMapping;
+    Rc<util::FileMapping>         m_binMapping;
+    Rc<util::FileMapping>         m_idxMapping;
+    IndexHeader                   m_idxHeader = { };
+
+    size_t                        m_lutDataOffset = 0u;
+    uint64_t                      m_generation = 0u;
+
+    dxvk::mutex                   m_usageMutex;
+    std::unordered_set<uint64_t>  m_usedKeys;
+
     std::atomic<Status>           m_status = { Status::Uninitialized };
+    dxvk::condition_variable      m_statusCond;
 
-    std::unordered_map<LutKey, LutEntry, DxvkHash, DxvkEq> m_lut;
+    std::unordered_map<LutKey, IndexBucket, DxvkHash, DxvkEq> m_lut;
+
+    bool                          m_compress = false;
 
     dxvk::mutex                   m_writeMutex;
     dxvk::condition_variable      m_writeCond;
     std::queue<Rc<DxvkIrShader>>  m_writeQueue;
 
+    std::atomic<uint64_t>         m_statQueueDepth = { 0u };
+    std::atomic<uint64_t>         m_statBytesWritten = { 0u };
+
     dxvk::thread                  m_writer;
+    dxvk::thread                  m_initializer;
 
     DxvkShaderCache();
 
     bool ensureStatus(Status status);
 
-    Status initialize();
+    void runInitializer();
 
     Status tryInitializeLocked();
 
     bool openReadWriteLocked();
 
-    bool openWriteOnlyLocked();
+    bool createFilesLocked();
 
     bool parseLut();
 
-    Rc<DxvkIrShader> loadCachedShaderLocked(const LutKey& key, const LutEntry& entry);
+    void invalidate();
+
+    void closeFilesLocked();
+
+    bool mapIndexLocked(size_t lutOffset, size_t lutSize);
+
+    bool buildIndexLocked();
+
+    bool findEntry(const LutKey& key, IndexBucket& entry) const;
+
+    bool compareKeyData(const IndexBucket& a, const char* data, size_t size) const;
+
+    bool gatherEntriesLocked(std::unordered_map<std::string, CompactEntry>& entries);
+
+    bool needsCompactionLocked();
 
-    bool writeShaderLutEntry(DxvkIrShader& shader, const LutEntry& entry);
+    bool compactLocked();
 
-    bool writeShaderToCache(DxvkIrShader& shader);
+    void updateUsageStampsLocked();
+
+    bool writeCompactedFilesLocked(
+      const std::unordered_map<std::string, CompactEntry>& entries,
+            uint64_t                    generation,
+            CompactStats&               stats);
+
+    void removeTempFiles();
+
+    Rc<DxvkIrShader> loadCachedShader(const LutKey& key, const LutEntry& entry);
+
+    Rc<DxvkIrShader> loadCachedShaderFromFileLocked(const LutKey& key, const LutEntry& entry);
+
+    bool serializeShader(WriteBatch& batch, DxvkIrShader& shader);
+
+    bool writeBatch(WriteBatch& batch);
 
     bool readShaderLutEntry(LutKey& key, LutEntry& entry, size_t& offset);
 
@@ -159,58 +319,92 @@ namespace dxvk {
 
     void freeInstance();
 
-    static bool writeShaderXfbInfo(util::File& stream, const dxbc_spv::ir::IoXfbInfo& xfb);
+    static uint64_t getIndexVersionHash();
+
+    static uint32_t getUsageStamp();
 
-    static bool writeShaderCreateInfo(util::File& stream, const DxvkIrShaderCreateInfo& createInfo);
+    static uint64_t getMaxCacheSize();
 
-    static bool writeShaderLayout(util::File& stream, const DxvkPipelineLayoutBuilder& layout);
+    static uint64_t createGeneration();
 
-    static bool writeShaderIo(util::File& stream, const DxvkShaderIo& io);
+    static uint32_t computeBucketCount(uint32_t entryCount);
 
-    static bool writeShaderMetadata(util::File& stream, const DxvkShaderMetadata& metadata);
+    static bool writeIndexFile(
+      const std::string&                path,
+      const IndexHeader&                header,
+      const std::vector<IndexBucket>&   buckets);
 
-    static std::optional<LutEntry> writeShaderBinary(util::File& stream, DxvkIrShader& shader);
+    static MemoryStream serializeLutKey(const std::string& name, const DxvkIrShaderCreateInfo& createInfo);
+
+    template<typename Stream>
+    static bool writeShaderXfbInfo(Stream& stream, const dxbc_spv::ir::IoXfbInfo& xfb);
+
+    template<typename Stream>
+    static bool writeShaderCreateInfo(Stream& stream, const DxvkIrShaderCreateInfo& createInfo);
+
+    template<typename Stream>
+    static bool writeShaderLayout(Stream& stream, const DxvkPipelineLayoutBuilder& layout);
+
+    template<typename Stream>
+    static bool writeShaderIo(Stream& stream, const DxvkShaderIo& io);
+
+    template<typename Stream>
+    static bool writeShaderMetadata(Stream& stream, const DxvkShaderMetadata& metadata);
+
+    static std::vector<uint8_t> decompressIr(const uint8_t* data, const LutEntry& entry);
 
     static bool writeHeader(util::File& stream, const LutHeader& header);
 
-    static bool readShaderIo(util::File& stream, size_t& offset, DxvkShaderIo& io);
+    static bool writeBinHeader(util::File& stream, uint64_t generation);
+
+    template<typename Stream>
+    static bool readShaderIo(Stream& stream, size_t& offset, DxvkShaderIo& io);
 
-    static bool readShaderXfbInfo(util::File& stream, size_t& offset, dxbc_spv::ir::IoXfbInfo& xfb);
+    template<typename Stream>
+    static bool readShaderXfbInfo(Stream& stream, size_t& offset, dxbc_spv::ir::IoXfbInfo& xfb);
 
     static bool readShaderLutKey(util::File& stream, size_t& offset, LutKey& key);
 
-    static bool readShaderMetadata(util::File& stream, size_t& offset, DxvkShaderMetadata& metadata);
+    template<typename Stream>
+    static bool readShaderMetadata(Stream& stream, size_t& offset, DxvkShaderMetadata& metadata);
 
-    static bool readShaderLayout(util::File& stream, size_t& offset, DxvkPipelineLayoutBuilder& layout);
+    template<typename Stream>
+    static bool readShaderLayout(Stream& stream, size_t& offset, DxvkPipelineLayoutBuilder& layout);
 
-    static bool writeBytes(util::File& stream, const char* data, size_t size) {
+    template<typename Stream>
+    static bool writeBytes(Stream& stream, const char* data, size_t size) {
       return stream.append(size, data);
     }
 
-    static bool writeBytes(util::File& stream, const uint8_t* data, size_t size) {
+    template<typename Stream>
+    static bool writeBytes(Stream& stream, const uint8_t* data, size_t size) {
       return writeBytes(stream, reinterpret_cast<const char*>(data), size);
     }
 
-    static bool writeString(util::File& stream, const std::string& string) {
+    template<typename Stream>
+    static bool writeString(Stream& stream, const std::string& string) {
       return write(stream, uint16_t(string.size())) && writeBytes(stream, string.data(), string.size());
     }
 
-    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
-    static bool write(util::File& stream, const T& data) {
+    template<typename Stream, typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool write(Stream& stream, const T& data) {
       return writeBytes(stream, reinterpret_cast<const char*>(&data), sizeof(data));
     }
 
-    static bool readBytes(util::File& stream, char* data, size_t& offset, size_t size) {
+    template<typename Stream>
+    static bool readBytes(Stream& stream, char* data, size_t& offset, size_t size) {
       bool result = stream.read(offset, size, data);
       offset += size;
       return result;
     }
 
-    static bool readBytes(util::File& stream, uint8_t* data, size_t& offset, size_t size) {
+    template<typename Stream>
+    static bool readBytes(Stream& stream, uint8_t* data, size_t& offset, size_t size) {
       return readBytes(stream, reinterpret_cast<char*>(data), offset, size);
     }
 
-    static bool readString(util::File& stream, size_t& offset, std::string& string) {
+    template<typename Stream>
+    static bool readString(Stream& stream, size_t& offset, std::string& string) {
       uint16_t len = 0u;
 
       if (!read(stream, offset, len))
@@ -220,8 +414,8 @@ namespace dxvk {
       return readBytes(stream, string.data(), offset, len);
     }
 
-    template<typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
-    static bool read(util::File& stream, size_t& offset, T& data) {
+    template<typename Stream, typename T, std::enable_if_t<std::is_trivially_copyable_v<T>, bool> = true>
+    static bool read(Stream& stream, size_t& offset, T& data) {
       return readBytes(stream, reinterpret_cast<char*>(&data), offset, sizeof(data));
     }
 
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <unordered_set>
+
 #include <ir/ir_serialize.h>
 
 #include <spirv/spirv_builder.h>
@@ -1624,6 +1627,40 @@ namespace dxvk {
   };
 
 
+  // Upper bound for compressed SPIR-V kept in memory across all
+  // shaders, as well as the number of variants for each shader
+  constexpr static size_t CodeCacheMaxSize = 64ull << 20;
+  constexpr static size_t CodeCacheMaxEntries = 16u;
+
+  // Amount of memory to free up once the size limit is exceeded,
+  // so that eviction does not need to run on every insertion
+  constexpr static size_t CodeCacheEvictSize = CodeCacheMaxSize / 8u;
+
+  std::atomic<uint64_t> DxvkIrShader::s_codeCacheClock  = { 0u };
+  std::atomic<uint64_t> DxvkIrShader::s_codeCacheSize   = { 0u };
+  std::atomic<uint64_t> DxvkIrShader::s_codeCacheHits   = { 0u };
+  std::atomic<uint64_t> DxvkIrShader::s_codeCacheMisses = { 0u };
+
+
+  /**
+   * \brief Shaders with cached code
+   *
+   * Used to find the least recently used code across all shaders.
+   * Shaders register themselves when adding code for the first time
+   * and unregister on destruction, so any shader in the set is alive
+   * while the lock is held. Intentionally leaked so that shaders that
+   * are destroyed during process teardown can still unregister.
+   */
+  struct DxvkIrShaderCodeCacheRegistry {
+    dxvk::mutex                       mutex;
+    std::unordered_set<DxvkIrShader*> shaders;
+  };
+
+  static DxvkIrShaderCodeCacheRegistry& getCodeCacheRegistry() {
+    static DxvkIrShaderCodeCacheRegistry* s_registry = new DxvkIrShaderCodeCacheRegistry();
+    return *s_registry;
+  }
+
 
   DxvkIrShaderConverter::~DxvkIrShaderConverter() {
 
@@ -1648,6 +1685,27 @@ namespace dxvk {
   : m_debugName   (std::move(name)), m_info(info),
     m_layout      (std::move(layout)),
     m_ir          (std::move(ir)),
+    m_irData      (m_ir.data()),
+    m_irSize      (m_ir.size()),
+    m_convertedIr (true),
+    m_metadata    (std::move(metadata)) {
+
+  }
+
+
+  DxvkIrShader::DxvkIrShader(
+          std::string               name,
+    const DxvkIrShaderCreateInfo&   info,
+          DxvkShaderMetadata        metadata,
+          DxvkPipelineLayoutBuilder layout,
+          Rc<util::FileMapping>     mapping,
+    const uint8_t*                  irData,
+          size_t                    irSize)
+  : m_debugName   (std::move(name)), m_info(info),
+    m_layout      (std::move(layout)),
+    m_irMapping   (std::move(mapping)),
+    m_irData      (irData),
+    m_irSize      (irSize),
     m_convertedIr (true),
     m_metadata    (std::move(metadata)) {
 
@@ -1655,7 +1713,15 @@ namespace dxvk {
 
 
   DxvkIrShader::~DxvkIrShader() {
+    if (m_codeCacheRegistered.load(std::memory_order_acquire)) {
+      auto& registry = getCodeCacheRegistry();
 
+      std::lock_guard lock(registry.mutex);
+      registry.shaders.erase(this);
+    }
+
+    for (const auto& entry : m_codeCache)
+      s_codeCacheSize.fetch_sub(entry.code.getCompressedSize(), std::memory_order_relaxed);
   }
 
 
@@ -1676,6 +1742,188 @@ namespace dxvk {
     const DxvkShaderLinkage*          linkage) {
     convertIr("getCode()");
 
+    // Only cache code that is actually used for pipelines
+    if (!bindings)
+      return compileCode(bindings, linkage);
+
+    size_t hash = hashCodeKey(*bindings, linkage);
+
+    auto code = lookupCode(hash, *bindings, linkage);
+
+    if (code) {
+      s_codeCacheHits.fetch_add(1u, std::memory_order_relaxed);
+      return std::move(*code);
+    }
+
+    s_codeCacheMisses.fetch_add(1u, std::memory_order_relaxed);
+
+    auto result = compileCode(bindings, linkage);
+    addCode(hash, *bindings, linkage, result);
+    return result;
+  }
+
+
+  DxvkIrShaderCodeCacheStats DxvkIrShader::getCodeCacheStats() {
+    DxvkIrShaderCodeCacheStats stats = { };
+    stats.size = s_codeCacheSize.load(std::memory_order_relaxed);
+    stats.hits = s_codeCacheHits.load(std::memory_order_relaxed);
+    stats.misses = s_codeCacheMisses.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+
+  std::optional<SpirvCodeBuffer> DxvkIrShader::lookupCode(
+          size_t                      hash,
+    const DxvkShaderBindingMap&       bindings,
+    const DxvkShaderLinkage*          linkage) {
+    std::lock_guard lock(m_codeMutex);
+
+    for (size_t i = 0u; i < m_codeCache.size(); i++) {
+      auto& entry = m_codeCache[i];
+
+      if (entry.hash != hash || !entry.bindings.eq(bindings) || !compareLinkage(entry.linkage, linkage))
+        continue;
+
+      // Keep entries in most recently used order
+      std::rotate(m_codeCache.begin(), m_codeCache.begin() + i, m_codeCache.begin() + i + 1u);
+      m_codeCache.front().lastUse = s_codeCacheClock.fetch_add(1u, std::memory_order_relaxed);
+      return m_codeCache.front().code.decompress();
+    }
+
+    return std::nullopt;
+  }
+
+
+  void DxvkIrShader::addCode(
+          size_t                      hash,
+    const DxvkShaderBindingMap&       bindings,
+    const DxvkShaderLinkage*          linkage,
+          SpirvCodeBuffer             code) {
+    CodeCacheEntry entry;
+    entry.hash = hash;
+    entry.bindings = bindings;
+    entry.code = SpirvCompressedBuffer(code);
+
+    if (linkage)
+      entry.linkage = *linkage;
+
+    size_t size = entry.code.getCompressedSize();
+
+    if (size > CodeCacheEvictSize)
+      return;
+
+    if (!m_codeCacheRegistered.load(std::memory_order_acquire)) {
+      auto& registry = getCodeCacheRegistry();
+
+      std::lock_guard lock(registry.mutex);
+      registry.shaders.insert(this);
+
+      m_codeCacheRegistered.store(true, std::memory_order_release);
+    }
+
+    { std::lock_guard lock(m_codeMutex);
+
+      // Another thread may have compiled the same variant
+      for (const auto& e : m_codeCache) {
+        if (e.hash == hash && e.bindings.eq(bindings) && compareLinkage(e.linkage, linkage))
+          return;
+      }
+
+      if (m_codeCache.size() >= CodeCacheMaxEntries) {
+        s_codeCacheSize.fetch_sub(m_codeCache.back().code.getCompressedSize(), std::memory_order_relaxed);
+        m_codeCache.pop_back();
+      }
+
+      entry.lastUse = s_codeCacheClock.fetch_add(1u, std::memory_order_relaxed);
+
+      s_codeCacheSize.fetch_add(size, std::memory_order_relaxed);
+      m_codeCache.insert(m_codeCache.begin(), std::move(entry));
+    }
+
+    if (s_codeCacheSize.load(std::memory_order_relaxed) > CodeCacheMaxSize)
+      evictCode();
+  }
+
+
+  void DxvkIrShader::evictCode() {
+    auto& registry = getCodeCacheRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    // Another thread may have evicted code in the meantime
+    if (s_codeCacheSize.load(std::memory_order_relaxed) <= CodeCacheMaxSize)
+      return;
+
+    // Gather usage stamps of all cached code across all shaders.
+    // This is expensive, but only happens after a significant
+    // amount of new code has been added to the cache.
+    std::vector<std::pair<uint64_t, DxvkIrShader*>> entries;
+
+    for (auto shader : registry.shaders) {
+      std::lock_guard shaderLock(shader->m_codeMutex);
+
+      for (const auto& e : shader->m_codeCache)
+        entries.emplace_back(e.lastUse, shader);
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    uint64_t targetSize = CodeCacheMaxSize - CodeCacheEvictSize;
+
+    for (const auto& e : entries) {
+      if (s_codeCacheSize.load(std::memory_order_relaxed) <= targetSize)
+        break;
+
+      std::lock_guard shaderLock(e.second->m_codeMutex);
+      auto& cache = e.second->m_codeCache;
+
+      // Entries that were used since gathering the
+      // stamps have a new stamp and will be skipped
+      for (auto i = cache.begin(); i != cache.end(); i++) {
+        if (i->lastUse == e.first) {
+          s_codeCacheSize.fetch_sub(i->code.getCompressedSize(), std::memory_order_relaxed);
+          cache.erase(i);
+          break;
+        }
+      }
+    }
+  }
+
+
+  size_t DxvkIrShader::hashCodeKey(
+    const DxvkShaderBindingMap&       bindings,
+    const DxvkShaderLinkage*          linkage) {
+    DxvkHashState hash;
+    hash.add(bindings.hash());
+
+    if (linkage) {
+      hash.add(linkage->hash());
+      hash.add(uint32_t(linkage->semanticIo));
+      hash.add(uint32_t(linkage->inputTopology));
+      hash.add(uint32_t(linkage->prevStage));
+    }
+
+    return hash;
+  }
+
+
+  bool DxvkIrShader::compareLinkage(
+    const std::optional<DxvkShaderLinkage>& a,
+    const DxvkShaderLinkage*          b) {
+    if (!a || !b)
+      return !a && !b;
+
+    // The linkage equality check does not consider
+    // all properties that affect code generation.
+    return a->eq(*b)
+        && a->semanticIo == b->semanticIo
+        && a->inputTopology == b->inputTopology
+        && a->prevStage == b->prevStage;
+  }
+
+
+  SpirvCodeBuffer DxvkIrShader::compileCode(
+    const DxvkShaderBindingMap*       bindings,
+    const DxvkShaderLinkage*          linkage) {
     DxvkDxbcSpirvLogger logger(debugName());
 
     dxbc_spv::ir::Builder irBuilder;
@@ -1807,7 +2055,7 @@ namespace dxvk {
   std::pair<const uint8_t*, size_t> DxvkIrShader::getSerializedIr() {
     convertIr("getSerializedIr()");
 
-    return std::make_pair(m_ir.data(), m_ir.size());
+    return std::make_pair(m_irData, m_irSize);
   }
 
 
@@ -1928,11 +2176,13 @@ namespace dxvk {
     serializer.serialize(data.data(), data.size());
 
     m_ir = std::move(data);
+    m_irData = m_ir.data();
+    m_irSize = m_ir.size();
   }
 
 
   void DxvkIrShader::deserializeIr(dxbc_spv::ir::Builder& builder) const {
-    dxbc_spv::ir::Deserializer deserializer(m_ir.data(), m_ir.size());
+    dxbc_spv::ir::Deserializer deserializer(m_irData, m_irSize);
 
     if (!deserializer.deserialize(builder))
       throw DxvkError("Failed to deserialize shader");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "dxvk_shader.h"
 
 #include "../util/thread.h"
+#include "../util/util_file.h"
 
 namespace dxvk {
 
@@ -99,6 +101,16 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief SPIR-V code cache statistics
+   */
+  struct DxvkIrShaderCodeCacheStats {
+    uint64_t size   = 0u;
+    uint64_t hits   = 0u;
+    uint64_t misses = 0u;
+  };
+
+
   /**
    * \brief DXBC-SPIRV IR shader
    */
@@ -117,6 +129,15 @@ namespace dxvk {
             DxvkPipelineLayoutBuilder layout,
             std::vector<uint8_t>      ir);
 
+    DxvkIrShader(
+            std::string               name,
+      const DxvkIrShaderCreateInfo&   info,
+            DxvkShaderMetadata        metadata,
+            DxvkPipelineLayoutBuilder layout,
+            Rc<util::FileMapping>     mapping,
+      const uint8_t*                  irData,
+            size_t                    irSize);
+
     ~DxvkIrShader();
 
     /**
@@ -176,8 +197,33 @@ namespace dxvk {
      */
     std::string debugName();
 
+    /**
+     * \brief Queries SPIR-V code cache statistics
+     *
+     * Global counters for all IR shaders in the process.
+     * \returns Code cache statistics
+     */
+    static DxvkIrShaderCodeCacheStats getCodeCacheStats();
+
   private:
 
+    /**
+     * \brief Cached SPIR-V code
+     *
+     * Stores final SPIR-V for a given binding map and
+     * shader linkage. Keeps full copies of both since
+     * a hash collision would lead to invalid code. The
+     * usage stamp is unique across all shaders and is
+     * used to evict the least recently used entries.
+     */
+    struct CodeCacheEntry {
+      size_t                            hash = 0u;
+      uint64_t                          lastUse = 0u;
+      DxvkShaderBindingMap              bindings;
+      std::optional<DxvkShaderLinkage>  linkage;
+      SpirvCompressedBuffer             code;
+    };
+
     Rc<DxvkIrShaderConverter>     m_baseIr;
     std::string                   m_debugName;
 
@@ -187,10 +233,47 @@ namespace dxvk {
     dxvk::mutex                   m_mutex;
 
     std::vector<uint8_t>          m_ir;
+    Rc<util::FileMapping>         m_irMapping;
+    const uint8_t*                m_irData = nullptr;
+    size_t                        m_irSize = 0u;
     std::atomic<bool>             m_convertedIr = { false };
 
     DxvkShaderMetadata            m_metadata = { };
 
+    dxvk::mutex                   m_codeMutex;
+    std::vector<CodeCacheEntry>   m_codeCache;
+    std::atomic<bool>             m_codeCacheRegistered = { false };
+
+    static std::atomic<uint64_t>  s_codeCacheClock;
+    static std::atomic<uint64_t>  s_codeCacheSize;
+    static std::atomic<uint64_t>  s_codeCacheHits;
+    static std::atomic<uint64_t>  s_codeCacheMisses;
+
+    SpirvCodeBuffer compileCode(
+      const DxvkShaderBindingMap*       bindings,
+      const DxvkShaderLinkage*          linkage);
+
+    std::optional<SpirvCodeBuffer> lookupCode(
+            size_t                      hash,
+      const DxvkShaderBindingMap&       bindings,
+      const DxvkShaderLinkage*          linkage);
+
+    void addCode(
+            size_t                      hash,
+      const DxvkShaderBindingMap&       bindings,
+      const DxvkShaderLinkage*          linkage,
+            SpirvCodeBuffer             code);
+
+    static void evictCode();
+
+    static size_t hashCodeKey(
+      const DxvkShaderBindingMap&       bindings,
+      const DxvkShaderLinkage*          linkage);
+
+    static bool compareLinkage(
+      const std::optional<DxvkShaderLinkage>& a,
+      const DxvkShaderLinkage*          b);
+
     void convertIr(const char* reason);
 
     void convertShader();
@@ -36,6 +36,10 @@ namespace dxvk {
     DescriptorHeapSize,       ///< Amount of descriptor memory allocated
     DescriptorHeapUsed,       ///< Amount of descriptor memory used
     DescriptorCopyBusyTicks,  ///< Descriptor copy busy time in microseconds
+    ShaderCacheQueueDepth,    ///< Shaders queued for the cache writer
+    ShaderCacheBytesWritten,  ///< Bytes written to the shader cache
+    ShaderCodeCacheHits,      ///< SPIR-V code cache hits
+    ShaderCodeCacheMisses,    ///< SPIR-V code cache misses
 
     NumCounters               ///< Number of counters available
   };
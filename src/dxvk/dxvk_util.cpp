@@ -3,6 +3,8 @@
 #include "dxvk_format.h"
 #include "dxvk_util.h"
 
+#include "../util/util_texel.h"
+
 namespace dxvk::util {
   
   uint32_t computeMipLevelCount(VkExtent3D imageSize) {
@@ -26,31 +28,19 @@ namespace dxvk::util {
           VkDeviceSize      blockSize,
           VkDeviceSize      pitchPerRow,
           VkDeviceSize      pitchPerLayer) {
-    auto dstData = reinterpret_cast<      char*>(dstBytes);
-    auto srcData = reinterpret_cast<const char*>(srcBytes);
-    
     const VkDeviceSize bytesPerRow   = blockCount.width  * blockSize;
     const VkDeviceSize bytesPerLayer = blockCount.height * bytesPerRow;
-    const VkDeviceSize bytesTotal    = blockCount.depth  * bytesPerLayer;
-    
-    const bool directCopy = ((bytesPerRow   == pitchPerRow  ) || (blockCount.height == 1))
-                         && ((bytesPerLayer == pitchPerLayer) || (blockCount.depth  == 1));
-    
-    if (directCopy) {
-      std::memcpy(dstData, srcData, bytesTotal);
-    } else {
-      for (uint32_t i = 0; i < blockCount.depth; i++) {
-        for (uint32_t j = 0; j < blockCount.height; j++) {
-          std::memcpy(
-            dstData + j * bytesPerRow,
-            srcData + j * pitchPerRow,
-            bytesPerRow);
-        }
-        
-        srcData += pitchPerLayer;
-        dstData += bytesPerLayer;
-      }
-    }
+
+    texel::CopyRegion region;
+    region.rowSize        = bytesPerRow;
+    region.rowCount       = blockCount.height;
+    region.layerCount     = blockCount.depth;
+    region.srcRowPitch    = pitchPerRow;
+    region.srcLayerPitch  = pitchPerLayer;
+    region.dstRowPitch    = bytesPerRow;
+    region.dstLayerPitch  = bytesPerLayer;
+
+    texel::copyImage(dstBytes, srcBytes, region, true);
   }
   
   
@@ -65,7 +55,8 @@ namespace dxvk::util {
           VkExtent3D        imageExtent,
           uint32_t          imageLayers,
     const DxvkFormatInfo*   formatInfo,
-          VkImageAspectFlags aspectMask) {
+          VkImageAspectFlags aspectMask,
+          bool              streaming) {
     auto dstData = reinterpret_cast<      char*>(dstBytes);
     auto srcData = reinterpret_cast<const char*>(srcBytes);
 
@@ -86,57 +77,35 @@ namespace dxvk::util {
 
         VkDeviceSize bytesPerRow   = blockCount.width  * elementSize;
         VkDeviceSize bytesPerSlice = blockCount.height * bytesPerRow;
-        VkDeviceSize bytesTotal    = blockCount.depth  * bytesPerSlice;
 
         VkDeviceSize dstRowPitch   = dstRowPitchIn   ? dstRowPitchIn   : bytesPerRow;
         VkDeviceSize dstSlicePitch = dstSlicePitchIn ? dstSlicePitchIn : bytesPerSlice;
 
-        const bool directCopy = ((bytesPerRow   == srcRowPitch   && bytesPerRow   == dstRowPitch  ) || (blockCount.height == 1))
-                             && ((bytesPerSlice == srcSlicePitch && bytesPerSlice == dstSlicePitch) || (blockCount.depth  == 1));
-
-        if (directCopy) {
-          std::memcpy(dstData, srcData, bytesTotal);
-
-          switch (imageType) {
-            case VK_IMAGE_TYPE_1D:
-              srcData += srcRowPitch;
-              dstData += dstRowPitch;
-              break;
-            case VK_IMAGE_TYPE_2D:
-              srcData += blockCount.height * srcRowPitch;
-              dstData += blockCount.height * dstRowPitch;
-              break;
-            case VK_IMAGE_TYPE_3D:
-              srcData += blockCount.depth * srcSlicePitch;
-              dstData += blockCount.depth * dstSlicePitch;
-              break;
-            default: ;
-          }
-        } else {
-          for (uint32_t i = 0; i < blockCount.depth; i++) {
-            for (uint32_t j = 0; j < blockCount.height; j++) {
-              std::memcpy(
-                dstData + j * dstRowPitch,
-                srcData + j * srcRowPitch,
-                bytesPerRow);
-            }
-
-            switch (imageType) {
-              case VK_IMAGE_TYPE_1D:
-                srcData += srcRowPitch;
-                dstData += dstRowPitch;
-                break;
-              case VK_IMAGE_TYPE_2D:
-                srcData += blockCount.height * srcRowPitch;
-                dstData += blockCount.height * dstRowPitch;
-                break;
-              case VK_IMAGE_TYPE_3D:
-                srcData += srcSlicePitch;
-                dstData += dstSlicePitch;
-                break;
-              default: ;
-            }
-          }
+        texel::CopyRegion region;
+        region.rowSize        = bytesPerRow;
+        region.rowCount       = blockCount.height;
+        region.layerCount     = blockCount.depth;
+        region.srcRowPitch    = srcRowPitch;
+        region.srcLayerPitch  = srcSlicePitch;
+        region.dstRowPitch    = dstRowPitch;
+        region.dstLayerPitch  = dstSlicePitch;
+
+        texel::copyImage(dstData, srcData, region, streaming);
+
+        switch (imageType) {
+          case VK_IMAGE_TYPE_1D:
+            srcData += srcRowPitch;
+            dstData += dstRowPitch;
+            break;
+          case VK_IMAGE_TYPE_2D:
+            srcData += blockCount.height * srcRowPitch;
+            dstData += blockCount.height * dstRowPitch;
+            break;
+          case VK_IMAGE_TYPE_3D:
+            srcData += blockCount.depth * srcSlicePitch;
+            dstData += blockCount.depth * dstSlicePitch;
+            break;
+          default: ;
         }
       }
     }
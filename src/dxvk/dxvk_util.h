@@ -144,6 +144,8 @@ namespace dxvk::util {
   /**
    * \brief Writes tightly packed image data to a buffer
    * 
+   * The destination is written with streaming stores, so
+   * this must only be used to write to upload memory.
    * \param [in] dstBytes Destination buffer pointer
    * \param [in] srcBytes Pointer to source data
    * \param [in] blockCount Number of blocks to copy
@@ -165,6 +167,8 @@ namespace dxvk::util {
    * Note that passing destination pitches of 0 means that the data is
    * tightly packed, while a source pitch of 0 will not show this behaviour
    * in order to match client API behaviour for initialization.
+   * Streaming stores should only be used when writing to memory
+   * that will not be read back by the CPU any time soon.
    * \param [in] dstBytes Destination buffer pointer
    * \param [in] srcBytes Pointer to source data
    * \param [in] srcRowPitch Number of bytes between rows to read
@@ -176,6 +180,7 @@ namespace dxvk::util {
    * \param [in] imageLayers Image layer count
    * \param [in] formatInfo Image format info
    * \param [in] aspectMask Image aspects to pack
+   * \param [in] streaming Whether to use streaming stores
    */
   void packImageData(
           void*             dstBytes,
@@ -188,7 +193,8 @@ namespace dxvk::util {
           VkExtent3D        imageExtent,
           uint32_t          imageLayers,
     const DxvkFormatInfo*   formatInfo,
-          VkImageAspectFlags aspectMask);
+          VkImageAspectFlags aspectMask,
+          bool              streaming = true);
   
   /**
    * \brief Computes minimum extent
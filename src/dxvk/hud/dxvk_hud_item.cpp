@@ -882,6 +882,7 @@ namespace dxvk::hud {
     if (ticks >= UpdateInterval) {
       m_cacheStats = m_device->getMemoryAllocationStats(m_stats);
       m_displayCacheStats |= m_cacheStats.requestCount != 0u;
+      m_displayLockStats |= m_stats.lockStats.lockCount != 0u;
 
       m_lastUpdate = time;
     }
@@ -908,6 +909,16 @@ namespace dxvk::hud {
       y -= 24;
     }
 
+    if (m_displayLockStats) {
+      const auto& lockStats = m_stats.lockStats;
+      uint64_t contention = (100u * lockStats.contentionCount) / std::max<uint64_t>(lockStats.lockCount, 1u);
+
+      std::string lockStr = str::format("Lock: ", lockStats.holdTime, " us held (", contention, "% contended)");
+      renderer.drawText(14, { x, y }, 0xffffffffu, lockStr);
+
+      y -= 24;
+    }
+
     for (uint32_t i = m_stats.memoryTypes.size(); i; i--) {
       const auto& type = m_stats.memoryTypes.at(i - 1);
 
@@ -1385,6 +1396,50 @@ namespace dxvk::hud {
   }
 
 
+  HudShaderCacheItem::HudShaderCacheItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudShaderCacheItem::~HudShaderCacheItem() {
+
+  }
+
+
+  void HudShaderCacheItem::update(dxvk::high_resolution_clock::time_point time) {
+    DxvkStatCounters counters = m_device->getStatCounters();
+
+    m_queueDepth   = counters.getCtr(DxvkStatCounter::ShaderCacheQueueDepth);
+    m_bytesWritten = counters.getCtr(DxvkStatCounter::ShaderCacheBytesWritten);
+    m_codeHits     = counters.getCtr(DxvkStatCounter::ShaderCodeCacheHits);
+    m_codeMisses   = counters.getCtr(DxvkStatCounter::ShaderCodeCacheMisses);
+  }
+
+
+  HudPos HudShaderCacheItem::render(
+    const Rc<DxvkCommandList>&ctx,
+    const HudPipelineKey&     key,
+    const HudOptions&         options,
+          HudRenderer&        renderer,
+          HudPos              position) {
+    position.y += 16;
+    renderer.drawText(16, position, 0xff40ffffu, "Cache queue:");
+    renderer.drawText(16, { position.x + 240, position.y }, 0xffffffffu, str::format(m_queueDepth));
+
+    position.y += 20;
+    renderer.drawText(16, position, 0xff40ffffu, "Cache written:");
+    renderer.drawText(16, { position.x + 240, position.y }, 0xffffffffu, str::format(m_bytesWritten >> 10, " kB"));
+
+    position.y += 20;
+    renderer.drawText(16, position, 0xff40ffffu, "SPIR-V hits:");
+    renderer.drawText(16, { position.x + 240, position.y }, 0xffffffffu, str::format(m_codeHits, " / ", m_codeHits + m_codeMisses));
+
+    position.y += 8;
+    return position;
+  }
+
+
 
   HudLatencyItem::HudLatencyItem() {
 
@@ -1464,4 +1519,80 @@ namespace dxvk::hud {
     return position;
   }
 
+
+  HudFramePacingItem::HudFramePacingItem() {
+
+  }
+
+
+  HudFramePacingItem::~HudFramePacingItem() {
+
+  }
+
+
+  void HudFramePacingItem::accumulateStats(const FpsLimiterStats& stats) {
+    std::lock_guard lock(m_mutex);
+
+    for (size_t i = 0; i < stats.histogram.size(); i++)
+      m_accumStats.histogram[i] += stats.histogram[i];
+
+    m_accumStats.frameCount += stats.frameCount;
+    m_accumStats.maxError = std::max(m_accumStats.maxError, stats.maxError);
+    m_accumStats.totalError += stats.totalError;
+  }
+
+
+  void HudFramePacingItem::update(dxvk::high_resolution_clock::time_point time) {
+    uint64_t ticks = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate).count();
+
+    if (ticks >= UpdateInterval) {
+      std::lock_guard lock(m_mutex);
+
+      m_displayStats = std::exchange(m_accumStats, FpsLimiterStats());
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudFramePacingItem::render(
+    const Rc<DxvkCommandList>&ctx,
+    const HudPipelineKey&     key,
+    const HudOptions&         options,
+          HudRenderer&        renderer,
+          HudPos              position) {
+    // Nothing to show if the limiter did not delay any frames
+    if (!m_displayStats.frameCount)
+      return position;
+
+    uint32_t frameCount = m_displayStats.frameCount;
+    uint64_t avgError = std::chrono::duration_cast<std::chrono::microseconds>(m_displayStats.totalError).count() / frameCount;
+    uint64_t maxError = std::chrono::duration_cast<std::chrono::microseconds>(m_displayStats.maxError).count();
+
+    position.y += 16;
+    renderer.drawText(16, position, 0xffff60a0u, "Pacing error:");
+
+    position.y += 20;
+    renderer.drawText(16, position, 0xffc0c0c0u, "Average:");
+    renderer.drawText(16, { position.x + 108, position.y }, 0xffffffffu, str::format(avgError, " us"));
+
+    position.y += 20;
+    renderer.drawText(16, position, 0xffc0c0c0u, "Maximum:");
+    renderer.drawText(16, { position.x + 108, position.y }, 0xffffffffu, str::format(maxError, " us"));
+
+    for (size_t i = 0; i < m_displayStats.histogram.size(); i++) {
+      std::string label = i < FpsLimiterStats::BucketLimits.size()
+        ? str::format("< ", FpsLimiterStats::BucketLimits[i], " us:")
+        : str::format(">= ", FpsLimiterStats::BucketLimits.back(), " us:");
+
+      uint32_t percentage = (100u * m_displayStats.histogram[i]) / frameCount;
+
+      position.y += 20;
+      renderer.drawText(16, position, 0xffc0c0c0u, label);
+      renderer.drawText(16, { position.x + 108, position.y }, 0xffffffffu, str::format(percentage, "%"));
+    }
+
+    position.y += 8;
+    return position;
+  }
+
 }
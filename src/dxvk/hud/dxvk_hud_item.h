@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "../../util/util_fps_limiter.h"
 #include "../../util/util_time.h"
 
 #include "../dxvk_gpu_query.h"
@@ -577,6 +578,7 @@ namespace dxvk::hud {
     high_resolution_clock::time_point m_lastUpdate = { };
 
     bool                      m_displayCacheStats = false;
+    bool                      m_displayLockStats = false;
 
     Rc<DxvkBuffer>            m_dataBuffer;
     std::vector<DrawInfo>     m_drawInfos;
@@ -736,6 +738,38 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display shader cache statistics
+   */
+  class HudShaderCacheItem : public HudItem {
+
+  public:
+
+    HudShaderCacheItem(const Rc<DxvkDevice>& device);
+
+    ~HudShaderCacheItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+      const Rc<DxvkCommandList>&ctx,
+      const HudPipelineKey&     key,
+      const HudOptions&         options,
+            HudRenderer&        renderer,
+            HudPos              position);
+
+  private:
+
+    Rc<DxvkDevice> m_device;
+
+    uint64_t m_queueDepth   = 0;
+    uint64_t m_bytesWritten = 0;
+    uint64_t m_codeHits     = 0;
+    uint64_t m_codeMisses   = 0;
+
+  };
+
+
   /**
    * \brief Frame latency item
    */
@@ -777,4 +811,41 @@ namespace dxvk::hud {
 
   };
 
+
+  /**
+   * \brief Frame pacing item
+   *
+   * Displays a histogram of frame rate limiter pacing errors.
+   */
+  class HudFramePacingItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudFramePacingItem();
+
+    ~HudFramePacingItem();
+
+    void accumulateStats(const FpsLimiterStats& stats);
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+      const Rc<DxvkCommandList>&ctx,
+      const HudPipelineKey&     key,
+      const HudOptions&         options,
+            HudRenderer&        renderer,
+            HudPos              position);
+
+  private:
+
+    sync::Spinlock      m_mutex;
+
+    FpsLimiterStats     m_accumStats = { };
+    FpsLimiterStats     m_displayStats = { };
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
 }
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+#include "../dxvk_allocator.h"
+#include "../dxvk_memory_trace.h"
+
+using namespace dxvk;
+
+/**
+ * \brief Simulated memory pool
+ *
+ * Mirrors the chunk management of the memory allocator's device and
+ * mapped memory pools closely enough to compare allocation policies,
+ * but frees chunks as soon as they become empty.
+ */
+struct ReplayPool {
+  constexpr static uint64_t MaxChunkSize = DxvkPageAllocator::MaxChunkSize;
+  constexpr static uint64_t MinChunkSize = MaxChunkSize / 64u;
+
+  DxvkPageAllocator pageAllocator;
+  DxvkPoolAllocator poolAllocator = { pageAllocator };
+
+  uint64_t nextChunkSize = MinChunkSize;
+  uint64_t chunkMemory = 0u;
+
+  int64_t alloc(uint64_t size, uint64_t align) {
+    if (size <= DxvkPoolAllocator::MaxSize)
+      return poolAllocator.alloc(size);
+    else
+      return pageAllocator.alloc(size, align);
+  }
+
+  bool free(uint64_t address, uint64_t size) {
+    if (size <= DxvkPoolAllocator::MaxSize)
+      return poolAllocator.free(address, size);
+    else
+      return pageAllocator.free(address, size);
+  }
+
+  void addChunk(uint64_t size) {
+    uint64_t chunkSize = nextChunkSize;
+
+    while (chunkSize < size)
+      chunkSize *= 2u;
+
+    if (nextChunkSize < MaxChunkSize && nextChunkSize <= chunkMemory / 2u)
+      nextChunkSize *= 2u;
+
+    pageAllocator.addChunk(chunkSize);
+    chunkMemory += chunkSize;
+  }
+
+  void removeChunk(uint32_t chunkIndex) {
+    chunkMemory -= uint64_t(pageAllocator.pageCount(chunkIndex)) * DxvkPageAllocator::PageSize;
+    pageAllocator.removeChunk(chunkIndex);
+  }
+};
+
+
+struct ReplayAllocation {
+  ReplayPool* pool;
+  int64_t     address;
+  uint64_t    size;
+};
+
+
+struct ReplayOpStats {
+  uint64_t count = 0u;
+  uint64_t time = 0u;
+
+  void print(const char* name) const {
+    std::cout << "  " << std::setw(10) << std::left << name << std::right
+              << std::setw(12) << count << " ops, "
+              << std::fixed << std::setprecision(1)
+              << std::setw(8) << (count ? double(time) / double(count) : 0.0) << " ns/op" << std::endl;
+  }
+};
+
+
+struct ReplayStats {
+  uint64_t committed = 0u;
+  uint64_t used = 0u;
+
+  uint64_t peakCommitted = 0u;
+  uint64_t peakUsed = 0u;
+  double   peakFragmentation = 0.0;
+
+  ReplayOpStats alloc;
+  ReplayOpStats free;
+  uint64_t relocations = 0u;
+  uint64_t dedicated = 0u;
+  uint64_t unknown = 0u;
+
+  void update() {
+    if (committed > peakCommitted) {
+      peakCommitted = committed;
+      peakFragmentation = 1.0 - double(used) / double(committed);
+    }
+
+    peakUsed = std::max(peakUsed, used);
+  }
+};
+
+
+static double toMiB(uint64_t bytes) {
+  return double(bytes) / double(1u << 20);
+}
+
+
+static uint64_t elapsedNs(high_resolution_clock::time_point t0, high_resolution_clock::time_point t1) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+}
+
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " trace-file" << std::endl;
+    return 1;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+
+  if (!file) {
+    std::cerr << "Failed to open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  DxvkAllocationTraceHeader header = { };
+
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+   || std::memcmp(header.magic, DxvkAllocationTraceMagic, sizeof(header.magic))
+   || header.version != DxvkAllocationTrace::Version
+   || header.recordSize != sizeof(DxvkAllocationTraceRecord)) {
+    std::cerr << "Invalid or unsupported trace file" << std::endl;
+    return 1;
+  }
+
+  std::unordered_map<uint32_t, std::unique_ptr<ReplayPool>> pools;
+  std::unordered_map<uint64_t, ReplayAllocation> allocations;
+
+  ReplayStats stats;
+  DxvkAllocationTraceRecord record = { };
+
+  while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    if (record.event == DxvkAllocationTraceEvent::Relocate) {
+      stats.relocations += 1u;
+      continue;
+    }
+
+    if (record.pool == DxvkAllocationTracePool::Dedicated) {
+      if (record.event == DxvkAllocationTraceEvent::Allocate) {
+        allocations.insert_or_assign(record.allocation, ReplayAllocation { nullptr, -1, record.size });
+        stats.committed += record.size;
+        stats.used += record.size;
+        stats.dedicated += 1u;
+      } else {
+        auto entry = allocations.find(record.allocation);
+
+        if (entry == allocations.end()) {
+          stats.unknown += 1u;
+          continue;
+        }
+
+        stats.committed -= entry->second.size;
+        stats.used -= entry->second.size;
+        allocations.erase(entry);
+      }
+
+      stats.update();
+      continue;
+    }
+
+    if (record.event == DxvkAllocationTraceEvent::Allocate) {
+      uint32_t poolKey = (uint32_t(record.memoryType) << 8u) | uint32_t(record.pool);
+      auto& pool = pools[poolKey];
+
+      if (!pool)
+        pool = std::make_unique<ReplayPool>();
+
+      uint64_t alignment = std::max<uint64_t>(record.alignment, 1u);
+      uint64_t oldCommitted = pool->chunkMemory;
+
+      auto t0 = high_resolution_clock::now();
+      int64_t address = pool->alloc(record.size, alignment);
+
+      if (address < 0) {
+        pool->addChunk(record.size);
+        address = pool->alloc(record.size, alignment);
+      }
+
+      auto t1 = high_resolution_clock::now();
+
+      if (address < 0) {
+        std::cerr << "Allocation of " << record.size << " bytes failed" << std::endl;
+        return 1;
+      }
+
+      stats.alloc.count += 1u;
+      stats.alloc.time += elapsedNs(t0, t1);
+
+      allocations.insert_or_assign(record.allocation, ReplayAllocation { pool.get(), address, record.size });
+
+      stats.committed += pool->chunkMemory - oldCommitted;
+      stats.used += record.size;
+    } else {
+      auto entry = allocations.find(record.allocation);
+
+      if (entry == allocations.end()) {
+        stats.unknown += 1u;
+        continue;
+      }
+
+      auto allocation = entry->second;
+      allocations.erase(entry);
+
+      uint64_t oldCommitted = allocation.pool->chunkMemory;
+
+      auto t0 = high_resolution_clock::now();
+
+      if (allocation.pool->free(allocation.address, allocation.size))
+        allocation.pool->removeChunk(uint32_t(allocation.address >> DxvkPageAllocator::ChunkAddressBits));
+
+      auto t1 = high_resolution_clock::now();
+
+      stats.free.count += 1u;
+      stats.free.time += elapsedNs(t0, t1);
+
+      stats.committed -= oldCommitted - allocation.pool->chunkMemory;
+      stats.used -= allocation.size;
+    }
+
+    stats.update();
+  }
+
+  double fragmentation = stats.committed
+    ? 1.0 - double(stats.used) / double(stats.committed)
+    : 0.0;
+
+  std::cout << std::fixed << std::setprecision(1)
+            << "Peak footprint:      " << toMiB(stats.peakCommitted) << " MiB" << std::endl
+            << "Peak live memory:    " << toMiB(stats.peakUsed) << " MiB" << std::endl
+            << std::setprecision(3)
+            << "Fragmentation:       " << stats.peakFragmentation << " at peak, "
+                                       << fragmentation << " at end" << std::endl
+            << "Dedicated:           " << stats.dedicated << " allocations" << std::endl
+            << "Relocations:         " << stats.relocations << std::endl;
+
+  if (stats.unknown)
+    std::cout << "Unmatched frees:     " << stats.unknown << std::endl;
+
+  std::cout << "Page allocator time:" << std::endl;
+  stats.alloc.print("alloc");
+  stats.free.print("free");
+  return 0;
+}
@@ -46,6 +46,16 @@ namespace dxvk {
   }
 
   
+  std::vector<uint32_t> SpirvCodeBuffer::release() {
+    std::vector<uint32_t> result = std::move(m_code);
+    result.clear();
+
+    m_code = std::vector<uint32_t>();
+    m_ptr = 0;
+    return result;
+  }
+
+
   uint32_t SpirvCodeBuffer::allocId() {
     constexpr size_t BoundIdsOffset = 3;
 
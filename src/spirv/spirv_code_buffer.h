@@ -81,6 +81,27 @@ namespace dxvk {
       return SpirvInstructionIterator(nullptr, 0, 0);
     }
     
+    /**
+     * \brief Reserves storage
+     *
+     * Ensures that the given number of dwords can be
+     * appended to the buffer without reallocating.
+     * \param [in] dwords Number of dwords to reserve
+     */
+    void reserve(size_t dwords) {
+      m_code.reserve(m_code.size() + dwords);
+    }
+
+    /**
+     * \brief Releases underlying storage
+     *
+     * Empties the buffer and returns the storage vector
+     * with its capacity intact, so that the memory can
+     * be reused for another code buffer.
+     * \returns Empty storage vector
+     */
+    std::vector<uint32_t> release();
+
     /**
      * \brief Allocates a new ID
      *
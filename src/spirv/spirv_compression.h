@@ -24,6 +24,14 @@ namespace dxvk {
     
     SpirvCodeBuffer decompress() const;
 
+    /**
+     * \brief Queries memory footprint
+     * \returns Size of compressed code, in bytes
+     */
+    size_t getCompressedSize() const {
+      return m_code.size() * sizeof(uint32_t);
+    }
+
   private:
 
     size_t                m_size;
@@ -2,21 +2,62 @@
 
 #include "spirv_module.h"
 
+#include "../util/thread.h"
+
 namespace dxvk {
   
-  SpirvModule::SpirvModule(uint32_t version)
+  /**
+   * \brief Code buffer storage pool
+   *
+   * Keeps the storage of code buffers owned by destroyed modules
+   * around, with one free list per module section, so that the
+   * next module can reuse memory that is already sized for the
+   * respective section. The total amount of pooled memory is
+   * limited, and buffers that grew larger than the per-buffer
+   * limit are freed, so that the pool does not hold on to too
+   * much memory after compiling a particularly large shader.
+   */
+  struct SpirvStoragePool {
+    constexpr static size_t MaxBufferBytes = size_t(1u) << 20;
+    constexpr static size_t MaxTotalBytes = size_t(4u) << 20;
+
+    dxvk::mutex mutex;
+    size_t totalBytes = 0u;
+    std::array<std::vector<std::vector<uint32_t>>, 11> sections;
+  };
+
+
+  static SpirvStoragePool& getStoragePool() {
+    // Intentionally leaked so that modules destroyed
+    // during process teardown never access a pool
+    // whose destructor has already run.
+    static SpirvStoragePool* s_pool = new SpirvStoragePool();
+    return *s_pool;
+  }
+
+
+  SpirvModule::SpirvModule(uint32_t version, size_t sizeHint)
   : m_version(version) {
+    this->acquireStorage(sizeHint);
     this->instImportGlsl450();
   }
   
   
   SpirvModule::~SpirvModule() {
-    
+    this->releaseStorage();
   }
   
   
   SpirvCodeBuffer SpirvModule::compile() {
+    // Header is five dwords, dead code elimination
+    // may only ever shrink the final function code.
+    size_t dwords = 5u;
+
+    for (auto section : getSections())
+      dwords += section->dwords();
+
     SpirvCodeBuffer result;
+    result.reserve(dwords);
     result.putHeader(m_version, m_id);
     result.append(m_capabilities);
     result.append(m_extensions);
@@ -61,6 +102,66 @@ namespace dxvk {
   }
   
   
+  std::array<SpirvCodeBuffer*, 11> SpirvModule::getSections() {
+    return {{
+      &m_capabilities,  &m_extensions,  &m_instExt,
+      &m_memoryModel,   &m_entryPoints, &m_execModeInfo,
+      &m_debugNames,    &m_annotations, &m_typeConstDefs,
+      &m_variables,     &m_code,
+    }};
+  }
+
+
+  void SpirvModule::acquireStorage(size_t sizeHint) {
+    auto sections = getSections();
+
+    { auto& storagePool = getStoragePool();
+      std::lock_guard<dxvk::mutex> lock(storagePool.mutex);
+
+      for (size_t i = 0; i < sections.size(); i++) {
+        auto& pool = storagePool.sections[i];
+
+        if (!pool.empty()) {
+          storagePool.totalBytes -= pool.back().capacity() * sizeof(uint32_t);
+
+          *sections[i] = SpirvCodeBuffer(std::move(pool.back()));
+          pool.pop_back();
+        }
+      }
+    }
+
+    if (sizeHint) {
+      // Rough estimate of section sizes relative to the function
+      // code, based on the output of the DXSO and FF compilers.
+      m_debugNames.reserve(sizeHint / 4u);
+      m_annotations.reserve(sizeHint / 8u);
+      m_typeConstDefs.reserve(sizeHint / 4u);
+      m_variables.reserve(sizeHint / 16u);
+      m_code.reserve(sizeHint);
+    }
+  }
+
+
+  void SpirvModule::releaseStorage() {
+    auto sections = getSections();
+
+    auto& storagePool = getStoragePool();
+    std::lock_guard<dxvk::mutex> lock(storagePool.mutex);
+
+    for (size_t i = 0; i < sections.size(); i++) {
+      auto storage = sections[i]->release();
+      size_t bytes = storage.capacity() * sizeof(uint32_t);
+
+      // Also covers buffers that were only inflated by the size hint
+      if (bytes && bytes <= SpirvStoragePool::MaxBufferBytes
+       && storagePool.totalBytes + bytes <= SpirvStoragePool::MaxTotalBytes) {
+        storagePool.sections[i].push_back(std::move(storage));
+        storagePool.totalBytes += bytes;
+      }
+    }
+  }
+
+
   uint32_t SpirvModule::allocateId() {
     return m_id++;
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -57,7 +58,18 @@ namespace dxvk {
     
   public:
     
-    explicit SpirvModule(uint32_t version);
+    /**
+     * \brief Creates module
+     *
+     * Code buffer storage is recycled from previously destroyed
+     * modules where possible. The size hint is used to reserve
+     * memory up front so that emitting the shader code does not
+     * need to repeatedly grow the code buffers.
+     * \param [in] version SPIR-V version
+     * \param [in] sizeHint Expected size of the function
+     *    code section in dwords, or 0 if unknown.
+     */
+    explicit SpirvModule(uint32_t version, size_t sizeHint = 0u);
 
     ~SpirvModule();
     
@@ -1313,6 +1325,12 @@ namespace dxvk {
 
     std::vector<uint32_t> m_interfaceVars;
 
+    std::array<SpirvCodeBuffer*, 11> getSections();
+
+    void acquireStorage(size_t sizeHint);
+
+    void releaseStorage();
+
     uint32_t defType(
             spv::Op                 op, 
             uint32_t                argCount,
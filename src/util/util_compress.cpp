@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "util_compress.h"
+
+namespace dxvk::util {
+
+  constexpr static uint32_t CompressHashBits = 12u;
+  constexpr static size_t   CompressMinMatch = 4u;
+  constexpr static size_t   CompressMaxOffset = 0xffffu;
+
+  static void encodeLength(std::vector<uint8_t>& dst, size_t length) {
+    while (length >= 255u) {
+      dst.push_back(255u);
+      length -= 255u;
+    }
+
+    dst.push_back(uint8_t(length));
+  }
+
+
+  static bool decodeLength(const uint8_t* src, size_t srcSize, size_t& offset, size_t& length) {
+    uint8_t byte;
+
+    do {
+      if (offset >= srcSize)
+        return false;
+
+      byte = src[offset++];
+      length += byte;
+    } while (byte == 255u);
+
+    return true;
+  }
+
+
+  static void encodeSequence(
+          std::vector<uint8_t>&       dst,
+    const uint8_t*                    literals,
+          size_t                      literalCount,
+          size_t                      matchOffset,
+          size_t                      matchLength) {
+    // Each sequence starts with a token that stores the literal count
+    // in the upper four bits and the match length in the lower four
+    // bits, with extra length bytes following if either overflows.
+    size_t matchBits = matchLength ? matchLength - CompressMinMatch : 0u;
+
+    dst.push_back(uint8_t((std::min<size_t>(literalCount, 15u) << 4u)
+                        | (std::min<size_t>(matchBits, 15u))));
+
+    if (literalCount >= 15u)
+      encodeLength(dst, literalCount - 15u);
+
+    dst.insert(dst.end(), literals, literals + literalCount);
+
+    if (!matchLength)
+      return;
+
+    dst.push_back(uint8_t(matchOffset));
+    dst.push_back(uint8_t(matchOffset >> 8u));
+
+    if (matchBits >= 15u)
+      encodeLength(dst, matchBits - 15u);
+  }
+
+
+  std::vector<uint8_t> compressBlock(
+    const uint8_t*                    data,
+          size_t                      size) {
+    std::vector<uint8_t> result;
+    result.reserve(size / 2u);
+
+    // Stores the most recent position plus one for each hash
+    std::array<uint32_t, 1u << CompressHashBits> table = { };
+
+    size_t anchor = 0u;
+    size_t pos = 0u;
+
+    while (pos + CompressMinMatch <= size) {
+      uint32_t value;
+      std::memcpy(&value, &data[pos], sizeof(value));
+
+      uint32_t hash = (value * 2654435761u) >> (32u - CompressHashBits);
+      size_t candidate = table[hash];
+      table[hash] = uint32_t(pos + 1u);
+
+      if (!candidate || pos - (candidate - 1u) > CompressMaxOffset
+       || std::memcmp(&data[candidate - 1u], &data[pos], CompressMinMatch)) {
+        pos += 1u;
+        continue;
+      }
+
+      size_t ref = candidate - 1u;
+      size_t length = CompressMinMatch;
+
+      while (pos + length < size && data[ref + length] == data[pos + length])
+        length += 1u;
+
+      encodeSequence(result, &data[anchor], pos - anchor, pos - ref, length);
+
+      pos += length;
+      anchor = pos;
+    }
+
+    // The last sequence always consists of literals only,
+    // which is how the decoder detects the end of the data.
+    encodeSequence(result, &data[anchor], size - anchor, 0u, 0u);
+    return result;
+  }
+
+
+  bool decompressBlock(
+    const uint8_t*                    src,
+          size_t                      srcSize,
+          uint8_t*                    dst,
+          size_t                      dstSize) {
+    size_t srcOffset = 0u;
+    size_t dstOffset = 0u;
+
+    while (srcOffset < srcSize) {
+      uint8_t token = src[srcOffset++];
+
+      size_t literalCount = token >> 4u;
+
+      if (literalCount == 15u && !decodeLength(src, srcSize, srcOffset, literalCount))
+        return false;
+
+      if (literalCount > srcSize - srcOffset || literalCount > dstSize - dstOffset)
+        return false;
+
+      std::memcpy(&dst[dstOffset], &src[srcOffset], literalCount);
+      srcOffset += literalCount;
+      dstOffset += literalCount;
+
+      if (srcOffset == srcSize)
+        break;
+
+      if (srcSize - srcOffset < 2u)
+        return false;
+
+      size_t matchOffset = size_t(src[srcOffset]) | (size_t(src[srcOffset + 1u]) << 8u);
+      srcOffset += 2u;
+
+      size_t matchLength = token & 0xfu;
+
+      if (matchLength == 15u && !decodeLength(src, srcSize, srcOffset, matchLength))
+        return false;
+
+      matchLength += CompressMinMatch;
+
+      if (!matchOffset || matchOffset > dstOffset || matchLength > dstSize - dstOffset)
+        return false;
+
+      // Matches may overlap with the bytes being written
+      for (size_t i = 0u; i < matchLength; i++)
+        dst[dstOffset + i] = dst[dstOffset + i - matchOffset];
+
+      dstOffset += matchLength;
+    }
+
+    return dstOffset == dstSize;
+  }
+
+}
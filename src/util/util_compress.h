@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dxvk::util {
+
+  /**
+   * \brief Compresses a block of data
+   *
+   * Implements a simple LZ77-style byte compression scheme that
+   * trades compression ratio for speed. Data is encoded as a
+   * sequence of literal runs, each optionally followed by a
+   * back-reference of at least four bytes within a 64k window.
+   * \param [in] data Pointer to uncompressed data
+   * \param [in] size Size of uncompressed data
+   * \returns Compressed data
+   */
+  std::vector<uint8_t> compressBlock(
+    const uint8_t*                    data,
+          size_t                      size);
+
+  /**
+   * \brief Decompresses a block of data
+   *
+   * Validates the compressed stream, so that corrupted
+   * input cannot cause out-of-bounds memory accesses.
+   * \param [in] src Compressed data
+   * \param [in] srcSize Size of compressed data
+   * \param [out] dst Destination buffer
+   * \param [in] dstSize Exact size of uncompressed data
+   * \returns \c true if the block was successfully decompressed
+   */
+  bool decompressBlock(
+    const uint8_t*                    src,
+          size_t                      srcSize,
+          uint8_t*                    dst,
+          size_t                      dstSize);
+
+}
@@ -10,6 +10,8 @@
 #include <sys/sysctl.h>
 #include <unistd.h>
 #include <limits.h>
+#elif !defined(_WIN32)
+#include <unistd.h>
 #endif
 
 #include "util_env.h"
@@ -108,6 +110,15 @@ namespace dxvk::env {
   }
   
   
+  uint32_t getProcessId() {
+#ifdef _WIN32
+    return uint32_t(::GetCurrentProcessId());
+#else
+    return uint32_t(::getpid());
+#endif
+  }
+
+
   void setThreadName(const std::string& name) {
 #ifdef _WIN32
     using SetThreadDescriptionProc = HRESULT (WINAPI *) (HANDLE, PCWSTR);
@@ -150,5 +161,48 @@ namespace dxvk::env {
     return std::filesystem::is_directory(path) || std::filesystem::create_directories(path);
 #endif
   }
+
+
+  bool replaceFile(const std::string& src, const std::string& dst) {
+#ifdef _WIN32
+    std::array<WCHAR, MAX_PATH + 1> wideSrc;
+    std::array<WCHAR, MAX_PATH + 1> wideDst;
+
+    size_t srcLength = str::transcodeString(
+      wideSrc.data(), wideSrc.size() - 1,
+      src.data(), src.size());
+
+    size_t dstLength = str::transcodeString(
+      wideDst.data(), wideDst.size() - 1,
+      dst.data(), dst.size());
+
+    wideSrc[srcLength] = L'\0';
+    wideDst[dstLength] = L'\0';
+
+    return MoveFileExW(wideSrc.data(), wideDst.data(), MOVEFILE_REPLACE_EXISTING);
+#else
+    std::error_code ec;
+    std::filesystem::rename(src, dst, ec);
+    return !ec;
+#endif
+  }
+
+
+  bool removeFile(const std::string& path) {
+#ifdef _WIN32
+    std::array<WCHAR, MAX_PATH + 1> widePath;
+
+    size_t length = str::transcodeString(
+      widePath.data(), widePath.size() - 1,
+      path.data(), path.size());
+
+    widePath[length] = L'\0';
+
+    return DeleteFileW(widePath.data());
+#else
+    std::error_code ec;
+    return std::filesystem::remove(path, ec);
+#endif
+  }
   
 }
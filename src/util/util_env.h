@@ -62,6 +62,12 @@ namespace dxvk::env {
    */
   std::string getExePath();
   
+  /**
+   * \brief Gets process ID of the calling process
+   * \returns Process ID
+   */
+  uint32_t getProcessId();
+
   /**
    * \brief Sets name of the calling thread
    * \param [in] name Thread name
@@ -75,5 +81,24 @@ namespace dxvk::env {
    * \returns \c true on success
    */
   bool createDirectory(const std::string& path);
+
+  /**
+   * \brief Replaces a file with another file
+   *
+   * Renames the source file, overwriting the
+   * destination file if it already exists.
+   * \param [in] src Path to file to rename
+   * \param [in] dst New file path
+   * \returns \c true on success
+   */
+  bool replaceFile(const std::string& src, const std::string& dst);
+
+  /**
+   * \brief Removes a file
+   *
+   * \param [in] path Path to file to remove
+   * \returns \c true if the file was removed
+   */
+  bool removeFile(const std::string& path);
   
 }
@@ -2,6 +2,12 @@
 
 #include "./com/com_include.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "./log/log.h"
 
 #include "util_file.h"
@@ -98,6 +104,25 @@ namespace dxvk::util {
       return FlushFileBuffers(m_file);
     }
 
+    Rc<FileMapping> map(size_t size) {
+      if (m_file == INVALID_HANDLE_VALUE || !size)
+        return nullptr;
+
+      HANDLE mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+      if (!mapping)
+        return nullptr;
+
+      void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+
+      if (!data) {
+        CloseHandle(mapping);
+        return nullptr;
+      }
+
+      return new FileMapping(data, size, mapping);
+    }
+
   private:
 
     FileFlags m_flags = { };
@@ -154,7 +179,8 @@ namespace dxvk::util {
 
   public:
 
-    StlFile(const std::string& path, FileFlags flags) {
+    StlFile(const std::string& path, FileFlags flags)
+    : m_path(path) {
       std::ios_base::openmode mode = std::ios_base::binary;
 
       if (flags.test(FileFlag::AllowRead))
@@ -229,8 +255,27 @@ namespace dxvk::util {
       return true;
     }
 
+    Rc<FileMapping> map(size_t size) {
+      if (!status() || !size)
+        return nullptr;
+
+      int fd = ::open(m_path.c_str(), O_RDONLY);
+
+      if (fd < 0)
+        return nullptr;
+
+      void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+
+      if (data == MAP_FAILED)
+        return nullptr;
+
+      return new FileMapping(data, size, nullptr);
+    }
+
   private:
 
+    std::string   m_path;
     FileFlags     m_flags = { };
     std::fstream  m_file;
 
@@ -239,6 +284,22 @@ namespace dxvk::util {
   using FileImpl = StlFile;
 #endif
 
+  FileMapping::FileMapping(const void* data, size_t size, void* handle)
+  : m_data(data), m_size(size), m_handle(handle) {
+
+  }
+
+
+  FileMapping::~FileMapping() {
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_handle);
+#else
+    ::munmap(const_cast<void*>(m_data), m_size);
+#endif
+  }
+
+
   FileIface::~FileIface() {
 
   }
@@ -300,6 +361,13 @@ namespace dxvk::util {
     return m_impl && m_impl->flush();
   }
 
+  Rc<FileMapping> File::map(size_t size) {
+    if (!m_impl)
+      return nullptr;
+
+    return m_impl->map(size);
+  }
+
   File::operator bool () const {
     return m_impl && m_impl->status();
   }
@@ -3,6 +3,8 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string>
 
 #include "util_flags.h"
 #include "util_likely.h"
@@ -24,6 +26,73 @@ namespace dxvk::util {
   using FileFlags = Flags<FileFlag>;
 
 
+  /**
+   * \brief Read-only file mapping
+   *
+   * Keeps a read-only view of a file prefix mapped into the
+   * address space for as long as a reference to it exists.
+   */
+  class FileMapping {
+
+  public:
+
+    FileMapping(const void* data, size_t size, void* handle);
+
+    ~FileMapping();
+
+    /**
+     * \brief Queries pointer to mapped data
+     * \returns Pointer to start of the file
+     */
+    const void* data() const {
+      return m_data;
+    }
+
+    /**
+     * \brief Queries size of the mapped range
+     * \returns Mapped size, in bytes
+     */
+    size_t size() const {
+      return m_size;
+    }
+
+    /**
+     * \brief Reads data from the mapping
+     *
+     * Provided for compatibility with file read methods.
+     * \param [in] offset Offset into the mapping
+     * \param [in] size Number of bytes to read
+     * \param [out] data Destination pointer
+     * \returns \c true if the range is valid
+     */
+    bool read(size_t offset, size_t size, void* data) const {
+      if (offset > m_size || size > m_size - offset)
+        return false;
+
+      std::memcpy(data, reinterpret_cast<const char*>(m_data) + offset, size);
+      return true;
+    }
+
+    force_inline void incRef() {
+      m_refCount.fetch_add(1u, std::memory_order_acquire);
+    }
+
+    force_inline void decRef() {
+      if (m_refCount.fetch_sub(1u, std::memory_order_acquire) == 1u)
+        delete this;
+    }
+
+  private:
+
+    std::atomic<uint32_t> m_refCount = { 0u };
+
+    const void* m_data   = nullptr;
+    size_t      m_size   = 0u;
+    void*       m_handle = nullptr;
+
+  };
+
+
   /**
    * \brief Platform-specific file interface
    */
@@ -45,6 +114,8 @@ namespace dxvk::util {
 
     virtual bool flush() = 0;
 
+    virtual Rc<FileMapping> map(size_t size) = 0;
+
     force_inline void incRef() {
       m_refCount.fetch_add(1u, std::memory_order_acquire);
     }
@@ -94,6 +165,19 @@ namespace dxvk::util {
 
     bool flush();
 
+    /**
+     * \brief Maps the first bytes of the file
+     *
+     * The mapping stays valid even if the file object gets
+     * closed. Data appended to the file after creating the
+     * mapping will not be visible through the mapping. The
+     * file must not be truncated while a mapping exists, since
+     * accessing the removed range may crash the process.
+     * \param [in] size Number of bytes to map
+     * \returns File mapping, or \c nullptr on error
+     */
+    Rc<FileMapping> map(size_t size);
+
     explicit operator bool () const;
 
   private:
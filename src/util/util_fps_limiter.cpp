@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <thread>
+#include <utility>
 
 #include "thread.h"
 #include "util_env.h"
@@ -41,10 +43,23 @@ namespace dxvk {
   }
 
 
+  void FpsLimiter::setPrecisePacing(bool enable) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    m_precisePacing = enable;
+  }
+
+
+  FpsLimiterStats FpsLimiter::getStatistics() {
+    std::lock_guard<dxvk::mutex> lock(m_statsMutex);
+    return std::exchange(m_stats, FpsLimiterStats());
+  }
+
+
   void FpsLimiter::delay() {
     std::unique_lock<dxvk::mutex> lock(m_mutex);
     auto interval = m_targetInterval;
     auto latency = m_maxLatency;
+    auto precise = m_precisePacing;
 
     if (interval == TimerDuration::zero()) {
       m_nextFrame = TimePoint();
@@ -64,8 +79,14 @@ namespace dxvk {
     // that can be written by setTargetFrameRate
     lock.unlock();
 
-    if (t1 < m_nextFrame)
-      Sleep::sleepUntil(t1, m_nextFrame);
+    if (t1 < m_nextFrame) {
+      TimePoint t2 = precise
+        ? preciseSleepUntil(t1, m_nextFrame)
+        : Sleep::sleepUntil(t1, m_nextFrame);
+
+      std::lock_guard<dxvk::mutex> statsLock(m_statsMutex);
+      recordPacingError(m_stats, t2 - m_nextFrame);
+    }
 
     m_nextFrame = (t1 < m_nextFrame + interval)
       ? m_nextFrame + interval
@@ -73,6 +94,67 @@ namespace dxvk {
   }
 
 
+  FpsLimiter::TimePoint FpsLimiter::preciseSleepUntil(TimePoint t0, TimePoint t1) {
+    TimerDuration threshold = computeSpinThreshold(m_sleepOvershoot);
+
+    if (t1 - t0 > threshold) {
+      TimePoint sleepTarget = t1 - threshold;
+
+      t0 = Sleep::sleepCoarse(t0, sleepTarget - t0);
+      m_sleepOvershoot = updateOvershootEstimate(m_sleepOvershoot, t0 - sleepTarget);
+    }
+
+    // Spin for the remaining time. Recalibration above
+    // ensures that this is usually well below a millisecond.
+    while (t0 < t1)
+      t0 = dxvk::high_resolution_clock::now();
+
+    return t0;
+  }
+
+
+  FpsLimiter::TimerDuration FpsLimiter::updateOvershootEstimate(
+          TimerDuration         estimate,
+          TimerDuration         overshoot) {
+    constexpr static TimerDuration MaxOvershoot = 4ms;
+
+    overshoot = std::clamp(overshoot, TimerDuration::zero(), MaxOvershoot);
+
+    if (overshoot >= estimate)
+      return overshoot;
+
+    return estimate - (estimate - overshoot) / 16;
+  }
+
+
+  FpsLimiter::TimerDuration FpsLimiter::computeSpinThreshold(
+          TimerDuration         estimate) {
+    // Add some headroom since the overshoot estimate is an
+    // average-ish value rather than a hard upper bound.
+    constexpr static TimerDuration MinThreshold = 50us;
+    return estimate + estimate / 4 + MinThreshold;
+  }
+
+
+  void FpsLimiter::recordPacingError(
+          FpsLimiterStats&      stats,
+          TimerDuration         error) {
+    if (error < TimerDuration::zero())
+      error = -error;
+
+    uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(error).count();
+    uint32_t bucket = 0u;
+
+    while (bucket < FpsLimiterStats::BucketLimits.size() && us >= FpsLimiterStats::BucketLimits[bucket])
+      bucket += 1u;
+
+    stats.histogram[bucket] += 1u;
+    stats.frameCount += 1u;
+    stats.maxError = std::max(stats.maxError, error);
+    stats.totalError += error;
+  }
+
+
   bool FpsLimiter::testRefreshHeuristic(TimerDuration interval, TimePoint now, uint32_t maxLatency) {
     if (m_heuristicEnable)
       return true;
@@ -7,6 +7,28 @@
 #include "util_time.h"
 
 namespace dxvk {
+
+  /**
+   * \brief Frame pacing statistics
+   *
+   * Histogram of the pacing error, i.e. the difference between
+   * the target time of a frame and the time at which the frame
+   * rate limiter actually released it. Only frames for which the
+   * limiter had to wait are counted.
+   */
+  struct FpsLimiterStats {
+    /// Upper bounds of the histogram buckets, in microseconds.
+    /// The last bucket counts all frames above the last limit.
+    constexpr static std::array<uint32_t, 7> BucketLimits = { 10u, 25u, 50u, 100u, 250u, 500u, 1000u };
+
+    std::array<uint32_t, BucketLimits.size() + 1> histogram = { };
+
+    uint32_t frameCount = 0u;
+
+    std::chrono::nanoseconds maxError   = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds totalError = std::chrono::nanoseconds::zero();
+  };
+
   
   /**
    * \brief Frame rate limiter
@@ -40,11 +62,61 @@ namespace dxvk {
      */
     void delay();
 
-  private:
+    /**
+     * \brief Enables or disables precise pacing
+     *
+     * In precise mode, the limiter only sleeps until shortly
+     * before the target time and spins for the remainder. The
+     * spin margin is calibrated based on the observed sleep
+     * overshoot.
+     * \param [in] enable Whether to enable precise pacing
+     */
+    void setPrecisePacing(bool enable);
+
+    /**
+     * \brief Retrieves and resets pacing statistics
+     * \returns Statistics since the last call
+     */
+    FpsLimiterStats getStatistics();
 
     using TimePoint = dxvk::high_resolution_clock::time_point;
     using TimerDuration = std::chrono::nanoseconds;
 
+    /**
+     * \brief Updates sleep overshoot estimate
+     *
+     * Increases are applied immediately, so that a single late
+     * wake-up does not cause subsequent frames to miss their
+     * target, whereas decreases are applied gradually.
+     * \param [in] estimate Current overshoot estimate
+     * \param [in] overshoot Measured overshoot of the last sleep
+     * \returns Updated overshoot estimate
+     */
+    static TimerDuration updateOvershootEstimate(
+            TimerDuration         estimate,
+            TimerDuration         overshoot);
+
+    /**
+     * \brief Computes spin margin for a given overshoot estimate
+     *
+     * \param [in] estimate Sleep overshoot estimate
+     * \returns Time before the target to stop sleeping at
+     */
+    static TimerDuration computeSpinThreshold(
+            TimerDuration         estimate);
+
+    /**
+     * \brief Adds pacing error to statistics
+     *
+     * \param [in,out] stats Pacing statistics
+     * \param [in] error Difference between actual and target time
+     */
+    static void recordPacingError(
+            FpsLimiterStats&      stats,
+            TimerDuration         error);
+
+  private:
+
     dxvk::mutex     m_mutex;
 
     TimerDuration   m_targetInterval  = TimerDuration::zero();
@@ -55,8 +127,16 @@ namespace dxvk {
     TimePoint       m_heuristicFrameTime  = TimePoint();
     bool            m_heuristicEnable     = false;
 
+    bool            m_precisePacing   = false;
+    TimerDuration   m_sleepOvershoot  = std::chrono::milliseconds(1);
+
+    dxvk::mutex     m_statsMutex;
+    FpsLimiterStats m_stats;
+
     bool testRefreshHeuristic(TimerDuration interval, TimePoint now, uint32_t maxLatency);
 
+    TimePoint preciseSleepUntil(TimePoint t0, TimePoint t1);
+
   };
 
 }
@@ -107,6 +107,18 @@ namespace dxvk {
   }
 
 
+  Sleep::TimePoint Sleep::coarseSleep(TimePoint t0, TimerDuration duration) {
+    if (duration <= TimerDuration::zero())
+      return t0;
+
+    if (!m_initialized.load(std::memory_order_acquire))
+      initialize();
+
+    systemSleep(duration);
+    return dxvk::high_resolution_clock::now();
+  }
+
+
   void Sleep::systemSleep(TimerDuration duration) {
 #ifdef _WIN32
     if (NtDelayExecution) {
@@ -41,6 +41,21 @@ namespace dxvk {
       return sleepFor(t0, t1 - t0);
     }
 
+    /**
+     * \brief Sleeps without busy-waiting
+     *
+     * Issues a single system sleep for the given duration.
+     * Depending on the timer resolution, the thread may
+     * wake up significantly later than requested.
+     * \param [in] t0 Current time
+     * \param [in] duration Sleep duration
+     * \returns Time after sleep has finished
+     */
+    template<typename Rep, typename Period>
+    static TimePoint sleepCoarse(TimePoint t0, std::chrono::duration<Rep, Period> duration) {
+      return s_instance.coarseSleep(t0, std::chrono::duration_cast<TimerDuration>(duration));
+    }
+
   private:
 
     static Sleep s_instance;
@@ -71,6 +86,8 @@ namespace dxvk {
 
     TimePoint sleep(TimePoint t0, TimerDuration duration);
 
+    TimePoint coarseSleep(TimePoint t0, TimerDuration duration);
+
     void systemSleep(TimerDuration duration);
 
   };
@@ -0,0 +1,150 @@
+#include <cstring>
+
+#include "util_bit.h"
+#include "util_texel.h"
+
+namespace dxvk::texel {
+
+  /**
+   * \brief Copies memory using streaming stores without fencing
+   *
+   * The caller must issue a store fence once all copies are done.
+   * Copies that are too small to benefit from aligning the
+   * destination pointer are performed with regular stores.
+   */
+  static void copyStreamingUnfenced(
+          void*         dst,
+    const void*         src,
+          size_t        size) {
+    #if defined(DXVK_ARCH_X86) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+    auto dstPtr = reinterpret_cast<      char*>(dst);
+    auto srcPtr = reinterpret_cast<const char*>(src);
+
+    if (size >= 64u) {
+      // Align destination to 16 bytes so that we can use streaming
+      // stores, source data is loaded with unaligned loads since
+      // pitches provided by the application are arbitrary
+      size_t head = (16u - (reinterpret_cast<uintptr_t>(dstPtr) & 15u)) & 15u;
+
+      if (head) {
+        std::memcpy(dstPtr, srcPtr, head);
+
+        dstPtr += head;
+        srcPtr += head;
+        size -= head;
+      }
+
+      while (size >= 64u) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr +  0u));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr + 16u));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr + 32u));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr + 48u));
+
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dstPtr +  0u), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dstPtr + 16u), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dstPtr + 32u), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dstPtr + 48u), d);
+
+        dstPtr += 64u;
+        srcPtr += 64u;
+        size -= 64u;
+      }
+
+      while (size >= 16u) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcPtr));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dstPtr), a);
+
+        dstPtr += 16u;
+        srcPtr += 16u;
+        size -= 16u;
+      }
+    }
+
+    if (size)
+      std::memcpy(dstPtr, srcPtr, size);
+    #else
+    std::memcpy(dst, src, size);
+    #endif
+  }
+
+
+  static void copyRegular(
+          void*         dst,
+    const void*         src,
+          size_t        size) {
+    std::memcpy(dst, src, size);
+  }
+
+
+  static void fenceStreaming() {
+    #if defined(DXVK_ARCH_X86) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+    _mm_sfence();
+    #endif
+  }
+
+
+  void copyStreaming(
+          void*         dst,
+    const void*         src,
+          size_t        size) {
+    if (size < MinStreamingCopySize) {
+      std::memcpy(dst, src, size);
+      return;
+    }
+
+    copyStreamingUnfenced(dst, src, size);
+    fenceStreaming();
+  }
+
+
+  void copyImage(
+          void*         dst,
+    const void*         src,
+    const CopyRegion&   region,
+          bool          streaming) {
+    if (!region.rowSize || !region.rowCount || !region.layerCount)
+      return;
+
+    auto dstData = reinterpret_cast<      char*>(dst);
+    auto srcData = reinterpret_cast<const char*>(src);
+
+    size_t layerSize = region.rowSize * region.rowCount;
+    size_t totalSize = region.layerCount * layerSize;
+
+    bool tightRows = (region.rowCount == 1u)
+      || (region.srcRowPitch == region.rowSize && region.dstRowPitch == region.rowSize);
+    bool tightLayers = (region.layerCount == 1u)
+      || (region.srcLayerPitch == layerSize && region.dstLayerPitch == layerSize);
+
+    streaming &= totalSize >= MinStreamingCopySize;
+
+    auto copyFn = streaming ? &copyStreamingUnfenced : &copyRegular;
+
+    if (tightRows && tightLayers) {
+      copyFn(dstData, srcData, totalSize);
+    } else if (tightRows) {
+      for (size_t i = 0; i < region.layerCount; i++) {
+        copyFn(
+          dstData + i * region.dstLayerPitch,
+          srcData + i * region.srcLayerPitch,
+          layerSize);
+      }
+    } else {
+      for (size_t i = 0; i < region.layerCount; i++) {
+        auto dstLayer = dstData + i * region.dstLayerPitch;
+        auto srcLayer = srcData + i * region.srcLayerPitch;
+
+        for (size_t j = 0; j < region.rowCount; j++) {
+          copyFn(
+            dstLayer + j * region.dstRowPitch,
+            srcLayer + j * region.srcRowPitch,
+            region.rowSize);
+        }
+      }
+    }
+
+    if (streaming)
+      fenceStreaming();
+  }
+
+}
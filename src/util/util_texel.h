@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dxvk::texel {
+
+  /**
+   * \brief Minimum copy size for streaming stores
+   *
+   * Below this size, aligning the destination and fencing
+   * the stores costs more than it saves, so small copies
+   * go through a regular \c memcpy instead.
+   */
+  constexpr size_t MinStreamingCopySize = 256u;
+
+  /**
+   * \brief Image copy region
+   *
+   * Describes a copy of \c rowCount rows with \c rowSize bytes
+   * each, repeated for \c layerCount layers or slices. Pitches
+   * are given in bytes and may differ between source and
+   * destination.
+   */
+  struct CopyRegion {
+    size_t rowSize        = 0u;
+    size_t rowCount       = 0u;
+    size_t layerCount     = 0u;
+    size_t srcRowPitch    = 0u;
+    size_t srcLayerPitch  = 0u;
+    size_t dstRowPitch    = 0u;
+    size_t dstLayerPitch  = 0u;
+  };
+
+  /**
+   * \brief Copies memory using non-temporal stores
+   *
+   * Meant for writing to mapped memory that will only
+   * be read by the GPU, since streaming stores bypass
+   * the cache and combine well with write-combined
+   * memory. Handles arbitrary alignment and sizes.
+   * \param [in] dst Destination pointer
+   * \param [in] src Source pointer
+   * \param [in] size Number of bytes to copy
+   */
+  void copyStreaming(
+          void*         dst,
+    const void*         src,
+          size_t        size);
+
+  /**
+   * \brief Copies image data with arbitrary pitches
+   *
+   * Collapses the copy into a single contiguous copy if both
+   * source and destination are tightly packed. If \c streaming
+   * is \c true, the destination is written with non-temporal
+   * stores, which should only be used for upload memory.
+   * \param [in] dst Destination pointer
+   * \param [in] src Source pointer
+   * \param [in] region Copy region
+   * \param [in] streaming Whether to use streaming stores
+   */
+  void copyImage(
+          void*         dst,
+    const void*         src,
+    const CopyRegion&   region,
+          bool          streaming);
+
+}
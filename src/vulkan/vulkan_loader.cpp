@@ -1,6 +1,7 @@
 #include <tuple>
 
 #include "vulkan_loader.h"
+#include "vulkan_null.h"
 
 #include "../util/log/log.h"
 
@@ -42,6 +43,14 @@ namespace dxvk::vk {
   }
 
   LibraryLoader::LibraryLoader() {
+    NullDriverMode nullDriver = getNullDriverMode();
+
+    if (nullDriver != NullDriverMode::Disabled) {
+      Logger::warn("Vulkan: Using null driver, nothing will be rendered");
+      m_getInstanceProcAddr = getNullDriverProc(nullDriver);
+      return;
+    }
+
     std::tie(m_library, m_getInstanceProcAddr) = loadVulkanLibrary();
   }
 
@@ -0,0 +1,2278 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "vulkan_null.h"
+
+#include "../util/log/log.h"
+
+#include "../util/util_bit.h"
+#include "../util/util_env.h"
+#include "../util/util_math.h"
+#include "../util/util_string.h"
+#include "../util/util_time.h"
+
+#include "../util/thread.h"
+
+namespace dxvk::vk {
+
+  namespace null {
+
+    /** Number of samples reported for occlusion queries, so that
+     *  applications relying on them keep rendering their geometry */
+    constexpr uint64_t OcclusionQuerySamples = 1024u;
+
+    /** Alignment of mapped memory pointers */
+    constexpr VkDeviceSize MemoryMapAlignment = 64u;
+
+    /** Mask of all memory types */
+    constexpr uint32_t MemoryTypeMask = 0xfu;
+
+    /** Whether to log every call */
+    static bool g_traceCalls = false;
+
+    /** Counter for objects that don't need any state */
+    static std::atomic<uint64_t> g_handleCounter = { 1u };
+
+    /** Fake GPU virtual address space for buffers */
+    static std::atomic<uint64_t> g_addressCounter = { 1ull << 32u };
+
+    /** Dummy object to derive the physical device handle from */
+    static char g_physicalDeviceTag = 0;
+
+
+    template<typename H>
+    H allocHandle() {
+      return (H)(uintptr_t)(g_handleCounter.fetch_add(1u, std::memory_order_relaxed));
+    }
+
+    template<typename H, typename T>
+    H toHandle(T* object) {
+      return (H)(uintptr_t)(object);
+    }
+
+    template<typename T, typename H>
+    T* fromHandle(H handle) {
+      return (T*)(uintptr_t)(handle);
+    }
+
+    template<typename T>
+    const T* findStruct(const void* pNext, VkStructureType sType) {
+      auto s = reinterpret_cast<const VkBaseInStructure*>(pNext);
+
+      while (s && s->sType != sType)
+        s = s->pNext;
+
+      return reinterpret_cast<const T*>(s);
+    }
+
+    template<typename T>
+    VkResult enumerate(uint32_t* pCount, T* pOut, const T* pItems, uint32_t itemCount) {
+      if (!pOut) {
+        *pCount = itemCount;
+        return VK_SUCCESS;
+      }
+
+      uint32_t count = std::min(*pCount, itemCount);
+
+      for (uint32_t i = 0; i < count; i++)
+        pOut[i] = pItems[i];
+
+      *pCount = count;
+      return count < itemCount ? VK_INCOMPLETE : VK_SUCCESS;
+    }
+
+    static uint64_t getTimestamp() {
+      auto now = dxvk::high_resolution_clock::now();
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    }
+
+    static dxvk::high_resolution_clock::time_point getDeadline(uint64_t timeout) {
+      // Avoid overflow for infinite timeouts
+      auto now = dxvk::high_resolution_clock::now();
+
+      if (timeout >= uint64_t(std::numeric_limits<int64_t>::max() / 2))
+        return dxvk::high_resolution_clock::time_point::max();
+
+      return now + std::chrono::nanoseconds(timeout);
+    }
+
+
+    /**
+     * \brief Format block info
+     *
+     * Conservative estimate of the memory layout of a format, used
+     * to compute image sizes and linear image layouts. Formats that
+     * are not explicitly handled use a large upper bound.
+     */
+    struct FormatInfo {
+      uint32_t blockWidth   = 1u;
+      uint32_t blockHeight  = 1u;
+      uint32_t blockSize    = 16u;
+      uint32_t planeCount   = 1u;
+    };
+
+    static bool isInRange(VkFormat format, VkFormat first, VkFormat last) {
+      return uint32_t(format) >= uint32_t(first)
+          && uint32_t(format) <= uint32_t(last);
+    }
+
+    static bool isDepthStencilFormat(VkFormat format) {
+      return isInRange(format, VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT_S8_UINT);
+    }
+
+    static bool isCompressedFormat(VkFormat format) {
+      return isInRange(format, VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_ASTC_12x12_SRGB_BLOCK);
+    }
+
+    static bool isMultiPlaneFormat(VkFormat format) {
+      return isInRange(format, VK_FORMAT_G8B8G8R8_422_UNORM, VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM);
+    }
+
+    static FormatInfo getFormatInfo(VkFormat format) {
+      FormatInfo result = { };
+
+      if (format == VK_FORMAT_R4G4_UNORM_PACK8
+       || format == VK_FORMAT_S8_UINT
+       || format == VK_FORMAT_A8_UNORM_KHR
+       || isInRange(format, VK_FORMAT_R8_UNORM, VK_FORMAT_R8_SRGB)) {
+        result.blockSize = 1u;
+      } else if (format == VK_FORMAT_D16_UNORM
+       || format == VK_FORMAT_A4R4G4B4_UNORM_PACK16_EXT
+       || format == VK_FORMAT_A4B4G4R4_UNORM_PACK16_EXT
+       || format == VK_FORMAT_A1B5G5R5_UNORM_PACK16_KHR
+       || isInRange(format, VK_FORMAT_R4G4B4A4_UNORM_PACK16, VK_FORMAT_A1R5G5B5_UNORM_PACK16)
+       || isInRange(format, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8_SRGB)
+       || isInRange(format, VK_FORMAT_R16_UNORM, VK_FORMAT_R16_SFLOAT)) {
+        result.blockSize = 2u;
+      } else if (isInRange(format, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_B8G8R8_SRGB)) {
+        result.blockSize = 3u;
+      } else if (format == VK_FORMAT_B10G11R11_UFLOAT_PACK32
+       || format == VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+       || format == VK_FORMAT_X8_D24_UNORM_PACK32
+       || format == VK_FORMAT_D32_SFLOAT
+       || format == VK_FORMAT_D16_UNORM_S8_UINT
+       || format == VK_FORMAT_D24_UNORM_S8_UINT
+       || isInRange(format, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_A2B10G10R10_SINT_PACK32)
+       || isInRange(format, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16_SFLOAT)
+       || isInRange(format, VK_FORMAT_R32_UINT, VK_FORMAT_R32_SFLOAT)) {
+        result.blockSize = 4u;
+      } else if (isInRange(format, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16_SFLOAT)) {
+        result.blockSize = 6u;
+      } else if (format == VK_FORMAT_D32_SFLOAT_S8_UINT
+       || isInRange(format, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT)
+       || isInRange(format, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32_SFLOAT)
+       || isInRange(format, VK_FORMAT_R64_UINT, VK_FORMAT_R64_SFLOAT)) {
+        result.blockSize = 8u;
+      } else if (isInRange(format, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32_SFLOAT)) {
+        result.blockSize = 12u;
+      } else if (isInRange(format, VK_FORMAT_R32G32B32A32_UINT, VK_FORMAT_R32G32B32A32_SFLOAT)
+       || isInRange(format, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64_SFLOAT)) {
+        result.blockSize = 16u;
+      } else if (isInRange(format, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64_SFLOAT)) {
+        result.blockSize = 24u;
+      } else if (isInRange(format, VK_FORMAT_R64G64B64A64_UINT, VK_FORMAT_R64G64B64A64_SFLOAT)) {
+        result.blockSize = 32u;
+      } else if (isCompressedFormat(format)) {
+        // Use 4x4 blocks for everything, which overestimates
+        // the size of ASTC images with larger block sizes.
+        bool isSmallBlock = isInRange(format, VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGBA_SRGB_BLOCK)
+                         || isInRange(format, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC4_SNORM_BLOCK)
+                         || isInRange(format, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK)
+                         || isInRange(format, VK_FORMAT_EAC_R11_UNORM_BLOCK, VK_FORMAT_EAC_R11_SNORM_BLOCK);
+
+        result.blockWidth = 4u;
+        result.blockHeight = 4u;
+        result.blockSize = isSmallBlock ? 8u : 16u;
+      } else if (isMultiPlaneFormat(format)) {
+        result.blockSize = 8u;
+        result.planeCount = 3u;
+      }
+
+      return result;
+    }
+
+
+    static uint32_t getPlaneIndex(VkImageAspectFlags aspect) {
+      if (aspect & VK_IMAGE_ASPECT_PLANE_1_BIT) return 1u;
+      if (aspect & VK_IMAGE_ASPECT_PLANE_2_BIT) return 2u;
+      return 0u;
+    }
+
+
+    /**
+     * \brief Computes image layout
+     *
+     * Lays out mip levels one after another, with all array layers of
+     * a mip level stored consecutively, and planes stored one after
+     * another. Optionally returns the layout of a single subresource.
+     * \param [in] info Image create info
+     * \param [in] pSubresource Subresource to query, or \c nullptr
+     * \param [out] pLayout Subresource layout
+     * \returns Total image size, in bytes
+     */
+    static VkDeviceSize computeImageLayout(
+      const VkImageCreateInfo&      info,
+      const VkImageSubresource*     pSubresource,
+            VkSubresourceLayout*    pLayout) {
+      FormatInfo format = getFormatInfo(info.format);
+
+      VkDeviceSize offset = 0u;
+
+      for (uint32_t m = 0; m < info.mipLevels; m++) {
+        uint32_t w = std::max(info.extent.width  >> m, 1u);
+        uint32_t h = std::max(info.extent.height >> m, 1u);
+        uint32_t d = std::max(info.extent.depth  >> m, 1u);
+
+        VkDeviceSize rowPitch = align(VkDeviceSize((w + format.blockWidth - 1u) / format.blockWidth) * format.blockSize, VkDeviceSize(64u));
+        VkDeviceSize depthPitch = rowPitch * ((h + format.blockHeight - 1u) / format.blockHeight);
+        VkDeviceSize arrayPitch = depthPitch * d;
+
+        if (pSubresource && pSubresource->mipLevel == m) {
+          pLayout->offset = offset + pSubresource->arrayLayer * arrayPitch;
+          pLayout->size = arrayPitch;
+          pLayout->rowPitch = rowPitch;
+          pLayout->arrayPitch = arrayPitch;
+          pLayout->depthPitch = depthPitch;
+        }
+
+        offset += arrayPitch * info.arrayLayers;
+      }
+
+      if (pSubresource)
+        pLayout->offset += getPlaneIndex(pSubresource->aspectMask) * offset;
+
+      return offset * format.planeCount;
+    }
+
+
+    static VkFormatFeatureFlags2 getFormatFeatures(VkFormat format, VkImageTiling tiling) {
+      if (format == VK_FORMAT_UNDEFINED)
+        return 0u;
+
+      VkFormatFeatureFlags2 common = VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_BIT
+                                   | VK_FORMAT_FEATURE_2_TRANSFER_SRC_BIT
+                                   | VK_FORMAT_FEATURE_2_TRANSFER_DST_BIT;
+
+      if (isDepthStencilFormat(format)) {
+        if (tiling != VK_IMAGE_TILING_OPTIMAL)
+          return 0u;
+
+        return common
+          | VK_FORMAT_FEATURE_2_DEPTH_STENCIL_ATTACHMENT_BIT
+          | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+          | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_DEPTH_COMPARISON_BIT
+          | VK_FORMAT_FEATURE_2_BLIT_SRC_BIT;
+      }
+
+      if (isCompressedFormat(format) || isMultiPlaneFormat(format)) {
+        return common
+          | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+          | VK_FORMAT_FEATURE_2_BLIT_SRC_BIT;
+      }
+
+      if (tiling != VK_IMAGE_TILING_OPTIMAL)
+        return common | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+      return common
+        | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+        | VK_FORMAT_FEATURE_2_STORAGE_IMAGE_BIT
+        | VK_FORMAT_FEATURE_2_STORAGE_READ_WITHOUT_FORMAT_BIT
+        | VK_FORMAT_FEATURE_2_STORAGE_WRITE_WITHOUT_FORMAT_BIT
+        | VK_FORMAT_FEATURE_2_COLOR_ATTACHMENT_BIT
+        | VK_FORMAT_FEATURE_2_COLOR_ATTACHMENT_BLEND_BIT
+        | VK_FORMAT_FEATURE_2_BLIT_SRC_BIT
+        | VK_FORMAT_FEATURE_2_BLIT_DST_BIT;
+    }
+
+
+    static VkFormatFeatureFlags2 getBufferFeatures(VkFormat format) {
+      if (format == VK_FORMAT_UNDEFINED
+       || isDepthStencilFormat(format)
+       || isCompressedFormat(format)
+       || isMultiPlaneFormat(format))
+        return 0u;
+
+      return VK_FORMAT_FEATURE_2_VERTEX_BUFFER_BIT
+           | VK_FORMAT_FEATURE_2_UNIFORM_TEXEL_BUFFER_BIT
+           | VK_FORMAT_FEATURE_2_STORAGE_TEXEL_BUFFER_BIT
+           | VK_FORMAT_FEATURE_2_STORAGE_READ_WITHOUT_FORMAT_BIT
+           | VK_FORMAT_FEATURE_2_STORAGE_WRITE_WITHOUT_FORMAT_BIT;
+    }
+
+
+    static VkResult getImageFormatProperties(
+            VkFormat                  format,
+            VkImageType               type,
+            VkImageTiling             tiling,
+            VkImageUsageFlags         usage,
+            VkImageCreateFlags        flags,
+            VkImageFormatProperties*  pProperties) {
+      *pProperties = { };
+
+      VkFormatFeatureFlags2 features = getFormatFeatures(format, tiling);
+
+      static const std::array<std::pair<VkImageUsageFlags, VkFormatFeatureFlags2>, 6> s_usageFeatures = {{
+        { VK_IMAGE_USAGE_TRANSFER_SRC_BIT,              VK_FORMAT_FEATURE_2_TRANSFER_SRC_BIT              },
+        { VK_IMAGE_USAGE_TRANSFER_DST_BIT,              VK_FORMAT_FEATURE_2_TRANSFER_DST_BIT              },
+        { VK_IMAGE_USAGE_SAMPLED_BIT,                   VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_BIT             },
+        { VK_IMAGE_USAGE_STORAGE_BIT,                   VK_FORMAT_FEATURE_2_STORAGE_IMAGE_BIT             },
+        { VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,          VK_FORMAT_FEATURE_2_COLOR_ATTACHMENT_BIT          },
+        { VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,  VK_FORMAT_FEATURE_2_DEPTH_STENCIL_ATTACHMENT_BIT  },
+      }};
+
+      if (!features)
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+
+      for (const auto& u : s_usageFeatures) {
+        if ((usage & u.first) && !(features & u.second))
+          return VK_ERROR_FORMAT_NOT_SUPPORTED;
+      }
+
+      switch (type) {
+        case VK_IMAGE_TYPE_1D:
+          pProperties->maxExtent = { 16384u, 1u, 1u };
+          pProperties->maxMipLevels = 15u;
+          pProperties->maxArrayLayers = 2048u;
+          break;
+
+        case VK_IMAGE_TYPE_2D:
+          pProperties->maxExtent = { 16384u, 16384u, 1u };
+          pProperties->maxMipLevels = 15u;
+          pProperties->maxArrayLayers = 2048u;
+          break;
+
+        case VK_IMAGE_TYPE_3D:
+          pProperties->maxExtent = { 2048u, 2048u, 2048u };
+          pProperties->maxMipLevels = 12u;
+          pProperties->maxArrayLayers = 1u;
+          break;
+
+        default:
+          return VK_ERROR_FORMAT_NOT_SUPPORTED;
+      }
+
+      pProperties->sampleCounts = VK_SAMPLE_COUNT_1_BIT;
+
+      if (type == VK_IMAGE_TYPE_2D && tiling == VK_IMAGE_TILING_OPTIMAL
+       && !(flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT)
+       && !isCompressedFormat(format) && !isMultiPlaneFormat(format)) {
+        pProperties->sampleCounts |= VK_SAMPLE_COUNT_2_BIT
+                                  |  VK_SAMPLE_COUNT_4_BIT
+                                  |  VK_SAMPLE_COUNT_8_BIT;
+      }
+
+      pProperties->maxResourceSize = 1ull << 40u;
+      return VK_SUCCESS;
+    }
+
+
+    static void getMemoryProperties(VkPhysicalDeviceMemoryProperties* pProperties) {
+      *pProperties = { };
+
+      pProperties->memoryHeapCount = 3u;
+      pProperties->memoryHeaps[0u] = { 8ull << 30u, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+      pProperties->memoryHeaps[1u] = { 16ull << 30u, 0u };
+      pProperties->memoryHeaps[2u] = { 256ull << 20u, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+
+      pProperties->memoryTypeCount = 4u;
+      pProperties->memoryTypes[0u] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0u };
+      pProperties->memoryTypes[1u] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1u };
+      pProperties->memoryTypes[2u] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                     | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1u };
+      pProperties->memoryTypes[3u] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                                     | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                     | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 2u };
+    }
+
+
+    static void getQueueFamilyProperties(VkQueueFamilyProperties* pProperties) {
+      *pProperties = { };
+      pProperties->queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+      pProperties->queueCount = 1u;
+      pProperties->timestampValidBits = 64u;
+      pProperties->minImageTransferGranularity = { 1u, 1u, 1u };
+    }
+
+
+    static void getLimits(VkPhysicalDeviceLimits* pLimits) {
+      constexpr uint32_t MaxDescriptors = 1u << 20u;
+      constexpr VkSampleCountFlags SampleCounts = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT
+                                                | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+
+      *pLimits = { };
+      pLimits->maxImageDimension1D                   = 16384u;
+      pLimits->maxImageDimension2D                   = 16384u;
+      pLimits->maxImageDimension3D                   = 2048u;
+      pLimits->maxImageDimensionCube                 = 16384u;
+      pLimits->maxImageArrayLayers                   = 2048u;
+      pLimits->maxTexelBufferElements                = 1u << 27u;
+      pLimits->maxUniformBufferRange                 = 65536u;
+      pLimits->maxStorageBufferRange                 = 1u << 30u;
+      pLimits->maxPushConstantsSize                  = 256u;
+      pLimits->maxMemoryAllocationCount              = 4096u;
+      pLimits->maxSamplerAllocationCount             = 4000u;
+      pLimits->bufferImageGranularity                = 1u;
+      pLimits->maxBoundDescriptorSets                = 32u;
+      pLimits->maxPerStageDescriptorSamplers         = MaxDescriptors;
+      pLimits->maxPerStageDescriptorUniformBuffers   = MaxDescriptors;
+      pLimits->maxPerStageDescriptorStorageBuffers   = MaxDescriptors;
+      pLimits->maxPerStageDescriptorSampledImages    = MaxDescriptors;
+      pLimits->maxPerStageDescriptorStorageImages    = MaxDescriptors;
+      pLimits->maxPerStageDescriptorInputAttachments = MaxDescriptors;
+      pLimits->maxPerStageResources                  = MaxDescriptors;
+      pLimits->maxDescriptorSetSamplers              = MaxDescriptors;
+      pLimits->maxDescriptorSetUniformBuffers        = MaxDescriptors;
+      pLimits->maxDescriptorSetUniformBuffersDynamic = 16u;
+      pLimits->maxDescriptorSetStorageBuffers        = MaxDescriptors;
+      pLimits->maxDescriptorSetStorageBuffersDynamic = 8u;
+      pLimits->maxDescriptorSetSampledImages         = MaxDescriptors;
+      pLimits->maxDescriptorSetStorageImages         = MaxDescriptors;
+      pLimits->maxDescriptorSetInputAttachments      = MaxDescriptors;
+      pLimits->maxVertexInputAttributes              = 32u;
+      pLimits->maxVertexInputBindings                = 32u;
+      pLimits->maxVertexInputAttributeOffset         = 2047u;
+      pLimits->maxVertexInputBindingStride           = 2048u;
+      pLimits->maxVertexOutputComponents             = 128u;
+      pLimits->maxTessellationGenerationLevel        = 64u;
+      pLimits->maxTessellationPatchSize              = 32u;
+      pLimits->maxTessellationControlPerVertexInputComponents = 128u;
+      pLimits->maxTessellationControlPerVertexOutputComponents = 128u;
+      pLimits->maxTessellationControlPerPatchOutputComponents = 120u;
+      pLimits->maxTessellationControlTotalOutputComponents = 4096u;
+      pLimits->maxTessellationEvaluationInputComponents = 128u;
+      pLimits->maxTessellationEvaluationOutputComponents = 128u;
+      pLimits->maxGeometryShaderInvocations          = 32u;
+      pLimits->maxGeometryInputComponents            = 128u;
+      pLimits->maxGeometryOutputComponents           = 128u;
+      pLimits->maxGeometryOutputVertices             = 256u;
+      pLimits->maxGeometryTotalOutputComponents      = 1024u;
+      pLimits->maxFragmentInputComponents            = 128u;
+      pLimits->maxFragmentOutputAttachments          = 8u;
+      pLimits->maxFragmentDualSrcAttachments         = 1u;
+      pLimits->maxFragmentCombinedOutputResources    = MaxDescriptors;
+      pLimits->maxComputeSharedMemorySize            = 65536u;
+      pLimits->maxComputeWorkGroupCount[0]           = 65535u;
+      pLimits->maxComputeWorkGroupCount[1]           = 65535u;
+      pLimits->maxComputeWorkGroupCount[2]           = 65535u;
+      pLimits->maxComputeWorkGroupInvocations        = 1024u;
+      pLimits->maxComputeWorkGroupSize[0]            = 1024u;
+      pLimits->maxComputeWorkGroupSize[1]            = 1024u;
+      pLimits->maxComputeWorkGroupSize[2]            = 64u;
+      pLimits->subPixelPrecisionBits                 = 8u;
+      pLimits->subTexelPrecisionBits                 = 8u;
+      pLimits->mipmapPrecisionBits                   = 8u;
+      pLimits->maxDrawIndexedIndexValue              = ~0u;
+      pLimits->maxDrawIndirectCount                  = ~0u;
+      pLimits->maxSamplerLodBias                     = 16.0f;
+      pLimits->maxSamplerAnisotropy                  = 16.0f;
+      pLimits->maxViewports                          = 16u;
+      pLimits->maxViewportDimensions[0]              = 16384u;
+      pLimits->maxViewportDimensions[1]              = 16384u;
+      pLimits->viewportBoundsRange[0]                = -32768.0f;
+      pLimits->viewportBoundsRange[1]                = 32767.0f;
+      pLimits->viewportSubPixelBits                  = 8u;
+      pLimits->minMemoryMapAlignment                 = size_t(MemoryMapAlignment);
+      pLimits->minTexelBufferOffsetAlignment         = 16u;
+      pLimits->minUniformBufferOffsetAlignment       = 64u;
+      pLimits->minStorageBufferOffsetAlignment       = 16u;
+      pLimits->minTexelOffset                        = -8;
+      pLimits->maxTexelOffset                        = 7u;
+      pLimits->minTexelGatherOffset                  = -32;
+      pLimits->maxTexelGatherOffset                  = 31u;
+      pLimits->minInterpolationOffset                = -0.5f;
+      pLimits->maxInterpolationOffset                = 0.4375f;
+      pLimits->subPixelInterpolationOffsetBits       = 4u;
+      pLimits->maxFramebufferWidth                   = 16384u;
+      pLimits->maxFramebufferHeight                  = 16384u;
+      pLimits->maxFramebufferLayers                  = 2048u;
+      pLimits->framebufferColorSampleCounts          = SampleCounts;
+      pLimits->framebufferDepthSampleCounts          = SampleCounts;
+      pLimits->framebufferStencilSampleCounts        = SampleCounts;
+      pLimits->framebufferNoAttachmentsSampleCounts  = SampleCounts;
+      pLimits->maxColorAttachments                   = 8u;
+      pLimits->sampledImageColorSampleCounts         = SampleCounts;
+      pLimits->sampledImageIntegerSampleCounts       = SampleCounts;
+      pLimits->sampledImageDepthSampleCounts         = SampleCounts;
+      pLimits->sampledImageStencilSampleCounts       = SampleCounts;
+      pLimits->storageImageSampleCounts              = VK_SAMPLE_COUNT_1_BIT;
+      pLimits->maxSampleMaskWords                    = 1u;
+      pLimits->timestampComputeAndGraphics           = VK_TRUE;
+      pLimits->timestampPeriod                       = 1.0f;
+      pLimits->maxClipDistances                      = 8u;
+      pLimits->maxCullDistances                      = 8u;
+      pLimits->maxCombinedClipAndCullDistances       = 8u;
+      pLimits->discreteQueuePriorities               = 2u;
+      pLimits->pointSizeRange[0]                     = 1.0f;
+      pLimits->pointSizeRange[1]                     = 2048.0f;
+      pLimits->lineWidthRange[0]                     = 1.0f;
+      pLimits->lineWidthRange[1]                     = 8.0f;
+      pLimits->pointSizeGranularity                  = 0.125f;
+      pLimits->lineWidthGranularity                  = 0.125f;
+      pLimits->standardSampleLocations               = VK_TRUE;
+      pLimits->optimalBufferCopyOffsetAlignment      = 1u;
+      pLimits->optimalBufferCopyRowPitchAlignment    = 1u;
+      pLimits->nonCoherentAtomSize                   = 64u;
+    }
+
+
+    /**
+     * \brief Enables all features in a feature struct
+     *
+     * Only valid for structures that consist of the
+     * structure header followed by \c VkBool32 members.
+     */
+    template<typename T>
+    void enableAllFeatures(T* pFeatures) {
+      constexpr size_t HeaderSize = sizeof(VkBaseOutStructure);
+
+      auto bools = reinterpret_cast<VkBool32*>(reinterpret_cast<char*>(pFeatures) + HeaderSize);
+
+      for (size_t i = 0; i < (sizeof(T) - HeaderSize) / sizeof(VkBool32); i++)
+        bools[i] = VK_TRUE;
+    }
+
+
+    static const std::array<VkExtensionProperties, 2> s_instanceExtensions = {{
+      { VK_KHR_SURFACE_EXTENSION_NAME,                VK_KHR_SURFACE_SPEC_VERSION               },
+      { VK_KHR_WIN32_SURFACE_EXTENSION_NAME,          VK_KHR_WIN32_SURFACE_SPEC_VERSION         },
+    }};
+
+    static const std::array<VkExtensionProperties, 7> s_deviceExtensions = {{
+      { VK_EXT_DEPTH_CLIP_ENABLE_EXTENSION_NAME,      VK_EXT_DEPTH_CLIP_ENABLE_SPEC_VERSION     },
+      { VK_EXT_ROBUSTNESS_2_EXTENSION_NAME,           VK_EXT_ROBUSTNESS_2_SPEC_VERSION          },
+      { VK_KHR_LOAD_STORE_OP_NONE_EXTENSION_NAME,     VK_KHR_LOAD_STORE_OP_NONE_SPEC_VERSION    },
+      { VK_KHR_MAINTENANCE_5_EXTENSION_NAME,          VK_KHR_MAINTENANCE_5_SPEC_VERSION         },
+      { VK_KHR_MAINTENANCE_6_EXTENSION_NAME,          VK_KHR_MAINTENANCE_6_SPEC_VERSION         },
+      { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,       VK_KHR_PIPELINE_LIBRARY_SPEC_VERSION      },
+      { VK_KHR_SWAPCHAIN_EXTENSION_NAME,              VK_KHR_SWAPCHAIN_SPEC_VERSION             },
+    }};
+
+
+    struct NullDevice {
+      VkQueue queue = VK_NULL_HANDLE;
+    };
+
+    struct NullMemory {
+      VkDeviceSize  size  = 0u;
+      void*         base  = nullptr;
+      void*         data  = nullptr;
+    };
+
+    struct NullBuffer {
+      VkDeviceSize    size    = 0u;
+      VkDeviceAddress address = 0u;
+    };
+
+    struct NullImage {
+      VkImageCreateInfo info = { };
+    };
+
+    struct NullFence {
+      std::atomic<bool> signaled = { false };
+    };
+
+    struct NullSemaphore {
+      dxvk::mutex               mutex;
+      dxvk::condition_variable  cond;
+      uint64_t                  value = 0u;
+    };
+
+    struct NullEvent {
+      std::atomic<bool> signaled = { false };
+    };
+
+    struct NullQueryPool {
+      VkQueryType type        = VK_QUERY_TYPE_OCCLUSION;
+      uint32_t    valueCount  = 1u;
+    };
+
+    struct NullSwapchain {
+      std::vector<VkImage>  images;
+      uint32_t              nextImage = 0u;
+    };
+
+
+    static void signalFence(VkFence fence) {
+      if (fence)
+        fromHandle<NullFence>(fence)->signaled.store(true, std::memory_order_release);
+    }
+
+
+    static void signalSemaphore(VkSemaphore semaphore, uint64_t value) {
+      if (!semaphore)
+        return;
+
+      auto object = fromHandle<NullSemaphore>(semaphore);
+
+      std::lock_guard lock(object->mutex);
+      object->value = std::max(object->value, value);
+      object->cond.notify_all();
+    }
+
+
+    static uint64_t getSemaphoreValue(VkSemaphore semaphore) {
+      auto object = fromHandle<NullSemaphore>(semaphore);
+
+      std::lock_guard lock(object->mutex);
+      return object->value;
+    }
+
+
+    static VkResult waitSemaphore(VkSemaphore semaphore, uint64_t value, dxvk::high_resolution_clock::time_point deadline) {
+      auto object = fromHandle<NullSemaphore>(semaphore);
+
+      std::unique_lock lock(object->mutex);
+
+      if (deadline == dxvk::high_resolution_clock::time_point::max()) {
+        object->cond.wait(lock, [object, value] { return object->value >= value; });
+        return VK_SUCCESS;
+      }
+
+      while (object->value < value) {
+        auto now = dxvk::high_resolution_clock::now();
+
+        if (now >= deadline)
+          return VK_TIMEOUT;
+
+        object->cond.wait_for(lock, deadline - now);
+      }
+
+      return VK_SUCCESS;
+    }
+
+
+    ///////////////////////////////////////////
+    // Instance and physical device functions
+
+    VkResult VKAPI_CALL vkEnumerateInstanceVersion(
+            uint32_t*                       pApiVersion) {
+      *pApiVersion = VK_API_VERSION_1_3;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(
+            uint32_t*                       pPropertyCount,
+            VkLayerProperties*              pProperties) {
+      *pPropertyCount = 0u;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(
+      const char*                           pLayerName,
+            uint32_t*                       pPropertyCount,
+            VkExtensionProperties*          pProperties) {
+      if (pLayerName)
+        return VK_ERROR_LAYER_NOT_PRESENT;
+
+      return enumerate(pPropertyCount, pProperties,
+        s_instanceExtensions.data(), s_instanceExtensions.size());
+    }
+
+
+    VkResult VKAPI_CALL vkCreateInstance(
+      const VkInstanceCreateInfo*           pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkInstance*                     pInstance) {
+      *pInstance = allocHandle<VkInstance>();
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
+            VkInstance                      instance,
+            uint32_t*                       pPhysicalDeviceCount,
+            VkPhysicalDevice*               pPhysicalDevices) {
+      VkPhysicalDevice adapter = toHandle<VkPhysicalDevice>(&g_physicalDeviceTag);
+      return enumerate(pPhysicalDeviceCount, pPhysicalDevices, &adapter, 1u);
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(
+            VkPhysicalDevice                physicalDevice,
+      const char*                           pLayerName,
+            uint32_t*                       pPropertyCount,
+            VkExtensionProperties*          pProperties) {
+      if (pLayerName)
+        return VK_ERROR_LAYER_NOT_PRESENT;
+
+      return enumerate(pPropertyCount, pProperties,
+        s_deviceExtensions.data(), s_deviceExtensions.size());
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFeatures(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceFeatures*       pFeatures) {
+      auto bools = reinterpret_cast<VkBool32*>(pFeatures);
+
+      for (size_t i = 0; i < sizeof(*pFeatures) / sizeof(VkBool32); i++)
+        bools[i] = VK_TRUE;
+
+      // Sparse binding would require an actual implementation
+      pFeatures->sparseBinding = VK_FALSE;
+      pFeatures->sparseResidencyBuffer = VK_FALSE;
+      pFeatures->sparseResidencyImage2D = VK_FALSE;
+      pFeatures->sparseResidencyImage3D = VK_FALSE;
+      pFeatures->sparseResidency2Samples = VK_FALSE;
+      pFeatures->sparseResidency4Samples = VK_FALSE;
+      pFeatures->sparseResidency8Samples = VK_FALSE;
+      pFeatures->sparseResidency16Samples = VK_FALSE;
+      pFeatures->sparseResidencyAliased = VK_FALSE;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFeatures2(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceFeatures2*      pFeatures) {
+      vkGetPhysicalDeviceFeatures(physicalDevice, &pFeatures->features);
+
+      for (auto s = reinterpret_cast<VkBaseOutStructure*>(pFeatures->pNext); s; s = s->pNext) {
+        switch (s->sType) {
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES: {
+            auto features = reinterpret_cast<VkPhysicalDeviceVulkan11Features*>(s);
+            enableAllFeatures(features);
+            features->protectedMemory = VK_FALSE;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceVulkan12Features*>(s));
+            break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceVulkan13Features*>(s));
+            break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_CLIP_ENABLE_FEATURES_EXT:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceDepthClipEnableFeaturesEXT*>(s));
+            break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceRobustness2FeaturesEXT*>(s));
+            break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceMaintenance5FeaturesKHR*>(s));
+            break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_6_FEATURES_KHR:
+            enableAllFeatures(reinterpret_cast<VkPhysicalDeviceMaintenance6FeaturesKHR*>(s));
+            break;
+
+          default:
+            break;
+        }
+      }
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceProperties(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceProperties*     pProperties) {
+      *pProperties = { };
+      pProperties->apiVersion = VK_API_VERSION_1_3;
+      pProperties->driverVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
+      pProperties->vendorID = VK_VENDOR_ID_MESA;
+      pProperties->deviceType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+
+      std::strncpy(pProperties->deviceName, "DXVK Null Device",
+        sizeof(pProperties->deviceName) - 1u);
+
+      getLimits(&pProperties->limits);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceProperties2(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceProperties2*    pProperties) {
+      constexpr uint32_t MaxDescriptors = 1u << 20u;
+
+      vkGetPhysicalDeviceProperties(physicalDevice, &pProperties->properties);
+
+      for (auto s = reinterpret_cast<VkBaseOutStructure*>(pProperties->pNext); s; s = s->pNext) {
+        switch (s->sType) {
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES: {
+            auto props = reinterpret_cast<VkPhysicalDeviceVulkan11Properties*>(s);
+            props->deviceUUID[0u] = 0xd8u;
+            props->driverUUID[0u] = 0xd8u;
+            props->deviceLUIDValid = VK_FALSE;
+            props->subgroupSize = 32u;
+            props->subgroupSupportedStages = VK_SHADER_STAGE_ALL;
+            props->subgroupSupportedOperations = VK_SUBGROUP_FEATURE_BASIC_BIT
+              | VK_SUBGROUP_FEATURE_VOTE_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT
+              | VK_SUBGROUP_FEATURE_BALLOT_BIT | VK_SUBGROUP_FEATURE_SHUFFLE_BIT
+              | VK_SUBGROUP_FEATURE_SHUFFLE_RELATIVE_BIT | VK_SUBGROUP_FEATURE_CLUSTERED_BIT
+              | VK_SUBGROUP_FEATURE_QUAD_BIT;
+            props->subgroupQuadOperationsInAllStages = VK_TRUE;
+            props->pointClippingBehavior = VK_POINT_CLIPPING_BEHAVIOR_ALL_CLIP_PLANES;
+            props->maxMultiviewViewCount = 8u;
+            props->maxMultiviewInstanceIndex = 1u << 27u;
+            props->maxPerSetDescriptors = MaxDescriptors;
+            props->maxMemoryAllocationSize = 4ull << 30u;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES: {
+            auto props = reinterpret_cast<VkPhysicalDeviceVulkan12Properties*>(s);
+            std::strncpy(props->driverName, "DXVK Null Driver", sizeof(props->driverName) - 1u);
+            props->conformanceVersion = { 1u, 3u, 0u, 0u };
+            props->denormBehaviorIndependence = VK_SHADER_FLOAT_CONTROLS_INDEPENDENCE_ALL;
+            props->roundingModeIndependence = VK_SHADER_FLOAT_CONTROLS_INDEPENDENCE_ALL;
+            props->shaderSignedZeroInfNanPreserveFloat16 = VK_TRUE;
+            props->shaderSignedZeroInfNanPreserveFloat32 = VK_TRUE;
+            props->shaderSignedZeroInfNanPreserveFloat64 = VK_TRUE;
+            props->shaderDenormPreserveFloat16 = VK_TRUE;
+            props->shaderDenormPreserveFloat32 = VK_TRUE;
+            props->shaderDenormPreserveFloat64 = VK_TRUE;
+            props->shaderDenormFlushToZeroFloat16 = VK_TRUE;
+            props->shaderDenormFlushToZeroFloat32 = VK_TRUE;
+            props->shaderDenormFlushToZeroFloat64 = VK_TRUE;
+            props->shaderRoundingModeRTEFloat16 = VK_TRUE;
+            props->shaderRoundingModeRTEFloat32 = VK_TRUE;
+            props->shaderRoundingModeRTEFloat64 = VK_TRUE;
+            props->shaderRoundingModeRTZFloat16 = VK_TRUE;
+            props->shaderRoundingModeRTZFloat32 = VK_TRUE;
+            props->shaderRoundingModeRTZFloat64 = VK_TRUE;
+            props->maxUpdateAfterBindDescriptorsInAllPools = MaxDescriptors;
+            props->shaderUniformBufferArrayNonUniformIndexingNative = VK_TRUE;
+            props->shaderSampledImageArrayNonUniformIndexingNative = VK_TRUE;
+            props->shaderStorageBufferArrayNonUniformIndexingNative = VK_TRUE;
+            props->shaderStorageImageArrayNonUniformIndexingNative = VK_TRUE;
+            props->shaderInputAttachmentArrayNonUniformIndexingNative = VK_TRUE;
+            props->robustBufferAccessUpdateAfterBind = VK_TRUE;
+            props->maxPerStageDescriptorUpdateAfterBindSamplers = MaxDescriptors;
+            props->maxPerStageDescriptorUpdateAfterBindUniformBuffers = MaxDescriptors;
+            props->maxPerStageDescriptorUpdateAfterBindStorageBuffers = MaxDescriptors;
+            props->maxPerStageDescriptorUpdateAfterBindSampledImages = MaxDescriptors;
+            props->maxPerStageDescriptorUpdateAfterBindStorageImages = MaxDescriptors;
+            props->maxPerStageDescriptorUpdateAfterBindInputAttachments = MaxDescriptors;
+            props->maxPerStageUpdateAfterBindResources = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindSamplers = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindUniformBuffers = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindUniformBuffersDynamic = 16u;
+            props->maxDescriptorSetUpdateAfterBindStorageBuffers = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindStorageBuffersDynamic = 8u;
+            props->maxDescriptorSetUpdateAfterBindSampledImages = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindStorageImages = MaxDescriptors;
+            props->maxDescriptorSetUpdateAfterBindInputAttachments = MaxDescriptors;
+            props->supportedDepthResolveModes = VK_RESOLVE_MODE_SAMPLE_ZERO_BIT
+              | VK_RESOLVE_MODE_AVERAGE_BIT | VK_RESOLVE_MODE_MIN_BIT | VK_RESOLVE_MODE_MAX_BIT;
+            props->supportedStencilResolveModes = VK_RESOLVE_MODE_SAMPLE_ZERO_BIT
+              | VK_RESOLVE_MODE_MIN_BIT | VK_RESOLVE_MODE_MAX_BIT;
+            props->independentResolveNone = VK_TRUE;
+            props->independentResolve = VK_TRUE;
+            props->filterMinmaxSingleComponentFormats = VK_TRUE;
+            props->filterMinmaxImageComponentMapping = VK_TRUE;
+            props->maxTimelineSemaphoreValueDifference = ~0ull;
+            props->framebufferIntegerColorSampleCounts = VK_SAMPLE_COUNT_1_BIT
+              | VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES: {
+            auto props = reinterpret_cast<VkPhysicalDeviceVulkan13Properties*>(s);
+            props->minSubgroupSize = 32u;
+            props->maxSubgroupSize = 32u;
+            props->maxComputeWorkgroupSubgroups = 32u;
+            props->requiredSubgroupSizeStages = VK_SHADER_STAGE_COMPUTE_BIT;
+            props->maxInlineUniformBlockSize = 256u;
+            props->maxPerStageDescriptorInlineUniformBlocks = 32u;
+            props->maxPerStageDescriptorUpdateAfterBindInlineUniformBlocks = 32u;
+            props->maxDescriptorSetInlineUniformBlocks = 32u;
+            props->maxDescriptorSetUpdateAfterBindInlineUniformBlocks = 32u;
+            props->maxInlineUniformTotalSize = 65536u;
+            props->storageTexelBufferOffsetAlignmentBytes = 16u;
+            props->storageTexelBufferOffsetSingleTexelAlignment = VK_TRUE;
+            props->uniformTexelBufferOffsetAlignmentBytes = 16u;
+            props->uniformTexelBufferOffsetSingleTexelAlignment = VK_TRUE;
+            props->maxBufferSize = 4ull << 30u;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_PROPERTIES_EXT: {
+            auto props = reinterpret_cast<VkPhysicalDeviceRobustness2PropertiesEXT*>(s);
+            props->robustStorageBufferAccessSizeAlignment = 4u;
+            props->robustUniformBufferAccessSizeAlignment = 16u;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_PROPERTIES_KHR: {
+            auto props = reinterpret_cast<VkPhysicalDeviceMaintenance5PropertiesKHR*>(s);
+            props->earlyFragmentMultisampleCoverageAfterSampleCounting = VK_TRUE;
+            props->earlyFragmentSampleMaskTestBeforeSampleCounting = VK_TRUE;
+            props->depthStencilSwizzleOneSupport = VK_TRUE;
+            props->polygonModePointSize = VK_TRUE;
+            props->nonStrictSinglePixelWideLinesUseParallelogram = VK_FALSE;
+            props->nonStrictWideLinesUseParallelogram = VK_FALSE;
+          } break;
+
+          case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_6_PROPERTIES_KHR: {
+            auto props = reinterpret_cast<VkPhysicalDeviceMaintenance6PropertiesKHR*>(s);
+            props->blockTexelViewCompatibleMultipleLayers = VK_TRUE;
+            props->maxCombinedImageSamplerDescriptorCount = 3u;
+            props->fragmentShadingRateClampCombinerInputs = VK_FALSE;
+          } break;
+
+          default:
+            break;
+        }
+      }
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFormatProperties(
+            VkPhysicalDevice                physicalDevice,
+            VkFormat                        format,
+            VkFormatProperties*             pFormatProperties) {
+      pFormatProperties->linearTilingFeatures = VkFormatFeatureFlags(getFormatFeatures(format, VK_IMAGE_TILING_LINEAR));
+      pFormatProperties->optimalTilingFeatures = VkFormatFeatureFlags(getFormatFeatures(format, VK_IMAGE_TILING_OPTIMAL));
+      pFormatProperties->bufferFeatures = VkFormatFeatureFlags(getBufferFeatures(format));
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFormatProperties2(
+            VkPhysicalDevice                physicalDevice,
+            VkFormat                        format,
+            VkFormatProperties2*            pFormatProperties) {
+      vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &pFormatProperties->formatProperties);
+
+      for (auto s = reinterpret_cast<VkBaseOutStructure*>(pFormatProperties->pNext); s; s = s->pNext) {
+        if (s->sType == VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3) {
+          auto props = reinterpret_cast<VkFormatProperties3*>(s);
+          props->linearTilingFeatures = getFormatFeatures(format, VK_IMAGE_TILING_LINEAR);
+          props->optimalTilingFeatures = getFormatFeatures(format, VK_IMAGE_TILING_OPTIMAL);
+          props->bufferFeatures = getBufferFeatures(format);
+        }
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties(
+            VkPhysicalDevice                physicalDevice,
+            VkFormat                        format,
+            VkImageType                     type,
+            VkImageTiling                   tiling,
+            VkImageUsageFlags               usage,
+            VkImageCreateFlags              flags,
+            VkImageFormatProperties*        pImageFormatProperties) {
+      return getImageFormatProperties(format, type, tiling, usage, flags, pImageFormatProperties);
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties2(
+            VkPhysicalDevice                physicalDevice,
+      const VkPhysicalDeviceImageFormatInfo2* pImageFormatInfo,
+            VkImageFormatProperties2*       pImageFormatProperties) {
+      return getImageFormatProperties(pImageFormatInfo->format, pImageFormatInfo->type,
+        pImageFormatInfo->tiling, pImageFormatInfo->usage, pImageFormatInfo->flags,
+        &pImageFormatProperties->imageFormatProperties);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceMemoryProperties* pMemoryProperties) {
+      getMemoryProperties(pMemoryProperties);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2(
+            VkPhysicalDevice                physicalDevice,
+            VkPhysicalDeviceMemoryProperties2* pMemoryProperties) {
+      getMemoryProperties(&pMemoryProperties->memoryProperties);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(
+            VkPhysicalDevice                physicalDevice,
+            uint32_t*                       pQueueFamilyPropertyCount,
+            VkQueueFamilyProperties*        pQueueFamilyProperties) {
+      VkQueueFamilyProperties properties;
+      getQueueFamilyProperties(&properties);
+
+      enumerate(pQueueFamilyPropertyCount, pQueueFamilyProperties, &properties, 1u);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties2(
+            VkPhysicalDevice                physicalDevice,
+            uint32_t*                       pQueueFamilyPropertyCount,
+            VkQueueFamilyProperties2*       pQueueFamilyProperties) {
+      if (!pQueueFamilyProperties) {
+        *pQueueFamilyPropertyCount = 1u;
+        return;
+      }
+
+      if (*pQueueFamilyPropertyCount)
+        getQueueFamilyProperties(&pQueueFamilyProperties[0u].queueFamilyProperties);
+
+      *pQueueFamilyPropertyCount = std::min(*pQueueFamilyPropertyCount, 1u);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceSparseImageFormatProperties(
+            VkPhysicalDevice                physicalDevice,
+            VkFormat                        format,
+            VkImageType                     type,
+            VkSampleCountFlagBits           samples,
+            VkImageUsageFlags               usage,
+            VkImageTiling                   tiling,
+            uint32_t*                       pPropertyCount,
+            VkSparseImageFormatProperties*  pProperties) {
+      *pPropertyCount = 0u;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceSparseImageFormatProperties2(
+            VkPhysicalDevice                physicalDevice,
+      const VkPhysicalDeviceSparseImageFormatInfo2* pFormatInfo,
+            uint32_t*                       pPropertyCount,
+            VkSparseImageFormatProperties2* pProperties) {
+      *pPropertyCount = 0u;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceExternalSemaphoreProperties(
+            VkPhysicalDevice                physicalDevice,
+      const VkPhysicalDeviceExternalSemaphoreInfo* pExternalSemaphoreInfo,
+            VkExternalSemaphoreProperties*  pExternalSemaphoreProperties) {
+      pExternalSemaphoreProperties->exportFromImportedHandleTypes = 0u;
+      pExternalSemaphoreProperties->compatibleHandleTypes = 0u;
+      pExternalSemaphoreProperties->externalSemaphoreFeatures = 0u;
+    }
+
+
+    ///////////////////////////////////////////
+    // Surface functions
+
+    VkResult VKAPI_CALL vkCreateWin32SurfaceKHR(
+            VkInstance                      instance,
+      const VkWin32SurfaceCreateInfoKHR*    pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkSurfaceKHR*                   pSurface) {
+      *pSurface = allocHandle<VkSurfaceKHR>();
+      return VK_SUCCESS;
+    }
+
+
+    VkBool32 VKAPI_CALL vkGetPhysicalDeviceWin32PresentationSupportKHR(
+            VkPhysicalDevice                physicalDevice,
+            uint32_t                        queueFamilyIndex) {
+      return VK_TRUE;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(
+            VkPhysicalDevice                physicalDevice,
+            uint32_t                        queueFamilyIndex,
+            VkSurfaceKHR                    surface,
+            VkBool32*                       pSupported) {
+      *pSupported = VK_TRUE;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+            VkPhysicalDevice                physicalDevice,
+            VkSurfaceKHR                    surface,
+            VkSurfaceCapabilitiesKHR*       pSurfaceCapabilities) {
+      *pSurfaceCapabilities = { };
+      pSurfaceCapabilities->minImageCount = 2u;
+      pSurfaceCapabilities->maxImageCount = 8u;
+      pSurfaceCapabilities->currentExtent = { ~0u, ~0u };
+      pSurfaceCapabilities->minImageExtent = { 1u, 1u };
+      pSurfaceCapabilities->maxImageExtent = { 16384u, 16384u };
+      pSurfaceCapabilities->maxImageArrayLayers = 1u;
+      pSurfaceCapabilities->supportedTransforms = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+      pSurfaceCapabilities->currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+      pSurfaceCapabilities->supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+      pSurfaceCapabilities->supportedUsageFlags = VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+        | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+        | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR(
+            VkPhysicalDevice                physicalDevice,
+            VkSurfaceKHR                    surface,
+            uint32_t*                       pSurfaceFormatCount,
+            VkSurfaceFormatKHR*             pSurfaceFormats) {
+      static const std::array<VkSurfaceFormatKHR, 5> s_formats = {{
+        { VK_FORMAT_B8G8R8A8_UNORM,           VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_B8G8R8A8_SRGB,            VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_R8G8B8A8_UNORM,           VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_R8G8B8A8_SRGB,            VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+      }};
+
+      return enumerate(pSurfaceFormatCount, pSurfaceFormats, s_formats.data(), s_formats.size());
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(
+            VkPhysicalDevice                physicalDevice,
+            VkSurfaceKHR                    surface,
+            uint32_t*                       pPresentModeCount,
+            VkPresentModeKHR*               pPresentModes) {
+      static const std::array<VkPresentModeKHR, 3> s_presentModes = {{
+        VK_PRESENT_MODE_FIFO_KHR,
+        VK_PRESENT_MODE_IMMEDIATE_KHR,
+        VK_PRESENT_MODE_MAILBOX_KHR,
+      }};
+
+      return enumerate(pPresentModeCount, pPresentModes, s_presentModes.data(), s_presentModes.size());
+    }
+
+
+    ///////////////////////////////////////////
+    // Device and queue functions
+
+    VkResult VKAPI_CALL vkCreateDevice(
+            VkPhysicalDevice                physicalDevice,
+      const VkDeviceCreateInfo*             pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkDevice*                       pDevice) {
+      auto device = new NullDevice();
+      device->queue = allocHandle<VkQueue>();
+
+      *pDevice = toHandle<VkDevice>(device);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyDevice(
+            VkDevice                        device,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullDevice>(device);
+    }
+
+
+    void VKAPI_CALL vkGetDeviceQueue(
+            VkDevice                        device,
+            uint32_t                        queueFamilyIndex,
+            uint32_t                        queueIndex,
+            VkQueue*                        pQueue) {
+      *pQueue = fromHandle<NullDevice>(device)->queue;
+    }
+
+
+    VkResult VKAPI_CALL vkQueueSubmit(
+            VkQueue                         queue,
+            uint32_t                        submitCount,
+      const VkSubmitInfo*                   pSubmits,
+            VkFence                         fence) {
+      for (uint32_t i = 0; i < submitCount; i++) {
+        auto timeline = findStruct<VkTimelineSemaphoreSubmitInfo>(
+          pSubmits[i].pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO);
+
+        for (uint32_t j = 0; j < pSubmits[i].signalSemaphoreCount; j++) {
+          uint64_t value = timeline && j < timeline->signalSemaphoreValueCount
+            ? timeline->pSignalSemaphoreValues[j] : 0u;
+
+          signalSemaphore(pSubmits[i].pSignalSemaphores[j], value);
+        }
+      }
+
+      signalFence(fence);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkQueueSubmit2(
+            VkQueue                         queue,
+            uint32_t                        submitCount,
+      const VkSubmitInfo2*                  pSubmits,
+            VkFence                         fence) {
+      for (uint32_t i = 0; i < submitCount; i++) {
+        for (uint32_t j = 0; j < pSubmits[i].signalSemaphoreInfoCount; j++) {
+          const auto& info = pSubmits[i].pSignalSemaphoreInfos[j];
+          signalSemaphore(info.semaphore, info.value);
+        }
+      }
+
+      signalFence(fence);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkQueueBindSparse(
+            VkQueue                         queue,
+            uint32_t                        bindInfoCount,
+      const VkBindSparseInfo*               pBindInfo,
+            VkFence                         fence) {
+      for (uint32_t i = 0; i < bindInfoCount; i++) {
+        auto timeline = findStruct<VkTimelineSemaphoreSubmitInfo>(
+          pBindInfo[i].pNext, VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO);
+
+        for (uint32_t j = 0; j < pBindInfo[i].signalSemaphoreCount; j++) {
+          uint64_t value = timeline && j < timeline->signalSemaphoreValueCount
+            ? timeline->pSignalSemaphoreValues[j] : 0u;
+
+          signalSemaphore(pBindInfo[i].pSignalSemaphores[j], value);
+        }
+      }
+
+      signalFence(fence);
+      return VK_SUCCESS;
+    }
+
+
+    ///////////////////////////////////////////
+    // Memory functions
+
+    VkResult VKAPI_CALL vkAllocateMemory(
+            VkDevice                        device,
+      const VkMemoryAllocateInfo*           pAllocateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkDeviceMemory*                 pMemory) {
+      VkPhysicalDeviceMemoryProperties properties;
+      getMemoryProperties(&properties);
+
+      if (pAllocateInfo->memoryTypeIndex >= properties.memoryTypeCount)
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+      auto memory = new NullMemory();
+      memory->size = pAllocateInfo->allocationSize;
+
+      // Only host-visible memory needs to be backed by actual
+      // memory, since the application may write to it.
+      VkMemoryPropertyFlags flags = properties.memoryTypes[pAllocateInfo->memoryTypeIndex].propertyFlags;
+
+      if (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        VkDeviceSize size = pAllocateInfo->allocationSize + MemoryMapAlignment;
+
+        if (size > VkDeviceSize(std::numeric_limits<size_t>::max())
+         || !(memory->base = std::malloc(size_t(size)))) {
+          delete memory;
+          return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+
+        memory->data = reinterpret_cast<void*>(align(
+          reinterpret_cast<uintptr_t>(memory->base), uintptr_t(MemoryMapAlignment)));
+      }
+
+      *pMemory = toHandle<VkDeviceMemory>(memory);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkFreeMemory(
+            VkDevice                        device,
+            VkDeviceMemory                  memory,
+      const VkAllocationCallbacks*          pAllocator) {
+      auto object = fromHandle<NullMemory>(memory);
+
+      if (object) {
+        std::free(object->base);
+        delete object;
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkMapMemory(
+            VkDevice                        device,
+            VkDeviceMemory                  memory,
+            VkDeviceSize                    offset,
+            VkDeviceSize                    size,
+            VkMemoryMapFlags                flags,
+            void**                          ppData) {
+      auto object = fromHandle<NullMemory>(memory);
+
+      if (!object->data)
+        return VK_ERROR_MEMORY_MAP_FAILED;
+
+      *ppData = reinterpret_cast<char*>(object->data) + offset;
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkGetDeviceMemoryCommitment(
+            VkDevice                        device,
+            VkDeviceMemory                  memory,
+            VkDeviceSize*                   pCommittedMemoryInBytes) {
+      *pCommittedMemoryInBytes = fromHandle<NullMemory>(memory)->size;
+    }
+
+
+    static void getBufferMemoryRequirements(VkDeviceSize size, VkMemoryRequirements* pRequirements) {
+      pRequirements->size = align(size, VkDeviceSize(256u));
+      pRequirements->alignment = 256u;
+      pRequirements->memoryTypeBits = MemoryTypeMask;
+    }
+
+
+    static void getImageMemoryRequirements(const VkImageCreateInfo& info, VkMemoryRequirements* pRequirements) {
+      pRequirements->alignment = info.tiling == VK_IMAGE_TILING_OPTIMAL ? 4096u : 256u;
+      pRequirements->size = align(computeImageLayout(info, nullptr, nullptr), pRequirements->alignment);
+      pRequirements->memoryTypeBits = MemoryTypeMask;
+    }
+
+
+    static void getDedicatedRequirements(void* pNext) {
+      for (auto s = reinterpret_cast<VkBaseOutStructure*>(pNext); s; s = s->pNext) {
+        if (s->sType == VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS) {
+          auto dedicated = reinterpret_cast<VkMemoryDedicatedRequirements*>(s);
+          dedicated->prefersDedicatedAllocation = VK_FALSE;
+          dedicated->requiresDedicatedAllocation = VK_FALSE;
+        }
+      }
+    }
+
+
+    void VKAPI_CALL vkGetBufferMemoryRequirements(
+            VkDevice                        device,
+            VkBuffer                        buffer,
+            VkMemoryRequirements*           pMemoryRequirements) {
+      getBufferMemoryRequirements(fromHandle<NullBuffer>(buffer)->size, pMemoryRequirements);
+    }
+
+
+    void VKAPI_CALL vkGetBufferMemoryRequirements2(
+            VkDevice                        device,
+      const VkBufferMemoryRequirementsInfo2* pInfo,
+            VkMemoryRequirements2*          pMemoryRequirements) {
+      getBufferMemoryRequirements(fromHandle<NullBuffer>(pInfo->buffer)->size, &pMemoryRequirements->memoryRequirements);
+      getDedicatedRequirements(pMemoryRequirements->pNext);
+    }
+
+
+    void VKAPI_CALL vkGetDeviceBufferMemoryRequirements(
+            VkDevice                        device,
+      const VkDeviceBufferMemoryRequirements* pInfo,
+            VkMemoryRequirements2*          pMemoryRequirements) {
+      getBufferMemoryRequirements(pInfo->pCreateInfo->size, &pMemoryRequirements->memoryRequirements);
+      getDedicatedRequirements(pMemoryRequirements->pNext);
+    }
+
+
+    void VKAPI_CALL vkGetImageMemoryRequirements(
+            VkDevice                        device,
+            VkImage                         image,
+            VkMemoryRequirements*           pMemoryRequirements) {
+      getImageMemoryRequirements(fromHandle<NullImage>(image)->info, pMemoryRequirements);
+    }
+
+
+    void VKAPI_CALL vkGetImageMemoryRequirements2(
+            VkDevice                        device,
+      const VkImageMemoryRequirementsInfo2* pInfo,
+            VkMemoryRequirements2*          pMemoryRequirements) {
+      getImageMemoryRequirements(fromHandle<NullImage>(pInfo->image)->info, &pMemoryRequirements->memoryRequirements);
+      getDedicatedRequirements(pMemoryRequirements->pNext);
+    }
+
+
+    void VKAPI_CALL vkGetDeviceImageMemoryRequirements(
+            VkDevice                        device,
+      const VkDeviceImageMemoryRequirements* pInfo,
+            VkMemoryRequirements2*          pMemoryRequirements) {
+      getImageMemoryRequirements(*pInfo->pCreateInfo, &pMemoryRequirements->memoryRequirements);
+      getDedicatedRequirements(pMemoryRequirements->pNext);
+    }
+
+
+    void VKAPI_CALL vkGetImageSparseMemoryRequirements(
+            VkDevice                        device,
+            VkImage                         image,
+            uint32_t*                       pSparseMemoryRequirementCount,
+            VkSparseImageMemoryRequirements* pSparseMemoryRequirements) {
+      *pSparseMemoryRequirementCount = 0u;
+    }
+
+
+    void VKAPI_CALL vkGetImageSparseMemoryRequirements2(
+            VkDevice                        device,
+      const VkImageSparseMemoryRequirementsInfo2* pInfo,
+            uint32_t*                       pSparseMemoryRequirementCount,
+            VkSparseImageMemoryRequirements2* pSparseMemoryRequirements) {
+      *pSparseMemoryRequirementCount = 0u;
+    }
+
+
+    ///////////////////////////////////////////
+    // Synchronization functions
+
+    VkResult VKAPI_CALL vkCreateFence(
+            VkDevice                        device,
+      const VkFenceCreateInfo*              pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkFence*                        pFence) {
+      auto fence = new NullFence();
+      fence->signaled.store(pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT);
+
+      *pFence = toHandle<VkFence>(fence);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyFence(
+            VkDevice                        device,
+            VkFence                         fence,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullFence>(fence);
+    }
+
+
+    VkResult VKAPI_CALL vkResetFences(
+            VkDevice                        device,
+            uint32_t                        fenceCount,
+      const VkFence*                        pFences) {
+      for (uint32_t i = 0; i < fenceCount; i++)
+        fromHandle<NullFence>(pFences[i])->signaled.store(false, std::memory_order_release);
+
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetFenceStatus(
+            VkDevice                        device,
+            VkFence                         fence) {
+      return fromHandle<NullFence>(fence)->signaled.load(std::memory_order_acquire)
+        ? VK_SUCCESS : VK_NOT_READY;
+    }
+
+
+    VkResult VKAPI_CALL vkWaitForFences(
+            VkDevice                        device,
+            uint32_t                        fenceCount,
+      const VkFence*                        pFences,
+            VkBool32                        waitAll,
+            uint64_t                        timeout) {
+      auto deadline = getDeadline(timeout);
+
+      while (true) {
+        uint32_t signaled = 0u;
+
+        for (uint32_t i = 0; i < fenceCount; i++) {
+          if (fromHandle<NullFence>(pFences[i])->signaled.load(std::memory_order_acquire))
+            signaled += 1u;
+        }
+
+        if (waitAll ? signaled == fenceCount : signaled != 0u)
+          return VK_SUCCESS;
+
+        if (dxvk::high_resolution_clock::now() >= deadline)
+          return VK_TIMEOUT;
+
+        std::this_thread::yield();
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkCreateSemaphore(
+            VkDevice                        device,
+      const VkSemaphoreCreateInfo*          pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkSemaphore*                    pSemaphore) {
+      auto typeInfo = findStruct<VkSemaphoreTypeCreateInfo>(
+        pCreateInfo->pNext, VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO);
+
+      auto semaphore = new NullSemaphore();
+
+      if (typeInfo)
+        semaphore->value = typeInfo->initialValue;
+
+      *pSemaphore = toHandle<VkSemaphore>(semaphore);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroySemaphore(
+            VkDevice                        device,
+            VkSemaphore                     semaphore,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullSemaphore>(semaphore);
+    }
+
+
+    VkResult VKAPI_CALL vkGetSemaphoreCounterValue(
+            VkDevice                        device,
+            VkSemaphore                     semaphore,
+            uint64_t*                       pValue) {
+      *pValue = getSemaphoreValue(semaphore);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkSignalSemaphore(
+            VkDevice                        device,
+      const VkSemaphoreSignalInfo*          pSignalInfo) {
+      signalSemaphore(pSignalInfo->semaphore, pSignalInfo->value);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkWaitSemaphores(
+            VkDevice                        device,
+      const VkSemaphoreWaitInfo*            pWaitInfo,
+            uint64_t                        timeout) {
+      auto deadline = getDeadline(timeout);
+
+      if (!(pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT)) {
+        for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; i++) {
+          VkResult vr = waitSemaphore(pWaitInfo->pSemaphores[i], pWaitInfo->pValues[i], deadline);
+
+          if (vr != VK_SUCCESS)
+            return vr;
+        }
+
+        return VK_SUCCESS;
+      }
+
+      while (true) {
+        for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; i++) {
+          if (getSemaphoreValue(pWaitInfo->pSemaphores[i]) >= pWaitInfo->pValues[i])
+            return VK_SUCCESS;
+        }
+
+        if (dxvk::high_resolution_clock::now() >= deadline)
+          return VK_TIMEOUT;
+
+        std::this_thread::yield();
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkCreateEvent(
+            VkDevice                        device,
+      const VkEventCreateInfo*              pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkEvent*                        pEvent) {
+      *pEvent = toHandle<VkEvent>(new NullEvent());
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyEvent(
+            VkDevice                        device,
+            VkEvent                         event,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullEvent>(event);
+    }
+
+
+    VkResult VKAPI_CALL vkGetEventStatus(
+            VkDevice                        device,
+            VkEvent                         event) {
+      return fromHandle<NullEvent>(event)->signaled.load()
+        ? VK_EVENT_SET : VK_EVENT_RESET;
+    }
+
+
+    VkResult VKAPI_CALL vkSetEvent(
+            VkDevice                        device,
+            VkEvent                         event) {
+      fromHandle<NullEvent>(event)->signaled.store(true);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkResetEvent(
+            VkDevice                        device,
+            VkEvent                         event) {
+      fromHandle<NullEvent>(event)->signaled.store(false);
+      return VK_SUCCESS;
+    }
+
+
+    ///////////////////////////////////////////
+    // Query functions
+
+    VkResult VKAPI_CALL vkCreateQueryPool(
+            VkDevice                        device,
+      const VkQueryPoolCreateInfo*          pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkQueryPool*                    pQueryPool) {
+      auto pool = new NullQueryPool();
+      pool->type = pCreateInfo->queryType;
+
+      if (pCreateInfo->queryType == VK_QUERY_TYPE_PIPELINE_STATISTICS)
+        pool->valueCount = bit::popcnt(pCreateInfo->pipelineStatistics);
+      else if (pCreateInfo->queryType == VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT)
+        pool->valueCount = 2u;
+
+      *pQueryPool = toHandle<VkQueryPool>(pool);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyQueryPool(
+            VkDevice                        device,
+            VkQueryPool                     queryPool,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullQueryPool>(queryPool);
+    }
+
+
+    VkResult VKAPI_CALL vkGetQueryPoolResults(
+            VkDevice                        device,
+            VkQueryPool                     queryPool,
+            uint32_t                        firstQuery,
+            uint32_t                        queryCount,
+            size_t                          dataSize,
+            void*                           pData,
+            VkDeviceSize                    stride,
+            VkQueryResultFlags              flags) {
+      auto pool = fromHandle<NullQueryPool>(queryPool);
+
+      uint64_t result = 0u;
+
+      if (pool->type == VK_QUERY_TYPE_OCCLUSION)
+        result = OcclusionQuerySamples;
+      else if (pool->type == VK_QUERY_TYPE_TIMESTAMP)
+        result = getTimestamp();
+
+      bool is64Bit = flags & VK_QUERY_RESULT_64_BIT;
+      bool withAvailability = flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+
+      uint32_t valueCount = pool->valueCount + (withAvailability ? 1u : 0u);
+
+      for (uint32_t i = 0; i < queryCount; i++) {
+        auto dst = reinterpret_cast<char*>(pData) + i * stride;
+
+        for (uint32_t j = 0; j < valueCount; j++) {
+          uint64_t value = j < pool->valueCount ? result : 1u;
+
+          if (is64Bit) {
+            std::memcpy(dst + j * sizeof(uint64_t), &value, sizeof(uint64_t));
+          } else {
+            uint32_t value32 = uint32_t(value);
+            std::memcpy(dst + j * sizeof(uint32_t), &value32, sizeof(uint32_t));
+          }
+        }
+      }
+
+      return VK_SUCCESS;
+    }
+
+
+    ///////////////////////////////////////////
+    // Resource functions
+
+    VkResult VKAPI_CALL vkCreateBuffer(
+            VkDevice                        device,
+      const VkBufferCreateInfo*             pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkBuffer*                       pBuffer) {
+      auto buffer = new NullBuffer();
+      buffer->size = pCreateInfo->size;
+      buffer->address = g_addressCounter.fetch_add(
+        align(pCreateInfo->size, VkDeviceSize(65536u)),
+        std::memory_order_relaxed);
+
+      *pBuffer = toHandle<VkBuffer>(buffer);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyBuffer(
+            VkDevice                        device,
+            VkBuffer                        buffer,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullBuffer>(buffer);
+    }
+
+
+    VkDeviceAddress VKAPI_CALL vkGetBufferDeviceAddress(
+            VkDevice                        device,
+      const VkBufferDeviceAddressInfo*      pInfo) {
+      return fromHandle<NullBuffer>(pInfo->buffer)->address;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateImage(
+            VkDevice                        device,
+      const VkImageCreateInfo*              pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkImage*                        pImage) {
+      auto image = new NullImage();
+      image->info = *pCreateInfo;
+      image->info.pNext = nullptr;
+      image->info.queueFamilyIndexCount = 0u;
+      image->info.pQueueFamilyIndices = nullptr;
+
+      *pImage = toHandle<VkImage>(image);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyImage(
+            VkDevice                        device,
+            VkImage                         image,
+      const VkAllocationCallbacks*          pAllocator) {
+      delete fromHandle<NullImage>(image);
+    }
+
+
+    void VKAPI_CALL vkGetImageSubresourceLayout(
+            VkDevice                        device,
+            VkImage                         image,
+      const VkImageSubresource*             pSubresource,
+            VkSubresourceLayout*            pLayout) {
+      computeImageLayout(fromHandle<NullImage>(image)->info, pSubresource, pLayout);
+    }
+
+
+    void VKAPI_CALL vkGetImageSubresourceLayout2KHR(
+            VkDevice                        device,
+            VkImage                         image,
+      const VkImageSubresource2KHR*         pSubresource,
+            VkSubresourceLayout2KHR*        pLayout) {
+      computeImageLayout(fromHandle<NullImage>(image)->info,
+        &pSubresource->imageSubresource, &pLayout->subresourceLayout);
+    }
+
+
+    void VKAPI_CALL vkGetDeviceImageSubresourceLayoutKHR(
+            VkDevice                        device,
+      const VkDeviceImageSubresourceInfoKHR* pInfo,
+            VkSubresourceLayout2KHR*        pLayout) {
+      computeImageLayout(*pInfo->pCreateInfo,
+        &pInfo->pSubresource->imageSubresource, &pLayout->subresourceLayout);
+    }
+
+
+    ///////////////////////////////////////////
+    // Stateless objects
+    //
+    // These objects do not need any state for the null driver
+    // to function, so we only need to generate unique handles.
+
+    #define NULL_DEFINE_CREATE(fn, InfoType, HandleType)    \
+    VkResult VKAPI_CALL fn(                                 \
+            VkDevice                        device,         \
+      const InfoType*                       pCreateInfo,    \
+      const VkAllocationCallbacks*          pAllocator,     \
+            HandleType*                     pHandle) {      \
+      *pHandle = allocHandle<HandleType>();                 \
+      return VK_SUCCESS;                                    \
+    }
+
+    NULL_DEFINE_CREATE(vkCreateBufferView,              VkBufferViewCreateInfo,               VkBufferView)
+    NULL_DEFINE_CREATE(vkCreateImageView,               VkImageViewCreateInfo,                VkImageView)
+    NULL_DEFINE_CREATE(vkCreateShaderModule,            VkShaderModuleCreateInfo,             VkShaderModule)
+    NULL_DEFINE_CREATE(vkCreatePipelineCache,           VkPipelineCacheCreateInfo,            VkPipelineCache)
+    NULL_DEFINE_CREATE(vkCreatePipelineLayout,          VkPipelineLayoutCreateInfo,           VkPipelineLayout)
+    NULL_DEFINE_CREATE(vkCreateSampler,                 VkSamplerCreateInfo,                  VkSampler)
+    NULL_DEFINE_CREATE(vkCreateDescriptorSetLayout,     VkDescriptorSetLayoutCreateInfo,      VkDescriptorSetLayout)
+    NULL_DEFINE_CREATE(vkCreateDescriptorPool,          VkDescriptorPoolCreateInfo,           VkDescriptorPool)
+    NULL_DEFINE_CREATE(vkCreateFramebuffer,             VkFramebufferCreateInfo,              VkFramebuffer)
+    NULL_DEFINE_CREATE(vkCreateRenderPass,              VkRenderPassCreateInfo,               VkRenderPass)
+    NULL_DEFINE_CREATE(vkCreateRenderPass2,             VkRenderPassCreateInfo2,              VkRenderPass)
+    NULL_DEFINE_CREATE(vkCreateCommandPool,             VkCommandPoolCreateInfo,              VkCommandPool)
+    NULL_DEFINE_CREATE(vkCreateDescriptorUpdateTemplate,VkDescriptorUpdateTemplateCreateInfo, VkDescriptorUpdateTemplate)
+
+    #undef NULL_DEFINE_CREATE
+
+
+    VkResult VKAPI_CALL vkGetPipelineCacheData(
+            VkDevice                        device,
+            VkPipelineCache                 pipelineCache,
+            size_t*                         pDataSize,
+            void*                           pData) {
+      *pDataSize = 0u;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateGraphicsPipelines(
+            VkDevice                        device,
+            VkPipelineCache                 pipelineCache,
+            uint32_t                        createInfoCount,
+      const VkGraphicsPipelineCreateInfo*   pCreateInfos,
+      const VkAllocationCallbacks*          pAllocator,
+            VkPipeline*                     pPipelines) {
+      for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = allocHandle<VkPipeline>();
+
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateComputePipelines(
+            VkDevice                        device,
+            VkPipelineCache                 pipelineCache,
+            uint32_t                        createInfoCount,
+      const VkComputePipelineCreateInfo*    pCreateInfos,
+      const VkAllocationCallbacks*          pAllocator,
+            VkPipeline*                     pPipelines) {
+      for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = allocHandle<VkPipeline>();
+
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkAllocateDescriptorSets(
+            VkDevice                        device,
+      const VkDescriptorSetAllocateInfo*    pAllocateInfo,
+            VkDescriptorSet*                pDescriptorSets) {
+      for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++)
+        pDescriptorSets[i] = allocHandle<VkDescriptorSet>();
+
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkAllocateCommandBuffers(
+            VkDevice                        device,
+      const VkCommandBufferAllocateInfo*    pAllocateInfo,
+            VkCommandBuffer*                pCommandBuffers) {
+      for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++)
+        pCommandBuffers[i] = allocHandle<VkCommandBuffer>();
+
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkGetRenderAreaGranularity(
+            VkDevice                        device,
+            VkRenderPass                    renderPass,
+            VkExtent2D*                     pGranularity) {
+      *pGranularity = { 1u, 1u };
+    }
+
+
+    void VKAPI_CALL vkGetRenderingAreaGranularityKHR(
+            VkDevice                        device,
+      const VkRenderingAreaInfoKHR*         pRenderingAreaInfo,
+            VkExtent2D*                     pGranularity) {
+      *pGranularity = { 1u, 1u };
+    }
+
+
+    ///////////////////////////////////////////
+    // Swap chain functions
+
+    VkResult VKAPI_CALL vkCreateSwapchainKHR(
+            VkDevice                        device,
+      const VkSwapchainCreateInfoKHR*       pCreateInfo,
+      const VkAllocationCallbacks*          pAllocator,
+            VkSwapchainKHR*                 pSwapchain) {
+      VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+      imageInfo.imageType = VK_IMAGE_TYPE_2D;
+      imageInfo.format = pCreateInfo->imageFormat;
+      imageInfo.extent = { pCreateInfo->imageExtent.width, pCreateInfo->imageExtent.height, 1u };
+      imageInfo.mipLevels = 1u;
+      imageInfo.arrayLayers = pCreateInfo->imageArrayLayers;
+      imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+      imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+      imageInfo.usage = pCreateInfo->imageUsage;
+      imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+      auto swapchain = new NullSwapchain();
+      swapchain->images.resize(std::max(pCreateInfo->minImageCount, 1u));
+
+      for (auto& image : swapchain->images)
+        vkCreateImage(device, &imageInfo, pAllocator, &image);
+
+      *pSwapchain = toHandle<VkSwapchainKHR>(swapchain);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroySwapchainKHR(
+            VkDevice                        device,
+            VkSwapchainKHR                  swapchain,
+      const VkAllocationCallbacks*          pAllocator) {
+      auto object = fromHandle<NullSwapchain>(swapchain);
+
+      if (object) {
+        for (auto image : object->images)
+          vkDestroyImage(device, image, pAllocator);
+
+        delete object;
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkGetSwapchainImagesKHR(
+            VkDevice                        device,
+            VkSwapchainKHR                  swapchain,
+            uint32_t*                       pSwapchainImageCount,
+            VkImage*                        pSwapchainImages) {
+      auto object = fromHandle<NullSwapchain>(swapchain);
+
+      return enumerate(pSwapchainImageCount, pSwapchainImages,
+        object->images.data(), object->images.size());
+    }
+
+
+    VkResult VKAPI_CALL vkAcquireNextImageKHR(
+            VkDevice                        device,
+            VkSwapchainKHR                  swapchain,
+            uint64_t                        timeout,
+            VkSemaphore                     semaphore,
+            VkFence                         fence,
+            uint32_t*                       pImageIndex) {
+      auto object = fromHandle<NullSwapchain>(swapchain);
+
+      *pImageIndex = object->nextImage;
+      object->nextImage = (object->nextImage + 1u) % object->images.size();
+
+      signalFence(fence);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkQueuePresentKHR(
+            VkQueue                         queue,
+      const VkPresentInfoKHR*               pPresentInfo) {
+      if (pPresentInfo->pResults) {
+        for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++)
+          pPresentInfo->pResults[i] = VK_SUCCESS;
+      }
+
+      return VK_SUCCESS;
+    }
+
+
+    PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(
+            VkInstance                      instance,
+      const char*                           pName);
+
+    PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(
+            VkDevice                        device,
+      const char*                           pName);
+
+
+    /**
+     * \brief Stub for functions without side effects
+     *
+     * Returns \c VK_SUCCESS for functions returning a \c VkResult,
+     * and a default-constructed value for all other functions.
+     */
+    template<typename Fn>
+    struct NullStub;
+
+    template<typename R, typename... Args>
+    struct NullStub<R (VKAPI_PTR*)(Args...)> {
+      static R VKAPI_CALL call(Args...) {
+        if constexpr (std::is_same_v<R, VkResult>)
+          return VK_SUCCESS;
+        else if constexpr (!std::is_void_v<R>)
+          return R();
+      }
+    };
+
+
+    /**
+     * \brief Wrapper that logs calls before forwarding them
+     */
+    template<typename Fn, const char* Name, Fn Impl>
+    struct NullTrace;
+
+    template<typename R, typename... Args, const char* Name, R (VKAPI_PTR* Impl)(Args...)>
+    struct NullTrace<R (VKAPI_PTR*)(Args...), Name, Impl> {
+      static R VKAPI_CALL call(Args... args) {
+        Logger::info(str::format("NullDriver: ", Name));
+        return Impl(args...);
+      }
+    };
+
+
+    #define NULL_STUB_FUNCTIONS(X)                \
+      X(vkDestroyInstance)                        \
+      X(vkDestroySurfaceKHR)                      \
+      X(vkQueueWaitIdle)                          \
+      X(vkDeviceWaitIdle)                         \
+      X(vkUnmapMemory)                            \
+      X(vkFlushMappedMemoryRanges)                \
+      X(vkInvalidateMappedMemoryRanges)           \
+      X(vkBindBufferMemory)                       \
+      X(vkBindImageMemory)                        \
+      X(vkDestroyBufferView)                      \
+      X(vkDestroyImageView)                       \
+      X(vkDestroyShaderModule)                    \
+      X(vkDestroyPipelineCache)                   \
+      X(vkMergePipelineCaches)                    \
+      X(vkDestroyPipeline)                        \
+      X(vkDestroyPipelineLayout)                  \
+      X(vkDestroySampler)                         \
+      X(vkDestroyDescriptorSetLayout)             \
+      X(vkDestroyDescriptorPool)                  \
+      X(vkResetDescriptorPool)                    \
+      X(vkFreeDescriptorSets)                     \
+      X(vkUpdateDescriptorSets)                   \
+      X(vkDestroyFramebuffer)                     \
+      X(vkDestroyRenderPass)                      \
+      X(vkDestroyCommandPool)                     \
+      X(vkResetCommandPool)                       \
+      X(vkFreeCommandBuffers)                     \
+      X(vkBeginCommandBuffer)                     \
+      X(vkEndCommandBuffer)                       \
+      X(vkResetCommandBuffer)                     \
+      X(vkDestroyDescriptorUpdateTemplate)        \
+      X(vkUpdateDescriptorSetWithTemplate)        \
+      X(vkResetQueryPool)                         \
+      X(vkCmdBindPipeline)                        \
+      X(vkCmdSetViewport)                         \
+      X(vkCmdSetScissor)                          \
+      X(vkCmdSetLineWidth)                        \
+      X(vkCmdSetDepthBias)                        \
+      X(vkCmdSetBlendConstants)                   \
+      X(vkCmdSetDepthBounds)                      \
+      X(vkCmdSetStencilCompareMask)               \
+      X(vkCmdSetStencilWriteMask)                 \
+      X(vkCmdSetStencilReference)                 \
+      X(vkCmdBindVertexBuffers2)                  \
+      X(vkCmdSetCullMode)                         \
+      X(vkCmdSetDepthBoundsTestEnable)            \
+      X(vkCmdSetDepthCompareOp)                   \
+      X(vkCmdSetDepthTestEnable)                  \
+      X(vkCmdSetDepthWriteEnable)                 \
+      X(vkCmdSetFrontFace)                        \
+      X(vkCmdSetPrimitiveTopology)                \
+      X(vkCmdSetScissorWithCount)                 \
+      X(vkCmdSetStencilOp)                        \
+      X(vkCmdSetStencilTestEnable)                \
+      X(vkCmdSetViewportWithCount)                \
+      X(vkCmdSetRasterizerDiscardEnable)          \
+      X(vkCmdSetDepthBiasEnable)                  \
+      X(vkCmdSetPrimitiveRestartEnable)           \
+      X(vkCmdBindDescriptorSets)                  \
+      X(vkCmdBindIndexBuffer)                     \
+      X(vkCmdBindVertexBuffers)                   \
+      X(vkCmdDraw)                                \
+      X(vkCmdDrawIndexed)                         \
+      X(vkCmdDrawIndirect)                        \
+      X(vkCmdDrawIndirectCount)                   \
+      X(vkCmdDrawIndexedIndirect)                 \
+      X(vkCmdDrawIndexedIndirectCount)            \
+      X(vkCmdDispatch)                            \
+      X(vkCmdDispatchIndirect)                    \
+      X(vkCmdCopyBuffer)                          \
+      X(vkCmdCopyBuffer2)                         \
+      X(vkCmdCopyImage)                           \
+      X(vkCmdCopyImage2)                          \
+      X(vkCmdBlitImage)                           \
+      X(vkCmdBlitImage2)                          \
+      X(vkCmdCopyBufferToImage)                   \
+      X(vkCmdCopyBufferToImage2)                  \
+      X(vkCmdCopyImageToBuffer)                   \
+      X(vkCmdCopyImageToBuffer2)                  \
+      X(vkCmdUpdateBuffer)                        \
+      X(vkCmdFillBuffer)                          \
+      X(vkCmdClearColorImage)                     \
+      X(vkCmdClearDepthStencilImage)              \
+      X(vkCmdClearAttachments)                    \
+      X(vkCmdResolveImage)                        \
+      X(vkCmdResolveImage2)                       \
+      X(vkCmdSetEvent)                            \
+      X(vkCmdSetEvent2)                           \
+      X(vkCmdResetEvent)                          \
+      X(vkCmdResetEvent2)                         \
+      X(vkCmdWaitEvents)                          \
+      X(vkCmdWaitEvents2)                         \
+      X(vkCmdPipelineBarrier)                     \
+      X(vkCmdPipelineBarrier2)                    \
+      X(vkCmdBeginQuery)                          \
+      X(vkCmdEndQuery)                            \
+      X(vkCmdResetQueryPool)                      \
+      X(vkCmdWriteTimestamp)                      \
+      X(vkCmdWriteTimestamp2)                     \
+      X(vkCmdCopyQueryPoolResults)                \
+      X(vkCmdPushConstants)                       \
+      X(vkCmdBeginRenderPass)                     \
+      X(vkCmdBeginRenderPass2)                    \
+      X(vkCmdNextSubpass)                         \
+      X(vkCmdNextSubpass2)                        \
+      X(vkCmdEndRenderPass)                       \
+      X(vkCmdEndRenderPass2)                      \
+      X(vkCmdBeginRendering)                      \
+      X(vkCmdEndRendering)                        \
+      X(vkCmdExecuteCommands)                     \
+      X(vkCmdBindIndexBuffer2KHR)                 \
+      X(vkCmdBindDescriptorSets2KHR)              \
+      X(vkCmdPushConstants2KHR)                   \
+      X(vkCmdPushDescriptorSet2KHR)               \
+      X(vkCmdPushDescriptorSetWithTemplate2KHR)
+
+    #define NULL_IMPL_FUNCTIONS(X)                \
+      X(vkGetInstanceProcAddr)                    \
+      X(vkGetDeviceProcAddr)                      \
+      X(vkEnumerateInstanceVersion)               \
+      X(vkEnumerateInstanceLayerProperties)       \
+      X(vkEnumerateInstanceExtensionProperties)   \
+      X(vkCreateInstance)                         \
+      X(vkEnumeratePhysicalDevices)               \
+      X(vkEnumerateDeviceExtensionProperties)     \
+      X(vkGetPhysicalDeviceFeatures)              \
+      X(vkGetPhysicalDeviceFeatures2)             \
+      X(vkGetPhysicalDeviceProperties)            \
+      X(vkGetPhysicalDeviceProperties2)           \
+      X(vkGetPhysicalDeviceFormatProperties)      \
+      X(vkGetPhysicalDeviceFormatProperties2)     \
+      X(vkGetPhysicalDeviceImageFormatProperties) \
+      X(vkGetPhysicalDeviceImageFormatProperties2)\
+      X(vkGetPhysicalDeviceMemoryProperties)      \
+      X(vkGetPhysicalDeviceMemoryProperties2)     \
+      X(vkGetPhysicalDeviceQueueFamilyProperties) \
+      X(vkGetPhysicalDeviceQueueFamilyProperties2)\
+      X(vkGetPhysicalDeviceSparseImageFormatProperties) \
+      X(vkGetPhysicalDeviceSparseImageFormatProperties2) \
+      X(vkGetPhysicalDeviceExternalSemaphoreProperties) \
+      X(vkCreateWin32SurfaceKHR)                  \
+      X(vkGetPhysicalDeviceWin32PresentationSupportKHR) \
+      X(vkGetPhysicalDeviceSurfaceSupportKHR)     \
+      X(vkGetPhysicalDeviceSurfaceCapabilitiesKHR)\
+      X(vkGetPhysicalDeviceSurfaceFormatsKHR)     \
+      X(vkGetPhysicalDeviceSurfacePresentModesKHR)\
+      X(vkCreateDevice)                           \
+      X(vkDestroyDevice)                          \
+      X(vkGetDeviceQueue)                         \
+      X(vkQueueSubmit)                            \
+      X(vkQueueSubmit2)                           \
+      X(vkQueueBindSparse)                        \
+      X(vkAllocateMemory)                         \
+      X(vkFreeMemory)                             \
+      X(vkMapMemory)                              \
+      X(vkGetDeviceMemoryCommitment)              \
+      X(vkGetBufferMemoryRequirements)            \
+      X(vkGetBufferMemoryRequirements2)           \
+      X(vkGetDeviceBufferMemoryRequirements)      \
+      X(vkGetImageMemoryRequirements)             \
+      X(vkGetImageMemoryRequirements2)            \
+      X(vkGetDeviceImageMemoryRequirements)       \
+      X(vkGetImageSparseMemoryRequirements)       \
+      X(vkGetImageSparseMemoryRequirements2)      \
+      X(vkCreateFence)                            \
+      X(vkDestroyFence)                           \
+      X(vkResetFences)                            \
+      X(vkGetFenceStatus)                         \
+      X(vkWaitForFences)                          \
+      X(vkCreateSemaphore)                        \
+      X(vkDestroySemaphore)                       \
+      X(vkGetSemaphoreCounterValue)               \
+      X(vkSignalSemaphore)                        \
+      X(vkWaitSemaphores)                         \
+      X(vkCreateEvent)                            \
+      X(vkDestroyEvent)                           \
+      X(vkGetEventStatus)                         \
+      X(vkSetEvent)                               \
+      X(vkResetEvent)                             \
+      X(vkCreateQueryPool)                        \
+      X(vkDestroyQueryPool)                       \
+      X(vkGetQueryPoolResults)                    \
+      X(vkCreateBuffer)                           \
+      X(vkDestroyBuffer)                          \
+      X(vkGetBufferDeviceAddress)                 \
+      X(vkCreateImage)                            \
+      X(vkDestroyImage)                           \
+      X(vkGetImageSubresourceLayout)              \
+      X(vkGetImageSubresourceLayout2KHR)          \
+      X(vkGetDeviceImageSubresourceLayoutKHR)     \
+      X(vkCreateBufferView)                       \
+      X(vkCreateImageView)                        \
+      X(vkCreateShaderModule)                     \
+      X(vkCreatePipelineCache)                    \
+      X(vkGetPipelineCacheData)                   \
+      X(vkCreateGraphicsPipelines)                \
+      X(vkCreateComputePipelines)                 \
+      X(vkCreatePipelineLayout)                   \
+      X(vkCreateSampler)                          \
+      X(vkCreateDescriptorSetLayout)              \
+      X(vkCreateDescriptorPool)                   \
+      X(vkAllocateDescriptorSets)                 \
+      X(vkCreateFramebuffer)                      \
+      X(vkCreateRenderPass)                       \
+      X(vkCreateRenderPass2)                      \
+      X(vkGetRenderAreaGranularity)               \
+      X(vkGetRenderingAreaGranularityKHR)         \
+      X(vkCreateCommandPool)                      \
+      X(vkAllocateCommandBuffers)                 \
+      X(vkCreateDescriptorUpdateTemplate)         \
+      X(vkCreateSwapchainKHR)                     \
+      X(vkDestroySwapchainKHR)                    \
+      X(vkGetSwapchainImagesKHR)                  \
+      X(vkAcquireNextImageKHR)                    \
+      X(vkQueuePresentKHR)
+
+    namespace names {
+      #define NULL_DECLARE_NAME(fn) constexpr char fn[] = #fn;
+      NULL_STUB_FUNCTIONS(NULL_DECLARE_NAME)
+      NULL_IMPL_FUNCTIONS(NULL_DECLARE_NAME)
+      #undef NULL_DECLARE_NAME
+    }
+
+
+    struct NullFunction {
+      const char*         name;
+      PFN_vkVoidFunction  direct;
+      PFN_vkVoidFunction  traced;
+    };
+
+    #define NULL_STUB_ENTRY(fn) { #fn,                                                  \
+      reinterpret_cast<PFN_vkVoidFunction>(&NullStub<PFN_ ## fn>::call),                \
+      reinterpret_cast<PFN_vkVoidFunction>(&NullTrace<PFN_ ## fn, names::fn,            \
+        &NullStub<PFN_ ## fn>::call>::call) },
+
+    #define NULL_IMPL_ENTRY(fn) { #fn,                                                  \
+      reinterpret_cast<PFN_vkVoidFunction>(&null::fn),                                  \
+      reinterpret_cast<PFN_vkVoidFunction>(&NullTrace<PFN_ ## fn, names::fn,            \
+        &null::fn>::call) },
+
+    static const NullFunction g_functions[] = {
+      NULL_STUB_FUNCTIONS(NULL_STUB_ENTRY)
+      NULL_IMPL_FUNCTIONS(NULL_IMPL_ENTRY)
+    };
+
+    #undef NULL_STUB_ENTRY
+    #undef NULL_IMPL_ENTRY
+    #undef NULL_STUB_FUNCTIONS
+    #undef NULL_IMPL_FUNCTIONS
+
+
+    static PFN_vkVoidFunction lookupFunction(const char* pName) {
+      for (const auto& f : g_functions) {
+        if (!std::strcmp(f.name, pName))
+          return g_traceCalls ? f.traced : f.direct;
+      }
+
+      return nullptr;
+    }
+
+
+    PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(
+            VkInstance                      instance,
+      const char*                           pName) {
+      return lookupFunction(pName);
+    }
+
+
+    PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(
+            VkDevice                        device,
+      const char*                           pName) {
+      return lookupFunction(pName);
+    }
+
+  }
+
+
+  NullDriverMode getNullDriverMode() {
+    std::string mode = env::getEnvVar("DXVK_NULL_DRIVER");
+
+    if (mode.empty() || mode == "0")
+      return NullDriverMode::Disabled;
+
+    if (mode == "trace")
+      return NullDriverMode::Trace;
+
+    return NullDriverMode::Enabled;
+  }
+
+
+  PFN_vkGetInstanceProcAddr getNullDriverProc(NullDriverMode mode) {
+    null::g_traceCalls = mode == NullDriverMode::Trace;
+    return &null::vkGetInstanceProcAddr;
+  }
+
+}
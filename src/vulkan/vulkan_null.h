@@ -0,0 +1,38 @@
+#pragma once
+
+#include "vulkan_loader.h"
+
+namespace dxvk::vk {
+
+  /**
+   * \brief Null driver mode
+   */
+  enum class NullDriverMode : uint32_t {
+    Disabled  = 0,  ///< Use the system Vulkan loader
+    Enabled   = 1,  ///< Use the null driver
+    Trace     = 2,  ///< Use the null driver and log all calls
+  };
+
+  /**
+   * \brief Queries null driver mode
+   *
+   * Controlled via the \c DXVK_NULL_DRIVER environment
+   * variable, which can be set to \c 1 or \c trace.
+   * \returns Null driver mode
+   */
+  NullDriverMode getNullDriverMode();
+
+  /**
+   * \brief Retrieves null driver entry point
+   *
+   * The null driver implements enough of the Vulkan API to create
+   * a device and record and submit work without any GPU present,
+   * so that CPU-side code can be profiled in isolation. Commands
+   * are discarded, submissions complete immediately, and only
+   * host-visible memory is actually allocated.
+   * \param [in] mode Null driver mode
+   * \returns Pointer to \c vkGetInstanceProcAddr
+   */
+  PFN_vkGetInstanceProcAddr getNullDriverProc(NullDriverMode mode);
+
+}